@@ -0,0 +1,380 @@
+///////////////////////////////////////////////////////////////////////////////
+// ambientocclusion.cpp
+// ============
+// darken the creases and contact areas of the drawn frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AmbientOcclusion.h"
+#include "DynamicResolution.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// width and height of the work groups of every pass -
+	// must match the shader
+	const int g_GroupSize = 8;
+	// image units the passes read and write
+	const GLuint g_InputImageUnit = 0;
+	const GLuint g_OutputImageUnit = 1;
+	// names of the passes for the error messages
+	const char* g_PassNames[] = { "occlusion", "accumulate", "upsample" };
+
+	// distance around a point searched for occluders, in
+	// world units - about the height of a keyboard key
+	const float g_Radius = 0.35f;
+	// how far the frame is darkened where it is fully occluded
+	const float g_Strength = 0.85f;
+	// weight of the new frame in the accumulated occlusion
+	const float g_HistoryBlend = 0.1f;
+}
+
+/***********************************************************
+ *  AmbientOcclusion()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AmbientOcclusion::AmbientOcclusion()
+{
+	for (int i = 0; i < PASS_COUNT; i++)
+	{
+		m_programIDs[i] = 0;
+	}
+	m_occlusionTextureID = 0;
+	m_historyTextureIDs[0] = 0;
+	m_historyTextureIDs[1] = 0;
+	m_historyIndex = 0;
+	m_bHistoryValid = false;
+	m_resolutionDivisor = 2;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_historyWidth = 0;
+	m_historyHeight = 0;
+	m_previousView = glm::mat4(1.0f);
+	m_previousViewProjection = glm::mat4(1.0f);
+	m_frameIndex = 0;
+}
+
+/***********************************************************
+ *  ~AmbientOcclusion()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AmbientOcclusion::~AmbientOcclusion()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking whether the context has
+ *  compute shaders and image load and store.
+ ***********************************************************/
+bool AmbientOcclusion::IsSupported()
+{
+	return(GLEW_VERSION_4_3);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for building the three passes from
+ *  the shader file.  The textures they work in are created
+ *  by the first Apply(), once the frame size is known.
+ ***********************************************************/
+bool AmbientOcclusion::Create(const char* shaderFilePath, const AssetPack* pAssetPack, int resolutionDivisor)
+{
+	Destroy();
+
+	if ((1 != resolutionDivisor) && (2 != resolutionDivisor) && (4 != resolutionDivisor))
+	{
+		std::cout << "The ambient occlusion resolution must be divided by 1, 2 or 4" << std::endl;
+		return(false);
+	}
+	m_resolutionDivisor = resolutionDivisor;
+
+	AssetPack::ASSET_DATA shaderFile;
+	if (false == pAssetPack->Read(shaderFilePath, shaderFile))
+	{
+		std::cout << "Could not open the ambient occlusion shader: " << shaderFilePath << std::endl;
+		return(false);
+	}
+
+	for (int i = 0; i < PASS_COUNT; i++)
+	{
+		if (false == LoadPass(shaderFile, (PASS)i))
+		{
+			Destroy();
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the shader programs and
+ *  the textures.
+ ***********************************************************/
+void AmbientOcclusion::Destroy()
+{
+	for (int i = 0; i < PASS_COUNT; i++)
+	{
+		if (0 != m_programIDs[i])
+		{
+			GLStateCache::ForgetProgram(m_programIDs[i]);
+			glDeleteProgram(m_programIDs[i]);
+			m_programIDs[i] = 0;
+		}
+	}
+	if (0 != m_occlusionTextureID)
+	{
+		GLStateCache::ForgetTexture(m_occlusionTextureID);
+		glDeleteTextures(1, &m_occlusionTextureID);
+		m_occlusionTextureID = 0;
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		if (0 != m_historyTextureIDs[i])
+		{
+			GLStateCache::ForgetTexture(m_historyTextureIDs[i]);
+			glDeleteTextures(1, &m_historyTextureIDs[i]);
+			m_historyTextureIDs[i] = 0;
+		}
+	}
+
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_bHistoryValid = false;
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method is used for running the passes over the
+ *  drawn part of the frame textures:
+ *    - the occlusion is sampled at the reduced resolution
+ *    - it is blended into the history of the earlier frames,
+ *      found by reprojecting every pixel with the last view,
+ *      unless the depth there shows it was something else
+ *    - the history is scaled up to the frame, weighting the
+ *      four nearest pixels by how close their depth is, and
+ *      the frame color is darkened by it
+ ***********************************************************/
+void AmbientOcclusion::Apply(
+	GLuint colorTextureID,
+	GLuint depthTextureID,
+	int width,
+	int height,
+	const glm::mat4& view,
+	const glm::mat4& projection)
+{
+	if ((0 == m_programIDs[PASS_OCCLUSION]) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	int targetWidth = (width + m_resolutionDivisor - 1) / m_resolutionDivisor;
+	int targetHeight = (height + m_resolutionDivisor - 1) / m_resolutionDivisor;
+	if ((targetWidth > m_targetWidth) || (targetHeight > m_targetHeight))
+	{
+		if (false == CreateTargets(targetWidth, targetHeight))
+		{
+			return;
+		}
+	}
+
+	// a new render scale moves every pixel of the history
+	if ((width != m_historyWidth) || (height != m_historyHeight))
+	{
+		m_bHistoryValid = false;
+		m_historyWidth = width;
+		m_historyHeight = height;
+	}
+
+	glm::mat4 inverseProjection = glm::inverse(projection);
+	glm::vec2 frameSize = glm::vec2((float)width, (float)height);
+	glm::vec2 targetSize = glm::vec2((float)targetWidth, (float)targetHeight);
+	GLuint groupsX = (GLuint)((targetWidth + g_GroupSize - 1) / g_GroupSize);
+	GLuint groupsY = (GLuint)((targetHeight + g_GroupSize - 1) / g_GroupSize);
+	GLuint currentHistoryID = m_historyTextureIDs[m_historyIndex];
+	GLuint previousHistoryID = m_historyTextureIDs[1 - m_historyIndex];
+
+	GLStateCache::BindTexture(DynamicResolution::FRAME_TEXTURE_UNIT, GL_TEXTURE_2D, depthTextureID);
+
+	// sample the occlusion at the reduced resolution
+	GLStateCache::UseProgram(m_programIDs[PASS_OCCLUSION]);
+	GLStateCache::SetMat4Value("projection", projection);
+	GLStateCache::SetMat4Value("inverseProjection", inverseProjection);
+	GLStateCache::SetVec2Value("frameSize", frameSize);
+	GLStateCache::SetVec2Value("targetSize", targetSize);
+	GLStateCache::SetIntValue("resolutionDivisor", m_resolutionDivisor);
+	GLStateCache::SetFloatValue("radius", g_Radius);
+	GLStateCache::SetUIntValue("frameIndex", m_frameIndex);
+	glBindImageTexture(g_OutputImageUnit, m_occlusionTextureID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
+	glDispatchCompute(groupsX, groupsY, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	// blend it into the reprojected history
+	GLStateCache::UseProgram(m_programIDs[PASS_ACCUMULATE]);
+	GLStateCache::SetMat4Value("inverseProjection", inverseProjection);
+	GLStateCache::SetMat4Value("inverseView", glm::inverse(view));
+	GLStateCache::SetMat4Value("previousView", m_previousView);
+	GLStateCache::SetMat4Value("previousViewProjection", m_previousViewProjection);
+	GLStateCache::SetVec2Value("frameSize", frameSize);
+	GLStateCache::SetVec2Value("targetSize", targetSize);
+	GLStateCache::SetIntValue("resolutionDivisor", m_resolutionDivisor);
+	GLStateCache::SetFloatValue("historyBlend", (true == m_bHistoryValid) ? g_HistoryBlend : 1.0f);
+	GLStateCache::BindTexture(HISTORY_UNIT, GL_TEXTURE_2D, previousHistoryID);
+	glBindImageTexture(g_InputImageUnit, m_occlusionTextureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG16F);
+	glBindImageTexture(g_OutputImageUnit, currentHistoryID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
+	glDispatchCompute(groupsX, groupsY, 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	// scale it up and darken the frame, one thread per pixel
+	GLStateCache::UseProgram(m_programIDs[PASS_UPSAMPLE]);
+	GLStateCache::SetMat4Value("inverseProjection", inverseProjection);
+	GLStateCache::SetVec2Value("frameSize", frameSize);
+	GLStateCache::SetVec2Value("targetSize", targetSize);
+	GLStateCache::SetIntValue("resolutionDivisor", m_resolutionDivisor);
+	GLStateCache::SetFloatValue("strength", g_Strength);
+	glBindImageTexture(g_InputImageUnit, currentHistoryID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RG16F);
+	glBindImageTexture(g_OutputImageUnit, colorTextureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+	glDispatchCompute(
+		(GLuint)((width + g_GroupSize - 1) / g_GroupSize),
+		(GLuint)((height + g_GroupSize - 1) / g_GroupSize),
+		1);
+	// the frame is blitted next, and the history is sampled as
+	// a texture in the next frame
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	m_previousView = view;
+	m_previousViewProjection = projection * view;
+	m_historyIndex = 1 - m_historyIndex;
+	m_bHistoryValid = true;
+	m_frameIndex++;
+}
+
+/***********************************************************
+ *  ResetHistory()
+ *
+ *  This method is used for starting the accumulation over
+ *  from the next frame.
+ ***********************************************************/
+void AmbientOcclusion::ResetHistory()
+{
+	m_bHistoryValid = false;
+}
+
+/***********************************************************
+ *  GetResolutionDivisor()
+ *
+ *  This method is used for getting how many times smaller
+ *  than the frame the occlusion is sampled at.
+ ***********************************************************/
+int AmbientOcclusion::GetResolutionDivisor() const
+{
+	return(m_resolutionDivisor);
+}
+
+/***********************************************************
+ *  LoadPass()
+ *
+ *  This method is used for compiling one pass of the shader
+ *  file, with the pass picked by a #define inserted after
+ *  the #version line.
+ ***********************************************************/
+bool AmbientOcclusion::LoadPass(const AssetPack::ASSET_DATA& shaderFile, PASS pass)
+{
+	std::string source((const char*)shaderFile.pData, shaderFile.size);
+	std::string define = "#define AO_PASS " + std::to_string((int)pass) + "\n";
+	size_t versionStart = source.find("#version");
+	size_t lineEnd = (std::string::npos == versionStart) ? std::string::npos : source.find('\n', versionStart);
+	if (std::string::npos == lineEnd)
+	{
+		source = define + source;
+	}
+	else
+	{
+		// the #line keeps the compile errors on the lines of the file
+		source.insert(lineEnd + 1, define + "#line 2\n");
+	}
+
+	const char* pShaderCode = source.c_str();
+	GLint success = 0;
+	char infoLog[512];
+
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shaderID, 1, &pShaderCode, NULL);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+		std::cout << "Failed to compile the ambient occlusion " << g_PassNames[pass] << " pass: " << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(false);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, shaderID);
+	glLinkProgram(programID);
+	glDeleteShader(shaderID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(programID, 512, NULL, infoLog);
+		std::cout << "Failed to link the ambient occlusion " << g_PassNames[pass] << " pass: " << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(false);
+	}
+
+	m_programIDs[pass] = programID;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for allocating the occlusion and the
+ *  two history textures at the reduced resolution.  Each
+ *  holds the occlusion and the linear depth it was found
+ *  at, which the history and the upsample compare against.
+ ***********************************************************/
+bool AmbientOcclusion::CreateTargets(int width, int height)
+{
+	GLuint* pTextureIDs[3] = { &m_occlusionTextureID, &m_historyTextureIDs[0], &m_historyTextureIDs[1] };
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (0 != *pTextureIDs[i])
+		{
+			GLStateCache::ForgetTexture(*pTextureIDs[i]);
+			glDeleteTextures(1, pTextureIDs[i]);
+		}
+
+		glGenTextures(1, pTextureIDs[i]);
+		GLStateCache::BindTexture(HISTORY_UNIT, GL_TEXTURE_2D, *pTextureIDs[i]);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG16F, width, height);
+		// the history is reprojected to points between pixels
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+
+	m_targetWidth = width;
+	m_targetHeight = height;
+	m_bHistoryValid = false;
+
+	return(true);
+}
@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// ambientocclusion.h
+// ============
+// darken the creases and contact areas of the drawn frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/***********************************************************
+ *  AmbientOcclusion
+ *
+ *  This class works out how much of the light around each
+ *  pixel is blocked by the nearby geometry, from the depth
+ *  of the drawn frame alone, and darkens the frame by it.
+ *  The occlusion is sampled at full, half or quarter
+ *  resolution with only a few samples per pixel, rotated
+ *  differently every frame.  The samples are then averaged
+ *  over time in a history reprojected with the camera
+ *  motion, and scaled back up to the frame with weights
+ *  that keep the occlusion from bleeding across depth
+ *  edges.  All three passes are compute shaders built from
+ *  one shader file.
+ ***********************************************************/
+class AmbientOcclusion
+{
+public:
+	// texture unit the history is read from
+	static const int HISTORY_UNIT = 21;
+
+	// constructor
+	AmbientOcclusion();
+	// destructor
+	~AmbientOcclusion();
+
+	// check whether the context has compute shaders and image
+	// load and store, which are core in OpenGL 4.3
+	static bool IsSupported();
+
+	// build the passes from the shader file, to run at the
+	// frame resolution divided by 1, 2 or 4
+	bool Create(const char* shaderFilePath, const AssetPack* pAssetPack, int resolutionDivisor);
+	// free the shader programs and textures
+	void Destroy();
+
+	// darken the lower left width by height pixels of the
+	// frame textures, which were drawn with the passed in
+	// view and projection
+	void Apply(
+		GLuint colorTextureID,
+		GLuint depthTextureID,
+		int width,
+		int height,
+		const glm::mat4& view,
+		const glm::mat4& projection);
+
+	// drop the history, for when the frame it was built from
+	// no longer matches the next one
+	void ResetHistory();
+
+	int GetResolutionDivisor() const;
+
+private:
+	// compute passes, in the order they run
+	enum PASS
+	{
+		PASS_OCCLUSION = 0,
+		PASS_ACCUMULATE,
+		PASS_UPSAMPLE,
+		PASS_COUNT
+	};
+
+	GLuint m_programIDs[PASS_COUNT];
+	// occlusion and linear depth sampled this frame
+	GLuint m_occlusionTextureID;
+	// accumulated occlusion and linear depth of this frame and
+	// the last, swapped every frame
+	GLuint m_historyTextureIDs[2];
+	int m_historyIndex;
+	bool m_bHistoryValid;
+	int m_resolutionDivisor;
+	// size the reduced resolution textures are allocated at
+	int m_targetWidth;
+	int m_targetHeight;
+	// frame size the history was built at
+	int m_historyWidth;
+	int m_historyHeight;
+	// view values of the last frame, for the reprojection
+	glm::mat4 m_previousView;
+	glm::mat4 m_previousViewProjection;
+	// picks the rotation of the samples
+	uint32_t m_frameIndex;
+
+	// compile and link one pass of the shader file
+	bool LoadPass(const AssetPack::ASSET_DATA& shaderFile, PASS pass);
+	// reallocate the reduced resolution textures
+	bool CreateTargets(int width, int height);
+};
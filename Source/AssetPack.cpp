@@ -0,0 +1,694 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.cpp
+// ============
+// read the textures, meshes and shaders from one mapped archive
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "AssetPack.h"
+#include "MeshImporter.h"
+#include "TextureImporter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+static_assert(sizeof(AssetPack::PACK_HEADER) == 32, "PACK_HEADER layout is stored in the pack files");
+static_assert(sizeof(AssetPack::PACK_ENTRY) == 48, "PACK_ENTRY layout is stored in the pack files");
+
+namespace
+{
+	// identifies a pack file
+	const char g_PackMagic[4] = { 'A', 'P', 'A', 'K' };
+	// assets are only stored compressed when it saves at least
+	// this fraction of their size
+	const float g_MinimumCompressionSaving = 0.1f;
+
+	// LZ4 block format limits
+	const size_t g_LZ4MinMatch = 4;
+	const size_t g_LZ4MaxOffset = 65535;
+	// the last match must start this far before the end, and
+	// the last bytes are always literals
+	const size_t g_LZ4MatchStartLimit = 12;
+	const size_t g_LZ4LastLiterals = 5;
+	const int g_LZ4HashBits = 16;
+
+	/***********************************************************
+	 *  NormalizePath()
+	 *
+	 *  This function is used for turning an asset path into the
+	 *  form stored in the pack - forward slashes, lower case,
+	 *  and no leading "./".
+	 ***********************************************************/
+	std::string NormalizePath(const char* assetPath)
+	{
+		std::string path = assetPath;
+		for (size_t i = 0; i < path.size(); i++)
+		{
+			if (path[i] == '\\')
+			{
+				path[i] = '/';
+			}
+			else if ((path[i] >= 'A') && (path[i] <= 'Z'))
+			{
+				path[i] = (char)(path[i] - 'A' + 'a');
+			}
+		}
+		while (path.compare(0, 2, "./") == 0)
+		{
+			path.erase(0, 2);
+		}
+
+		return(path);
+	}
+
+	/***********************************************************
+	 *  HashPath()
+	 *
+	 *  This function is used for hashing a normalized asset
+	 *  path with 64 bit FNV-1a.
+	 ***********************************************************/
+	uint64_t HashPath(const std::string& path)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < path.size(); i++)
+		{
+			hash ^= (unsigned char)path[i];
+			hash *= 1099511628211ULL;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  Read32()
+	 *
+	 *  This function is used for reading four unaligned bytes.
+	 ***********************************************************/
+	inline uint32_t Read32(const unsigned char* p)
+	{
+		uint32_t value;
+		memcpy(&value, p, sizeof(value));
+		return(value);
+	}
+
+	/***********************************************************
+	 *  WriteLength()
+	 *
+	 *  This function is used for writing the part of an LZ4
+	 *  literal or match length that did not fit in the token.
+	 ***********************************************************/
+	void WriteLength(size_t length, std::vector<unsigned char>& output)
+	{
+		while (length >= 255)
+		{
+			output.push_back(255);
+			length -= 255;
+		}
+		output.push_back((unsigned char)length);
+	}
+
+	/***********************************************************
+	 *  ReadLength()
+	 *
+	 *  This function is used for reading the extra bytes of an
+	 *  LZ4 literal or match length.
+	 ***********************************************************/
+	bool ReadLength(const unsigned char*& p, const unsigned char* end, size_t& length)
+	{
+		unsigned char value = 255;
+		while (value == 255)
+		{
+			if (p >= end)
+			{
+				return(false);
+			}
+			value = *p++;
+			length += value;
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  PACK_ITEM
+	 *
+	 *  One asset collected while a pack is being built.
+	 ***********************************************************/
+	struct PACK_ITEM
+	{
+		std::string name;
+		uint64_t hash;
+		uint64_t size;
+		uint32_t compression;
+		std::vector<unsigned char> data;
+	};
+}
+
+/***********************************************************
+ *  AssetPack()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+AssetPack::AssetPack()
+{
+	m_pHeader = NULL;
+	m_pEntries = NULL;
+	m_pNames = NULL;
+}
+
+/***********************************************************
+ *  ~AssetPack()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+AssetPack::~AssetPack()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a pack file and checking
+ *  that its table of contents and every asset it lists are
+ *  inside the file, so reads do not need to check again.
+ ***********************************************************/
+bool AssetPack::Open(const char* filePath)
+{
+	Close();
+
+	if (false == m_packFile.Open(filePath))
+	{
+		std::cout << "Could not open asset pack " << filePath << std::endl;
+		return(false);
+	}
+
+	const unsigned char* pData = m_packFile.GetData();
+	uint64_t size = m_packFile.GetSize();
+	const PACK_HEADER* pHeader = (const PACK_HEADER*)pData;
+	if ((size < sizeof(PACK_HEADER)) ||
+		(memcmp(pHeader->magic, g_PackMagic, sizeof(pHeader->magic)) != 0) ||
+		(PACK_VERSION != pHeader->version) ||
+		((pHeader->entriesOffset % sizeof(uint64_t)) != 0) ||
+		(pHeader->entriesOffset + (uint64_t)pHeader->entryCount * sizeof(PACK_ENTRY) > size) ||
+		(pHeader->namesOffset + pHeader->namesSize > size))
+	{
+		std::cout << filePath << " is not a valid asset pack" << std::endl;
+		m_packFile.Close();
+		return(false);
+	}
+
+	const PACK_ENTRY* pEntries = (const PACK_ENTRY*)(pData + pHeader->entriesOffset);
+	for (uint32_t i = 0; i < pHeader->entryCount; i++)
+	{
+		const PACK_ENTRY& entry = pEntries[i];
+		if ((entry.offset + entry.storedSize > size) ||
+			((uint64_t)entry.nameOffset + entry.nameLength > pHeader->namesSize) ||
+			((COMPRESSION_NONE != entry.compression) && (COMPRESSION_LZ4 != entry.compression)) ||
+			((COMPRESSION_NONE == entry.compression) && (entry.storedSize != entry.size)) ||
+			((i > 0) && (pEntries[i - 1].nameHash > entry.nameHash)))
+		{
+			std::cout << filePath << " has a broken table of contents" << std::endl;
+			m_packFile.Close();
+			return(false);
+		}
+	}
+
+	m_pHeader = pHeader;
+	m_pEntries = pEntries;
+	m_pNames = (const char*)(pData + pHeader->namesOffset);
+
+	std::cout << "Opened asset pack " << filePath << " with " << pHeader->entryCount << " assets" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the pack file.  Asset
+ *  data read from the pack must not be used afterwards.
+ ***********************************************************/
+void AssetPack::Close()
+{
+	m_packFile.Close();
+	m_pHeader = NULL;
+	m_pEntries = NULL;
+	m_pNames = NULL;
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method is used for checking whether a pack is open.
+ ***********************************************************/
+bool AssetPack::IsOpen() const
+{
+	return(NULL != m_pHeader);
+}
+
+/***********************************************************
+ *  FindEntry()
+ *
+ *  This method is used for finding an asset in the table of
+ *  contents with a binary search on the path hash.  The
+ *  paths are compared as well, in case two of them share a
+ *  hash.
+ ***********************************************************/
+const AssetPack::PACK_ENTRY* AssetPack::FindEntry(const char* assetPath) const
+{
+	if (NULL == m_pHeader)
+	{
+		return(NULL);
+	}
+
+	std::string path = NormalizePath(assetPath);
+	uint64_t hash = HashPath(path);
+
+	const PACK_ENTRY* pFirst = m_pEntries;
+	const PACK_ENTRY* pLast = m_pEntries + m_pHeader->entryCount;
+	const PACK_ENTRY* pEntry = std::lower_bound(pFirst, pLast, hash,
+		[](const PACK_ENTRY& entry, uint64_t value)
+		{
+			return(entry.nameHash < value);
+		});
+
+	for (; (pEntry < pLast) && (pEntry->nameHash == hash); pEntry++)
+	{
+		if ((pEntry->nameLength == path.size()) &&
+			(memcmp(m_pNames + pEntry->nameOffset, path.data(), path.size()) == 0))
+		{
+			return(pEntry);
+		}
+	}
+
+	return(NULL);
+}
+
+/***********************************************************
+ *  Contains()
+ *
+ *  This method is used for checking whether an asset is
+ *  stored in the open pack.
+ ***********************************************************/
+bool AssetPack::Contains(const char* assetPath) const
+{
+	return(NULL != FindEntry(assetPath));
+}
+
+/***********************************************************
+ *  Read()
+ *
+ *  This method is used for getting the contents of an
+ *  asset.  Uncompressed packed assets point straight into
+ *  the mapped pack, so nothing is copied.  Compressed ones
+ *  are decompressed into the storage of the asset, and
+ *  assets that are not packed are mapped from their loose
+ *  files.  It can be called from any thread.
+ ***********************************************************/
+bool AssetPack::Read(const char* assetPath, ASSET_DATA& asset) const
+{
+	asset.pData = NULL;
+	asset.size = 0;
+	asset.bPacked = false;
+	asset.looseFile.Close();
+	asset.storage.clear();
+
+	const PACK_ENTRY* pEntry = FindEntry(assetPath);
+	if (NULL != pEntry)
+	{
+		const unsigned char* pStored = m_packFile.GetData() + pEntry->offset;
+		if (COMPRESSION_NONE == pEntry->compression)
+		{
+			asset.pData = pStored;
+		}
+		else
+		{
+			asset.storage.resize((size_t)pEntry->size);
+			if (false == DecompressLZ4(pStored, (size_t)pEntry->storedSize, asset.storage.data(), asset.storage.size()))
+			{
+				std::cout << "Could not decompress asset " << assetPath << std::endl;
+				asset.storage.clear();
+				return(false);
+			}
+			asset.pData = asset.storage.data();
+		}
+		asset.size = (size_t)pEntry->size;
+		asset.bPacked = true;
+		return(true);
+	}
+
+	if (false == asset.looseFile.Open(assetPath))
+	{
+		return(false);
+	}
+	asset.pData = asset.looseFile.GetData();
+	asset.size = asset.looseFile.GetSize();
+
+	return(true);
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for writing a pack file from the
+ *  assets listed in a manifest.  Blank lines and lines that
+ *  start with # are skipped.  OBJ and glTF models are
+ *  imported and stored as their mesh cache, and images as
+ *  their texture cache, under the path the loaders look
+ *  for.  Each asset is compressed when that saves enough,
+ *  and the table of contents is sorted by path hash.
+ ***********************************************************/
+bool AssetPack::Build(const char* manifestPath, const char* packPath)
+{
+	std::ifstream manifest(manifestPath);
+	if (!manifest.is_open())
+	{
+		std::cout << "Could not open asset manifest " << manifestPath << std::endl;
+		return(false);
+	}
+
+	std::vector<PACK_ITEM> items;
+	std::string line;
+	while (std::getline(manifest, line))
+	{
+		while ((false == line.empty()) &&
+			((line.back() == '\r') || (line.back() == ' ') || (line.back() == '\t')))
+		{
+			line.pop_back();
+		}
+		if ((true == line.empty()) || (line[0] == '#'))
+		{
+			continue;
+		}
+
+		PACK_ITEM item;
+		std::string path = NormalizePath(line.c_str());
+		size_t dot = path.find_last_of('.');
+		std::string extension = (dot == std::string::npos) ? std::string() : path.substr(dot);
+		if ((extension == ".obj") || (extension == ".gltf") || (extension == ".glb"))
+		{
+			MESH_DATA mesh;
+			if (false == MeshImporter::Import(line.c_str(), mesh))
+			{
+				return(false);
+			}
+			MeshImporter::BuildCache(line.c_str(), mesh, item.data);
+			item.name = NormalizePath(MeshImporter::GetCachePath(line.c_str()).c_str());
+		}
+		else if ((extension == ".jpg") || (extension == ".jpeg") || (extension == ".png") ||
+			(extension == ".tga") || (extension == ".bmp"))
+		{
+			MappedFile file;
+			if ((false == file.Open(line.c_str())) ||
+				(false == TextureImporter::Import(
+					file.GetData(),
+					file.GetSize(),
+					TextureImporter::DEFAULT_FILTER,
+					line.c_str(),
+					item.data)))
+			{
+				std::cout << "Could not import image " << line << std::endl;
+				return(false);
+			}
+			item.name = NormalizePath(TextureImporter::GetCachePath(line.c_str()).c_str());
+		}
+		else
+		{
+			MappedFile file;
+			if (false == file.Open(line.c_str()))
+			{
+				std::cout << "Could not open asset " << line << std::endl;
+				return(false);
+			}
+			item.data.assign(file.GetData(), file.GetData() + file.GetSize());
+			item.name = path;
+		}
+
+		item.hash = HashPath(item.name);
+		item.size = item.data.size();
+		item.compression = COMPRESSION_NONE;
+
+		std::vector<unsigned char> compressed;
+		CompressLZ4(item.data.data(), item.data.size(), compressed);
+		if ((float)compressed.size() < (float)item.data.size() * (1.0f - g_MinimumCompressionSaving))
+		{
+			item.data.swap(compressed);
+			item.compression = COMPRESSION_LZ4;
+		}
+
+		items.push_back(std::move(item));
+	}
+
+	std::sort(items.begin(), items.end(),
+		[](const PACK_ITEM& a, const PACK_ITEM& b)
+		{
+			return(a.hash < b.hash);
+		});
+
+	// header, table of contents and names, then the aligned assets
+	PACK_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_PackMagic, sizeof(header.magic));
+	header.version = PACK_VERSION;
+	header.entryCount = (uint32_t)items.size();
+	header.entriesOffset = sizeof(PACK_HEADER);
+	header.namesOffset = header.entriesOffset + items.size() * sizeof(PACK_ENTRY);
+
+	std::vector<PACK_ENTRY> entries(items.size());
+	std::string names;
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		if ((i > 0) && (items[i].name == items[i - 1].name))
+		{
+			std::cout << "Asset " << items[i].name << " is listed twice in " << manifestPath << std::endl;
+			return(false);
+		}
+
+		memset(&entries[i], 0, sizeof(PACK_ENTRY));
+		entries[i].nameHash = items[i].hash;
+		entries[i].nameOffset = (uint32_t)names.size();
+		entries[i].nameLength = (uint32_t)items[i].name.size();
+		entries[i].storedSize = items[i].data.size();
+		entries[i].size = items[i].size;
+		entries[i].compression = items[i].compression;
+		names += items[i].name;
+	}
+	header.namesSize = (uint32_t)names.size();
+
+	uint64_t offset = header.namesOffset + names.size();
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		offset = (offset + ASSET_ALIGNMENT - 1) & ~(uint64_t)(ASSET_ALIGNMENT - 1);
+		entries[i].offset = offset;
+		offset += entries[i].storedSize;
+	}
+
+	std::ofstream packFile(packPath, std::ios::binary | std::ios::trunc);
+	if (!packFile.is_open())
+	{
+		std::cout << "Could not write asset pack " << packPath << std::endl;
+		return(false);
+	}
+
+	const char padding[ASSET_ALIGNMENT] = { 0 };
+	uint64_t written = header.namesOffset + names.size();
+	packFile.write((const char*)&header, sizeof(header));
+	packFile.write((const char*)entries.data(), entries.size() * sizeof(PACK_ENTRY));
+	packFile.write(names.data(), names.size());
+	for (size_t i = 0; i < items.size(); i++)
+	{
+		packFile.write(padding, (std::streamsize)(entries[i].offset - written));
+		packFile.write((const char*)items[i].data.data(), items[i].data.size());
+		written = entries[i].offset + entries[i].storedSize;
+	}
+	packFile.close();
+
+	if (packFile.fail())
+	{
+		std::cout << "Could not write asset pack " << packPath << std::endl;
+		return(false);
+	}
+
+	uint64_t originalSize = 0;
+	int compressedCount = 0;
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		originalSize += entries[i].size;
+		compressedCount += (COMPRESSION_LZ4 == entries[i].compression) ? 1 : 0;
+	}
+	std::cout << "Wrote asset pack " << packPath << " with " << entries.size() << " assets, "
+		<< compressedCount << " compressed, " << written << " of " << originalSize << " bytes" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CompressLZ4()
+ *
+ *  This method is used for compressing a buffer into the LZ4
+ *  block format with a greedy single probe hash table.  It
+ *  trades some ratio for speed, and the output can be read
+ *  by any LZ4 block decoder.
+ ***********************************************************/
+void AssetPack::CompressLZ4(
+	const unsigned char* pSource,
+	size_t sourceSize,
+	std::vector<unsigned char>& compressed)
+{
+	compressed.clear();
+	compressed.reserve(sourceSize + sourceSize / 255 + 16);
+
+	// positions plus one, so zero means an empty slot
+	std::vector<uint32_t> hashTable((size_t)1 << g_LZ4HashBits, 0);
+	size_t anchor = 0;
+	size_t position = 0;
+
+	if (sourceSize > g_LZ4MatchStartLimit)
+	{
+		size_t matchStartLimit = sourceSize - g_LZ4MatchStartLimit;
+		size_t matchEndLimit = sourceSize - g_LZ4LastLiterals;
+
+		while (position < matchStartLimit)
+		{
+			uint32_t sequence = Read32(pSource + position);
+			uint32_t hash = (sequence * 2654435761U) >> (32 - g_LZ4HashBits);
+			size_t candidate = hashTable[hash];
+			hashTable[hash] = (uint32_t)(position + 1);
+
+			if ((0 == candidate) ||
+				(position - (candidate - 1) > g_LZ4MaxOffset) ||
+				(Read32(pSource + candidate - 1) != sequence))
+			{
+				position++;
+				continue;
+			}
+
+			size_t match = candidate - 1;
+			size_t matchLength = g_LZ4MinMatch;
+			while ((position + matchLength < matchEndLimit) &&
+				(pSource[match + matchLength] == pSource[position + matchLength]))
+			{
+				matchLength++;
+			}
+
+			// token, literals, offset and match length
+			size_t literalLength = position - anchor;
+			size_t extraMatchLength = matchLength - g_LZ4MinMatch;
+			compressed.push_back((unsigned char)(
+				((literalLength < 15 ? literalLength : 15) << 4) |
+				(extraMatchLength < 15 ? extraMatchLength : 15)));
+			if (literalLength >= 15)
+			{
+				WriteLength(literalLength - 15, compressed);
+			}
+			compressed.insert(compressed.end(), pSource + anchor, pSource + position);
+			size_t offset = position - match;
+			compressed.push_back((unsigned char)(offset & 0xFF));
+			compressed.push_back((unsigned char)(offset >> 8));
+			if (extraMatchLength >= 15)
+			{
+				WriteLength(extraMatchLength - 15, compressed);
+			}
+
+			position += matchLength;
+			anchor = position;
+		}
+	}
+
+	// the last sequence is only literals
+	size_t literalLength = sourceSize - anchor;
+	compressed.push_back((unsigned char)((literalLength < 15 ? literalLength : 15) << 4));
+	if (literalLength >= 15)
+	{
+		WriteLength(literalLength - 15, compressed);
+	}
+	compressed.insert(compressed.end(), pSource + anchor, pSource + sourceSize);
+}
+
+/***********************************************************
+ *  DecompressLZ4()
+ *
+ *  This method is used for decompressing an LZ4 block into
+ *  a buffer of the exact original size.  Every length and
+ *  offset is checked, so a damaged block fails instead of
+ *  writing outside the buffer.
+ ***********************************************************/
+bool AssetPack::DecompressLZ4(
+	const unsigned char* pSource,
+	size_t sourceSize,
+	unsigned char* pDestination,
+	size_t destinationSize)
+{
+	const unsigned char* p = pSource;
+	const unsigned char* end = pSource + sourceSize;
+	size_t written = 0;
+
+	while (p < end)
+	{
+		unsigned char token = *p++;
+
+		size_t literalLength = token >> 4;
+		if ((literalLength == 15) && (false == ReadLength(p, end, literalLength)))
+		{
+			return(false);
+		}
+		if ((literalLength > (size_t)(end - p)) || (literalLength > destinationSize - written))
+		{
+			return(false);
+		}
+		memcpy(pDestination + written, p, literalLength);
+		p += literalLength;
+		written += literalLength;
+
+		// the last sequence has no match
+		if (p >= end)
+		{
+			break;
+		}
+
+		if (end - p < 2)
+		{
+			return(false);
+		}
+		size_t offset = (size_t)p[0] | ((size_t)p[1] << 8);
+		p += 2;
+		if ((0 == offset) || (offset > written))
+		{
+			return(false);
+		}
+
+		size_t matchLength = token & 15;
+		if ((matchLength == 15) && (false == ReadLength(p, end, matchLength)))
+		{
+			return(false);
+		}
+		matchLength += g_LZ4MinMatch;
+		if (matchLength > destinationSize - written)
+		{
+			return(false);
+		}
+
+		// the match can overlap the bytes it is writing
+		const unsigned char* pMatch = pDestination + written - offset;
+		unsigned char* pOutput = pDestination + written;
+		if (offset >= matchLength)
+		{
+			memcpy(pOutput, pMatch, matchLength);
+		}
+		else
+		{
+			for (size_t i = 0; i < matchLength; i++)
+			{
+				pOutput[i] = pMatch[i];
+			}
+		}
+		written += matchLength;
+	}
+
+	return(written == destinationSize);
+}
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// assetpack.h
+// ============
+// read the textures, meshes and shaders from one mapped archive
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  AssetPack
+ *
+ *  This class reads assets out of a single pack file that
+ *  is mapped into memory.  The pack starts with a table of
+ *  contents sorted by the hash of each asset path, and every
+ *  asset is stored aligned so it can be handed to OpenGL or
+ *  a decoder in place.  Assets that shrink enough are stored
+ *  LZ4 compressed and are decompressed when they are read.
+ *
+ *  Assets that are not in the pack, or every asset when no
+ *  pack is open, are read from the loose files instead.
+ ***********************************************************/
+class AssetPack
+{
+public:
+	// how an asset is stored in the pack
+	enum COMPRESSION
+	{
+		COMPRESSION_NONE = 0,
+		COMPRESSION_LZ4 = 1
+	};
+
+	// header at the start of the pack file
+	struct PACK_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t entryCount;
+		uint32_t namesSize;
+		// byte offsets from the start of the file
+		uint64_t entriesOffset;
+		uint64_t namesOffset;
+	};
+
+	// table of contents entry for one asset
+	struct PACK_ENTRY
+	{
+		// hash of the normalized path, which the entries are
+		// sorted by
+		uint64_t nameHash;
+		// normalized path in the names block
+		uint32_t nameOffset;
+		uint32_t nameLength;
+		// location of the stored bytes from the start of the file
+		uint64_t offset;
+		uint64_t storedSize;
+		// size once decompressed
+		uint64_t size;
+		uint32_t compression;
+		uint32_t padding;
+	};
+
+	// contents of one asset - pData points into the mapped
+	// pack, into a mapped loose file, or into storage when the
+	// asset had to be decompressed
+	struct ASSET_DATA
+	{
+		const unsigned char* pData;
+		size_t size;
+		// true when the asset came from the pack
+		bool bPacked;
+		MappedFile looseFile;
+		std::vector<unsigned char> storage;
+	};
+
+	// bumped whenever the pack layout changes
+	static const uint32_t PACK_VERSION = 1;
+	// every stored asset starts on this boundary
+	static const uint32_t ASSET_ALIGNMENT = 64;
+
+	// constructor
+	AssetPack();
+	// destructor
+	~AssetPack();
+
+	// map a pack file and check its table of contents
+	bool Open(const char* filePath);
+	void Close();
+	bool IsOpen() const;
+
+	// check whether an asset is stored in the pack
+	bool Contains(const char* assetPath) const;
+	// get the contents of an asset from the pack, or from
+	// its loose file when it is not packed
+	bool Read(const char* assetPath, ASSET_DATA& asset) const;
+
+	// write a pack holding every asset listed in a manifest,
+	// one path per line - mesh files are stored as their
+	// imported mesh cache
+	static bool Build(const char* manifestPath, const char* packPath);
+
+	// LZ4 block format compression of a buffer
+	static void CompressLZ4(
+		const unsigned char* pSource,
+		size_t sourceSize,
+		std::vector<unsigned char>& compressed);
+	static bool DecompressLZ4(
+		const unsigned char* pSource,
+		size_t sourceSize,
+		unsigned char* pDestination,
+		size_t destinationSize);
+
+private:
+	MappedFile m_packFile;
+	const PACK_HEADER* m_pHeader;
+	const PACK_ENTRY* m_pEntries;
+	const char* m_pNames;
+
+	// find the table of contents entry of an asset
+	const PACK_ENTRY* FindEntry(const char* assetPath) const;
+};
@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawdatabuffer.cpp
+// ============
+// persistently mapped ring buffer holding the per-draw shader data
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DrawDataBuffer.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// flags used for both creating and mapping the buffer
+	const GLbitfield g_MapFlags =
+		GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	// nanoseconds to block on a fence before checking again
+	const GLuint64 g_FenceTimeout = 1000000;
+}
+
+/***********************************************************
+ *  DrawDataBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DrawDataBuffer::DrawDataBuffer()
+{
+	m_bufferID = 0;
+	m_pMappedData = NULL;
+	m_maxRecords = 0;
+	m_regionSize = 0;
+	m_frameIndex = 0;
+	for (int i = 0; i < FRAME_COUNT; i++)
+	{
+		m_fences[i] = NULL;
+	}
+}
+
+/***********************************************************
+ *  ~DrawDataBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DrawDataBuffer::~DrawDataBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the shader storage
+ *  buffer with room for three frames of draw records, and
+ *  mapping it persistently into client memory.
+ ***********************************************************/
+bool DrawDataBuffer::Create(uint32_t maxRecords)
+{
+	GLint offsetAlignment = 0;
+
+	Destroy();
+
+	if (maxRecords == 0)
+	{
+		maxRecords = 1;
+	}
+
+	// each frame region has to start on a valid binding offset
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
+	if (offsetAlignment <= 0)
+	{
+		offsetAlignment = 256;
+	}
+	m_maxRecords = maxRecords;
+	m_regionSize = (GLsizeiptr)(maxRecords * sizeof(DRAW_RECORD));
+	m_regionSize = ((m_regionSize + offsetAlignment - 1) / offsetAlignment) * offsetAlignment;
+
+	glGenBuffers(1, &m_bufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bufferID);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, m_regionSize * FRAME_COUNT, NULL, g_MapFlags);
+	m_pMappedData = (unsigned char*)glMapBufferRange(
+		GL_SHADER_STORAGE_BUFFER, 0, m_regionSize * FRAME_COUNT, g_MapFlags);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	if (NULL == m_pMappedData)
+	{
+		std::cout << "Failed to map the per-draw data buffer" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_frameIndex = 0;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for unmapping and freeing the buffer
+ *  along with any fences that are still waiting.
+ ***********************************************************/
+void DrawDataBuffer::Destroy()
+{
+	for (int i = 0; i < FRAME_COUNT; i++)
+	{
+		if (NULL != m_fences[i])
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = NULL;
+		}
+	}
+
+	if (0 != m_bufferID)
+	{
+		if (NULL != m_pMappedData)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_bufferID);
+			glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		}
+		GLStateCache::ForgetBuffer(m_bufferID);
+		glDeleteBuffers(1, &m_bufferID);
+		m_bufferID = 0;
+	}
+
+	m_pMappedData = NULL;
+	m_maxRecords = 0;
+	m_regionSize = 0;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for waiting until the GPU has
+ *  finished reading the next frame region, and returning
+ *  the region so the draw records can be written into it.
+ *  The records may be written from any thread.
+ ***********************************************************/
+DrawDataBuffer::DRAW_RECORD* DrawDataBuffer::BeginFrame()
+{
+	if (NULL == m_pMappedData)
+	{
+		return(NULL);
+	}
+
+	GLsync fence = m_fences[m_frameIndex];
+	if (NULL != fence)
+	{
+		GLenum waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+		while (waitResult == GL_TIMEOUT_EXPIRED)
+		{
+			waitResult = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, g_FenceTimeout);
+		}
+		if (waitResult == GL_WAIT_FAILED)
+		{
+			std::cout << "Failed waiting on the per-draw data fence" << std::endl;
+		}
+		glDeleteSync(fence);
+		m_fences[m_frameIndex] = NULL;
+	}
+
+	return((DRAW_RECORD*)(m_pMappedData + (m_regionSize * m_frameIndex)));
+}
+
+/***********************************************************
+ *  BindFrame()
+ *
+ *  This method is used for binding the current frame region
+ *  to the draw record binding point of the shaders.  Views
+ *  drawn one at a time bind the same region, which the state
+ *  cache only passes on once.
+ ***********************************************************/
+void DrawDataBuffer::BindFrame()
+{
+	if (0 == m_bufferID)
+	{
+		return;
+	}
+
+	GLStateCache::BindBufferRange(
+		GL_SHADER_STORAGE_BUFFER,
+		DRAW_RECORD_BINDING,
+		m_bufferID,
+		m_regionSize * m_frameIndex,
+		m_regionSize);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing a fence after the draws
+ *  that read the current frame region, and moving on to
+ *  the next region in the ring.
+ ***********************************************************/
+void DrawDataBuffer::EndFrame()
+{
+	if (0 == m_bufferID)
+	{
+		return;
+	}
+
+	m_fences[m_frameIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	m_frameIndex = (m_frameIndex + 1) % FRAME_COUNT;
+}
+
+/***********************************************************
+ *  SetDrawIndex()
+ *
+ *  This method is used for selecting the draw record that
+ *  the shaders read for the next draw command.  The index is
+ *  passed as a constant vertex attribute, which is context
+ *  state, so it works with any vertex array object.
+ ***********************************************************/
+void DrawDataBuffer::SetDrawIndex(uint32_t drawIndex)
+{
+	glVertexAttribI1ui(DRAW_INDEX_LOCATION, drawIndex);
+}
+
+/***********************************************************
+ *  GetCapacity()
+ *
+ *  This method is used for getting the number of records
+ *  that fit into each frame region.
+ ***********************************************************/
+uint32_t DrawDataBuffer::GetCapacity() const
+{
+	return(m_maxRecords);
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// drawdatabuffer.h
+// ============
+// persistently mapped ring buffer holding the per-draw shader data
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/***********************************************************
+ *  DrawDataBuffer
+ *
+ *  This class manages a shader storage buffer that stays
+ *  mapped for the life of the application.  The buffer is
+ *  split into three frame regions, and a fence is placed
+ *  after each frame's draws so the CPU never writes into a
+ *  region the GPU may still be reading.
+ ***********************************************************/
+class DrawDataBuffer
+{
+public:
+	// per-draw values read by the shaders - the layout
+	// must match the DrawRecord struct in the shaders
+	struct DRAW_RECORD
+	{
+		glm::mat4 model;
+		glm::vec4 color;
+		glm::vec2 UVscale;
+		// entry of the material table, which also holds the
+		// textures of the draw
+		uint16_t materialIndex;
+		uint16_t padding[3];
+		// scale in xy and offset in zw that place the lightmap
+		// coordinates in the object's square of the atlas, all
+		// zero when the object has no lightmap
+		glm::vec4 lightmapScaleOffset;
+	};
+
+	// vertex attribute location that carries the draw index
+	static const GLuint DRAW_INDEX_LOCATION = 7;
+	// shader storage binding point of the draw records
+	static const GLuint DRAW_RECORD_BINDING = 0;
+
+	// constructor
+	DrawDataBuffer();
+	// destructor
+	~DrawDataBuffer();
+
+	// create and map the buffer for the passed in number of records
+	bool Create(uint32_t maxRecords);
+	// unmap and free the buffer
+	void Destroy();
+
+	// wait for the next frame region to be free and return it
+	DRAW_RECORD* BeginFrame();
+	// bind the current frame region for the shaders to read
+	void BindFrame();
+	// fence the current frame region and move to the next one
+	void EndFrame();
+	// select the draw record used by the next draw command
+	void SetDrawIndex(uint32_t drawIndex);
+
+	// number of records in each frame region
+	uint32_t GetCapacity() const;
+
+private:
+	// number of frame regions in the ring
+	static const int FRAME_COUNT = 3;
+
+	// OpenGL buffer object
+	GLuint m_bufferID;
+	// start of the persistently mapped memory
+	unsigned char* m_pMappedData;
+	// number of records in each frame region
+	uint32_t m_maxRecords;
+	// size in bytes of each frame region
+	GLsizeiptr m_regionSize;
+	// frame region currently being written
+	int m_frameIndex;
+	// fences placed after the draws of each frame region
+	GLsync m_fences[FRAME_COUNT];
+};
@@ -0,0 +1,531 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.cpp
+// ============
+// render the scene offscreen at a resolution that follows the GPU time
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "DynamicResolution.h"
+#include "GLStateCache.h"
+
+#include <cmath>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// range the render scale is kept in
+	const float g_MinRenderScale = 0.5f;
+	const float g_MaxRenderScale = 1.0f;
+	// smallest change made to the render scale
+	const float g_RenderScaleStep = 0.05f;
+	// GPU time below which the render scale is raised, as a
+	// fraction of the target, so it does not flip back and forth
+	const float g_RaiseThreshold = 0.8f;
+	// frames to wait after a change for the new GPU time to settle
+	const int g_ScaleCooldownFrames = 30;
+	// weight of each new GPU time sample in the smoothed time
+	const float g_SmoothingFactor = 0.1f;
+}
+
+/***********************************************************
+ *  DynamicResolution()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+DynamicResolution::DynamicResolution()
+{
+	m_framebufferID = 0;
+	m_colorTextureID = 0;
+	m_depthTextureID = 0;
+	m_multisampleFramebufferID = 0;
+	m_multisampleColorRenderbufferID = 0;
+	m_multisampleDepthRenderbufferID = 0;
+	m_sampleCount = 1;
+	m_bResolved = true;
+	m_outputWidth = 0;
+	m_outputHeight = 0;
+	m_renderWidth = 0;
+	m_renderHeight = 0;
+
+	for (int i = 0; i < QUERY_COUNT; i++)
+	{
+		m_timerQueries[i] = 0;
+		m_bQueryPending[i] = false;
+	}
+	m_queryIndex = 0;
+
+	m_renderScale = g_MaxRenderScale;
+	m_bFixedScale = false;
+	// aim for 60 frames per second by default
+	m_targetFrameTime = 1000.0f / 60.0f;
+	m_gpuFrameTime = 0.0f;
+	m_scaleCooldown = 0;
+}
+
+/***********************************************************
+ *  ~DynamicResolution()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+DynamicResolution::~DynamicResolution()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the offscreen framebuffer
+ *  and the timer queries.
+ ***********************************************************/
+void DynamicResolution::Destroy()
+{
+	if (0 != m_framebufferID)
+	{
+		GLStateCache::ForgetFramebuffer(m_framebufferID);
+		glDeleteFramebuffers(1, &m_framebufferID);
+		m_framebufferID = 0;
+	}
+	if (0 != m_colorTextureID)
+	{
+		GLStateCache::ForgetTexture(m_colorTextureID);
+		glDeleteTextures(1, &m_colorTextureID);
+		m_colorTextureID = 0;
+	}
+	if (0 != m_depthTextureID)
+	{
+		GLStateCache::ForgetTexture(m_depthTextureID);
+		glDeleteTextures(1, &m_depthTextureID);
+		m_depthTextureID = 0;
+	}
+	if (0 != m_multisampleFramebufferID)
+	{
+		GLStateCache::ForgetFramebuffer(m_multisampleFramebufferID);
+		glDeleteFramebuffers(1, &m_multisampleFramebufferID);
+		glDeleteRenderbuffers(1, &m_multisampleColorRenderbufferID);
+		glDeleteRenderbuffers(1, &m_multisampleDepthRenderbufferID);
+		m_multisampleFramebufferID = 0;
+		m_multisampleColorRenderbufferID = 0;
+		m_multisampleDepthRenderbufferID = 0;
+	}
+	if (0 != m_timerQueries[0])
+	{
+		glDeleteQueries(QUERY_COUNT, m_timerQueries);
+		for (int i = 0; i < QUERY_COUNT; i++)
+		{
+			m_timerQueries[i] = 0;
+			m_bQueryPending[i] = false;
+		}
+	}
+
+	m_outputWidth = 0;
+	m_outputHeight = 0;
+}
+
+/***********************************************************
+ *  SetTargetFrameTime()
+ *
+ *  This method is used for setting the GPU time, in
+ *  milliseconds, that the render scale is adjusted to hold.
+ ***********************************************************/
+void DynamicResolution::SetTargetFrameTime(float milliseconds)
+{
+	if (milliseconds > 0.0f)
+	{
+		m_targetFrameTime = milliseconds;
+	}
+}
+
+/***********************************************************
+ *  SetFixedScale()
+ *
+ *  This method is used for fixing the render scale at the
+ *  passed in value.  A value of zero lets the render scale
+ *  follow the GPU time again.
+ ***********************************************************/
+void DynamicResolution::SetFixedScale(float renderScale)
+{
+	if (renderScale <= 0.0f)
+	{
+		m_bFixedScale = false;
+		return;
+	}
+
+	m_bFixedScale = true;
+	m_renderScale = fminf(fmaxf(renderScale, 0.1f), g_MaxRenderScale);
+}
+
+/***********************************************************
+ *  SetSampleCount()
+ *
+ *  This method is used for setting the samples per pixel
+ *  the scene is drawn with.  The framebuffer is allocated
+ *  again for the next frame.
+ ***********************************************************/
+void DynamicResolution::SetSampleCount(int sampleCount)
+{
+	sampleCount = (sampleCount < 1) ? 1 : ((sampleCount > 8) ? 8 : sampleCount);
+	if (sampleCount != m_sampleCount)
+	{
+		m_sampleCount = sampleCount;
+		m_outputWidth = 0;
+		m_outputHeight = 0;
+	}
+}
+
+/***********************************************************
+ *  GetSampleCount()
+ *
+ *  This method is used for getting the samples per pixel
+ *  the scene is drawn with.
+ ***********************************************************/
+int DynamicResolution::GetSampleCount() const
+{
+	return(m_sampleCount);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for binding the offscreen framebuffer
+ *  and setting the viewport to the scaled resolution.  The
+ *  framebuffer is allocated at the full output size, so a
+ *  new render scale only changes the viewport.
+ ***********************************************************/
+void DynamicResolution::BeginFrame(int outputWidth, int outputHeight)
+{
+	if ((outputWidth <= 0) || (outputHeight <= 0))
+	{
+		return;
+	}
+
+	if ((outputWidth != m_outputWidth) || (outputHeight != m_outputHeight))
+	{
+		if (false == CreateFramebuffer(outputWidth, outputHeight))
+		{
+			return;
+		}
+	}
+
+	ReadTimerQuery();
+
+	m_renderWidth = (int)(m_outputWidth * m_renderScale + 0.5f);
+	m_renderHeight = (int)(m_outputHeight * m_renderScale + 0.5f);
+	if (m_renderWidth < 1)
+	{
+		m_renderWidth = 1;
+	}
+	if (m_renderHeight < 1)
+	{
+		m_renderHeight = 1;
+	}
+
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER,
+		(0 != m_multisampleFramebufferID) ? m_multisampleFramebufferID : m_framebufferID);
+	GLStateCache::Viewport(0, 0, m_renderWidth, m_renderHeight);
+	m_bResolved = (0 == m_multisampleFramebufferID);
+
+	glBeginQuery(GL_TIME_ELAPSED, m_timerQueries[m_queryIndex]);
+}
+
+/***********************************************************
+ *  Resolve()
+ *
+ *  This method is used for averaging the samples of the
+ *  drawn part of the multisample framebuffer into the frame
+ *  textures.  The depth cannot be averaged, so one sample
+ *  of each pixel is kept.
+ ***********************************************************/
+void DynamicResolution::Resolve()
+{
+	if (true == m_bResolved)
+	{
+		return;
+	}
+
+	GLStateCache::BindFramebuffer(GL_READ_FRAMEBUFFER, m_multisampleFramebufferID);
+	GLStateCache::BindFramebuffer(GL_DRAW_FRAMEBUFFER, m_framebufferID);
+	glBlitFramebuffer(
+		0, 0, m_renderWidth, m_renderHeight,
+		0, 0, m_renderWidth, m_renderHeight,
+		GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT,
+		GL_NEAREST);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	m_bResolved = true;
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for stopping the GPU timer and
+ *  scaling the drawn part of the offscreen framebuffer up
+ *  to fill the window framebuffer.
+ ***********************************************************/
+void DynamicResolution::EndFrame()
+{
+	if (0 == m_framebufferID)
+	{
+		return;
+	}
+
+	Resolve();
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_bQueryPending[m_queryIndex] = true;
+	m_queryIndex = (m_queryIndex + 1) % QUERY_COUNT;
+
+	GLStateCache::BindFramebuffer(GL_READ_FRAMEBUFFER, m_framebufferID);
+	GLStateCache::BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(
+		0, 0, m_renderWidth, m_renderHeight,
+		0, 0, m_outputWidth, m_outputHeight,
+		GL_COLOR_BUFFER_BIT,
+		(m_renderWidth == m_outputWidth) ? GL_NEAREST : GL_LINEAR);
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::Viewport(0, 0, m_outputWidth, m_outputHeight);
+}
+
+/***********************************************************
+ *  GetRenderScale()
+ *
+ *  This method is used for getting the fraction of the
+ *  output resolution the scene is drawn at.
+ ***********************************************************/
+float DynamicResolution::GetRenderScale() const
+{
+	return(m_renderScale);
+}
+
+/***********************************************************
+ *  GetRenderWidth()
+ *
+ *  This method is used for getting the width the scene is
+ *  drawn at this frame.
+ ***********************************************************/
+int DynamicResolution::GetRenderWidth() const
+{
+	return(m_renderWidth);
+}
+
+/***********************************************************
+ *  GetRenderHeight()
+ *
+ *  This method is used for getting the height the scene is
+ *  drawn at this frame.
+ ***********************************************************/
+int DynamicResolution::GetRenderHeight() const
+{
+	return(m_renderHeight);
+}
+
+/***********************************************************
+ *  GetGPUFrameTime()
+ *
+ *  This method is used for getting the smoothed time the
+ *  GPU spends drawing the scene, in milliseconds.
+ ***********************************************************/
+float DynamicResolution::GetGPUFrameTime() const
+{
+	return(m_gpuFrameTime);
+}
+
+/***********************************************************
+ *  GetColorTexture()
+ *
+ *  This method is used for getting the texture the color of
+ *  the frame is drawn into.
+ ***********************************************************/
+GLuint DynamicResolution::GetColorTexture() const
+{
+	return(m_colorTextureID);
+}
+
+/***********************************************************
+ *  GetDepthTexture()
+ *
+ *  This method is used for getting the texture the depth and
+ *  stencil of the frame are drawn into.
+ ***********************************************************/
+GLuint DynamicResolution::GetDepthTexture() const
+{
+	return(m_depthTextureID);
+}
+
+/***********************************************************
+ *  CreateFramebuffer()
+ *
+ *  This method is used for allocating the color and depth
+ *  textures of the offscreen framebuffer, and its
+ *  multisample renderbuffers when there is more than one
+ *  sample per pixel.  The textures have immutable storage,
+ *  so a new size replaces them.
+ ***********************************************************/
+bool DynamicResolution::CreateFramebuffer(int width, int height)
+{
+	if (0 == m_framebufferID)
+	{
+		glGenFramebuffers(1, &m_framebufferID);
+	}
+	if (0 == m_timerQueries[0])
+	{
+		glGenQueries(QUERY_COUNT, m_timerQueries);
+	}
+	if (0 != m_colorTextureID)
+	{
+		GLStateCache::ForgetTexture(m_colorTextureID);
+		glDeleteTextures(1, &m_colorTextureID);
+		GLStateCache::ForgetTexture(m_depthTextureID);
+		glDeleteTextures(1, &m_depthTextureID);
+	}
+	if ((m_sampleCount > 1) && (0 == m_multisampleFramebufferID))
+	{
+		glGenFramebuffers(1, &m_multisampleFramebufferID);
+		glGenRenderbuffers(1, &m_multisampleColorRenderbufferID);
+		glGenRenderbuffers(1, &m_multisampleDepthRenderbufferID);
+	}
+	else if ((1 == m_sampleCount) && (0 != m_multisampleFramebufferID))
+	{
+		GLStateCache::ForgetFramebuffer(m_multisampleFramebufferID);
+		glDeleteFramebuffers(1, &m_multisampleFramebufferID);
+		glDeleteRenderbuffers(1, &m_multisampleColorRenderbufferID);
+		glDeleteRenderbuffers(1, &m_multisampleDepthRenderbufferID);
+		m_multisampleFramebufferID = 0;
+		m_multisampleColorRenderbufferID = 0;
+		m_multisampleDepthRenderbufferID = 0;
+	}
+
+	// the frame is read texel by texel, so neither texture
+	// has mipmaps or filtering - the color is kept in half
+	// floats, so the light above one is not clipped until the
+	// frame is tone mapped or copied into the window
+	glGenTextures(1, &m_colorTextureID);
+	GLStateCache::BindTexture(FRAME_TEXTURE_UNIT, GL_TEXTURE_2D, m_colorTextureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenTextures(1, &m_depthTextureID);
+	GLStateCache::BindTexture(FRAME_TEXTURE_UNIT, GL_TEXTURE_2D, m_depthTextureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_framebufferID);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_colorTextureID, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, m_depthTextureID, 0);
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+	// the multisample renderbuffers are only ever resolved,
+	// so they need no textures
+	if ((status == GL_FRAMEBUFFER_COMPLETE) && (0 != m_multisampleFramebufferID))
+	{
+		GLint maxSamples = 1;
+		glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+		GLsizei samples = (GLsizei)((m_sampleCount < maxSamples) ? m_sampleCount : maxSamples);
+
+		glBindRenderbuffer(GL_RENDERBUFFER, m_multisampleColorRenderbufferID);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA16F, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, m_multisampleDepthRenderbufferID);
+		glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+		GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, m_multisampleFramebufferID);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_multisampleColorRenderbufferID);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_multisampleDepthRenderbufferID);
+		status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	}
+	GLStateCache::BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cout << "The offscreen framebuffer is incomplete: 0x" << std::hex << status << std::dec << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_outputWidth = width;
+	m_outputHeight = height;
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReadTimerQuery()
+ *
+ *  This method is used for reading the oldest timer query,
+ *  which is about to be reused.  If the GPU has not finished
+ *  it yet, the sample is dropped instead of waiting.
+ ***********************************************************/
+void DynamicResolution::ReadTimerQuery()
+{
+	if (false == m_bQueryPending[m_queryIndex])
+	{
+		return;
+	}
+
+	GLint bAvailable = 0;
+	glGetQueryObjectiv(m_timerQueries[m_queryIndex], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+	m_bQueryPending[m_queryIndex] = false;
+	if (!bAvailable)
+	{
+		return;
+	}
+
+	GLuint64 elapsedTime = 0;
+	glGetQueryObjectui64v(m_timerQueries[m_queryIndex], GL_QUERY_RESULT, &elapsedTime);
+	float sampleTime = (float)(elapsedTime / 1000000.0);
+
+	if (m_gpuFrameTime <= 0.0f)
+	{
+		m_gpuFrameTime = sampleTime;
+	}
+	else
+	{
+		m_gpuFrameTime += (sampleTime - m_gpuFrameTime) * g_SmoothingFactor;
+	}
+
+	UpdateRenderScale();
+}
+
+/***********************************************************
+ *  UpdateRenderScale()
+ *
+ *  This method is used for moving the render scale towards
+ *  the value that would hold the target frame time.  The
+ *  GPU time is taken to grow with the pixel count, which is
+ *  the square of the render scale.  The scale drops as soon
+ *  as the target is missed, but only rises once there is
+ *  clear headroom.
+ ***********************************************************/
+void DynamicResolution::UpdateRenderScale()
+{
+	if ((true == m_bFixedScale) || (m_gpuFrameTime <= 0.0f))
+	{
+		return;
+	}
+	if (m_scaleCooldown > 0)
+	{
+		m_scaleCooldown--;
+		return;
+	}
+
+	float newScale = m_renderScale;
+	float idealScale = m_renderScale * sqrtf(m_targetFrameTime / m_gpuFrameTime);
+
+	if (m_gpuFrameTime > m_targetFrameTime)
+	{
+		newScale = floorf(idealScale / g_RenderScaleStep) * g_RenderScaleStep;
+	}
+	else if (m_gpuFrameTime < (m_targetFrameTime * g_RaiseThreshold))
+	{
+		newScale = m_renderScale + g_RenderScaleStep;
+	}
+
+	newScale = fminf(fmaxf(newScale, g_MinRenderScale), g_MaxRenderScale);
+	if (fabsf(newScale - m_renderScale) >= (g_RenderScaleStep * 0.5f))
+	{
+		m_renderScale = newScale;
+		m_scaleCooldown = g_ScaleCooldownFrames;
+	}
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// dynamicresolution.h
+// ============
+// render the scene offscreen at a resolution that follows the GPU time
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+/***********************************************************
+ *  DynamicResolution
+ *
+ *  This class owns an offscreen framebuffer that the scene
+ *  is drawn into at a fraction of the window resolution.
+ *  The frame is then scaled up into the window.  The time
+ *  the GPU spends on the scene is measured with timer
+ *  queries, and the render scale is lowered or raised to
+ *  hold the target frame time.  The color and depth of the
+ *  frame are textures, with the color in half floats, so
+ *  passes that run over the drawn frame before it is shown
+ *  can read them.  With more than one sample per pixel the
+ *  scene is drawn into multisample renderbuffers instead,
+ *  which are resolved into the textures.
+ ***********************************************************/
+class DynamicResolution
+{
+public:
+	// texture unit the frame textures are bound to while they
+	// are created, and that the depth is read from by the
+	// passes over the frame
+	static const int FRAME_TEXTURE_UNIT = 20;
+
+	// constructor
+	DynamicResolution();
+	// destructor
+	~DynamicResolution();
+
+	// free the offscreen framebuffer and timer queries
+	void Destroy();
+
+	// GPU time in milliseconds the render scale aims for
+	void SetTargetFrameTime(float milliseconds);
+	// keep the render scale at a fixed value, or pass zero
+	// to let it follow the GPU time again
+	void SetFixedScale(float renderScale);
+	// samples per pixel the scene is drawn with, from 1 to 8
+	void SetSampleCount(int sampleCount);
+	int GetSampleCount() const;
+
+	// bind the offscreen framebuffer for drawing a frame
+	// that is shown at the passed in output size
+	void BeginFrame(int outputWidth, int outputHeight);
+	// average the samples of the drawn frame into the frame
+	// textures - EndFrame() does this when it was not done
+	void Resolve();
+	// scale the drawn frame up into the window framebuffer
+	void EndFrame();
+
+	// current render scale and resolution
+	float GetRenderScale() const;
+	int GetRenderWidth() const;
+	int GetRenderHeight() const;
+	// smoothed GPU time of the scene in milliseconds
+	float GetGPUFrameTime() const;
+	// textures the frame is drawn into, allocated at the
+	// output size with the frame in the lower left corner
+	GLuint GetColorTexture() const;
+	GLuint GetDepthTexture() const;
+
+private:
+	// number of timer queries in flight, so reading a result
+	// never waits on the GPU
+	static const int QUERY_COUNT = 4;
+
+	// offscreen framebuffer objects
+	GLuint m_framebufferID;
+	GLuint m_colorTextureID;
+	GLuint m_depthTextureID;
+	// multisample framebuffer objects the scene is drawn into
+	// when there is more than one sample per pixel
+	GLuint m_multisampleFramebufferID;
+	GLuint m_multisampleColorRenderbufferID;
+	GLuint m_multisampleDepthRenderbufferID;
+	int m_sampleCount;
+	// true once the frame textures hold this frame
+	bool m_bResolved;
+	// size of the window framebuffer, which is also the size
+	// the offscreen framebuffer is allocated at
+	int m_outputWidth;
+	int m_outputHeight;
+	// part of the offscreen framebuffer drawn this frame
+	int m_renderWidth;
+	int m_renderHeight;
+
+	// timer queries measuring the scene on the GPU
+	GLuint m_timerQueries[QUERY_COUNT];
+	bool m_bQueryPending[QUERY_COUNT];
+	int m_queryIndex;
+
+	float m_renderScale;
+	bool m_bFixedScale;
+	float m_targetFrameTime;
+	float m_gpuFrameTime;
+	// frames left before the render scale may change again
+	int m_scaleCooldown;
+
+	// reallocate the offscreen framebuffer for a new size
+	bool CreateFramebuffer(int width, int height);
+	// read any finished timer query
+	void ReadTimerQuery();
+	// move the render scale towards the target frame time
+	void UpdateRenderScale();
+};
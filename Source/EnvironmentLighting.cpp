@@ -0,0 +1,666 @@
+///////////////////////////////////////////////////////////////////////////////
+// environmentlighting.cpp
+// ============
+// precompute and cache the image based lighting maps of the scene
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "EnvironmentLighting.h"
+#include "GLStateCache.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static_assert(sizeof(EnvironmentLighting::CACHE_HEADER) == 64, "CACHE_HEADER must stay 64 bytes so the maps stay aligned");
+
+namespace
+{
+	// identifies an environment lighting cache file
+	const char g_CacheMagic[4] = { 'I', 'B', 'L', 'C' };
+	const float g_Pi = 3.14159265358979f;
+	// samples taken for each texel - the smooth gradient needs
+	// few for the irradiance, and the blurrier specular mips
+	// take more as they get smaller, up to the limit
+	const uint32_t g_IrradianceSamples = 256;
+	const uint32_t g_FirstSpecularSamples = 256;
+	const uint32_t g_MaxSpecularSamples = 16384;
+	const uint32_t g_LookupSamples = 512;
+	// rows of the lookup table computed by each job
+	const int g_LookupRowsPerJob = 16;
+
+	/***********************************************************
+	 *  GetCubeDirection()
+	 *
+	 *  This function is used for getting the direction through
+	 *  the center of a texel of a cubemap face, in the OpenGL
+	 *  face order and orientation.
+	 ***********************************************************/
+	glm::vec3 GetCubeDirection(int face, int x, int y, int size)
+	{
+		float u = 2.0f * ((float)x + 0.5f) / (float)size - 1.0f;
+		float v = 2.0f * ((float)y + 0.5f) / (float)size - 1.0f;
+		glm::vec3 direction;
+
+		switch (face)
+		{
+		case 0:
+			direction = glm::vec3(1.0f, -v, -u);
+			break;
+		case 1:
+			direction = glm::vec3(-1.0f, -v, u);
+			break;
+		case 2:
+			direction = glm::vec3(u, 1.0f, v);
+			break;
+		case 3:
+			direction = glm::vec3(u, -1.0f, -v);
+			break;
+		case 4:
+			direction = glm::vec3(u, -v, 1.0f);
+			break;
+		default:
+			direction = glm::vec3(-u, -v, -1.0f);
+			break;
+		}
+
+		return(glm::normalize(direction));
+	}
+
+	/***********************************************************
+	 *  Hammersley()
+	 *
+	 *  This function is used for getting a point of the low
+	 *  discrepancy Hammersley set, which spreads the samples
+	 *  more evenly than random numbers.
+	 ***********************************************************/
+	glm::vec2 Hammersley(uint32_t index, uint32_t count)
+	{
+		uint32_t bits = index;
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+
+		return(glm::vec2((float)index / (float)count, (float)bits * 2.3283064365386963e-10f));
+	}
+
+	/***********************************************************
+	 *  ToWorld()
+	 *
+	 *  This function is used for turning a direction around
+	 *  the z axis into the same direction around the normal.
+	 ***********************************************************/
+	glm::vec3 ToWorld(const glm::vec3& local, const glm::vec3& normal)
+	{
+		glm::vec3 up = (fabsf(normal.z) < 0.999f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		glm::vec3 tangent = glm::normalize(glm::cross(up, normal));
+		glm::vec3 bitangent = glm::cross(normal, tangent);
+
+		return(glm::normalize(tangent * local.x + bitangent * local.y + normal * local.z));
+	}
+
+	/***********************************************************
+	 *  SampleGGX()
+	 *
+	 *  This function is used for picking a half vector around
+	 *  the z axis in proportion to the GGX distribution of the
+	 *  passed in roughness.
+	 ***********************************************************/
+	glm::vec3 SampleGGX(const glm::vec2& point, float roughness)
+	{
+		float alpha = roughness * roughness;
+		float phi = 2.0f * g_Pi * point.x;
+		float cosTheta = sqrtf((1.0f - point.y) / (1.0f + (alpha * alpha - 1.0f) * point.y));
+		float sinTheta = sqrtf(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+
+		return(glm::vec3(cosf(phi) * sinTheta, sinf(phi) * sinTheta, cosTheta));
+	}
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  This function is used for folding bytes into an FNV-1a
+	 *  hash.
+	 ***********************************************************/
+	uint64_t HashBytes(const void* pData, size_t size, uint64_t hash)
+	{
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ pBytes[i]) * 1099511628211ULL;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  HashEnvironment()
+	 *
+	 *  This function is used for identifying an environment
+	 *  and the map sizes, which the cache is checked against.
+	 ***********************************************************/
+	uint64_t HashEnvironment(const EnvironmentLighting::ENVIRONMENT& environment)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		const int sizes[4] =
+		{
+			EnvironmentLighting::IRRADIANCE_SIZE,
+			EnvironmentLighting::SPECULAR_SIZE,
+			EnvironmentLighting::SPECULAR_MIP_COUNT,
+			EnvironmentLighting::LOOKUP_SIZE
+		};
+
+		hash = HashBytes(sizes, sizeof(sizes), hash);
+		hash = HashBytes(&environment.skyColor, sizeof(glm::vec3), hash);
+		hash = HashBytes(&environment.horizonColor, sizeof(glm::vec3), hash);
+		hash = HashBytes(&environment.groundColor, sizeof(glm::vec3), hash);
+		for (size_t i = 0; i < environment.lights.size(); i++)
+		{
+			const EnvironmentLighting::ENVIRONMENT_LIGHT& light = environment.lights[i];
+			hash = HashBytes(&light.direction, sizeof(glm::vec3), hash);
+			hash = HashBytes(&light.color, sizeof(glm::vec3), hash);
+			hash = HashBytes(&light.angle, sizeof(float), hash);
+		}
+
+		return(hash);
+	}
+}
+
+/***********************************************************
+ *  EnvironmentLighting()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+EnvironmentLighting::EnvironmentLighting()
+{
+	m_environmentHash = 0;
+	m_pJobSystem = NULL;
+	m_bComputed = false;
+	m_irradianceID = 0;
+	m_specularID = 0;
+	m_lookupID = 0;
+
+	size_t offset = 0;
+	m_layout.irradianceOffset = offset;
+	offset += (size_t)6 * IRRADIANCE_SIZE * IRRADIANCE_SIZE * 3;
+	int size = SPECULAR_SIZE;
+	for (int mip = 0; mip < SPECULAR_MIP_COUNT; mip++)
+	{
+		m_layout.specularOffsets[mip] = offset;
+		offset += (size_t)6 * size * size * 3;
+		size = std::max(1, size / 2);
+	}
+	m_layout.lookupOffset = offset;
+	offset += (size_t)LOOKUP_SIZE * LOOKUP_SIZE * 2;
+	m_layout.floatCount = offset;
+}
+
+/***********************************************************
+ *  ~EnvironmentLighting()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+EnvironmentLighting::~EnvironmentLighting()
+{
+	if (NULL != m_pJobSystem)
+	{
+		m_pJobSystem->Wait(&m_jobs);
+	}
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking that the fragment shader
+ *  has a texture unit for every map after the 16 scene
+ *  textures.  OpenGL only promises 16 in total.
+ ***********************************************************/
+bool EnvironmentLighting::IsSupported()
+{
+	GLint unitCount = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &unitCount);
+
+	return(unitCount > LOOKUP_UNIT);
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for getting the maps ready without
+ *  holding up the rest of the scene loading.  A cache built
+ *  from the same environment is read right away, otherwise
+ *  the faces and the lookup table rows are integrated by
+ *  jobs on the worker threads until Finish() is called.
+ ***********************************************************/
+void EnvironmentLighting::Start(const ENVIRONMENT& environment, const char* cachePath, JobSystem* pJobSystem)
+{
+	m_environment = environment;
+	m_environmentHash = HashEnvironment(environment);
+	m_cachePath = cachePath;
+	m_pJobSystem = pJobSystem;
+	m_bComputed = false;
+
+	if (true == LoadCache())
+	{
+		return;
+	}
+
+	m_bComputed = true;
+	m_data.assign(m_layout.floatCount, 0.0f);
+	for (int face = 0; face < 6; face++)
+	{
+		m_pJobSystem->Execute([this, face]() { ComputeIrradianceFace(face); }, &m_jobs);
+		for (int mip = 0; mip < SPECULAR_MIP_COUNT; mip++)
+		{
+			m_pJobSystem->Execute([this, mip, face]() { ComputeSpecularFace(mip, face); }, &m_jobs);
+		}
+	}
+	for (int row = 0; row < LOOKUP_SIZE; row += g_LookupRowsPerJob)
+	{
+		int lastRow = std::min(row + g_LookupRowsPerJob, (int)LOOKUP_SIZE);
+		m_pJobSystem->Execute([this, row, lastRow]() { ComputeLookupRows(row, lastRow); }, &m_jobs);
+	}
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for waiting for the maps to be ready,
+ *  saving them when they were computed, and handing them
+ *  to OpenGL.  The CPU copy is freed afterwards.
+ ***********************************************************/
+bool EnvironmentLighting::Finish()
+{
+	if (NULL == m_pJobSystem)
+	{
+		return(false);
+	}
+	m_pJobSystem->Wait(&m_jobs);
+	if (m_data.size() != m_layout.floatCount)
+	{
+		return(false);
+	}
+
+	if (true == m_bComputed)
+	{
+		WriteCache();
+	}
+	Upload();
+
+	std::vector<float>().swap(m_data);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the map textures.
+ ***********************************************************/
+void EnvironmentLighting::Destroy()
+{
+	GLuint* textureIDs[3] = { &m_irradianceID, &m_specularID, &m_lookupID };
+	for (int i = 0; i < 3; i++)
+	{
+		if (0 != *textureIDs[i])
+		{
+			GLStateCache::ForgetTexture(*textureIDs[i]);
+			glDeleteTextures(1, textureIDs[i]);
+			*textureIDs[i] = 0;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetRadiance()
+ *
+ *  This method is used for getting the light arriving from
+ *  a direction.  The lights have a soft edge, so the small
+ *  mirror-like mips do not alias them.
+ ***********************************************************/
+glm::vec3 EnvironmentLighting::GetRadiance(const glm::vec3& direction, bool bLights) const
+{
+	glm::vec3 radiance;
+	if (direction.y >= 0.0f)
+	{
+		radiance = glm::mix(m_environment.horizonColor, m_environment.skyColor, sqrtf(direction.y));
+	}
+	else
+	{
+		radiance = glm::mix(m_environment.horizonColor, m_environment.groundColor, sqrtf(-direction.y));
+	}
+
+	if (true == bLights)
+	{
+		for (size_t i = 0; i < m_environment.lights.size(); i++)
+		{
+			const ENVIRONMENT_LIGHT& light = m_environment.lights[i];
+			float cosAngle = glm::dot(direction, light.direction);
+			float cosEdge = cosf(light.angle);
+			float cosInner = cosf(light.angle * 0.8f);
+			if (cosAngle > cosEdge)
+			{
+				radiance += light.color * glm::clamp((cosAngle - cosEdge) / (cosInner - cosEdge), 0.0f, 1.0f);
+			}
+		}
+	}
+
+	return(radiance);
+}
+
+/***********************************************************
+ *  ComputeIrradianceFace()
+ *
+ *  This method is used for integrating the cosine weighted
+ *  light over the hemisphere around every texel of a face.
+ *  The gradient is sampled, and the lights are added in
+ *  closed form, as small discs, so they do not show up as
+ *  noise.  The values are divided by pi, so the shader only
+ *  multiplies them by the albedo.
+ ***********************************************************/
+void EnvironmentLighting::ComputeIrradianceFace(int face)
+{
+	float* pFace = m_data.data() + m_layout.irradianceOffset + (size_t)face * IRRADIANCE_SIZE * IRRADIANCE_SIZE * 3;
+
+	for (int y = 0; y < IRRADIANCE_SIZE; y++)
+	{
+		for (int x = 0; x < IRRADIANCE_SIZE; x++)
+		{
+			glm::vec3 normal = GetCubeDirection(face, x, y, IRRADIANCE_SIZE);
+			glm::vec3 irradiance(0.0f);
+
+			// cosine weighted samples, so the average is the
+			// irradiance over pi
+			for (uint32_t i = 0; i < g_IrradianceSamples; i++)
+			{
+				glm::vec2 point = Hammersley(i, g_IrradianceSamples);
+				float radius = sqrtf(point.y);
+				float phi = 2.0f * g_Pi * point.x;
+				glm::vec3 local(radius * cosf(phi), radius * sinf(phi), sqrtf(std::max(0.0f, 1.0f - point.y)));
+				irradiance += GetRadiance(ToWorld(local, normal), false);
+			}
+			irradiance /= (float)g_IrradianceSamples;
+
+			for (size_t i = 0; i < m_environment.lights.size(); i++)
+			{
+				const ENVIRONMENT_LIGHT& light = m_environment.lights[i];
+				float solidAngle = 2.0f * g_Pi * (1.0f - cosf(light.angle));
+				irradiance += light.color * solidAngle * std::max(glm::dot(normal, light.direction), 0.0f) / g_Pi;
+			}
+
+			float* pTexel = pFace + ((size_t)y * IRRADIANCE_SIZE + x) * 3;
+			pTexel[0] = irradiance.r;
+			pTexel[1] = irradiance.g;
+			pTexel[2] = irradiance.b;
+		}
+	}
+}
+
+/***********************************************************
+ *  ComputeSpecularFace()
+ *
+ *  This method is used for prefiltering one face of one
+ *  specular mip with the GGX lobe of the roughness the mip
+ *  stands for, taking the view to be along the normal.  The
+ *  first mip is the mirror reflection itself.
+ ***********************************************************/
+void EnvironmentLighting::ComputeSpecularFace(int mip, int face)
+{
+	int size = std::max(1, SPECULAR_SIZE >> mip);
+	float roughness = (float)mip / (float)(SPECULAR_MIP_COUNT - 1);
+	uint32_t sampleCount = 1;
+	if (mip > 0)
+	{
+		sampleCount = std::min(g_FirstSpecularSamples << (2 * (mip - 1)), g_MaxSpecularSamples);
+	}
+	float* pFace = m_data.data() + m_layout.specularOffsets[mip] + (size_t)face * size * size * 3;
+
+	for (int y = 0; y < size; y++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			glm::vec3 normal = GetCubeDirection(face, x, y, size);
+			glm::vec3 color(0.0f);
+
+			if (0 == mip)
+			{
+				color = GetRadiance(normal, true);
+			}
+			else
+			{
+				float totalWeight = 0.0f;
+				for (uint32_t i = 0; i < sampleCount; i++)
+				{
+					glm::vec3 halfVector = ToWorld(SampleGGX(Hammersley(i, sampleCount), roughness), normal);
+					glm::vec3 lightDirection = 2.0f * glm::dot(normal, halfVector) * halfVector - normal;
+					float NdotL = glm::dot(normal, lightDirection);
+					if (NdotL > 0.0f)
+					{
+						color += GetRadiance(lightDirection, true) * NdotL;
+						totalWeight += NdotL;
+					}
+				}
+				color /= std::max(totalWeight, 0.0001f);
+			}
+
+			float* pTexel = pFace + ((size_t)y * size + x) * 3;
+			pTexel[0] = color.r;
+			pTexel[1] = color.g;
+			pTexel[2] = color.b;
+		}
+	}
+}
+
+/***********************************************************
+ *  ComputeLookupRows()
+ *
+ *  This method is used for integrating the split sum BRDF
+ *  terms, the scale and bias applied to the Fresnel
+ *  reflectance, for the view angles along x and the
+ *  roughness along y.
+ ***********************************************************/
+void EnvironmentLighting::ComputeLookupRows(int firstRow, int lastRow)
+{
+	float* pLookup = m_data.data() + m_layout.lookupOffset;
+	const glm::vec3 normal(0.0f, 0.0f, 1.0f);
+
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		float roughness = ((float)y + 0.5f) / (float)LOOKUP_SIZE;
+		float alpha = roughness * roughness;
+		float k = alpha / 2.0f;
+
+		for (int x = 0; x < LOOKUP_SIZE; x++)
+		{
+			float NdotV = ((float)x + 0.5f) / (float)LOOKUP_SIZE;
+			glm::vec3 viewDirection(sqrtf(1.0f - NdotV * NdotV), 0.0f, NdotV);
+			float scale = 0.0f;
+			float bias = 0.0f;
+
+			for (uint32_t i = 0; i < g_LookupSamples; i++)
+			{
+				glm::vec3 halfVector = SampleGGX(Hammersley(i, g_LookupSamples), roughness);
+				glm::vec3 lightDirection = 2.0f * glm::dot(viewDirection, halfVector) * halfVector - viewDirection;
+				float NdotL = std::max(lightDirection.z, 0.0f);
+				float NdotH = std::max(halfVector.z, 0.0f);
+				float VdotH = std::max(glm::dot(viewDirection, halfVector), 0.0f);
+				if (NdotL <= 0.0f)
+				{
+					continue;
+				}
+
+				float geometry = (NdotV / (NdotV * (1.0f - k) + k)) * (NdotL / (NdotL * (1.0f - k) + k));
+				float visibility = geometry * VdotH / std::max(NdotH * NdotV, 0.0001f);
+				float fresnel = powf(1.0f - VdotH, 5.0f);
+				scale += (1.0f - fresnel) * visibility;
+				bias += fresnel * visibility;
+			}
+
+			float* pTexel = pLookup + ((size_t)y * LOOKUP_SIZE + x) * 2;
+			pTexel[0] = scale / (float)g_LookupSamples;
+			pTexel[1] = bias / (float)g_LookupSamples;
+		}
+	}
+}
+
+/***********************************************************
+ *  LoadCache()
+ *
+ *  This method is used for reading the maps from the cache
+ *  file, when it was built from the same environment and
+ *  map sizes.
+ ***********************************************************/
+bool EnvironmentLighting::LoadCache()
+{
+	MappedFile cacheFile;
+	if (false == cacheFile.Open(m_cachePath.c_str()))
+	{
+		return(false);
+	}
+
+	const CACHE_HEADER* pHeader = (const CACHE_HEADER*)cacheFile.GetData();
+	size_t dataSize = m_layout.floatCount * sizeof(float);
+	if ((cacheFile.GetSize() < sizeof(CACHE_HEADER)) ||
+		(memcmp(pHeader->magic, g_CacheMagic, sizeof(pHeader->magic)) != 0) ||
+		(CACHE_VERSION != pHeader->version) ||
+		(m_environmentHash != pHeader->environmentHash) ||
+		((uint32_t)IRRADIANCE_SIZE != pHeader->irradianceSize) ||
+		((uint32_t)SPECULAR_SIZE != pHeader->specularSize) ||
+		((uint32_t)SPECULAR_MIP_COUNT != pHeader->specularMipCount) ||
+		((uint32_t)LOOKUP_SIZE != pHeader->lookupSize) ||
+		(pHeader->dataOffset < sizeof(CACHE_HEADER)) ||
+		(cacheFile.GetSize() < pHeader->dataOffset + dataSize))
+	{
+		return(false);
+	}
+
+	m_data.resize(m_layout.floatCount);
+	memcpy(m_data.data(), cacheFile.GetData() + pHeader->dataOffset, dataSize);
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for writing the computed maps into
+ *  the cache file, through a side file so a failed write
+ *  never leaves a broken cache.
+ ***********************************************************/
+bool EnvironmentLighting::WriteCache() const
+{
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_CacheMagic, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	header.environmentHash = m_environmentHash;
+	header.irradianceSize = IRRADIANCE_SIZE;
+	header.specularSize = SPECULAR_SIZE;
+	header.specularMipCount = SPECULAR_MIP_COUNT;
+	header.lookupSize = LOOKUP_SIZE;
+	header.dataOffset = sizeof(CACHE_HEADER);
+
+	std::string newCachePath = m_cachePath + ".new";
+	std::ofstream cacheFile(newCachePath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!cacheFile.is_open())
+	{
+		std::cout << "Could not write environment lighting cache " << m_cachePath << std::endl;
+		return(false);
+	}
+
+	cacheFile.write((const char*)&header, sizeof(header));
+	cacheFile.write((const char*)m_data.data(), m_data.size() * sizeof(float));
+	cacheFile.close();
+
+	if ((cacheFile.fail()) ||
+		(false == MappedFile::ReplaceFile(newCachePath.c_str(), m_cachePath.c_str())))
+	{
+		std::cout << "Could not write environment lighting cache " << m_cachePath << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for creating the map textures in
+ *  half floats and binding them to their texture units,
+ *  which nothing else uses.
+ ***********************************************************/
+void EnvironmentLighting::Upload()
+{
+	Destroy();
+
+	glGenTextures(1, &m_irradianceID);
+	GLStateCache::BindTexture(IRRADIANCE_UNIT, GL_TEXTURE_CUBE_MAP, m_irradianceID);
+	glTexStorage2D(GL_TEXTURE_CUBE_MAP, 1, GL_RGB16F, IRRADIANCE_SIZE, IRRADIANCE_SIZE);
+	for (int face = 0; face < 6; face++)
+	{
+		glTexSubImage2D(
+			GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+			0,
+			0,
+			0,
+			IRRADIANCE_SIZE,
+			IRRADIANCE_SIZE,
+			GL_RGB,
+			GL_FLOAT,
+			m_data.data() + m_layout.irradianceOffset + (size_t)face * IRRADIANCE_SIZE * IRRADIANCE_SIZE * 3);
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glGenTextures(1, &m_specularID);
+	GLStateCache::BindTexture(SPECULAR_UNIT, GL_TEXTURE_CUBE_MAP, m_specularID);
+	glTexStorage2D(GL_TEXTURE_CUBE_MAP, SPECULAR_MIP_COUNT, GL_RGB16F, SPECULAR_SIZE, SPECULAR_SIZE);
+	for (int mip = 0; mip < SPECULAR_MIP_COUNT; mip++)
+	{
+		int size = std::max(1, SPECULAR_SIZE >> mip);
+		for (int face = 0; face < 6; face++)
+		{
+			glTexSubImage2D(
+				GL_TEXTURE_CUBE_MAP_POSITIVE_X + face,
+				mip,
+				0,
+				0,
+				size,
+				size,
+				GL_RGB,
+				GL_FLOAT,
+				m_data.data() + m_layout.specularOffsets[mip] + (size_t)face * size * size * 3);
+		}
+	}
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	glGenTextures(1, &m_lookupID);
+	GLStateCache::BindTexture(LOOKUP_UNIT, GL_TEXTURE_2D, m_lookupID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RG16F, LOOKUP_SIZE, LOOKUP_SIZE);
+	glTexSubImage2D(
+		GL_TEXTURE_2D,
+		0,
+		0,
+		0,
+		LOOKUP_SIZE,
+		LOOKUP_SIZE,
+		GL_RG,
+		GL_FLOAT,
+		m_data.data() + m_layout.lookupOffset);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// filter across the cube faces, so the blurry mips have
+	// no seams
+	GLStateCache::SetEnabled(GL_TEXTURE_CUBE_MAP_SEAMLESS, true);
+}
@@ -0,0 +1,151 @@
+///////////////////////////////////////////////////////////////////////////////
+// environmentlighting.h
+// ============
+// precompute and cache the image based lighting maps of the scene
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  EnvironmentLighting
+ *
+ *  This class builds the three maps the physically based
+ *  shading path reads for the light that reaches the scene
+ *  from its surroundings - an irradiance cubemap for the
+ *  diffuse light, a specular cubemap prefiltered for every
+ *  roughness down its mips, and the split sum BRDF lookup
+ *  table.  The surroundings are described by a few colors
+ *  and bright spots rather than a captured image.  The maps
+ *  are integrated on the job system worker threads the first
+ *  time, and written to a cache file that later runs load
+ *  instead, as long as the description has not changed.
+ ***********************************************************/
+class EnvironmentLighting
+{
+public:
+	// bright area of the surroundings, like a lamp
+	struct ENVIRONMENT_LIGHT
+	{
+		// unit direction from the scene towards the light
+		glm::vec3 direction;
+		// radiance inside the light
+		glm::vec3 color;
+		// angular radius in radians
+		float angle;
+	};
+
+	// surroundings the maps are computed from - a gradient
+	// from the ground color below, through the horizon color,
+	// to the sky color above, with the lights on top
+	struct ENVIRONMENT
+	{
+		glm::vec3 skyColor;
+		glm::vec3 horizonColor;
+		glm::vec3 groundColor;
+		std::vector<ENVIRONMENT_LIGHT> lights;
+	};
+
+	// header at the start of the cache file, followed by the
+	// irradiance faces, the specular faces of every mip and
+	// the lookup table, all stored as floats
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		// hash of the environment the maps were built from
+		uint64_t environmentHash;
+		uint32_t irradianceSize;
+		uint32_t specularSize;
+		uint32_t specularMipCount;
+		uint32_t lookupSize;
+		// byte offset from the start of the file to the maps
+		uint32_t dataOffset;
+		uint32_t padding[7];
+	};
+
+	// bumped whenever the cache layout or the integration changes
+	static const uint32_t CACHE_VERSION = 1;
+	// size of the maps - the specular mips go from the
+	// mirror reflection down to fully rough
+	static const int IRRADIANCE_SIZE = 32;
+	static const int SPECULAR_SIZE = 128;
+	static const int SPECULAR_MIP_COUNT = 6;
+	static const int LOOKUP_SIZE = 128;
+	// texture units the maps are bound to, after the scene
+	// textures
+	static const int IRRADIANCE_UNIT = 16;
+	static const int SPECULAR_UNIT = 17;
+	static const int LOOKUP_UNIT = 18;
+
+	// constructor
+	EnvironmentLighting();
+	// destructor
+	~EnvironmentLighting();
+
+	// check whether the fragment shader can sample the maps
+	// next to the scene textures
+	static bool IsSupported();
+
+	// load the maps from the cache file, or start computing
+	// them on the worker threads when it is missing or was
+	// built from another environment
+	void Start(const ENVIRONMENT& environment, const char* cachePath, JobSystem* pJobSystem);
+	// wait for the maps, write the cache when they were
+	// computed, and upload and bind them
+	bool Finish();
+	// free the maps
+	void Destroy();
+
+private:
+	// byte layout of the maps, in floats from the start
+	struct MAP_LAYOUT
+	{
+		size_t irradianceOffset;
+		size_t specularOffsets[SPECULAR_MIP_COUNT];
+		size_t lookupOffset;
+		size_t floatCount;
+	};
+
+	ENVIRONMENT m_environment;
+	uint64_t m_environmentHash;
+	std::string m_cachePath;
+	JobSystem* m_pJobSystem;
+	// counts the map jobs still running
+	JobCounter m_jobs;
+	// true when the maps are being computed rather than loaded
+	bool m_bComputed;
+	MAP_LAYOUT m_layout;
+	std::vector<float> m_data;
+	GLuint m_irradianceID;
+	GLuint m_specularID;
+	GLuint m_lookupID;
+
+	// radiance arriving from a direction, with or without the
+	// lights
+	glm::vec3 GetRadiance(const glm::vec3& direction, bool bLights) const;
+	// compute one face of the irradiance cubemap
+	void ComputeIrradianceFace(int face);
+	// compute one face of one specular mip
+	void ComputeSpecularFace(int mip, int face);
+	// compute rows of the BRDF lookup table
+	void ComputeLookupRows(int firstRow, int lastRow);
+	// read the maps from the cache file
+	bool LoadCache();
+	// write the computed maps to the cache file
+	bool WriteCache() const;
+	// create the OpenGL textures of the maps
+	void Upload();
+};
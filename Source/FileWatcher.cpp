@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.cpp
+// ============
+// report the asset files that were edited while the scene is running
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FileWatcher.h"
+#include "MappedFile.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include <iostream>
+
+namespace
+{
+	// how long a file must go unchanged before it is reported
+	const int g_SettleMilliseconds = 150;
+	// how often the watching thread wakes up to check for
+	// files that settled, or to poll the files
+#ifdef __linux__
+	const int g_WakeMilliseconds = 50;
+#else
+	const int g_WakeMilliseconds = 250;
+#endif
+}
+
+/***********************************************************
+ *  FileWatcher()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FileWatcher::FileWatcher()
+{
+	m_bRunning = false;
+#ifdef __linux__
+	m_inotifyDescriptor = -1;
+#endif
+}
+
+/***********************************************************
+ *  ~FileWatcher()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FileWatcher::~FileWatcher()
+{
+	Stop();
+}
+
+/***********************************************************
+ *  Watch()
+ *
+ *  This method is used for adding a file to the watch
+ *  list.  A file that is already watched is not added again.
+ ***********************************************************/
+void FileWatcher::Watch(const std::string& filePath)
+{
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		if (m_files[i].filePath == filePath)
+		{
+			return;
+		}
+	}
+
+	WATCHED_FILE file;
+	file.filePath = filePath;
+	size_t separator = filePath.find_last_of("/\\");
+	if (std::string::npos == separator)
+	{
+		file.directory = ".";
+		file.name = filePath;
+	}
+	else
+	{
+		file.directory = filePath.substr(0, separator);
+		file.name = filePath.substr(separator + 1);
+	}
+	MappedFile::GetFileInfo(filePath.c_str(), file.size, file.modifiedTime);
+	file.bChanged = false;
+
+	m_files.push_back(file);
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for starting the watching thread.
+ *  On Linux each folder holding a watched file gets one
+ *  inotify watch for the writes and renames into it, which
+ *  is how editors save.
+ ***********************************************************/
+bool FileWatcher::Start()
+{
+	if ((true == m_bRunning) || (true == m_files.empty()))
+	{
+		return(false);
+	}
+
+#ifdef __linux__
+	m_inotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotifyDescriptor < 0)
+	{
+		std::cout << "Could not start watching the asset files" << std::endl;
+		return(false);
+	}
+
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		bool bWatched = false;
+		for (size_t j = 0; (j < m_watchDirectories.size()) && (false == bWatched); j++)
+		{
+			bWatched = (m_watchDirectories[j] == m_files[i].directory);
+		}
+		if (true == bWatched)
+		{
+			continue;
+		}
+
+		int watchDescriptor = inotify_add_watch(
+			m_inotifyDescriptor,
+			m_files[i].directory.c_str(),
+			IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+		if (watchDescriptor < 0)
+		{
+			std::cout << "Could not watch the folder " << m_files[i].directory << std::endl;
+			continue;
+		}
+		m_watchDescriptors.push_back(watchDescriptor);
+		m_watchDirectories.push_back(m_files[i].directory);
+	}
+#endif
+
+	m_bRunning = true;
+	m_thread = std::thread(&FileWatcher::WatchLoop, this);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Stop()
+ *
+ *  This method is used for stopping the watching thread
+ *  and closing the inotify watches.
+ ***********************************************************/
+void FileWatcher::Stop()
+{
+	if (true == m_bRunning)
+	{
+		m_bRunning = false;
+		m_thread.join();
+	}
+
+#ifdef __linux__
+	if (m_inotifyDescriptor >= 0)
+	{
+		close(m_inotifyDescriptor);
+		m_inotifyDescriptor = -1;
+	}
+	m_watchDescriptors.clear();
+	m_watchDirectories.clear();
+#endif
+}
+
+/***********************************************************
+ *  TakeChanges()
+ *
+ *  This method is used for getting the files that changed
+ *  and have settled, clearing their changed flags.  It is
+ *  called by the render loop between frames.
+ ***********************************************************/
+void FileWatcher::TakeChanges(std::vector<std::string>& changedFiles)
+{
+	changedFiles.clear();
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (size_t i = 0; i < m_files.size(); i++)
+	{
+		WATCHED_FILE& file = m_files[i];
+		if ((true == file.bChanged) &&
+			(now - file.changeTime >= std::chrono::milliseconds(g_SettleMilliseconds)))
+		{
+			file.bChanged = false;
+			changedFiles.push_back(file.filePath);
+		}
+	}
+}
+
+/***********************************************************
+ *  WatchLoop()
+ *
+ *  This method is used for waiting on the file changes
+ *  until the watcher is stopped.  The wait is short, so
+ *  stopping never takes long.
+ ***********************************************************/
+void FileWatcher::WatchLoop()
+{
+	while (true == m_bRunning)
+	{
+#ifdef __linux__
+		pollfd pollDescriptor;
+		pollDescriptor.fd = m_inotifyDescriptor;
+		pollDescriptor.events = POLLIN;
+		pollDescriptor.revents = 0;
+		if (poll(&pollDescriptor, 1, g_WakeMilliseconds) <= 0)
+		{
+			continue;
+		}
+
+		// the events are variable length, with the name of the
+		// file in the watched folder after each one
+		alignas(inotify_event) char events[4096];
+		ssize_t length = 0;
+		while ((length = read(m_inotifyDescriptor, events, sizeof(events))) > 0)
+		{
+			for (ssize_t offset = 0; offset < length; )
+			{
+				const inotify_event* pEvent = (const inotify_event*)(events + offset);
+				offset += sizeof(inotify_event) + pEvent->len;
+				if (0 == pEvent->len)
+				{
+					continue;
+				}
+
+				std::string directory;
+				for (size_t i = 0; i < m_watchDescriptors.size(); i++)
+				{
+					if (m_watchDescriptors[i] == pEvent->wd)
+					{
+						directory = m_watchDirectories[i];
+					}
+				}
+				for (size_t i = 0; i < m_files.size(); i++)
+				{
+					if ((m_files[i].directory == directory) && (m_files[i].name == pEvent->name))
+					{
+						MarkChanged(i);
+					}
+				}
+			}
+		}
+#else
+		std::this_thread::sleep_for(std::chrono::milliseconds(g_WakeMilliseconds));
+
+		for (size_t i = 0; i < m_files.size(); i++)
+		{
+			uint64_t size = 0;
+			uint64_t modifiedTime = 0;
+			if ((true == MappedFile::GetFileInfo(m_files[i].filePath.c_str(), size, modifiedTime)) &&
+				((size != m_files[i].size) || (modifiedTime != m_files[i].modifiedTime)))
+			{
+				m_files[i].size = size;
+				m_files[i].modifiedTime = modifiedTime;
+				MarkChanged(i);
+			}
+		}
+#endif
+	}
+}
+
+/***********************************************************
+ *  MarkChanged()
+ *
+ *  This method is used for flagging a file as changed.  Each
+ *  write pushes back the time it is reported at.
+ ***********************************************************/
+void FileWatcher::MarkChanged(size_t fileIndex)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_files[fileIndex].bChanged = true;
+	m_files[fileIndex].changeTime = std::chrono::steady_clock::now();
+}
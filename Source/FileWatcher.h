@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// filewatcher.h
+// ============
+// report the asset files that were edited while the scene is running
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  FileWatcher
+ *
+ *  This class watches a list of files on a background
+ *  thread.  On Linux it waits on inotify events for the
+ *  folders the files are in, and elsewhere it checks the
+ *  size and time stamp of every file a few times a second.
+ *  Editors often write a file in several steps, so a file
+ *  is only reported once it has not been written to for a
+ *  short moment.
+ ***********************************************************/
+class FileWatcher
+{
+public:
+	// constructor
+	FileWatcher();
+	// destructor
+	~FileWatcher();
+
+	// add a file to watch - must be called before Start()
+	void Watch(const std::string& filePath);
+	// start and stop the watching thread
+	bool Start();
+	void Stop();
+
+	// get the watched files that changed since the last call
+	// and have settled
+	void TakeChanges(std::vector<std::string>& changedFiles);
+
+private:
+	// one watched file
+	struct WATCHED_FILE
+	{
+		std::string filePath;
+		// folder and name, as inotify reports them
+		std::string directory;
+		std::string name;
+		// size and time stamp last seen, for polling
+		uint64_t size;
+		uint64_t modifiedTime;
+		// set when the file changed and has not been taken
+		bool bChanged;
+		std::chrono::steady_clock::time_point changeTime;
+	};
+
+	std::vector<WATCHED_FILE> m_files;
+	std::thread m_thread;
+	std::atomic<bool> m_bRunning;
+	// guards the changed flags of the files
+	std::mutex m_mutex;
+#ifdef __linux__
+	int m_inotifyDescriptor;
+	// inotify watch and folder of every watched folder
+	std::vector<int> m_watchDescriptors;
+	std::vector<std::string> m_watchDirectories;
+#endif
+
+	// main loop of the watching thread
+	void WatchLoop();
+	// note that a file was written to
+	void MarkChanged(size_t fileIndex);
+};
@@ -0,0 +1,946 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.cpp
+// ============
+// shadow the OpenGL state and drop the calls that would not change it
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLStateCache.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// shadow value of a binding that is not known
+	const GLuint g_UnknownID = 0xFFFFFFFF;
+
+	// texture targets shadowed on every unit
+	const GLenum g_TextureTargets[] =
+	{
+		GL_TEXTURE_2D,
+		GL_TEXTURE_CUBE_MAP,
+		GL_TEXTURE_2D_ARRAY,
+		GL_TEXTURE_2D_MULTISAMPLE
+	};
+	const int g_TextureTargetCount = sizeof(g_TextureTargets) / sizeof(g_TextureTargets[0]);
+
+	// buffer targets only ever bound through the cache - the
+	// array and storage targets are also bound when buffers
+	// are created, so they are passed through
+	const GLenum g_BufferTargets[] =
+	{
+		GL_DRAW_INDIRECT_BUFFER,
+		GL_PARAMETER_BUFFER,
+		GL_DISPATCH_INDIRECT_BUFFER
+	};
+	const int g_BufferTargetCount = sizeof(g_BufferTargets) / sizeof(g_BufferTargets[0]);
+
+	// indexed buffer targets and the binding points shadowed
+	const GLenum g_IndexedTargets[] =
+	{
+		GL_SHADER_STORAGE_BUFFER,
+		GL_UNIFORM_BUFFER
+	};
+	const int g_IndexedTargetCount = sizeof(g_IndexedTargets) / sizeof(g_IndexedTargets[0]);
+	const int g_MaxBufferBindings = 16;
+
+	// capabilities shadowed by SetEnabled()
+	const GLenum g_Capabilities[] =
+	{
+		GL_BLEND,
+		GL_DEPTH_TEST,
+		GL_CULL_FACE,
+		GL_SCISSOR_TEST,
+		GL_MULTISAMPLE,
+		GL_FRAMEBUFFER_SRGB
+	};
+	const int g_CapabilityCount = sizeof(g_Capabilities) / sizeof(g_Capabilities[0]);
+
+	// names of the kinds of calls, in CALL_TYPE order
+	const char* const g_CallNames[GLStateCache::CALL_TYPE_COUNT] =
+	{
+		"program",
+		"vertex array",
+		"texture",
+		"buffer",
+		"framebuffer",
+		"viewport",
+		"enable/disable",
+		"blend/depth",
+		"clear color",
+		"uniform"
+	};
+
+	// how a uniform value is sent to the driver
+	enum UNIFORM_KIND
+	{
+		UNIFORM_INT,
+		UNIFORM_UINT,
+		UNIFORM_FLOAT,
+		UNIFORM_VEC2,
+		UNIFORM_VEC3,
+		UNIFORM_VEC4,
+		UNIFORM_MAT4
+	};
+
+	// buffer range bound to an indexed binding point, where a
+	// size of zero is the whole buffer
+	struct BUFFER_BINDING
+	{
+		GLuint bufferID;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	// location and last value of a uniform, which is empty
+	// until the uniform is first set
+	struct UNIFORM_SLOT
+	{
+		GLint location;
+		std::vector<unsigned char> value;
+	};
+	typedef std::unordered_map<std::string, UNIFORM_SLOT> UNIFORM_MAP;
+
+	// shadow copy of the context state
+	struct CONTEXT_STATE
+	{
+		GLuint program;
+		GLuint vertexArray;
+		// -1 when not known
+		int activeUnit;
+		GLuint textures[GLStateCache::MAX_TEXTURE_UNITS][g_TextureTargetCount];
+		GLuint buffers[g_BufferTargetCount];
+		BUFFER_BINDING indexedBuffers[g_IndexedTargetCount][g_MaxBufferBindings];
+		GLuint readFramebuffer;
+		GLuint drawFramebuffer;
+		bool bViewportKnown[GLStateCache::MAX_VIEWPORTS];
+		GLfloat viewports[GLStateCache::MAX_VIEWPORTS][4];
+		// -1 when not known, else 0 or 1
+		int capabilities[g_CapabilityCount];
+		GLenum blendSource;
+		GLenum blendDestination;
+		GLenum depthFunction;
+		int depthMask;
+		bool bClearColorKnown;
+		GLfloat clearColor[4];
+
+		CONTEXT_STATE()
+		{
+			Reset();
+		}
+
+		void Reset()
+		{
+			program = g_UnknownID;
+			vertexArray = g_UnknownID;
+			activeUnit = -1;
+			for (int unit = 0; unit < GLStateCache::MAX_TEXTURE_UNITS; unit++)
+			{
+				for (int target = 0; target < g_TextureTargetCount; target++)
+				{
+					textures[unit][target] = g_UnknownID;
+				}
+			}
+			for (int target = 0; target < g_BufferTargetCount; target++)
+			{
+				buffers[target] = g_UnknownID;
+			}
+			for (int target = 0; target < g_IndexedTargetCount; target++)
+			{
+				for (int index = 0; index < g_MaxBufferBindings; index++)
+				{
+					indexedBuffers[target][index].bufferID = g_UnknownID;
+					indexedBuffers[target][index].offset = 0;
+					indexedBuffers[target][index].size = 0;
+				}
+			}
+			readFramebuffer = g_UnknownID;
+			drawFramebuffer = g_UnknownID;
+			for (int i = 0; i < GLStateCache::MAX_VIEWPORTS; i++)
+			{
+				bViewportKnown[i] = false;
+			}
+			for (int i = 0; i < g_CapabilityCount; i++)
+			{
+				capabilities[i] = -1;
+			}
+			blendSource = GL_NONE;
+			blendDestination = GL_NONE;
+			depthFunction = GL_NONE;
+			depthMask = -1;
+			bClearColorKnown = false;
+		}
+	};
+
+	CONTEXT_STATE g_State;
+	// uniforms of every program the cache has set values in
+	std::map<GLuint, UNIFORM_MAP> g_Uniforms;
+	bool g_bFilter = true;
+	uint64_t g_IssuedCalls[GLStateCache::CALL_TYPE_COUNT] = {};
+	uint64_t g_FilteredCalls[GLStateCache::CALL_TYPE_COUNT] = {};
+	uint64_t g_FrameCount = 0;
+
+	/***********************************************************
+	 *  SkipCall()
+	 *
+	 *  This function is used for counting a call and deciding
+	 *  whether it reaches the driver.  A redundant call is
+	 *  counted as filtered, and is only issued when the filter
+	 *  is turned off.
+	 ***********************************************************/
+	bool SkipCall(GLStateCache::CALL_TYPE type, bool bRedundant)
+	{
+		if (true == bRedundant)
+		{
+			g_FilteredCalls[type]++;
+			if (true == g_bFilter)
+			{
+				return(true);
+			}
+		}
+
+		g_IssuedCalls[type]++;
+		return(false);
+	}
+
+	/***********************************************************
+	 *  FindTarget()
+	 *
+	 *  This function is used for finding the shadow slot of a
+	 *  target in one of the target lists, or -1.
+	 ***********************************************************/
+	int FindTarget(const GLenum targets[], int targetCount, GLenum target)
+	{
+		for (int i = 0; i < targetCount; i++)
+		{
+			if (targets[i] == target)
+			{
+				return(i);
+			}
+		}
+
+		return(-1);
+	}
+
+	/***********************************************************
+	 *  SetUniformData()
+	 *
+	 *  This function is used for setting a uniform of the
+	 *  current program when its value changed.  The location
+	 *  is looked up once per program and name.
+	 ***********************************************************/
+	void SetUniformData(
+		const std::string& name,
+		UNIFORM_KIND kind,
+		const void* pData,
+		size_t size,
+		int count)
+	{
+		if (g_UnknownID == g_State.program)
+		{
+			GLint program = 0;
+			glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+			g_State.program = (GLuint)program;
+		}
+		if (0 == g_State.program)
+		{
+			return;
+		}
+
+		UNIFORM_MAP& uniforms = g_Uniforms[g_State.program];
+		UNIFORM_MAP::iterator slot = uniforms.find(name);
+		if (slot == uniforms.end())
+		{
+			UNIFORM_SLOT newSlot;
+			newSlot.location = glGetUniformLocation(g_State.program, name.c_str());
+			slot = uniforms.insert(std::make_pair(name, newSlot)).first;
+		}
+
+		// the driver ignores uniforms the shader does not use
+		bool bRedundant = (slot->second.location < 0) ||
+			((slot->second.value.size() == size) && (memcmp(slot->second.value.data(), pData, size) == 0));
+		if (true == SkipCall(GLStateCache::CALL_UNIFORM, bRedundant))
+		{
+			return;
+		}
+
+		slot->second.value.assign((const unsigned char*)pData, (const unsigned char*)pData + size);
+		GLint location = slot->second.location;
+		switch (kind)
+		{
+		case UNIFORM_INT:
+			glUniform1iv(location, count, (const GLint*)pData);
+			break;
+		case UNIFORM_UINT:
+			glUniform1uiv(location, count, (const GLuint*)pData);
+			break;
+		case UNIFORM_FLOAT:
+			glUniform1fv(location, count, (const GLfloat*)pData);
+			break;
+		case UNIFORM_VEC2:
+			glUniform2fv(location, count, (const GLfloat*)pData);
+			break;
+		case UNIFORM_VEC3:
+			glUniform3fv(location, count, (const GLfloat*)pData);
+			break;
+		case UNIFORM_VEC4:
+			glUniform4fv(location, count, (const GLfloat*)pData);
+			break;
+		case UNIFORM_MAT4:
+			glUniformMatrix4fv(location, count, GL_FALSE, (const GLfloat*)pData);
+			break;
+		}
+	}
+}
+
+/***********************************************************
+ *  Invalidate()
+ *
+ *  This method is used for forgetting all of the shadowed
+ *  state, including the uniform values, after code outside
+ *  the cache changed it.
+ ***********************************************************/
+void GLStateCache::Invalidate()
+{
+	g_State.Reset();
+	g_Uniforms.clear();
+}
+
+/***********************************************************
+ *  InvalidateVertexArray()
+ *
+ *  This method is used for forgetting the vertex array
+ *  binding, after code outside the cache bound one.
+ ***********************************************************/
+void GLStateCache::InvalidateVertexArray()
+{
+	g_State.vertexArray = g_UnknownID;
+}
+
+/***********************************************************
+ *  ForgetProgram()
+ *
+ *  This method is used for dropping the uniform values of a
+ *  program before it is deleted or linked again.
+ ***********************************************************/
+void GLStateCache::ForgetProgram(GLuint programID)
+{
+	g_Uniforms.erase(programID);
+	if (g_State.program == programID)
+	{
+		g_State.program = g_UnknownID;
+	}
+}
+
+/***********************************************************
+ *  ForgetTexture()
+ *
+ *  This method is used for forgetting the units a texture
+ *  is bound to before it is deleted.
+ ***********************************************************/
+void GLStateCache::ForgetTexture(GLuint textureID)
+{
+	for (int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+	{
+		for (int target = 0; target < g_TextureTargetCount; target++)
+		{
+			if (g_State.textures[unit][target] == textureID)
+			{
+				g_State.textures[unit][target] = g_UnknownID;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ForgetBuffer()
+ *
+ *  This method is used for forgetting the binding points a
+ *  buffer is bound to before it is deleted.
+ ***********************************************************/
+void GLStateCache::ForgetBuffer(GLuint bufferID)
+{
+	for (int target = 0; target < g_BufferTargetCount; target++)
+	{
+		if (g_State.buffers[target] == bufferID)
+		{
+			g_State.buffers[target] = g_UnknownID;
+		}
+	}
+	for (int target = 0; target < g_IndexedTargetCount; target++)
+	{
+		for (int index = 0; index < g_MaxBufferBindings; index++)
+		{
+			if (g_State.indexedBuffers[target][index].bufferID == bufferID)
+			{
+				g_State.indexedBuffers[target][index].bufferID = g_UnknownID;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ForgetVertexArray()
+ *
+ *  This method is used for forgetting a vertex array before
+ *  it is deleted.
+ ***********************************************************/
+void GLStateCache::ForgetVertexArray(GLuint vertexArrayID)
+{
+	if (g_State.vertexArray == vertexArrayID)
+	{
+		g_State.vertexArray = g_UnknownID;
+	}
+}
+
+/***********************************************************
+ *  ForgetFramebuffer()
+ *
+ *  This method is used for forgetting a framebuffer before
+ *  it is deleted.
+ ***********************************************************/
+void GLStateCache::ForgetFramebuffer(GLuint framebufferID)
+{
+	if (g_State.readFramebuffer == framebufferID)
+	{
+		g_State.readFramebuffer = g_UnknownID;
+	}
+	if (g_State.drawFramebuffer == framebufferID)
+	{
+		g_State.drawFramebuffer = g_UnknownID;
+	}
+}
+
+/***********************************************************
+ *  SetFiltering()
+ *
+ *  This method is used for turning the filter on or off.
+ *  With it off every call is issued, which gives the frame
+ *  time to compare against.
+ ***********************************************************/
+void GLStateCache::SetFiltering(bool bFilter)
+{
+	g_bFilter = bFilter;
+}
+
+/***********************************************************
+ *  UseProgram()
+ *
+ *  This method is used for making a shader program current.
+ ***********************************************************/
+void GLStateCache::UseProgram(GLuint programID)
+{
+	if (true == SkipCall(CALL_PROGRAM, g_State.program == programID))
+	{
+		return;
+	}
+
+	glUseProgram(programID);
+	g_State.program = programID;
+}
+
+/***********************************************************
+ *  GetProgram()
+ *
+ *  This method is used for getting the current program as
+ *  last set through the cache.
+ ***********************************************************/
+GLuint GLStateCache::GetProgram()
+{
+	return((g_UnknownID == g_State.program) ? 0 : g_State.program);
+}
+
+/***********************************************************
+ *  BindVertexArray()
+ *
+ *  This method is used for binding a vertex array.
+ ***********************************************************/
+void GLStateCache::BindVertexArray(GLuint vertexArrayID)
+{
+	if (true == SkipCall(CALL_VERTEX_ARRAY, g_State.vertexArray == vertexArrayID))
+	{
+		return;
+	}
+
+	glBindVertexArray(vertexArrayID);
+	g_State.vertexArray = vertexArrayID;
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for binding a texture to a texture
+ *  unit.  The active unit is only changed when the binding
+ *  of that unit changes.
+ ***********************************************************/
+void GLStateCache::BindTexture(int unit, GLenum target, GLuint textureID)
+{
+	int targetIndex = FindTarget(g_TextureTargets, g_TextureTargetCount, target);
+	bool bTracked = (unit >= 0) && (unit < MAX_TEXTURE_UNITS) && (targetIndex >= 0);
+
+	if (true == SkipCall(CALL_TEXTURE, (true == bTracked) && (g_State.textures[unit][targetIndex] == textureID)))
+	{
+		return;
+	}
+
+	if (g_State.activeUnit != unit)
+	{
+		g_IssuedCalls[CALL_TEXTURE]++;
+		glActiveTexture(GL_TEXTURE0 + unit);
+		g_State.activeUnit = unit;
+	}
+	glBindTexture(target, textureID);
+	if (true == bTracked)
+	{
+		g_State.textures[unit][targetIndex] = textureID;
+	}
+}
+
+/***********************************************************
+ *  BindBuffer()
+ *
+ *  This method is used for binding a buffer to a generic
+ *  binding point.
+ ***********************************************************/
+void GLStateCache::BindBuffer(GLenum target, GLuint bufferID)
+{
+	int targetIndex = FindTarget(g_BufferTargets, g_BufferTargetCount, target);
+
+	if (true == SkipCall(CALL_BUFFER, (targetIndex >= 0) && (g_State.buffers[targetIndex] == bufferID)))
+	{
+		return;
+	}
+
+	glBindBuffer(target, bufferID);
+	if (targetIndex >= 0)
+	{
+		g_State.buffers[targetIndex] = bufferID;
+	}
+}
+
+/***********************************************************
+ *  BindBufferBase()
+ *
+ *  This method is used for binding a whole buffer to an
+ *  indexed binding point.
+ ***********************************************************/
+void GLStateCache::BindBufferBase(GLenum target, GLuint index, GLuint bufferID)
+{
+	BindBufferRange(target, index, bufferID, 0, 0);
+}
+
+/***********************************************************
+ *  BindBufferRange()
+ *
+ *  This method is used for binding part of a buffer to an
+ *  indexed binding point, or the whole buffer when the size
+ *  is zero.
+ ***********************************************************/
+void GLStateCache::BindBufferRange(GLenum target, GLuint index, GLuint bufferID, GLintptr offset, GLsizeiptr size)
+{
+	int targetIndex = FindTarget(g_IndexedTargets, g_IndexedTargetCount, target);
+	bool bTracked = (targetIndex >= 0) && (index < (GLuint)g_MaxBufferBindings);
+
+	bool bRedundant = false;
+	if (true == bTracked)
+	{
+		const BUFFER_BINDING& binding = g_State.indexedBuffers[targetIndex][index];
+		bRedundant = (binding.bufferID == bufferID) && (binding.offset == offset) && (binding.size == size);
+	}
+	if (true == SkipCall(CALL_BUFFER, bRedundant))
+	{
+		return;
+	}
+
+	if (0 == size)
+	{
+		glBindBufferBase(target, index, bufferID);
+	}
+	else
+	{
+		glBindBufferRange(target, index, bufferID, offset, size);
+	}
+	if (true == bTracked)
+	{
+		BUFFER_BINDING& binding = g_State.indexedBuffers[targetIndex][index];
+		binding.bufferID = bufferID;
+		binding.offset = offset;
+		binding.size = size;
+	}
+}
+
+/***********************************************************
+ *  BindFramebuffer()
+ *
+ *  This method is used for binding a framebuffer for drawing,
+ *  reading or both.
+ ***********************************************************/
+void GLStateCache::BindFramebuffer(GLenum target, GLuint framebufferID)
+{
+	bool bRead = (GL_FRAMEBUFFER == target) || (GL_READ_FRAMEBUFFER == target);
+	bool bDraw = (GL_FRAMEBUFFER == target) || (GL_DRAW_FRAMEBUFFER == target);
+
+	bool bRedundant = ((false == bRead) || (g_State.readFramebuffer == framebufferID)) &&
+		((false == bDraw) || (g_State.drawFramebuffer == framebufferID));
+	if (true == SkipCall(CALL_FRAMEBUFFER, bRedundant))
+	{
+		return;
+	}
+
+	glBindFramebuffer(target, framebufferID);
+	if (true == bRead)
+	{
+		g_State.readFramebuffer = framebufferID;
+	}
+	if (true == bDraw)
+	{
+		g_State.drawFramebuffer = framebufferID;
+	}
+}
+
+/***********************************************************
+ *  Viewport()
+ *
+ *  This method is used for setting every viewport to the
+ *  same rectangle.
+ ***********************************************************/
+void GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	GLfloat viewport[4] = { (GLfloat)x, (GLfloat)y, (GLfloat)width, (GLfloat)height };
+
+	bool bRedundant = true;
+	for (int i = 0; (i < MAX_VIEWPORTS) && (true == bRedundant); i++)
+	{
+		bRedundant = (true == g_State.bViewportKnown[i]) &&
+			(memcmp(g_State.viewports[i], viewport, sizeof(viewport)) == 0);
+	}
+	if (true == SkipCall(CALL_VIEWPORT, bRedundant))
+	{
+		return;
+	}
+
+	glViewport(x, y, width, height);
+	for (int i = 0; i < MAX_VIEWPORTS; i++)
+	{
+		g_State.bViewportKnown[i] = true;
+		memcpy(g_State.viewports[i], viewport, sizeof(viewport));
+	}
+}
+
+/***********************************************************
+ *  ViewportIndexed()
+ *
+ *  This method is used for setting one entry of the
+ *  viewport array.
+ ***********************************************************/
+void GLStateCache::ViewportIndexed(GLuint index, GLfloat x, GLfloat y, GLfloat width, GLfloat height)
+{
+	GLfloat viewport[4] = { x, y, width, height };
+	bool bTracked = (index < (GLuint)MAX_VIEWPORTS);
+
+	bool bRedundant = (true == bTracked) &&
+		(true == g_State.bViewportKnown[index]) &&
+		(memcmp(g_State.viewports[index], viewport, sizeof(viewport)) == 0);
+	if (true == SkipCall(CALL_VIEWPORT, bRedundant))
+	{
+		return;
+	}
+
+	glViewportIndexedf(index, x, y, width, height);
+	if (true == bTracked)
+	{
+		g_State.bViewportKnown[index] = true;
+		memcpy(g_State.viewports[index], viewport, sizeof(viewport));
+	}
+}
+
+/***********************************************************
+ *  SetEnabled()
+ *
+ *  This method is used for enabling or disabling a
+ *  capability like blending or the depth test.
+ ***********************************************************/
+void GLStateCache::SetEnabled(GLenum capability, bool bEnabled)
+{
+	int capabilityIndex = FindTarget(g_Capabilities, g_CapabilityCount, capability);
+	int state = (true == bEnabled) ? 1 : 0;
+
+	if (true == SkipCall(CALL_CAPABILITY, (capabilityIndex >= 0) && (g_State.capabilities[capabilityIndex] == state)))
+	{
+		return;
+	}
+
+	if (true == bEnabled)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+	if (capabilityIndex >= 0)
+	{
+		g_State.capabilities[capabilityIndex] = state;
+	}
+}
+
+/***********************************************************
+ *  BlendFunc()
+ *
+ *  This method is used for setting the blend factors.
+ ***********************************************************/
+void GLStateCache::BlendFunc(GLenum source, GLenum destination)
+{
+	if (true == SkipCall(CALL_BLEND_DEPTH, (g_State.blendSource == source) && (g_State.blendDestination == destination)))
+	{
+		return;
+	}
+
+	glBlendFunc(source, destination);
+	g_State.blendSource = source;
+	g_State.blendDestination = destination;
+}
+
+/***********************************************************
+ *  DepthFunc()
+ *
+ *  This method is used for setting the depth comparison.
+ ***********************************************************/
+void GLStateCache::DepthFunc(GLenum function)
+{
+	if (true == SkipCall(CALL_BLEND_DEPTH, g_State.depthFunction == function))
+	{
+		return;
+	}
+
+	glDepthFunc(function);
+	g_State.depthFunction = function;
+}
+
+/***********************************************************
+ *  DepthMask()
+ *
+ *  This method is used for turning depth writes on or off.
+ ***********************************************************/
+void GLStateCache::DepthMask(bool bWrite)
+{
+	int state = (true == bWrite) ? 1 : 0;
+
+	if (true == SkipCall(CALL_BLEND_DEPTH, g_State.depthMask == state))
+	{
+		return;
+	}
+
+	glDepthMask((true == bWrite) ? GL_TRUE : GL_FALSE);
+	g_State.depthMask = state;
+}
+
+/***********************************************************
+ *  ClearColor()
+ *
+ *  This method is used for setting the color buffers are
+ *  cleared to.
+ ***********************************************************/
+void GLStateCache::ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	GLfloat color[4] = { red, green, blue, alpha };
+
+	if (true == SkipCall(CALL_CLEAR_COLOR,
+		(true == g_State.bClearColorKnown) && (memcmp(g_State.clearColor, color, sizeof(color)) == 0)))
+	{
+		return;
+	}
+
+	glClearColor(red, green, blue, alpha);
+	g_State.bClearColorKnown = true;
+	memcpy(g_State.clearColor, color, sizeof(color));
+}
+
+/***********************************************************
+ *  SetBoolValue()
+ *
+ *  This method is used for setting a bool uniform, which
+ *  the shader reads as an int.
+ ***********************************************************/
+void GLStateCache::SetBoolValue(const std::string& name, bool value)
+{
+	GLint intValue = (true == value) ? 1 : 0;
+	SetUniformData(name, UNIFORM_INT, &intValue, sizeof(intValue), 1);
+}
+
+/***********************************************************
+ *  SetIntValue()
+ *
+ *  This method is used for setting an int uniform or sampler.
+ ***********************************************************/
+void GLStateCache::SetIntValue(const std::string& name, int value)
+{
+	GLint intValue = value;
+	SetUniformData(name, UNIFORM_INT, &intValue, sizeof(intValue), 1);
+}
+
+/***********************************************************
+ *  SetUIntValue()
+ *
+ *  This method is used for setting an unsigned int uniform.
+ ***********************************************************/
+void GLStateCache::SetUIntValue(const std::string& name, unsigned int value)
+{
+	GLuint uintValue = value;
+	SetUniformData(name, UNIFORM_UINT, &uintValue, sizeof(uintValue), 1);
+}
+
+/***********************************************************
+ *  SetFloatValue()
+ *
+ *  This method is used for setting a float uniform.
+ ***********************************************************/
+void GLStateCache::SetFloatValue(const std::string& name, float value)
+{
+	SetUniformData(name, UNIFORM_FLOAT, &value, sizeof(value), 1);
+}
+
+/***********************************************************
+ *  SetVec2Value()
+ *
+ *  This method is used for setting a vec2 uniform.
+ ***********************************************************/
+void GLStateCache::SetVec2Value(const std::string& name, const glm::vec2& value)
+{
+	SetUniformData(name, UNIFORM_VEC2, glm::value_ptr(value), sizeof(float) * 2, 1);
+}
+
+/***********************************************************
+ *  SetVec3Value()
+ *
+ *  This method is used for setting a vec3 uniform.
+ ***********************************************************/
+void GLStateCache::SetVec3Value(const std::string& name, const glm::vec3& value)
+{
+	SetUniformData(name, UNIFORM_VEC3, glm::value_ptr(value), sizeof(float) * 3, 1);
+}
+
+/***********************************************************
+ *  SetVec3Value()
+ *
+ *  This method is used for setting a vec3 uniform.
+ ***********************************************************/
+void GLStateCache::SetVec3Value(const std::string& name, float x, float y, float z)
+{
+	SetVec3Value(name, glm::vec3(x, y, z));
+}
+
+/***********************************************************
+ *  SetVec4Value()
+ *
+ *  This method is used for setting a vec4 uniform.
+ ***********************************************************/
+void GLStateCache::SetVec4Value(const std::string& name, const glm::vec4& value)
+{
+	SetUniformData(name, UNIFORM_VEC4, glm::value_ptr(value), sizeof(float) * 4, 1);
+}
+
+/***********************************************************
+ *  SetMat4Value()
+ *
+ *  This method is used for setting a mat4 uniform.
+ ***********************************************************/
+void GLStateCache::SetMat4Value(const std::string& name, const glm::mat4& value)
+{
+	SetUniformData(name, UNIFORM_MAT4, glm::value_ptr(value), sizeof(float) * 16, 1);
+}
+
+/***********************************************************
+ *  SetVec4Array()
+ *
+ *  This method is used for setting a vec4 array uniform,
+ *  starting at its first element.
+ ***********************************************************/
+void GLStateCache::SetVec4Array(const std::string& name, const glm::vec4* pValues, int count)
+{
+	SetUniformData(name, UNIFORM_VEC4, glm::value_ptr(pValues[0]), sizeof(float) * 4 * count, count);
+}
+
+/***********************************************************
+ *  SetMat4Array()
+ *
+ *  This method is used for setting a mat4 array uniform,
+ *  starting at its first element.
+ ***********************************************************/
+void GLStateCache::SetMat4Array(const std::string& name, const glm::mat4* pValues, int count)
+{
+	SetUniformData(name, UNIFORM_MAT4, glm::value_ptr(pValues[0]), sizeof(float) * 16 * count, count);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for counting a finished frame.
+ ***********************************************************/
+void GLStateCache::EndFrame()
+{
+	g_FrameCount++;
+}
+
+/***********************************************************
+ *  GetIssuedCalls()
+ *
+ *  This method is used for getting the number of calls of a
+ *  kind that reached the driver.
+ ***********************************************************/
+uint64_t GLStateCache::GetIssuedCalls(CALL_TYPE type)
+{
+	return(g_IssuedCalls[type]);
+}
+
+/***********************************************************
+ *  GetFilteredCalls()
+ *
+ *  This method is used for getting the number of redundant
+ *  calls of a kind, which were dropped unless the filter
+ *  was turned off.
+ ***********************************************************/
+uint64_t GLStateCache::GetFilteredCalls(CALL_TYPE type)
+{
+	return(g_FilteredCalls[type]);
+}
+
+/***********************************************************
+ *  PrintStats()
+ *
+ *  This method is used for printing the calls issued and
+ *  filtered of every kind, per frame and in total.
+ ***********************************************************/
+void GLStateCache::PrintStats()
+{
+	double frames = (g_FrameCount > 0) ? (double)g_FrameCount : 1.0;
+	uint64_t totalIssued = 0;
+	uint64_t totalFiltered = 0;
+
+	std::cout << "GL state calls over " << g_FrameCount << " frames"
+		<< ((true == g_bFilter) ? "" : " (filter off, redundant calls were issued)") << ":" << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	for (int i = 0; i < CALL_TYPE_COUNT; i++)
+	{
+		totalIssued += g_IssuedCalls[i];
+		totalFiltered += g_FilteredCalls[i];
+		std::cout << "  " << std::left << std::setw(16) << g_CallNames[i] << std::right
+			<< " issued " << std::setw(10) << g_IssuedCalls[i] / frames << " per frame, "
+			<< "redundant " << std::setw(10) << g_FilteredCalls[i] / frames << " per frame" << std::endl;
+	}
+
+	// with the filter off the redundant calls were issued too
+	uint64_t totalCalls = (true == g_bFilter) ? (totalIssued + totalFiltered) : totalIssued;
+	double percent = (totalCalls > 0) ? (100.0 * totalFiltered / (double)totalCalls) : 0.0;
+	std::cout << "  total issued " << totalIssued << ", redundant " << totalFiltered
+		<< " (" << percent << "%)" << std::endl;
+	std::cout << std::defaultfloat;
+}
@@ -0,0 +1,116 @@
+///////////////////////////////////////////////////////////////////////////////
+// glstatecache.h
+// ============
+// shadow the OpenGL state and drop the calls that would not change it
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  GLStateCache
+ *
+ *  This class sits between the scene code and OpenGL for
+ *  the state that is set every frame - the shader program,
+ *  vertex array, texture and buffer bindings, framebuffers,
+ *  viewports, blend and depth state and the uniforms.  It
+ *  keeps a shadow copy of what was last set, and a call
+ *  that would set the same value again never reaches the
+ *  driver.  The calls issued and filtered are counted, so
+ *  the driver work saved can be measured.
+ *  There is one OpenGL context, so the shadow is global,
+ *  and every method must be called on the GL thread.  Code
+ *  that changes the state behind its back, like the basic
+ *  shape meshes binding their own vertex arrays, has to
+ *  tell it with one of the Invalidate methods.
+ ***********************************************************/
+class GLStateCache
+{
+public:
+	// kinds of calls counted by the cache
+	enum CALL_TYPE
+	{
+		CALL_PROGRAM = 0,
+		CALL_VERTEX_ARRAY,
+		CALL_TEXTURE,
+		CALL_BUFFER,
+		CALL_FRAMEBUFFER,
+		CALL_VIEWPORT,
+		CALL_CAPABILITY,
+		CALL_BLEND_DEPTH,
+		CALL_CLEAR_COLOR,
+		CALL_UNIFORM,
+		CALL_TYPE_COUNT
+	};
+
+	// texture units and viewports that are shadowed
+	static const int MAX_TEXTURE_UNITS = 32;
+	static const int MAX_VIEWPORTS = 16;
+
+	// forget all of the shadowed state, so the next call of
+	// every kind reaches the driver
+	static void Invalidate();
+	// forget the vertex array binding, after code outside
+	// the cache bound one
+	static void InvalidateVertexArray();
+	// forget the shadowed state of an object that is about
+	// to be deleted, as its ID can be handed out again
+	static void ForgetProgram(GLuint programID);
+	static void ForgetTexture(GLuint textureID);
+	static void ForgetBuffer(GLuint bufferID);
+	static void ForgetVertexArray(GLuint vertexArrayID);
+	static void ForgetFramebuffer(GLuint framebufferID);
+
+	// turn the filter off, so every call is issued and the
+	// redundant ones are only counted
+	static void SetFiltering(bool bFilter);
+
+	// bindings
+	static void UseProgram(GLuint programID);
+	static GLuint GetProgram();
+	static void BindVertexArray(GLuint vertexArrayID);
+	static void BindTexture(int unit, GLenum target, GLuint textureID);
+	static void BindBuffer(GLenum target, GLuint bufferID);
+	static void BindBufferBase(GLenum target, GLuint index, GLuint bufferID);
+	static void BindBufferRange(GLenum target, GLuint index, GLuint bufferID, GLintptr offset, GLsizeiptr size);
+	static void BindFramebuffer(GLenum target, GLuint framebufferID);
+
+	// fixed function state
+	static void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	static void ViewportIndexed(GLuint index, GLfloat x, GLfloat y, GLfloat width, GLfloat height);
+	static void SetEnabled(GLenum capability, bool bEnabled);
+	static void BlendFunc(GLenum source, GLenum destination);
+	static void DepthFunc(GLenum function);
+	static void DepthMask(bool bWrite);
+	static void ClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+	// uniforms of the current program, which keep their
+	// values while other programs are used
+	static void SetBoolValue(const std::string& name, bool value);
+	static void SetIntValue(const std::string& name, int value);
+	static void SetUIntValue(const std::string& name, unsigned int value);
+	static void SetFloatValue(const std::string& name, float value);
+	static void SetVec2Value(const std::string& name, const glm::vec2& value);
+	static void SetVec3Value(const std::string& name, const glm::vec3& value);
+	static void SetVec3Value(const std::string& name, float x, float y, float z);
+	static void SetVec4Value(const std::string& name, const glm::vec4& value);
+	static void SetMat4Value(const std::string& name, const glm::mat4& value);
+	static void SetVec4Array(const std::string& name, const glm::vec4* pValues, int count);
+	static void SetMat4Array(const std::string& name, const glm::mat4* pValues, int count);
+
+	// count a finished frame, for the per-frame averages
+	static void EndFrame();
+	// calls of a kind issued to the driver and filtered out
+	static uint64_t GetIssuedCalls(CALL_TYPE type);
+	static uint64_t GetFilteredCalls(CALL_TYPE type);
+	// print the counters of every kind of call
+	static void PrintStats();
+};
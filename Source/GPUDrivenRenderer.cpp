@@ -0,0 +1,370 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpudrivenrenderer.cpp
+// ============
+// cull the scene objects and build the draw commands on the GPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GPUDrivenRenderer.h"
+#include "GLStateCache.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// shader storage binding points used by the culling shader
+	const GLuint g_ObjectBinding = 2;
+	const GLuint g_LODBinding = 3;
+	const GLuint g_CommandBinding = 4;
+	const GLuint g_DrawCountBinding = 5;
+
+	// number of objects culled by each work group - must match
+	// local_size_x in the culling shader
+	const GLuint g_CullGroupSize = 64;
+
+	// projected bounding sphere sizes below which the second
+	// and third levels of detail are used
+	const glm::vec2 g_LODThresholds = glm::vec2(0.25f, 0.08f);
+}
+
+/***********************************************************
+ *  GPUDrivenRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GPUDrivenRenderer::GPUDrivenRenderer()
+{
+	m_pMeshes = NULL;
+	m_objectCount = 0;
+	m_cullProgramID = 0;
+	m_drawRecordBufferID = 0;
+	m_objectBufferID = 0;
+	m_lodBufferID = 0;
+	m_commandBufferID = 0;
+	m_drawCountBufferID = 0;
+	m_drawIndexBufferID = 0;
+	m_viewCount = 1;
+	m_drawIndexDivisor = 1;
+}
+
+/***********************************************************
+ *  ~GPUDrivenRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GPUDrivenRenderer::~GPUDrivenRenderer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking whether the context
+ *  supports multi-draw indirect with the draw count taken
+ *  from a buffer, which is core in OpenGL 4.6.
+ ***********************************************************/
+bool GPUDrivenRenderer::IsSupported()
+{
+	return(GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for loading the culling shader and
+ *  copying the scene objects into the buffers it reads.
+ *  The scene is static, so the draw records are uploaded
+ *  once instead of being written every frame.
+ ***********************************************************/
+bool GPUDrivenRenderer::Create(
+	const char* cullShaderFilePath,
+	const AssetPack* pAssetPack,
+	SceneMeshes* pMeshes,
+	const std::vector<DrawDataBuffer::DRAW_RECORD>& drawRecords,
+	const std::vector<OBJECT_RECORD>& objectRecords)
+{
+	Destroy();
+
+	if ((NULL == pMeshes) || (0 == pMeshes->GetVertexArray()))
+	{
+		std::cout << "GPU-driven rendering needs the scene meshes to be uploaded" << std::endl;
+		return(false);
+	}
+	if (objectRecords.empty() || (drawRecords.size() != objectRecords.size()))
+	{
+		std::cout << "GPU-driven rendering has no scene objects to draw" << std::endl;
+		return(false);
+	}
+	if (false == LoadCullShader(cullShaderFilePath, pAssetPack))
+	{
+		return(false);
+	}
+
+	m_pMeshes = pMeshes;
+	m_objectCount = (uint32_t)objectRecords.size();
+
+	// level of detail table, indexed by mesh * LOD_COUNT + lod
+	std::vector<LOD_RECORD> lodRecords;
+	for (int mesh = 0; mesh < MESH_TYPE_COUNT; mesh++)
+	{
+		for (int lod = 0; lod < SceneMeshes::LOD_COUNT; lod++)
+		{
+			const SceneMeshes::MESH_LOD& meshLOD = pMeshes->GetMeshLOD((MESH_TYPE)mesh, lod);
+			LOD_RECORD record;
+			record.firstIndex = meshLOD.firstIndex;
+			record.indexCount = meshLOD.indexCount;
+			record.baseVertex = meshLOD.baseVertex;
+			record.padding = 0;
+			lodRecords.push_back(record);
+		}
+	}
+
+	// the object index of each draw is its base instance, which
+	// an instanced attribute turns into the shader draw index
+	std::vector<uint32_t> drawIndices(m_objectCount);
+	for (uint32_t i = 0; i < m_objectCount; i++)
+	{
+		drawIndices[i] = i;
+	}
+
+	glGenBuffers(1, &m_drawRecordBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawRecordBufferID);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, drawRecords.size() * sizeof(DrawDataBuffer::DRAW_RECORD), drawRecords.data(), 0);
+
+	glGenBuffers(1, &m_objectBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_objectBufferID);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, objectRecords.size() * sizeof(OBJECT_RECORD), objectRecords.data(), 0);
+
+	glGenBuffers(1, &m_lodBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_lodBufferID);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, lodRecords.size() * sizeof(LOD_RECORD), lodRecords.data(), 0);
+
+	// every bucket has room for all of the objects
+	glGenBuffers(1, &m_commandBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_commandBufferID);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, BUCKET_COUNT * m_objectCount * sizeof(DRAW_ELEMENTS_COMMAND), NULL, 0);
+
+	glGenBuffers(1, &m_drawCountBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawCountBufferID);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, BUCKET_COUNT * sizeof(uint32_t), NULL, GL_DYNAMIC_STORAGE_BIT);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	GLStateCache::BindVertexArray(pMeshes->GetVertexArray());
+	glGenBuffers(1, &m_drawIndexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_drawIndexBufferID);
+	glBufferStorage(GL_ARRAY_BUFFER, drawIndices.size() * sizeof(uint32_t), drawIndices.data(), 0);
+	glEnableVertexAttribArray(DrawDataBuffer::DRAW_INDEX_LOCATION);
+	glVertexAttribIPointer(DrawDataBuffer::DRAW_INDEX_LOCATION, 1, GL_UNSIGNED_INT, sizeof(uint32_t), (void*)0);
+	glVertexAttribDivisor(DrawDataBuffer::DRAW_INDEX_LOCATION, 1);
+	GLStateCache::BindVertexArray(0);
+	m_drawIndexDivisor = 1;
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the culling shader and
+ *  all of the buffers.
+ ***********************************************************/
+void GPUDrivenRenderer::Destroy()
+{
+	GLuint* bufferIDs[] =
+	{
+		&m_drawRecordBufferID,
+		&m_objectBufferID,
+		&m_lodBufferID,
+		&m_commandBufferID,
+		&m_drawCountBufferID,
+		&m_drawIndexBufferID
+	};
+
+	for (size_t i = 0; i < sizeof(bufferIDs) / sizeof(bufferIDs[0]); i++)
+	{
+		if (0 != *bufferIDs[i])
+		{
+			GLStateCache::ForgetBuffer(*bufferIDs[i]);
+			glDeleteBuffers(1, bufferIDs[i]);
+			*bufferIDs[i] = 0;
+		}
+	}
+
+	if (0 != m_cullProgramID)
+	{
+		GLStateCache::ForgetProgram(m_cullProgramID);
+		glDeleteProgram(m_cullProgramID);
+		m_cullProgramID = 0;
+	}
+
+	m_pMeshes = NULL;
+	m_objectCount = 0;
+	m_viewCount = 1;
+}
+
+/***********************************************************
+ *  Cull()
+ *
+ *  This method is used for running the culling shader over
+ *  every scene object.  Each visible object appends a draw
+ *  command for its chosen level of detail to the bucket of
+ *  its mesh type.  With more than one view, an object is
+ *  kept if any view sees it, and its level of detail comes
+ *  from the view it is largest in.  The scene shader program
+ *  must be made current again before drawing.
+ ***********************************************************/
+void GPUDrivenRenderer::Cull(
+	const glm::mat4 viewProjections[],
+	const glm::vec4 frustumPlanes[][6],
+	int viewCount)
+{
+	const uint32_t zero = 0;
+
+	if (0 == m_cullProgramID)
+	{
+		return;
+	}
+
+	// start every bucket empty
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawCountBufferID);
+	glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	m_viewCount = glm::clamp(viewCount, 1, MAX_VIEWS);
+
+	// only the view values change from frame to frame, so the
+	// state cache drops the rest
+	GLStateCache::UseProgram(m_cullProgramID);
+	GLStateCache::SetIntValue("viewCount", m_viewCount);
+	GLStateCache::SetMat4Array("viewProjections", viewProjections, m_viewCount);
+	GLStateCache::SetVec4Array("frustumPlanes", frustumPlanes[0], m_viewCount * 6);
+	GLStateCache::SetVec2Value("lodThresholds", g_LODThresholds);
+	GLStateCache::SetUIntValue("objectCount", m_objectCount);
+	GLStateCache::SetUIntValue("bucketCapacity", m_objectCount);
+
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, g_ObjectBinding, m_objectBufferID);
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, g_LODBinding, m_lodBufferID);
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, g_CommandBinding, m_commandBufferID);
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, g_DrawCountBinding, m_drawCountBufferID);
+
+	glDispatchCompute((m_objectCount + g_CullGroupSize - 1) / g_CullGroupSize, 1, 1);
+
+	// the draw commands and counts are read as indirect parameters
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing the commands written by
+ *  the last Cull(), with one multi-draw call per bucket.
+ *  The draw count of each bucket is read from the GPU, so
+ *  nothing has to be read back.  The opaque and transparent
+ *  buckets use different shader variants, so they are drawn
+ *  by separate calls.
+ ***********************************************************/
+void GPUDrivenRenderer::Draw(bool bTransparent)
+{
+	if ((0 == m_cullProgramID) || (NULL == m_pMeshes))
+	{
+		return;
+	}
+
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, DrawDataBuffer::DRAW_RECORD_BINDING, m_drawRecordBufferID);
+	GLStateCache::BindVertexArray(m_pMeshes->GetVertexArray());
+	// every object is drawn once per view, so all of its
+	// instances have to read the same draw index
+	if (m_drawIndexDivisor != m_viewCount)
+	{
+		glVertexAttribDivisor(DrawDataBuffer::DRAW_INDEX_LOCATION, m_viewCount);
+		m_drawIndexDivisor = m_viewCount;
+	}
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBufferID);
+	GLStateCache::BindBuffer(GL_PARAMETER_BUFFER, m_drawCountBufferID);
+
+	// the transparent bucket is drawn last so it blends over
+	// the rest, and the opaque buckets are drawn without blending
+	GLStateCache::SetEnabled(GL_BLEND, bTransparent);
+	int firstBucket = (true == bTransparent) ? TRANSPARENT_BUCKET : 0;
+	int endBucket = (true == bTransparent) ? BUCKET_COUNT : TRANSPARENT_BUCKET;
+	for (int bucket = firstBucket; bucket < endBucket; bucket++)
+	{
+
+		const void* pCommands = (const void*)(bucket * m_objectCount * sizeof(DRAW_ELEMENTS_COMMAND));
+		GLintptr drawCountOffset = (GLintptr)(bucket * sizeof(uint32_t));
+
+		if (GLEW_VERSION_4_6)
+		{
+			glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, drawCountOffset, m_objectCount, 0);
+		}
+		else
+		{
+			glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, pCommands, drawCountOffset, m_objectCount, 0);
+		}
+	}
+}
+
+/***********************************************************
+ *  LoadCullShader()
+ *
+ *  This method is used for reading, compiling and linking
+ *  the culling compute shader from the asset pack, or from
+ *  the passed in file when it is not packed.  When the
+ *  shader is loaded again after it was edited, a shader
+ *  that fails to build leaves the last working one in use.
+ ***********************************************************/
+bool GPUDrivenRenderer::LoadCullShader(const char* filePath, const AssetPack* pAssetPack)
+{
+	AssetPack::ASSET_DATA shaderFile;
+	if (false == pAssetPack->Read(filePath, shaderFile))
+	{
+		std::cout << "Could not open the culling shader: " << filePath << std::endl;
+		return(false);
+	}
+
+	// the source is passed with its length, since the asset
+	// data is not null terminated
+	const char* pShaderCode = (const char*)shaderFile.pData;
+	GLint shaderLength = (GLint)shaderFile.size;
+
+	GLint success = 0;
+	char infoLog[512];
+
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shaderID, 1, &pShaderCode, &shaderLength);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+		std::cout << "Failed to compile the culling shader: " << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(false);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, shaderID);
+	glLinkProgram(programID);
+	glDeleteShader(shaderID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(programID, 512, NULL, infoLog);
+		std::cout << "Failed to link the culling shader: " << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(false);
+	}
+
+	if (0 != m_cullProgramID)
+	{
+		GLStateCache::ForgetProgram(m_cullProgramID);
+		glDeleteProgram(m_cullProgramID);
+	}
+	m_cullProgramID = programID;
+
+	return(true);
+}
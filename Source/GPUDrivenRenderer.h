@@ -0,0 +1,134 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpudrivenrenderer.h
+// ============
+// cull the scene objects and build the draw commands on the GPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneMeshes.h"
+#include "DrawDataBuffer.h"
+#include "AssetPack.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  GPUDrivenRenderer
+ *
+ *  This class keeps the scene objects in shader storage
+ *  buffers so that a compute shader can cull them against
+ *  the view frustum, pick a level of detail for each one,
+ *  and write the indirect draw commands.  Each frame is
+ *  then drawn with one multi-draw call per mesh type, plus
+ *  one for the transparent objects, so the CPU cost stays
+ *  the same no matter how many objects are in the scene.
+ ***********************************************************/
+class GPUDrivenRenderer
+{
+public:
+	// culling values for one scene object - the layout must
+	// match the ObjectRecord struct in the culling shader
+	struct OBJECT_RECORD
+	{
+		// world space bounding sphere, w is the radius
+		glm::vec4 boundingSphere;
+		uint32_t mesh;
+		uint32_t bTransparent;
+		uint32_t padding[2];
+	};
+
+	// most views that can be culled and drawn in one pass
+	static const int MAX_VIEWS = 4;
+
+	// constructor
+	GPUDrivenRenderer();
+	// destructor
+	~GPUDrivenRenderer();
+
+	// check whether the OpenGL context can draw indirectly
+	// with the draw count read from a buffer
+	static bool IsSupported();
+
+	// load the culling shader and create the buffers for the
+	// passed in meshes and scene objects
+	bool Create(
+		const char* cullShaderFilePath,
+		const AssetPack* pAssetPack,
+		SceneMeshes* pMeshes,
+		const std::vector<DrawDataBuffer::DRAW_RECORD>& drawRecords,
+		const std::vector<OBJECT_RECORD>& objectRecords);
+	// free the shader program and buffers
+	void Destroy();
+
+	// cull the scene objects against one or more views and
+	// write the draw commands - an object visible in any of
+	// the views is drawn once for each of them
+	void Cull(
+		const glm::mat4 viewProjections[],
+		const glm::vec4 frustumPlanes[][6],
+		int viewCount);
+	// draw the opaque buckets or the transparent bucket of
+	// the commands written by the last Cull()
+	void Draw(bool bTransparent);
+
+	// compile and link the culling compute shader - the
+	// program already loaded is only replaced when the new
+	// one links
+	bool LoadCullShader(const char* filePath, const AssetPack* pAssetPack);
+
+private:
+	// draw command layout read by the multi-draw calls
+	struct DRAW_ELEMENTS_COMMAND
+	{
+		uint32_t count;
+		uint32_t instanceCount;
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t baseInstance;
+	};
+
+	// buffer range of one level of detail - the layout must
+	// match the MeshLOD struct in the culling shader
+	struct LOD_RECORD
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		int32_t baseVertex;
+		uint32_t padding;
+	};
+
+	// one bucket of draw commands per mesh type, with the
+	// transparent objects in a last bucket drawn after them
+	static const int TRANSPARENT_BUCKET = MESH_TYPE_COUNT;
+	static const int BUCKET_COUNT = MESH_TYPE_COUNT + 1;
+
+	// meshes that the draw commands refer to
+	SceneMeshes* m_pMeshes;
+	// number of scene objects in the buffers
+	uint32_t m_objectCount;
+	// culling compute shader program
+	GLuint m_cullProgramID;
+	// static per-draw records read by the scene shaders
+	GLuint m_drawRecordBufferID;
+	// culling values of the scene objects
+	GLuint m_objectBufferID;
+	// buffer ranges of every mesh level of detail
+	GLuint m_lodBufferID;
+	// draw commands written by the culling shader
+	GLuint m_commandBufferID;
+	// number of draw commands written into each bucket
+	GLuint m_drawCountBufferID;
+	// object index of each instance, read as the draw index
+	GLuint m_drawIndexBufferID;
+	// number of views culled by the last Cull(), which is the
+	// number of instances drawn for every visible object
+	int m_viewCount;
+	// instance divisor currently set on the draw index
+	int m_drawIndexDivisor;
+};
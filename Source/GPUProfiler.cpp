@@ -0,0 +1,242 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuprofiler.cpp
+// ============
+// measure the GPU time of named parts of the frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GPUProfiler.h"
+
+#include <iomanip>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// weight of each new sample in the smoothed time
+	const float g_SmoothingFactor = 0.1f;
+}
+
+/***********************************************************
+ *  GPUProfiler()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GPUProfiler::GPUProfiler()
+{
+	m_frameIndex = 0;
+}
+
+/***********************************************************
+ *  ~GPUProfiler()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GPUProfiler::~GPUProfiler()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the timer queries.  The
+ *  scopes are kept, and get new queries when next used.
+ ***********************************************************/
+void GPUProfiler::Destroy()
+{
+	for (size_t i = 0; i < m_scopes.size(); i++)
+	{
+		SCOPE& scope = m_scopes[i];
+		if (0 != scope.queries[0][0])
+		{
+			glDeleteQueries(FRAME_COUNT * 2, &scope.queries[0][0]);
+		}
+		for (int frame = 0; frame < FRAME_COUNT; frame++)
+		{
+			scope.queries[frame][0] = 0;
+			scope.queries[frame][1] = 0;
+			scope.bPending[frame] = false;
+		}
+	}
+}
+
+/***********************************************************
+ *  AddScope()
+ *
+ *  This method is used for adding a named scope to time.
+ *  No OpenGL calls are made here, so scopes can be added
+ *  before the context exists.
+ ***********************************************************/
+int GPUProfiler::AddScope(const char* name)
+{
+	if ((int)m_scopes.size() >= MAX_SCOPES)
+	{
+		std::cout << "No room to profile the GPU scope: " << name << std::endl;
+		return(-1);
+	}
+
+	SCOPE scope;
+	scope.name = name;
+	for (int frame = 0; frame < FRAME_COUNT; frame++)
+	{
+		scope.queries[frame][0] = 0;
+		scope.queries[frame][1] = 0;
+		scope.bPending[frame] = false;
+	}
+	scope.time = 0.0f;
+	scope.totalTime = 0.0;
+	scope.sampleCount = 0;
+	m_scopes.push_back(scope);
+
+	return((int)m_scopes.size() - 1);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for reading the queries of the
+ *  oldest frame, which are about to be reused.  A scope
+ *  the GPU has not finished yet drops its sample instead
+ *  of waiting for it.
+ ***********************************************************/
+void GPUProfiler::BeginFrame()
+{
+	for (size_t i = 0; i < m_scopes.size(); i++)
+	{
+		SCOPE& scope = m_scopes[i];
+		if (false == scope.bPending[m_frameIndex])
+		{
+			continue;
+		}
+		scope.bPending[m_frameIndex] = false;
+
+		// the end timestamp finishes last, so both are ready
+		// once it is
+		GLint bAvailable = 0;
+		glGetQueryObjectiv(scope.queries[m_frameIndex][1], GL_QUERY_RESULT_AVAILABLE, &bAvailable);
+		if (!bAvailable)
+		{
+			continue;
+		}
+
+		GLuint64 beginTime = 0;
+		GLuint64 endTime = 0;
+		glGetQueryObjectui64v(scope.queries[m_frameIndex][0], GL_QUERY_RESULT, &beginTime);
+		glGetQueryObjectui64v(scope.queries[m_frameIndex][1], GL_QUERY_RESULT, &endTime);
+		float sampleTime = (endTime > beginTime) ? (float)((endTime - beginTime) / 1000000.0) : 0.0f;
+
+		if (0 == scope.sampleCount)
+		{
+			scope.time = sampleTime;
+		}
+		else
+		{
+			scope.time += (sampleTime - scope.time) * g_SmoothingFactor;
+		}
+		scope.totalTime += sampleTime;
+		scope.sampleCount++;
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for moving on to the queries of the
+ *  next frame in flight.
+ ***********************************************************/
+void GPUProfiler::EndFrame()
+{
+	m_frameIndex = (m_frameIndex + 1) % FRAME_COUNT;
+}
+
+/***********************************************************
+ *  BeginScope()
+ *
+ *  This method is used for writing the timestamp where a
+ *  scope begins.  The queries of a scope are created the
+ *  first time it is timed.
+ ***********************************************************/
+void GPUProfiler::BeginScope(int scope)
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()))
+	{
+		return;
+	}
+
+	SCOPE& profiledScope = m_scopes[scope];
+	if (0 == profiledScope.queries[0][0])
+	{
+		glGenQueries(FRAME_COUNT * 2, &profiledScope.queries[0][0]);
+	}
+
+	glQueryCounter(profiledScope.queries[m_frameIndex][0], GL_TIMESTAMP);
+}
+
+/***********************************************************
+ *  EndScope()
+ *
+ *  This method is used for writing the timestamp where a
+ *  scope ends.
+ ***********************************************************/
+void GPUProfiler::EndScope(int scope)
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()) ||
+		(0 == m_scopes[scope].queries[0][0]))
+	{
+		return;
+	}
+
+	SCOPE& profiledScope = m_scopes[scope];
+	glQueryCounter(profiledScope.queries[m_frameIndex][1], GL_TIMESTAMP);
+	profiledScope.bPending[m_frameIndex] = true;
+}
+
+/***********************************************************
+ *  GetTime()
+ *
+ *  This method is used for getting the smoothed GPU time of
+ *  a scope, in milliseconds.
+ ***********************************************************/
+float GPUProfiler::GetTime(int scope) const
+{
+	if ((scope < 0) || (scope >= (int)m_scopes.size()))
+	{
+		return(0.0f);
+	}
+
+	return(m_scopes[scope].time);
+}
+
+/***********************************************************
+ *  PrintReport()
+ *
+ *  This method is used for printing the average GPU time of
+ *  every scope that was measured during the run.
+ ***********************************************************/
+void GPUProfiler::PrintReport() const
+{
+	bool bHeader = false;
+
+	std::cout << std::fixed << std::setprecision(3);
+	for (size_t i = 0; i < m_scopes.size(); i++)
+	{
+		const SCOPE& scope = m_scopes[i];
+		if (0 == scope.sampleCount)
+		{
+			continue;
+		}
+
+		if (false == bHeader)
+		{
+			std::cout << "GPU time per frame:" << std::endl;
+			bHeader = true;
+		}
+		std::cout << "  " << std::left << std::setw(24) << scope.name << std::right
+			<< " average " << std::setw(8) << scope.totalTime / scope.sampleCount << " ms, "
+			<< "last " << std::setw(8) << scope.time << " ms over "
+			<< scope.sampleCount << " frames" << std::endl;
+	}
+	std::cout << std::defaultfloat;
+}
@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// gpuprofiler.h
+// ============
+// measure the GPU time of named parts of the frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  GPUProfiler
+ *
+ *  This class times named scopes of the frame on the GPU.
+ *  Each scope writes a timestamp query where it begins and
+ *  ends, and the queries of the last few frames are kept in
+ *  flight so a result is only read once the GPU is done
+ *  with it, instead of waiting.  Timestamps are used rather
+ *  than elapsed time queries, since those cannot be nested
+ *  inside the one the dynamic render scale keeps running.
+ ***********************************************************/
+class GPUProfiler
+{
+public:
+	// most scopes that can be timed
+	static const int MAX_SCOPES = 16;
+
+	// constructor
+	GPUProfiler();
+	// destructor
+	~GPUProfiler();
+
+	// free the timer queries
+	void Destroy();
+
+	// add a scope to time, returning its index, or -1 when
+	// there is no room for it
+	int AddScope(const char* name);
+
+	// read the results of the oldest frame in flight
+	void BeginFrame();
+	// move on to the queries of the next frame
+	void EndFrame();
+	// mark where a scope begins and ends on the GPU
+	void BeginScope(int scope);
+	void EndScope(int scope);
+
+	// smoothed GPU time of a scope in milliseconds
+	float GetTime(int scope) const;
+	// print the average time of every scope that was measured
+	void PrintReport() const;
+
+private:
+	// number of frames of queries in flight
+	static const int FRAME_COUNT = 4;
+
+	struct SCOPE
+	{
+		std::string name;
+		// begin and end timestamps of each frame in flight
+		GLuint queries[FRAME_COUNT][2];
+		bool bPending[FRAME_COUNT];
+		float time;
+		double totalTime;
+		uint32_t sampleCount;
+	};
+
+	std::vector<SCOPE> m_scopes;
+	int m_frameIndex;
+};
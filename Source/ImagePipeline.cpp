@@ -0,0 +1,1141 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagepipeline.cpp
+// ============
+// convert decoded images into the texture layout and build their mips
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImagePipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define IMAGE_PIPELINE_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and clang only emit the instructions enabled for a function,
+// while MSVC accepts every intrinsic anywhere
+#if defined(__GNUC__)
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_SSSE3 __attribute__((target("ssse3")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE2
+#define TARGET_SSSE3
+#define TARGET_AVX2
+#endif
+
+namespace
+{
+	// highest instruction set the kernels may use
+	std::atomic<int> g_SIMDLimit(ImagePipeline::SIMD_AVX2);
+
+	// radius of the Kaiser filter in destination texels, and
+	// the shape of its window
+	const float g_KaiserRadius = 2.0f;
+	const float g_KaiserAlpha = 4.0f;
+
+	/***********************************************************
+	 *  DetectSIMDLevel()
+	 *
+	 *  This function is used for asking the processor which of
+	 *  the instruction sets it supports.  AVX2 also needs the
+	 *  operating system to save the 256 bit registers.
+	 ***********************************************************/
+	ImagePipeline::SIMD_LEVEL DetectSIMDLevel()
+	{
+#if defined(IMAGE_PIPELINE_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+		__cpuid(info, 1);
+		bool bSSE2 = ((info[3] & (1 << 26)) != 0);
+		bool bSSSE3 = ((info[2] & (1 << 9)) != 0);
+		bool bOSXSAVE = ((info[2] & (1 << 27)) != 0);
+		bool bAVX = ((info[2] & (1 << 28)) != 0);
+		bool bAVX2 = false;
+		if ((maxLeaf >= 7) && (true == bOSXSAVE) && (true == bAVX) && ((_xgetbv(0) & 6) == 6))
+		{
+			__cpuidex(info, 7, 0);
+			bAVX2 = ((info[1] & (1 << 5)) != 0);
+		}
+#elif defined(IMAGE_PIPELINE_X86)
+		__builtin_cpu_init();
+		bool bSSE2 = (0 != __builtin_cpu_supports("sse2"));
+		bool bSSSE3 = (0 != __builtin_cpu_supports("ssse3"));
+		bool bAVX2 = (0 != __builtin_cpu_supports("avx2"));
+#else
+		bool bSSE2 = false;
+		bool bSSSE3 = false;
+		bool bAVX2 = false;
+#endif
+
+		if ((true == bAVX2) && (true == bSSSE3))
+		{
+			return(ImagePipeline::SIMD_AVX2);
+		}
+		if ((true == bSSSE3) && (true == bSSE2))
+		{
+			return(ImagePipeline::SIMD_SSSE3);
+		}
+		if (true == bSSE2)
+		{
+			return(ImagePipeline::SIMD_SSE2);
+		}
+
+		return(ImagePipeline::SIMD_NONE);
+	}
+
+	// lookup tables between 8 bit sRGB and 16 bit linear light
+	struct SRGB_TABLES
+	{
+		uint16_t toLinear[256];
+		unsigned char toSRGB[65536];
+
+		SRGB_TABLES()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				double encoded = i / 255.0;
+				double linear = (encoded <= 0.04045) ?
+					encoded / 12.92 :
+					pow((encoded + 0.055) / 1.055, 2.4);
+				toLinear[i] = (uint16_t)(linear * 65535.0 + 0.5);
+			}
+			for (int i = 0; i < 65536; i++)
+			{
+				double linear = i / 65535.0;
+				double encoded = (linear <= 0.0031308) ?
+					linear * 12.92 :
+					1.055 * pow(linear, 1.0 / 2.4) - 0.055;
+				toSRGB[i] = (unsigned char)(encoded * 255.0 + 0.5);
+			}
+		}
+	};
+
+	/***********************************************************
+	 *  GetSRGBTables()
+	 *
+	 *  This function is used for getting the sRGB tables, which
+	 *  are built by the first thread that needs them.
+	 ***********************************************************/
+	const SRGB_TABLES& GetSRGBTables()
+	{
+		static const SRGB_TABLES tables;
+		return(tables);
+	}
+
+	// one weighted source texel of a resampling filter
+	struct FILTER_TAP
+	{
+		int source;
+		float weight;
+	};
+
+	/***********************************************************
+	 *  BesselI0()
+	 *
+	 *  This function is used for evaluating the modified Bessel
+	 *  function of the first kind, which shapes the Kaiser
+	 *  window.
+	 ***********************************************************/
+	double BesselI0(double x)
+	{
+		double sum = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32; k++)
+		{
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+		}
+
+		return(sum);
+	}
+
+	/***********************************************************
+	 *  BuildKaiserTaps()
+	 *
+	 *  This function is used for working out the source texels
+	 *  and weights of every destination texel along one axis,
+	 *  for a Kaiser windowed sinc.  The texels wrap around the
+	 *  edges, like the repeated scene textures do.  Every
+	 *  destination texel has tapCount taps.
+	 ***********************************************************/
+	void BuildKaiserTaps(
+		int sourceSize,
+		int destinationSize,
+		std::vector<FILTER_TAP>& taps,
+		int& tapCount)
+	{
+		double scale = (double)sourceSize / (double)destinationSize;
+		double sourceRadius = g_KaiserRadius * scale;
+		tapCount = (int)std::ceil(sourceRadius * 2.0) + 1;
+		taps.resize((size_t)destinationSize * tapCount);
+
+		double windowScale = 1.0 / BesselI0(g_KaiserAlpha);
+		for (int i = 0; i < destinationSize; i++)
+		{
+			double center = (i + 0.5) * scale;
+			int first = (int)std::floor(center - sourceRadius);
+			FILTER_TAP* pTaps = &taps[(size_t)i * tapCount];
+			double total = 0.0;
+
+			for (int k = 0; k < tapCount; k++)
+			{
+				int source = first + k;
+				double t = (source + 0.5 - center) / scale;
+				double weight = 0.0;
+				if (std::fabs(t) < g_KaiserRadius)
+				{
+					double ratio = t / g_KaiserRadius;
+					double window = BesselI0(g_KaiserAlpha * std::sqrt(1.0 - ratio * ratio)) * windowScale;
+					double x = 3.14159265358979323846 * t;
+					double sinc = (std::fabs(x) < 1e-6) ? 1.0 : std::sin(x) / x;
+					weight = sinc * window;
+				}
+
+				pTaps[k].source = ((source % sourceSize) + sourceSize) % sourceSize;
+				pTaps[k].weight = (float)weight;
+				total += weight;
+			}
+
+			for (int k = 0; k < tapCount; k++)
+			{
+				pTaps[k].weight = (float)(pTaps[k].weight / total);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  UnpremultiplyAlpha()
+	 *
+	 *  This function is used for dividing the color of 16 bit
+	 *  linear pixels by their alpha again, once a mip has been
+	 *  filtered.
+	 ***********************************************************/
+	void UnpremultiplyAlpha(uint16_t* pPixels, size_t pixelCount)
+	{
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			uint16_t* pPixel = pPixels + i * 4;
+			uint32_t alpha = pPixel[3];
+			if (65535 == alpha)
+			{
+				continue;
+			}
+			for (int c = 0; c < 3; c++)
+			{
+				pPixel[c] = (0 == alpha) ? 0 :
+					(uint16_t)std::min<uint32_t>(65535, (pPixel[c] * 65535u + alpha / 2) / alpha);
+			}
+		}
+	}
+
+#if defined(IMAGE_PIPELINE_X86)
+	/***********************************************************
+	 *  SwapBytesSSE2() / SwapBytesAVX2()
+	 *
+	 *  These functions are used for swapping two rows of bytes
+	 *  in whole vectors, and return how many bytes were done.
+	 ***********************************************************/
+	TARGET_SSE2 size_t SwapBytesSSE2(unsigned char* pA, unsigned char* pB, size_t size)
+	{
+		size_t i = 0;
+		for (; i + 16 <= size; i += 16)
+		{
+			__m128i a = _mm_loadu_si128((const __m128i*)(pA + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(pB + i));
+			_mm_storeu_si128((__m128i*)(pA + i), b);
+			_mm_storeu_si128((__m128i*)(pB + i), a);
+		}
+
+		return(i);
+	}
+
+	TARGET_AVX2 size_t SwapBytesAVX2(unsigned char* pA, unsigned char* pB, size_t size)
+	{
+		size_t i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			__m256i a = _mm256_loadu_si256((const __m256i*)(pA + i));
+			__m256i b = _mm256_loadu_si256((const __m256i*)(pB + i));
+			_mm256_storeu_si256((__m256i*)(pA + i), b);
+			_mm256_storeu_si256((__m256i*)(pB + i), a);
+		}
+
+		return(i);
+	}
+
+	/***********************************************************
+	 *  ExpandRGBSSSE3() / ExpandRGBAVX2()
+	 *
+	 *  These functions are used for spreading RGB pixels out
+	 *  to RGBA with a byte shuffle.  Each load reads a little
+	 *  past the pixels it converts, so they stop early and
+	 *  return how many pixels were done.
+	 ***********************************************************/
+	TARGET_SSSE3 size_t ExpandRGBSSSE3(const unsigned char* pSource, size_t pixelCount, unsigned char* pDestination)
+	{
+		const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+		size_t i = 0;
+		for (; i + 6 <= pixelCount; i += 4)
+		{
+			__m128i rgb = _mm_loadu_si128((const __m128i*)(pSource + i * 3));
+			__m128i rgba = _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha);
+			_mm_storeu_si128((__m128i*)(pDestination + i * 4), rgba);
+		}
+
+		return(i);
+	}
+
+	TARGET_AVX2 size_t ExpandRGBAVX2(const unsigned char* pSource, size_t pixelCount, unsigned char* pDestination)
+	{
+		const __m256i shuffle = _mm256_setr_epi8(
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+			0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+		size_t i = 0;
+		for (; i + 10 <= pixelCount; i += 8)
+		{
+			// the second lane starts at the fifth pixel
+			__m128i low = _mm_loadu_si128((const __m128i*)(pSource + i * 3));
+			__m128i high = _mm_loadu_si128((const __m128i*)(pSource + i * 3 + 12));
+			__m256i rgb = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+			__m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha);
+			_mm256_storeu_si256((__m256i*)(pDestination + i * 4), rgba);
+		}
+
+		return(i);
+	}
+
+	/***********************************************************
+	 *  ExpandGreySSE2() / ExpandGreyAlphaSSE2()
+	 *
+	 *  These functions are used for spreading grey and grey
+	 *  and alpha pixels out to RGBA by interleaving the bytes
+	 *  with themselves, and return how many pixels were done.
+	 ***********************************************************/
+	TARGET_SSE2 size_t ExpandGreySSE2(const unsigned char* pSource, size_t pixelCount, unsigned char* pDestination)
+	{
+		const __m128i opaque = _mm_set1_epi8(-1);
+
+		size_t i = 0;
+		for (; i + 16 <= pixelCount; i += 16)
+		{
+			__m128i grey = _mm_loadu_si128((const __m128i*)(pSource + i));
+			__m128i greyGreyLow = _mm_unpacklo_epi8(grey, grey);
+			__m128i greyGreyHigh = _mm_unpackhi_epi8(grey, grey);
+			__m128i greyAlphaLow = _mm_unpacklo_epi8(grey, opaque);
+			__m128i greyAlphaHigh = _mm_unpackhi_epi8(grey, opaque);
+
+			__m128i* pOut = (__m128i*)(pDestination + i * 4);
+			_mm_storeu_si128(pOut + 0, _mm_unpacklo_epi16(greyGreyLow, greyAlphaLow));
+			_mm_storeu_si128(pOut + 1, _mm_unpackhi_epi16(greyGreyLow, greyAlphaLow));
+			_mm_storeu_si128(pOut + 2, _mm_unpacklo_epi16(greyGreyHigh, greyAlphaHigh));
+			_mm_storeu_si128(pOut + 3, _mm_unpackhi_epi16(greyGreyHigh, greyAlphaHigh));
+		}
+
+		return(i);
+	}
+
+	TARGET_SSE2 size_t ExpandGreyAlphaSSE2(const unsigned char* pSource, size_t pixelCount, unsigned char* pDestination)
+	{
+		const __m128i lowByte = _mm_set1_epi16(0x00FF);
+
+		size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			__m128i greyAlpha = _mm_loadu_si128((const __m128i*)(pSource + i * 2));
+			__m128i grey = _mm_and_si128(greyAlpha, lowByte);
+			__m128i greyGrey = _mm_or_si128(grey, _mm_slli_epi16(grey, 8));
+
+			__m128i* pOut = (__m128i*)(pDestination + i * 4);
+			_mm_storeu_si128(pOut + 0, _mm_unpacklo_epi16(greyGrey, greyAlpha));
+			_mm_storeu_si128(pOut + 1, _mm_unpackhi_epi16(greyGrey, greyAlpha));
+		}
+
+		return(i);
+	}
+
+	/***********************************************************
+	 *  IsOpaqueSSE2()
+	 *
+	 *  This function is used for checking the alpha of whole
+	 *  vectors of RGBA pixels, and returns false as soon as a
+	 *  pixel is not opaque.  done is set to the pixels checked.
+	 ***********************************************************/
+	TARGET_SSE2 bool IsOpaqueSSE2(const unsigned char* pPixels, size_t pixelCount, size_t& done)
+	{
+		const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
+		const __m128i opaque = _mm_set1_epi8(-1);
+
+		__m128i all = opaque;
+		size_t i = 0;
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i rgba = _mm_loadu_si128((const __m128i*)(pPixels + i * 4));
+			all = _mm_and_si128(all, _mm_or_si128(rgba, colorMask));
+		}
+		done = i;
+
+		return(0xFFFF == _mm_movemask_epi8(_mm_cmpeq_epi8(all, opaque)));
+	}
+
+	/***********************************************************
+	 *  PremultiplySSE2() / PremultiplyAVX2()
+	 *
+	 *  These functions are used for multiplying 8 bit RGBA
+	 *  pixels by their alpha, dividing by 255 with rounding,
+	 *  and return how many pixels were done.
+	 ***********************************************************/
+	TARGET_SSE2 __m128i PremultiplyWordsSSE2(__m128i pixels)
+	{
+		const __m128i keepColor = _mm_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0);
+		const __m128i alphaOne = _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255);
+		const __m128i half = _mm_set1_epi16(128);
+
+		// alpha in every channel, but 255 in the alpha channel
+		__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm_or_si128(_mm_and_si128(alpha, keepColor), alphaOne);
+
+		__m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), half);
+		return(_mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8));
+	}
+
+	TARGET_SSE2 size_t PremultiplySSE2(unsigned char* pPixels, size_t pixelCount)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		size_t i = 0;
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m128i rgba = _mm_loadu_si128((const __m128i*)(pPixels + i * 4));
+			__m128i low = PremultiplyWordsSSE2(_mm_unpacklo_epi8(rgba, zero));
+			__m128i high = PremultiplyWordsSSE2(_mm_unpackhi_epi8(rgba, zero));
+			_mm_storeu_si128((__m128i*)(pPixels + i * 4), _mm_packus_epi16(low, high));
+		}
+
+		return(i);
+	}
+
+	TARGET_AVX2 __m256i PremultiplyWordsAVX2(__m256i pixels)
+	{
+		const __m256i keepColor = _mm256_setr_epi16(-1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0);
+		const __m256i alphaOne = _mm256_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255);
+		const __m256i half = _mm256_set1_epi16(128);
+
+		__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		alpha = _mm256_or_si256(_mm256_and_si256(alpha, keepColor), alphaOne);
+
+		__m256i product = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), half);
+		return(_mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8));
+	}
+
+	TARGET_AVX2 size_t PremultiplyAVX2(unsigned char* pPixels, size_t pixelCount)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+
+		size_t i = 0;
+		for (; i + 8 <= pixelCount; i += 8)
+		{
+			// the unpacks and the pack work within each lane, so
+			// the pixels come back in order
+			__m256i rgba = _mm256_loadu_si256((const __m256i*)(pPixels + i * 4));
+			__m256i low = PremultiplyWordsAVX2(_mm256_unpacklo_epi8(rgba, zero));
+			__m256i high = PremultiplyWordsAVX2(_mm256_unpackhi_epi8(rgba, zero));
+			_mm256_storeu_si256((__m256i*)(pPixels + i * 4), _mm256_packus_epi16(low, high));
+		}
+
+		return(i);
+	}
+
+	/***********************************************************
+	 *  PremultiplyLinearSSE2() / PremultiplyLinearAVX2()
+	 *
+	 *  These functions are used for multiplying 16 bit linear
+	 *  RGBA pixels by their alpha.  The high half of the
+	 *  product divides by 65536 instead of 65535, which is
+	 *  below the 8 bit precision the mips are stored at.
+	 ***********************************************************/
+	TARGET_SSE2 size_t PremultiplyLinearSSE2(uint16_t* pPixels, size_t pixelCount)
+	{
+		const __m128i alphaMask = _mm_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1);
+
+		size_t i = 0;
+		for (; i + 2 <= pixelCount; i += 2)
+		{
+			__m128i rgba = _mm_loadu_si128((const __m128i*)(pPixels + i * 4));
+			__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(rgba, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m128i product = _mm_mulhi_epu16(rgba, alpha);
+			__m128i result = _mm_or_si128(_mm_andnot_si128(alphaMask, product), _mm_and_si128(alphaMask, rgba));
+			_mm_storeu_si128((__m128i*)(pPixels + i * 4), result);
+		}
+
+		return(i);
+	}
+
+	TARGET_AVX2 size_t PremultiplyLinearAVX2(uint16_t* pPixels, size_t pixelCount)
+	{
+		const __m256i alphaMask = _mm256_setr_epi16(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1);
+
+		size_t i = 0;
+		for (; i + 4 <= pixelCount; i += 4)
+		{
+			__m256i rgba = _mm256_loadu_si256((const __m256i*)(pPixels + i * 4));
+			__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(rgba, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			__m256i product = _mm256_mulhi_epu16(rgba, alpha);
+			__m256i result = _mm256_or_si256(_mm256_andnot_si256(alphaMask, product), _mm256_and_si256(alphaMask, rgba));
+			_mm256_storeu_si256((__m256i*)(pPixels + i * 4), result);
+		}
+
+		return(i);
+	}
+
+	/***********************************************************
+	 *  DownsampleRowSSE2() / DownsampleRowAVX2()
+	 *
+	 *  These functions are used for averaging two rows of 16
+	 *  bit RGBA pixels down to one row of half the width.  The
+	 *  rows are averaged first and then the pixel pairs, and
+	 *  they return how many destination pixels were done.
+	 ***********************************************************/
+	TARGET_SSE2 int DownsampleRowSSE2(const uint16_t* pRow0, const uint16_t* pRow1, int destinationWidth, uint16_t* pDestination)
+	{
+		int x = 0;
+		for (; x + 2 <= destinationWidth; x += 2)
+		{
+			__m128i a = _mm_avg_epu16(
+				_mm_loadu_si128((const __m128i*)(pRow0 + x * 8)),
+				_mm_loadu_si128((const __m128i*)(pRow1 + x * 8)));
+			__m128i b = _mm_avg_epu16(
+				_mm_loadu_si128((const __m128i*)(pRow0 + x * 8 + 8)),
+				_mm_loadu_si128((const __m128i*)(pRow1 + x * 8 + 8)));
+			__m128i even = _mm_unpacklo_epi64(a, b);
+			__m128i odd = _mm_unpackhi_epi64(a, b);
+			_mm_storeu_si128((__m128i*)(pDestination + x * 4), _mm_avg_epu16(even, odd));
+		}
+
+		return(x);
+	}
+
+	TARGET_AVX2 int DownsampleRowAVX2(const uint16_t* pRow0, const uint16_t* pRow1, int destinationWidth, uint16_t* pDestination)
+	{
+		int x = 0;
+		for (; x + 4 <= destinationWidth; x += 4)
+		{
+			__m256i a = _mm256_avg_epu16(
+				_mm256_loadu_si256((const __m256i*)(pRow0 + x * 8)),
+				_mm256_loadu_si256((const __m256i*)(pRow1 + x * 8)));
+			__m256i b = _mm256_avg_epu16(
+				_mm256_loadu_si256((const __m256i*)(pRow0 + x * 8 + 16)),
+				_mm256_loadu_si256((const __m256i*)(pRow1 + x * 8 + 16)));
+			// pixels 0 2 | 1 3 after the average within each lane
+			__m256i even = _mm256_unpacklo_epi64(a, b);
+			__m256i odd = _mm256_unpackhi_epi64(a, b);
+			__m256i average = _mm256_avg_epu16(even, odd);
+			_mm256_storeu_si256((__m256i*)(pDestination + x * 4), _mm256_permute4x64_epi64(average, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		return(x);
+	}
+
+	/***********************************************************
+	 *  FilterRowSSE2() / FilterColumnSSE2()
+	 *
+	 *  These functions are used for the two passes of the
+	 *  Kaiser filter, with the four channels of a pixel in one
+	 *  vector of floats.
+	 ***********************************************************/
+	TARGET_SSE2 void FilterRowSSE2(
+		const uint16_t* pRow,
+		const FILTER_TAP* pTaps,
+		int tapCount,
+		int destinationWidth,
+		float* pDestination)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for (int x = 0; x < destinationWidth; x++)
+		{
+			const FILTER_TAP* pPixelTaps = pTaps + (size_t)x * tapCount;
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < tapCount; k++)
+			{
+				__m128i texel = _mm_loadl_epi64((const __m128i*)(pRow + pPixelTaps[k].source * 4));
+				__m128 value = _mm_cvtepi32_ps(_mm_unpacklo_epi16(texel, zero));
+				sum = _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(pPixelTaps[k].weight)));
+			}
+			_mm_storeu_ps(pDestination + x * 4, sum);
+		}
+	}
+
+	TARGET_SSE2 void FilterColumnSSE2(
+		const float* pRows,
+		size_t rowStride,
+		const FILTER_TAP* pTaps,
+		int tapCount,
+		int width,
+		uint16_t* pDestination)
+	{
+		const __m128 low = _mm_setzero_ps();
+		const __m128 high = _mm_set1_ps(65535.0f);
+		const __m128i bias = _mm_set1_epi32(32768);
+		const __m128i signFlip = _mm_set1_epi16((short)0x8000);
+
+		for (int x = 0; x < width; x++)
+		{
+			__m128 sum = _mm_setzero_ps();
+			for (int k = 0; k < tapCount; k++)
+			{
+				__m128 value = _mm_loadu_ps(pRows + pTaps[k].source * rowStride + x * 4);
+				sum = _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(pTaps[k].weight)));
+			}
+
+			// the negative lobes can overshoot, and SSE2 only packs
+			// signed words, so the values are moved into that range
+			__m128i value = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(sum, low), high));
+			value = _mm_sub_epi32(value, bias);
+			__m128i packed = _mm_xor_si128(_mm_packs_epi32(value, value), signFlip);
+			_mm_storel_epi64((__m128i*)(pDestination + x * 4), packed);
+		}
+	}
+#endif
+
+	/***********************************************************
+	 *  DownsampleRowScalar()
+	 *
+	 *  This function is used for averaging two rows of pixels
+	 *  down to one row of half the width, in the same order as
+	 *  the vector versions so they give the same results.
+	 ***********************************************************/
+	void DownsampleRowScalar(
+		const uint16_t* pRow0,
+		const uint16_t* pRow1,
+		int sourceWidth,
+		int start,
+		int destinationWidth,
+		uint16_t* pDestination)
+	{
+		for (int x = start; x < destinationWidth; x++)
+		{
+			int x0 = std::min(x * 2, sourceWidth - 1) * 4;
+			int x1 = std::min(x * 2 + 1, sourceWidth - 1) * 4;
+			for (int c = 0; c < 4; c++)
+			{
+				uint32_t even = (pRow0[x0 + c] + pRow1[x0 + c] + 1u) >> 1;
+				uint32_t odd = (pRow0[x1 + c] + pRow1[x1 + c] + 1u) >> 1;
+				pDestination[x * 4 + c] = (uint16_t)((even + odd + 1u) >> 1);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetSIMDLevel()
+ *
+ *  This method is used for getting the instruction set the
+ *  kernels use.  The processor is only asked once.
+ ***********************************************************/
+ImagePipeline::SIMD_LEVEL ImagePipeline::GetSIMDLevel()
+{
+	static const SIMD_LEVEL supportedLevel = DetectSIMDLevel();
+
+	return((SIMD_LEVEL)std::min((int)supportedLevel, g_SIMDLimit.load()));
+}
+
+/***********************************************************
+ *  SetSIMDLevel()
+ *
+ *  This method is used for limiting the instruction set the
+ *  kernels use, for comparing them against each other.
+ ***********************************************************/
+void ImagePipeline::SetSIMDLevel(SIMD_LEVEL level)
+{
+	g_SIMDLimit.store((int)level);
+}
+
+/***********************************************************
+ *  FlipVertical()
+ *
+ *  This method is used for reversing the row order of an
+ *  image, since OpenGL expects the bottom row first.
+ ***********************************************************/
+void ImagePipeline::FlipVertical(
+	unsigned char* pPixels,
+	int width,
+	int height,
+	int bytesPerPixel)
+{
+	SIMD_LEVEL level = GetSIMDLevel();
+	size_t rowSize = (size_t)width * bytesPerPixel;
+
+	for (int y = 0; y < height / 2; y++)
+	{
+		unsigned char* pTop = pPixels + (size_t)y * rowSize;
+		unsigned char* pBottom = pPixels + (size_t)(height - 1 - y) * rowSize;
+		size_t i = 0;
+
+#if defined(IMAGE_PIPELINE_X86)
+		if (level >= SIMD_AVX2)
+		{
+			i = SwapBytesAVX2(pTop, pBottom, rowSize);
+		}
+		else if (level >= SIMD_SSE2)
+		{
+			i = SwapBytesSSE2(pTop, pBottom, rowSize);
+		}
+#endif
+
+		for (; i < rowSize; i++)
+		{
+			std::swap(pTop[i], pBottom[i]);
+		}
+	}
+}
+
+/***********************************************************
+ *  ExpandToRGBA()
+ *
+ *  This method is used for converting grey, grey and alpha,
+ *  RGB or RGBA pixels into RGBA.  Grey is copied into the
+ *  three color channels, and missing alpha is opaque.
+ ***********************************************************/
+void ImagePipeline::ExpandToRGBA(
+	const unsigned char* pSource,
+	int channels,
+	size_t pixelCount,
+	unsigned char* pDestination)
+{
+	SIMD_LEVEL level = GetSIMDLevel();
+	size_t i = 0;
+
+	if (4 == channels)
+	{
+		memcpy(pDestination, pSource, pixelCount * 4);
+		return;
+	}
+
+#if defined(IMAGE_PIPELINE_X86)
+	if ((3 == channels) && (level >= SIMD_AVX2))
+	{
+		i = ExpandRGBAVX2(pSource, pixelCount, pDestination);
+	}
+	else if ((3 == channels) && (level >= SIMD_SSSE3))
+	{
+		i = ExpandRGBSSSE3(pSource, pixelCount, pDestination);
+	}
+	else if ((2 == channels) && (level >= SIMD_SSE2))
+	{
+		i = ExpandGreyAlphaSSE2(pSource, pixelCount, pDestination);
+	}
+	else if ((1 == channels) && (level >= SIMD_SSE2))
+	{
+		i = ExpandGreySSE2(pSource, pixelCount, pDestination);
+	}
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		const unsigned char* pIn = pSource + i * channels;
+		unsigned char* pOut = pDestination + i * 4;
+		if (channels >= 3)
+		{
+			pOut[0] = pIn[0];
+			pOut[1] = pIn[1];
+			pOut[2] = pIn[2];
+			pOut[3] = 255;
+		}
+		else
+		{
+			pOut[0] = pIn[0];
+			pOut[1] = pIn[0];
+			pOut[2] = pIn[0];
+			pOut[3] = (2 == channels) ? pIn[1] : 255;
+		}
+	}
+}
+
+/***********************************************************
+ *  IsOpaque()
+ *
+ *  This method is used for checking whether every pixel of
+ *  an RGBA image has full alpha, so the alpha steps can be
+ *  skipped.
+ ***********************************************************/
+bool ImagePipeline::IsOpaque(const unsigned char* pPixels, size_t pixelCount)
+{
+	size_t i = 0;
+
+#if defined(IMAGE_PIPELINE_X86)
+	if (GetSIMDLevel() >= SIMD_SSE2)
+	{
+		if (false == IsOpaqueSSE2(pPixels, pixelCount, i))
+		{
+			return(false);
+		}
+	}
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		if (255 != pPixels[i * 4 + 3])
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  PremultiplyAlpha()
+ *
+ *  This method is used for multiplying the color of 8 bit
+ *  RGBA pixels by their alpha, rounded to nearest.
+ ***********************************************************/
+void ImagePipeline::PremultiplyAlpha(unsigned char* pPixels, size_t pixelCount)
+{
+	SIMD_LEVEL level = GetSIMDLevel();
+	size_t i = 0;
+
+#if defined(IMAGE_PIPELINE_X86)
+	if (level >= SIMD_AVX2)
+	{
+		i = PremultiplyAVX2(pPixels, pixelCount);
+	}
+	else if (level >= SIMD_SSE2)
+	{
+		i = PremultiplySSE2(pPixels, pixelCount);
+	}
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		unsigned char* pPixel = pPixels + i * 4;
+		uint32_t alpha = pPixel[3];
+		for (int c = 0; c < 3; c++)
+		{
+			uint32_t product = pPixel[c] * alpha + 128;
+			pPixel[c] = (unsigned char)((product + (product >> 8)) >> 8);
+		}
+	}
+}
+
+/***********************************************************
+ *  PremultiplyAlpha()
+ *
+ *  This method is used for multiplying the color of 16 bit
+ *  linear RGBA pixels by their alpha, so the mip filters
+ *  weight each texel by its coverage.
+ ***********************************************************/
+void ImagePipeline::PremultiplyAlpha(uint16_t* pPixels, size_t pixelCount)
+{
+	SIMD_LEVEL level = GetSIMDLevel();
+	size_t i = 0;
+
+#if defined(IMAGE_PIPELINE_X86)
+	if (level >= SIMD_AVX2)
+	{
+		i = PremultiplyLinearAVX2(pPixels, pixelCount);
+	}
+	else if (level >= SIMD_SSE2)
+	{
+		i = PremultiplyLinearSSE2(pPixels, pixelCount);
+	}
+#endif
+
+	for (; i < pixelCount; i++)
+	{
+		uint16_t* pPixel = pPixels + i * 4;
+		uint32_t alpha = pPixel[3];
+		for (int c = 0; c < 3; c++)
+		{
+			pPixel[c] = (uint16_t)((pPixel[c] * alpha) >> 16);
+		}
+	}
+}
+
+/***********************************************************
+ *  SRGBToLinear()
+ *
+ *  This method is used for decoding sRGB pixels into 16 bit
+ *  linear light through a lookup table.
+ ***********************************************************/
+void ImagePipeline::SRGBToLinear(const unsigned char* pSource, size_t pixelCount, uint16_t* pDestination)
+{
+	const SRGB_TABLES& tables = GetSRGBTables();
+
+	for (size_t i = 0; i < pixelCount * 4; i += 4)
+	{
+		pDestination[i + 0] = tables.toLinear[pSource[i + 0]];
+		pDestination[i + 1] = tables.toLinear[pSource[i + 1]];
+		pDestination[i + 2] = tables.toLinear[pSource[i + 2]];
+		pDestination[i + 3] = (uint16_t)(pSource[i + 3] * 257);
+	}
+}
+
+/***********************************************************
+ *  LinearToSRGB()
+ *
+ *  This method is used for encoding 16 bit linear pixels as
+ *  sRGB through a lookup table with an entry for every
+ *  linear value.
+ ***********************************************************/
+void ImagePipeline::LinearToSRGB(const uint16_t* pSource, size_t pixelCount, unsigned char* pDestination)
+{
+	const SRGB_TABLES& tables = GetSRGBTables();
+
+	for (size_t i = 0; i < pixelCount * 4; i += 4)
+	{
+		pDestination[i + 0] = tables.toSRGB[pSource[i + 0]];
+		pDestination[i + 1] = tables.toSRGB[pSource[i + 1]];
+		pDestination[i + 2] = tables.toSRGB[pSource[i + 2]];
+		pDestination[i + 3] = (unsigned char)((pSource[i + 3] + 128) / 257);
+	}
+}
+
+/***********************************************************
+ *  DownsampleBox()
+ *
+ *  This method is used for averaging each 2x2 block of
+ *  texels into one texel of the next mip.  An odd last row
+ *  or column is left out, the way OpenGL sizes the mips,
+ *  and a side that is already one texel is repeated.
+ ***********************************************************/
+void ImagePipeline::DownsampleBox(
+	const uint16_t* pSource,
+	int width,
+	int height,
+	uint16_t* pDestination)
+{
+	SIMD_LEVEL level = GetSIMDLevel();
+	int destinationWidth = std::max(1, width / 2);
+	int destinationHeight = std::max(1, height / 2);
+
+	for (int y = 0; y < destinationHeight; y++)
+	{
+		const uint16_t* pRow0 = pSource + (size_t)std::min(y * 2, height - 1) * width * 4;
+		const uint16_t* pRow1 = pSource + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+		uint16_t* pRow = pDestination + (size_t)y * destinationWidth * 4;
+		int x = 0;
+
+#if defined(IMAGE_PIPELINE_X86)
+		// the vector versions need both texels of every pair
+		if ((width >= 2) && (level >= SIMD_AVX2))
+		{
+			x = DownsampleRowAVX2(pRow0, pRow1, destinationWidth, pRow);
+		}
+		else if ((width >= 2) && (level >= SIMD_SSE2))
+		{
+			x = DownsampleRowSSE2(pRow0, pRow1, destinationWidth, pRow);
+		}
+#endif
+
+		DownsampleRowScalar(pRow0, pRow1, width, x, destinationWidth, pRow);
+	}
+}
+
+/***********************************************************
+ *  DownsampleKaiser()
+ *
+ *  This method is used for building the next mip with a
+ *  Kaiser windowed sinc, which keeps more detail than the
+ *  box filter without aliasing.  The filter is applied to
+ *  the rows and then the columns, wrapping around the edges.
+ ***********************************************************/
+void ImagePipeline::DownsampleKaiser(
+	const uint16_t* pSource,
+	int width,
+	int height,
+	uint16_t* pDestination)
+{
+	SIMD_LEVEL level = GetSIMDLevel();
+	int destinationWidth = std::max(1, width / 2);
+	int destinationHeight = std::max(1, height / 2);
+
+	std::vector<FILTER_TAP> rowTaps;
+	std::vector<FILTER_TAP> columnTaps;
+	int rowTapCount = 0;
+	int columnTapCount = 0;
+	BuildKaiserTaps(width, destinationWidth, rowTaps, rowTapCount);
+	BuildKaiserTaps(height, destinationHeight, columnTaps, columnTapCount);
+
+	// every source row filtered down to the destination width
+	size_t rowStride = (size_t)destinationWidth * 4;
+	std::vector<float> rows(rowStride * height);
+
+	for (int y = 0; y < height; y++)
+	{
+		const uint16_t* pRow = pSource + (size_t)y * width * 4;
+		float* pFiltered = rows.data() + y * rowStride;
+
+#if defined(IMAGE_PIPELINE_X86)
+		if (level >= SIMD_SSE2)
+		{
+			FilterRowSSE2(pRow, rowTaps.data(), rowTapCount, destinationWidth, pFiltered);
+			continue;
+		}
+#endif
+
+		for (int x = 0; x < destinationWidth; x++)
+		{
+			const FILTER_TAP* pTaps = &rowTaps[(size_t)x * rowTapCount];
+			for (int c = 0; c < 4; c++)
+			{
+				float sum = 0.0f;
+				for (int k = 0; k < rowTapCount; k++)
+				{
+					sum += pRow[pTaps[k].source * 4 + c] * pTaps[k].weight;
+				}
+				pFiltered[x * 4 + c] = sum;
+			}
+		}
+	}
+
+	for (int y = 0; y < destinationHeight; y++)
+	{
+		const FILTER_TAP* pTaps = &columnTaps[(size_t)y * columnTapCount];
+		uint16_t* pRow = pDestination + (size_t)y * destinationWidth * 4;
+
+#if defined(IMAGE_PIPELINE_X86)
+		if (level >= SIMD_SSE2)
+		{
+			FilterColumnSSE2(rows.data(), rowStride, pTaps, columnTapCount, destinationWidth, pRow);
+			continue;
+		}
+#endif
+
+		for (size_t i = 0; i < rowStride; i++)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < columnTapCount; k++)
+			{
+				sum += rows[pTaps[k].source * rowStride + i] * pTaps[k].weight;
+			}
+			pRow[i] = (uint16_t)std::lrint(std::min(std::max(sum, 0.0f), 65535.0f));
+		}
+	}
+}
+
+/***********************************************************
+ *  GetMipCount()
+ *
+ *  This method is used for getting the number of mips of an
+ *  image, down to a single texel.
+ ***********************************************************/
+int ImagePipeline::GetMipCount(int width, int height)
+{
+	int mipCount = 1;
+	while ((width > 1) || (height > 1))
+	{
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+		mipCount++;
+	}
+
+	return(mipCount);
+}
+
+/***********************************************************
+ *  GetMipChainSize()
+ *
+ *  This method is used for getting the bytes taken by every
+ *  RGBA mip of an image.
+ ***********************************************************/
+size_t ImagePipeline::GetMipChainSize(int width, int height)
+{
+	size_t size = 0;
+	int mipCount = GetMipCount(width, height);
+	for (int mip = 0; mip < mipCount; mip++)
+	{
+		size += (size_t)width * height * 4;
+		width = std::max(1, width / 2);
+		height = std::max(1, height / 2);
+	}
+
+	return(size);
+}
+
+/***********************************************************
+ *  BuildMipChain()
+ *
+ *  This method is used for building every mip of an RGBA
+ *  image.  The texels are decoded to linear light and
+ *  weighted by their alpha before they are filtered, so dark
+ *  and transparent texels do not bleed into the smaller
+ *  mips.  Each mip is encoded back to sRGB and stored with
+ *  premultiplied alpha, which is how the scene blends.
+ ***********************************************************/
+void ImagePipeline::BuildMipChain(
+	const unsigned char* pPixels,
+	int width,
+	int height,
+	MIP_FILTER filter,
+	unsigned char* pDestination)
+{
+	size_t pixelCount = (size_t)width * height;
+	bool bOpaque = IsOpaque(pPixels, pixelCount);
+
+	memcpy(pDestination, pPixels, pixelCount * 4);
+	if (false == bOpaque)
+	{
+		PremultiplyAlpha(pDestination, pixelCount);
+	}
+
+	std::vector<uint16_t> linear(pixelCount * 4);
+	std::vector<uint16_t> nextLinear;
+	std::vector<uint16_t> straight;
+	SRGBToLinear(pPixels, pixelCount, linear.data());
+	if (false == bOpaque)
+	{
+		PremultiplyAlpha(linear.data(), pixelCount);
+	}
+
+	int mipCount = GetMipCount(width, height);
+	for (int mip = 1; mip < mipCount; mip++)
+	{
+		pDestination += pixelCount * 4;
+
+		int nextWidth = std::max(1, width / 2);
+		int nextHeight = std::max(1, height / 2);
+		nextLinear.resize((size_t)nextWidth * nextHeight * 4);
+		if (MIP_FILTER_KAISER == filter)
+		{
+			DownsampleKaiser(linear.data(), width, height, nextLinear.data());
+		}
+		else
+		{
+			DownsampleBox(linear.data(), width, height, nextLinear.data());
+		}
+		linear.swap(nextLinear);
+		width = nextWidth;
+		height = nextHeight;
+		pixelCount = (size_t)width * height;
+
+		if (true == bOpaque)
+		{
+			LinearToSRGB(linear.data(), pixelCount, pDestination);
+		}
+		else
+		{
+			// the color is encoded straight and then premultiplied
+			// in the stored sRGB values
+			straight.assign(linear.begin(), linear.end());
+			UnpremultiplyAlpha(straight.data(), pixelCount);
+			LinearToSRGB(straight.data(), pixelCount, pDestination);
+			PremultiplyAlpha(pDestination, pixelCount);
+		}
+	}
+}
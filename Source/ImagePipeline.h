@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// imagepipeline.h
+// ============
+// convert decoded images into the texture layout and build their mips
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  ImagePipeline
+ *
+ *  This class holds the CPU steps that turn a decoded image
+ *  into the RGBA texture data and mip chain uploaded to the
+ *  GPU.  The hot loops have SSE2, SSSE3 and AVX2 versions,
+ *  and the fastest one the processor supports is picked the
+ *  first time it is needed.  Mips are filtered in linear
+ *  light with premultiplied alpha and stored sRGB encoded.
+ *  None of the methods use OpenGL, so they run on the
+ *  worker threads.
+ ***********************************************************/
+class ImagePipeline
+{
+public:
+	// instruction sets the kernels can use
+	enum SIMD_LEVEL
+	{
+		SIMD_NONE = 0,
+		SIMD_SSE2 = 1,
+		SIMD_SSSE3 = 2,
+		SIMD_AVX2 = 3
+	};
+
+	// filter used when a mip is built from the level above
+	enum MIP_FILTER
+	{
+		MIP_FILTER_BOX = 0,
+		MIP_FILTER_KAISER = 1
+	};
+
+	// instruction set used by the kernels
+	static SIMD_LEVEL GetSIMDLevel();
+	// limit the instruction set, for comparing the kernels -
+	// it never goes above what the processor supports
+	static void SetSIMDLevel(SIMD_LEVEL level);
+
+	// reverse the row order of an image in place
+	static void FlipVertical(
+		unsigned char* pPixels,
+		int width,
+		int height,
+		int bytesPerPixel);
+	// expand grey, grey and alpha, RGB or RGBA pixels to RGBA
+	static void ExpandToRGBA(
+		const unsigned char* pSource,
+		int channels,
+		size_t pixelCount,
+		unsigned char* pDestination);
+	// check whether every pixel of an RGBA image is opaque
+	static bool IsOpaque(const unsigned char* pPixels, size_t pixelCount);
+	// multiply the color of RGBA pixels by their alpha
+	static void PremultiplyAlpha(unsigned char* pPixels, size_t pixelCount);
+	static void PremultiplyAlpha(uint16_t* pPixels, size_t pixelCount);
+
+	// convert sRGB encoded RGBA pixels to 16 bit linear light
+	// and back - alpha is already linear
+	static void SRGBToLinear(const unsigned char* pSource, size_t pixelCount, uint16_t* pDestination);
+	static void LinearToSRGB(const uint16_t* pSource, size_t pixelCount, unsigned char* pDestination);
+
+	// build the next mip of a 16 bit linear RGBA image, half
+	// the size rounded down and at least one texel
+	static void DownsampleBox(
+		const uint16_t* pSource,
+		int width,
+		int height,
+		uint16_t* pDestination);
+	static void DownsampleKaiser(
+		const uint16_t* pSource,
+		int width,
+		int height,
+		uint16_t* pDestination);
+
+	// number of levels and total bytes of the RGBA mip chain
+	// of an image, down to a single texel
+	static int GetMipCount(int width, int height);
+	static size_t GetMipChainSize(int width, int height);
+	// build every mip of an sRGB RGBA image into one buffer
+	// of GetMipChainSize() bytes, largest level first.  The
+	// stored colors are premultiplied by alpha.
+	static void BuildMipChain(
+		const unsigned char* pPixels,
+		int width,
+		int height,
+		MIP_FILTER filter,
+		unsigned char* pDestination);
+};
@@ -0,0 +1,259 @@
+///////////////////////////////////////////////////////////////////////////////
+// importedmesh.cpp
+// ============
+// load an imported mesh into its own GPU buffers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ImportedMesh.h"
+#include "GLStateCache.h"
+#include "MeshImporter.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+/***********************************************************
+ *  ImportedMesh()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ImportedMesh::ImportedMesh()
+{
+	m_vertexCount = 0;
+	m_indexCount = 0;
+	m_boundsMin = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_boundsMax = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_vertexArrayID = 0;
+	m_vertexBufferID = 0;
+	m_indexBufferID = 0;
+}
+
+/***********************************************************
+ *  ~ImportedMesh()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ImportedMesh::~ImportedMesh()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for loading a model file.  A valid
+ *  cache is uploaded without looking at its contents,
+ *  otherwise the model is imported and the cache is written
+ *  for the next run.  A cache stored in the asset pack is
+ *  used whether or not the model file is there.
+ ***********************************************************/
+bool ImportedMesh::Load(const char* filePath, const AssetPack* pAssetPack)
+{
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	Destroy();
+	m_filePath = filePath;
+
+	std::string cachePath = MeshImporter::GetCachePath(filePath);
+	AssetPack::ASSET_DATA cache;
+	const MeshImporter::CACHE_HEADER* pHeader = NULL;
+	if (true == pAssetPack->Read(cachePath.c_str(), cache))
+	{
+		pHeader = MeshImporter::ValidateCache(
+			cache.pData,
+			cache.size,
+			(true == cache.bPacked) ? NULL : filePath);
+	}
+
+	bool bFromCache = (NULL != pHeader);
+	if (true == bFromCache)
+	{
+		const unsigned char* pData = cache.pData;
+		m_boundsMin = glm::vec3(pHeader->boundsMin[0], pHeader->boundsMin[1], pHeader->boundsMin[2]);
+		m_boundsMax = glm::vec3(pHeader->boundsMax[0], pHeader->boundsMax[1], pHeader->boundsMax[2]);
+		Upload(
+			pData + pHeader->vertexOffset,
+			pHeader->vertexCount,
+			(const uint32_t*)(pData + pHeader->indexOffset),
+			pHeader->indexCount);
+	}
+	else
+	{
+		// release the stale cache file before it is rewritten
+		cache.looseFile.Close();
+
+		MESH_DATA mesh;
+		if (false == MeshImporter::Import(filePath, mesh))
+		{
+			return(false);
+		}
+		MeshImporter::WriteCache(filePath, mesh);
+		Create(filePath, mesh);
+	}
+
+	double milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+	std::cout << ((true == bFromCache) ? "Loaded cached mesh " : "Imported mesh ") << filePath
+		<< " (" << m_vertexCount << " vertices, " << m_indexCount / 3 << " triangles) in "
+		<< milliseconds << " ms" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the mesh from a model
+ *  that was imported somewhere else, like on a worker thread
+ *  when the model file was edited.
+ ***********************************************************/
+void ImportedMesh::Create(const char* filePath, const MESH_DATA& mesh)
+{
+	Destroy();
+	m_filePath = filePath;
+
+	float boundsMin[3];
+	float boundsMax[3];
+	MeshImporter::GetBounds(mesh, boundsMin, boundsMax);
+	m_boundsMin = glm::vec3(boundsMin[0], boundsMin[1], boundsMin[2]);
+	m_boundsMax = glm::vec3(boundsMax[0], boundsMax[1], boundsMax[2]);
+	Upload(
+		mesh.vertices.data(),
+		(uint32_t)mesh.vertices.size(),
+		mesh.indices.data(),
+		(uint32_t)mesh.indices.size());
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for copying the vertices and indices
+ *  into the OpenGL buffers and describing the vertex layout.
+ ***********************************************************/
+void ImportedMesh::Upload(
+	const void* pVertices,
+	uint32_t vertexCount,
+	const uint32_t* pIndices,
+	uint32_t indexCount)
+{
+	m_vertexCount = vertexCount;
+	m_indexCount = indexCount;
+
+	glGenVertexArrays(1, &m_vertexArrayID);
+	GLStateCache::BindVertexArray(m_vertexArrayID);
+
+	glGenBuffers(1, &m_vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(GENERATED_VERTEX), pVertices, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &m_indexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(uint32_t), pIndices, GL_STATIC_DRAW);
+
+	// the attribute locations match the ShapeMeshes layout
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GENERATED_VERTEX), (void*)offsetof(GENERATED_VERTEX, position));
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(GENERATED_VERTEX), (void*)offsetof(GENERATED_VERTEX, normal));
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GENERATED_VERTEX), (void*)offsetof(GENERATED_VERTEX, textureCoordinate));
+
+	GLStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the OpenGL buffers.
+ ***********************************************************/
+void ImportedMesh::Destroy()
+{
+	if (0 != m_vertexArrayID)
+	{
+		GLStateCache::ForgetVertexArray(m_vertexArrayID);
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_vertexArrayID = 0;
+	}
+	if (0 != m_vertexBufferID)
+	{
+		glDeleteBuffers(1, &m_vertexBufferID);
+		m_vertexBufferID = 0;
+	}
+	if (0 != m_indexBufferID)
+	{
+		glDeleteBuffers(1, &m_indexBufferID);
+		m_indexBufferID = 0;
+	}
+	m_vertexCount = 0;
+	m_indexCount = 0;
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for drawing the mesh.  The draw index
+ *  attribute is not part of the vertex array, so the value
+ *  set with DrawDataBuffer::SetDrawIndex() is used.
+ ***********************************************************/
+void ImportedMesh::Draw(int instanceCount) const
+{
+	if (0 == m_vertexArrayID)
+	{
+		return;
+	}
+
+	// the vertex array stays bound, so drawing the same mesh
+	// again does not bind it again
+	GLStateCache::BindVertexArray(m_vertexArrayID);
+	glDrawElementsInstanced(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, (void*)0, instanceCount);
+}
+
+/***********************************************************
+ *  GetFilePath()
+ *
+ *  This method is used for getting the path of the model
+ *  file the mesh was loaded from.
+ ***********************************************************/
+const std::string& ImportedMesh::GetFilePath() const
+{
+	return(m_filePath);
+}
+
+/***********************************************************
+ *  GetBoundsMin()
+ *
+ *  This method is used for getting the lowest corner of the
+ *  object space bounding box.
+ ***********************************************************/
+glm::vec3 ImportedMesh::GetBoundsMin() const
+{
+	return(m_boundsMin);
+}
+
+/***********************************************************
+ *  GetBoundsMax()
+ *
+ *  This method is used for getting the highest corner of
+ *  the object space bounding box.
+ ***********************************************************/
+glm::vec3 ImportedMesh::GetBoundsMax() const
+{
+	return(m_boundsMax);
+}
+
+/***********************************************************
+ *  GetBoundingSphere()
+ *
+ *  This method is used for getting a sphere around the
+ *  bounding box, used for frustum culling.
+ ***********************************************************/
+glm::vec4 ImportedMesh::GetBoundingSphere() const
+{
+	glm::vec3 center = (m_boundsMin + m_boundsMax) * 0.5f;
+	float radius = glm::length(m_boundsMax - center);
+
+	return(glm::vec4(center, radius));
+}
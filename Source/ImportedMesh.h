@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// importedmesh.h
+// ============
+// load an imported mesh into its own GPU buffers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+#include "MeshGenerator.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  ImportedMesh
+ *
+ *  This class holds one mesh loaded from an authored model
+ *  file.  The first load imports the file and writes its
+ *  binary cache, and every later load maps the cache, from
+ *  the asset pack or next to the model, and copies it
+ *  straight into the OpenGL buffers.  The vertex layout is
+ *  the same as the full float scene meshes.
+ ***********************************************************/
+class ImportedMesh
+{
+public:
+	// constructor
+	ImportedMesh();
+	// destructor
+	~ImportedMesh();
+
+	// load the mesh from its cache, or import it when the
+	// cache is missing or out of date
+	bool Load(const char* filePath, const AssetPack* pAssetPack);
+	// create the mesh from a model that was already imported
+	void Create(const char* filePath, const MESH_DATA& mesh);
+	// free the OpenGL buffers
+	void Destroy();
+
+	// draw the whole mesh with the passed in number of instances
+	void Draw(int instanceCount) const;
+
+	// path of the model file the mesh was loaded from
+	const std::string& GetFilePath() const;
+	// object space bounding box and sphere - xyz is the
+	// center, w is the radius
+	glm::vec3 GetBoundsMin() const;
+	glm::vec3 GetBoundsMax() const;
+	glm::vec4 GetBoundingSphere() const;
+
+private:
+	std::string m_filePath;
+	uint32_t m_vertexCount;
+	uint32_t m_indexCount;
+	glm::vec3 m_boundsMin;
+	glm::vec3 m_boundsMax;
+
+	// OpenGL objects
+	GLuint m_vertexArrayID;
+	GLuint m_vertexBufferID;
+	GLuint m_indexBufferID;
+
+	// copy the vertices and indices into the OpenGL buffers
+	void Upload(
+		const void* pVertices,
+		uint32_t vertexCount,
+		const uint32_t* pIndices,
+		uint32_t indexCount);
+};
@@ -0,0 +1,247 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputmanager.cpp
+// ============
+// buffer the window input events and apply them once per frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InputManager.h"
+
+#include <algorithm>
+#include <cstddef>
+
+/***********************************************************
+ *  InputManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InputManager::InputManager()
+{
+	for (int i = 0; i < KEY_COUNT; i++)
+	{
+		m_keyDown[i] = false;
+		m_keyDownTime[i] = 0.0;
+		m_keyPressed[i] = false;
+		m_keyHeldTime[i] = 0.0f;
+	}
+
+	// a negative time marks that no frame has begun yet
+	m_frameTime = -1.0;
+	m_bFirstCursor = true;
+	m_lastCursorX = 0.0;
+	m_lastCursorY = 0.0;
+	m_cursorDelta = glm::vec2(0.0f, 0.0f);
+}
+
+/***********************************************************
+ *  ~InputManager()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InputManager::~InputManager()
+{
+	m_pendingEvents.clear();
+	m_frameEvents.clear();
+}
+
+/***********************************************************
+ *  QueueKeyEvent()
+ *
+ *  This method is used for buffering a key event until the
+ *  next frame begins.
+ ***********************************************************/
+void InputManager::QueueKeyEvent(double timestamp, int key, int action)
+{
+	INPUT_EVENT event;
+	event.timestamp = timestamp;
+	event.type = EVENT_KEY;
+	event.key = key;
+	event.action = action;
+	event.xPosition = 0.0;
+	event.yPosition = 0.0;
+	m_pendingEvents.push_back(event);
+}
+
+/***********************************************************
+ *  QueueCursorEvent()
+ *
+ *  This method is used for buffering a cursor move until
+ *  the next frame begins.
+ ***********************************************************/
+void InputManager::QueueCursorEvent(double timestamp, double xPosition, double yPosition)
+{
+	INPUT_EVENT event;
+	event.timestamp = timestamp;
+	event.type = EVENT_CURSOR;
+	event.key = -1;
+	event.action = -1;
+	event.xPosition = xPosition;
+	event.yPosition = yPosition;
+	m_pendingEvents.push_back(event);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for applying the buffered events in
+ *  the order they arrived.  The timestamps are used to work
+ *  out how much of the time since the previous frame each
+ *  key was held for, so movement does not depend on when
+ *  in the frame a key went down or came up.
+ ***********************************************************/
+void InputManager::BeginFrame(double frameTime)
+{
+	double frameStart = (m_frameTime < 0.0) ? frameTime : m_frameTime;
+
+	m_frameEvents.swap(m_pendingEvents);
+	m_pendingEvents.clear();
+
+	for (int i = 0; i < KEY_COUNT; i++)
+	{
+		m_keyPressed[i] = false;
+		m_keyHeldTime[i] = 0.0f;
+		if (true == m_keyDown[i])
+		{
+			m_keyDownTime[i] = frameStart;
+		}
+	}
+	m_cursorDelta = glm::vec2(0.0f, 0.0f);
+
+	for (size_t i = 0; i < m_frameEvents.size(); i++)
+	{
+		const INPUT_EVENT& event = m_frameEvents[i];
+		double eventTime = std::min(std::max(event.timestamp, frameStart), frameTime);
+
+		if (event.type == EVENT_KEY)
+		{
+			if (false == IsValidKey(event.key))
+			{
+				continue;
+			}
+
+			// repeats are ignored since the key is already down
+			if ((event.action == GLFW_PRESS) && (false == m_keyDown[event.key]))
+			{
+				m_keyDown[event.key] = true;
+				m_keyDownTime[event.key] = eventTime;
+				m_keyPressed[event.key] = true;
+			}
+			else if ((event.action == GLFW_RELEASE) && (true == m_keyDown[event.key]))
+			{
+				m_keyDown[event.key] = false;
+				m_keyHeldTime[event.key] += (float)(eventTime - m_keyDownTime[event.key]);
+			}
+		}
+		else if (event.type == EVENT_CURSOR)
+		{
+			// the first position only sets where movement starts from
+			if (true == m_bFirstCursor)
+			{
+				m_lastCursorX = event.xPosition;
+				m_lastCursorY = event.yPosition;
+				m_bFirstCursor = false;
+			}
+
+			// reversed since y-coordinates go from top to bottom
+			m_cursorDelta.x += (float)(event.xPosition - m_lastCursorX);
+			m_cursorDelta.y += (float)(m_lastCursorY - event.yPosition);
+			m_lastCursorX = event.xPosition;
+			m_lastCursorY = event.yPosition;
+		}
+	}
+
+	// keys still down were held until the end of the frame
+	for (int i = 0; i < KEY_COUNT; i++)
+	{
+		if (true == m_keyDown[i])
+		{
+			m_keyHeldTime[i] += (float)(frameTime - m_keyDownTime[i]);
+		}
+	}
+
+	m_frameTime = frameTime;
+}
+
+/***********************************************************
+ *  IsKeyDown()
+ *
+ *  This method is used for checking whether a key is down
+ *  once the events of the current frame are applied.
+ ***********************************************************/
+bool InputManager::IsKeyDown(int key) const
+{
+	if (false == IsValidKey(key))
+	{
+		return(false);
+	}
+
+	return(m_keyDown[key]);
+}
+
+/***********************************************************
+ *  WasKeyPressed()
+ *
+ *  This method is used for checking whether a key went down
+ *  since the previous frame, even if it has been released
+ *  again already.
+ ***********************************************************/
+bool InputManager::WasKeyPressed(int key) const
+{
+	if (false == IsValidKey(key))
+	{
+		return(false);
+	}
+
+	return(m_keyPressed[key]);
+}
+
+/***********************************************************
+ *  GetKeyHeldTime()
+ *
+ *  This method is used for getting how many seconds a key
+ *  was held down for since the previous frame.
+ ***********************************************************/
+float InputManager::GetKeyHeldTime(int key) const
+{
+	if (false == IsValidKey(key))
+	{
+		return(0.0f);
+	}
+
+	return(m_keyHeldTime[key]);
+}
+
+/***********************************************************
+ *  GetCursorDelta()
+ *
+ *  This method is used for getting the cursor movement of
+ *  all the cursor events in the current frame added up.
+ ***********************************************************/
+glm::vec2 InputManager::GetCursorDelta() const
+{
+	return(m_cursorDelta);
+}
+
+/***********************************************************
+ *  GetFrameEvents()
+ *
+ *  This method is used for getting the events that were
+ *  applied for the current frame.
+ ***********************************************************/
+const std::vector<InputManager::INPUT_EVENT>& InputManager::GetFrameEvents() const
+{
+	return(m_frameEvents);
+}
+
+/***********************************************************
+ *  IsValidKey()
+ *
+ *  This method is used for checking that a key code is in
+ *  the range of the key state arrays - GLFW reports keys
+ *  it does not know as GLFW_KEY_UNKNOWN, which is -1.
+ ***********************************************************/
+bool InputManager::IsValidKey(int key)
+{
+	return((key >= 0) && (key < KEY_COUNT));
+}
@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputmanager.h
+// ============
+// buffer the window input events and apply them once per frame
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// GLFW library
+#include "GLFW/glfw3.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  InputManager
+ *
+ *  This class collects the key and cursor events received
+ *  from the GLFW callbacks, each stamped with the time it
+ *  arrived.  Nothing is applied from inside the callbacks -
+ *  the buffered events are processed together when a frame
+ *  begins, which works out how long each key was held
+ *  during the frame and adds all the cursor movement up
+ *  into a single delta.
+ ***********************************************************/
+class InputManager
+{
+public:
+	// kinds of buffered input events
+	enum EVENT_TYPE
+	{
+		EVENT_KEY = 0,
+		EVENT_CURSOR
+	};
+
+	// one buffered input event
+	struct INPUT_EVENT
+	{
+		// seconds since GLFW was initialized
+		double timestamp;
+		uint32_t type;
+		// key code and GLFW action for key events
+		int32_t key;
+		int32_t action;
+		// cursor position for cursor events
+		double xPosition;
+		double yPosition;
+	};
+
+	// constructor
+	InputManager();
+	// destructor
+	~InputManager();
+
+	// buffer an event received from the GLFW callbacks
+	void QueueKeyEvent(double timestamp, int key, int action);
+	void QueueCursorEvent(double timestamp, double xPosition, double yPosition);
+
+	// apply every event buffered up to the passed in frame time
+	void BeginFrame(double frameTime);
+
+	// key state for the current frame
+	bool IsKeyDown(int key) const;
+	bool WasKeyPressed(int key) const;
+	float GetKeyHeldTime(int key) const;
+	// cursor movement for the current frame, with Y pointing up
+	glm::vec2 GetCursorDelta() const;
+	// events applied for the current frame
+	const std::vector<INPUT_EVENT>& GetFrameEvents() const;
+
+private:
+	// number of key codes that GLFW can report
+	static const int KEY_COUNT = GLFW_KEY_LAST + 1;
+
+	// events received since the last frame began
+	std::vector<INPUT_EVENT> m_pendingEvents;
+	// events applied for the current frame
+	std::vector<INPUT_EVENT> m_frameEvents;
+
+	// key state carried from frame to frame
+	bool m_keyDown[KEY_COUNT];
+	double m_keyDownTime[KEY_COUNT];
+	// key state for the current frame
+	bool m_keyPressed[KEY_COUNT];
+	float m_keyHeldTime[KEY_COUNT];
+
+	// time the current frame began
+	double m_frameTime;
+	// last known cursor position
+	bool m_bFirstCursor;
+	double m_lastCursorX;
+	double m_lastCursorY;
+	// cursor movement added up for the current frame
+	glm::vec2 m_cursorDelta;
+
+	// check that a key code can be stored
+	static bool IsValidKey(int key);
+};
@@ -0,0 +1,404 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputrecorder.cpp
+// ============
+// record the buffered input to a file and replay it at a fixed timestep
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "InputRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// identifies a recorded input file and its layout version
+	const char g_RecordingMagic[4] = { 'I', 'N', 'P', 'R' };
+	const uint32_t g_RecordingVersion = 1;
+}
+
+// replays run at 60 frames per second of scene time
+const double InputRecorder::REPLAY_TIMESTEP = 1.0 / 60.0;
+
+/***********************************************************
+ *  InputRecorder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+InputRecorder::InputRecorder()
+{
+	m_bRecording = false;
+	m_recordStartTime = -1.0;
+	m_recordedFrames = 0;
+	m_recordedEvents = 0;
+
+	m_bReplaying = false;
+	m_nextReplayEvent = 0;
+	m_replayFrame = 0;
+	m_replayEndTime = 0.0;
+	memset(&m_finalCamera, 0, sizeof(m_finalCamera));
+	m_lastRealTime = -1.0;
+}
+
+/***********************************************************
+ *  ~InputRecorder()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+InputRecorder::~InputRecorder()
+{
+	StopRecording();
+}
+
+/***********************************************************
+ *  StartRecording()
+ *
+ *  This method is used for creating the recorded file and
+ *  writing its header.  The frame and event counts in the
+ *  header are filled in by StopRecording().
+ ***********************************************************/
+bool InputRecorder::StartRecording(const char* filePath, Camera* pCamera)
+{
+	StopRecording();
+
+	m_recordFile.open(filePath, std::ios::binary | std::ios::trunc);
+	if (!m_recordFile.is_open())
+	{
+		std::cout << "Could not create the input recording: " << filePath << std::endl;
+		return(false);
+	}
+
+	FILE_HEADER header;
+	memcpy(header.magic, g_RecordingMagic, sizeof(header.magic));
+	header.version = g_RecordingVersion;
+	header.frameCount = 0;
+	header.eventCount = 0;
+	header.initialCamera = SaveCamera(pCamera);
+	m_recordFile.write((const char*)&header, sizeof(header));
+
+	m_recordFilePath = filePath;
+	m_bRecording = true;
+	m_recordStartTime = -1.0;
+	m_recordedFrames = 0;
+	m_recordedEvents = 0;
+
+	std::cout << "Recording input to " << filePath << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  RecordFrame()
+ *
+ *  This method is used for writing the events that were
+ *  applied for a frame, and the camera state they resulted
+ *  in.  The event times are stored relative to the frame.
+ ***********************************************************/
+void InputRecorder::RecordFrame(double frameTime, const InputManager* pInputManager, Camera* pCamera)
+{
+	if (false == m_bRecording)
+	{
+		return;
+	}
+
+	if (m_recordStartTime < 0.0)
+	{
+		m_recordStartTime = frameTime;
+	}
+
+	const std::vector<InputManager::INPUT_EVENT>& events = pInputManager->GetFrameEvents();
+
+	FRAME_HEADER frame;
+	frame.frameTime = frameTime - m_recordStartTime;
+	frame.eventCount = (uint32_t)events.size();
+	frame.camera = SaveCamera(pCamera);
+	m_recordFile.write((const char*)&frame, sizeof(frame));
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		RECORDED_EVENT recorded;
+		recorded.delay = (float)std::max(frameTime - events[i].timestamp, 0.0);
+		recorded.type = (uint8_t)events[i].type;
+		recorded.action = (uint8_t)events[i].action;
+		recorded.key = (int16_t)events[i].key;
+		recorded.xPosition = (float)events[i].xPosition;
+		recorded.yPosition = (float)events[i].yPosition;
+		m_recordFile.write((const char*)&recorded, sizeof(recorded));
+	}
+
+	m_recordedFrames++;
+	m_recordedEvents += frame.eventCount;
+}
+
+/***********************************************************
+ *  StopRecording()
+ *
+ *  This method is used for filling in the header counts and
+ *  closing the recorded file.
+ ***********************************************************/
+void InputRecorder::StopRecording()
+{
+	if (false == m_bRecording)
+	{
+		return;
+	}
+
+	// the counts follow the magic and version in the header
+	m_recordFile.seekp(sizeof(g_RecordingMagic) + sizeof(uint32_t));
+	m_recordFile.write((const char*)&m_recordedFrames, sizeof(m_recordedFrames));
+	m_recordFile.write((const char*)&m_recordedEvents, sizeof(m_recordedEvents));
+	m_recordFile.close();
+	m_bRecording = false;
+
+	std::cout << "Recorded " << m_recordedFrames << " frames and " << m_recordedEvents
+		<< " input events to " << m_recordFilePath << std::endl;
+}
+
+/***********************************************************
+ *  StartReplay()
+ *
+ *  This method is used for reading a recorded file into
+ *  memory and putting the camera back where the recording
+ *  started.
+ ***********************************************************/
+bool InputRecorder::StartReplay(const char* filePath, Camera* pCamera)
+{
+	std::ifstream replayFile(filePath, std::ios::binary);
+	if (!replayFile.is_open())
+	{
+		std::cout << "Could not open the input recording: " << filePath << std::endl;
+		return(false);
+	}
+
+	FILE_HEADER header;
+	replayFile.read((char*)&header, sizeof(header));
+	if (!replayFile ||
+		(memcmp(header.magic, g_RecordingMagic, sizeof(header.magic)) != 0) ||
+		(header.version != g_RecordingVersion))
+	{
+		std::cout << "Not a supported input recording: " << filePath << std::endl;
+		return(false);
+	}
+	if (header.frameCount == 0)
+	{
+		std::cout << "The input recording has no frames: " << filePath << std::endl;
+		return(false);
+	}
+
+	m_replayEvents.clear();
+	m_replayEvents.reserve(header.eventCount);
+	m_finalCamera = header.initialCamera;
+	m_replayEndTime = 0.0;
+
+	for (uint32_t i = 0; i < header.frameCount; i++)
+	{
+		FRAME_HEADER frame;
+		replayFile.read((char*)&frame, sizeof(frame));
+		if (!replayFile)
+		{
+			std::cout << "The input recording is truncated: " << filePath << std::endl;
+			return(false);
+		}
+
+		for (uint32_t j = 0; j < frame.eventCount; j++)
+		{
+			RECORDED_EVENT recorded;
+			replayFile.read((char*)&recorded, sizeof(recorded));
+			if (!replayFile)
+			{
+				std::cout << "The input recording is truncated: " << filePath << std::endl;
+				return(false);
+			}
+
+			InputManager::INPUT_EVENT event;
+			event.timestamp = frame.frameTime - recorded.delay;
+			event.type = recorded.type;
+			event.action = (recorded.action == 0xFF) ? -1 : recorded.action;
+			event.key = recorded.key;
+			event.xPosition = recorded.xPosition;
+			event.yPosition = recorded.yPosition;
+			m_replayEvents.push_back(event);
+		}
+
+		m_finalCamera = frame.camera;
+		m_replayEndTime = frame.frameTime;
+	}
+
+	LoadCamera(header.initialCamera, pCamera);
+
+	m_bReplaying = true;
+	m_nextReplayEvent = 0;
+	m_replayFrame = 0;
+	m_lastRealTime = -1.0;
+	m_replayFrameTimes.clear();
+
+	std::cout << "Replaying " << header.frameCount << " recorded frames from " << filePath << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  AdvanceReplay()
+ *
+ *  This method is used for queueing every recorded event up
+ *  to the time of the next replay frame.  The replay time
+ *  moves on by a fixed step each frame, however long the
+ *  frame really took, and the real frame time is kept for
+ *  the report at the end.
+ ***********************************************************/
+double InputRecorder::AdvanceReplay(InputManager* pInputManager, double realTime)
+{
+	double replayTime = m_replayFrame * REPLAY_TIMESTEP;
+
+	while ((m_nextReplayEvent < m_replayEvents.size()) &&
+		(m_replayEvents[m_nextReplayEvent].timestamp <= replayTime))
+	{
+		const InputManager::INPUT_EVENT& event = m_replayEvents[m_nextReplayEvent];
+		if (event.type == InputManager::EVENT_KEY)
+		{
+			pInputManager->QueueKeyEvent(event.timestamp, event.key, event.action);
+		}
+		else
+		{
+			pInputManager->QueueCursorEvent(event.timestamp, event.xPosition, event.yPosition);
+		}
+		m_nextReplayEvent++;
+	}
+
+	if (m_lastRealTime >= 0.0)
+	{
+		m_replayFrameTimes.push_back((float)(realTime - m_lastRealTime));
+	}
+	m_lastRealTime = realTime;
+	m_replayFrame++;
+
+	return(replayTime);
+}
+
+/***********************************************************
+ *  IsReplayFinished()
+ *
+ *  This method is used for checking whether the replay has
+ *  reached the end of the recording.
+ ***********************************************************/
+bool InputRecorder::IsReplayFinished() const
+{
+	return((true == m_bReplaying) &&
+		(m_nextReplayEvent >= m_replayEvents.size()) &&
+		((m_replayFrame * REPLAY_TIMESTEP) > m_replayEndTime));
+}
+
+/***********************************************************
+ *  FinishReplay()
+ *
+ *  This method is used for reporting the frame times of the
+ *  replay, and how far the camera ended up from where it
+ *  was at the end of the recording.  The replay samples the
+ *  input on a different set of frames than the recording,
+ *  so a small difference is expected.
+ ***********************************************************/
+void InputRecorder::FinishReplay(Camera* pCamera)
+{
+	if (false == m_bReplaying)
+	{
+		return;
+	}
+	m_bReplaying = false;
+
+	CAMERA_STATE finalCamera = SaveCamera(pCamera);
+	float positionDrift = 0.0f;
+	for (int i = 0; i < 3; i++)
+	{
+		float difference = finalCamera.position[i] - m_finalCamera.position[i];
+		positionDrift += difference * difference;
+	}
+
+	std::cout << "Replay finished after " << m_replayFrame << " frames" << std::endl;
+	std::cout << "Camera position drift: " << sqrtf(positionDrift) << std::endl;
+
+	if (m_replayFrameTimes.empty())
+	{
+		return;
+	}
+
+	std::vector<float> frameTimes = m_replayFrameTimes;
+	std::sort(frameTimes.begin(), frameTimes.end());
+	double totalTime = 0.0;
+	for (size_t i = 0; i < frameTimes.size(); i++)
+	{
+		totalTime += frameTimes[i];
+	}
+
+	std::cout << "Frame time ms - average: " << (totalTime / frameTimes.size()) * 1000.0
+		<< "  min: " << frameTimes.front() * 1000.0f
+		<< "  median: " << frameTimes[frameTimes.size() / 2] * 1000.0f
+		<< "  99th: " << frameTimes[(frameTimes.size() * 99) / 100] * 1000.0f
+		<< "  max: " << frameTimes.back() * 1000.0f << std::endl;
+}
+
+/***********************************************************
+ *  IsRecording()
+ *
+ *  This method is used for checking whether input is being
+ *  recorded.
+ ***********************************************************/
+bool InputRecorder::IsRecording() const
+{
+	return(m_bRecording);
+}
+
+/***********************************************************
+ *  IsReplaying()
+ *
+ *  This method is used for checking whether a recording is
+ *  being replayed.
+ ***********************************************************/
+bool InputRecorder::IsReplaying() const
+{
+	return(m_bReplaying);
+}
+
+/***********************************************************
+ *  SaveCamera()
+ *
+ *  This method is used for copying the camera values that
+ *  affect the view into a saved camera state.
+ ***********************************************************/
+InputRecorder::CAMERA_STATE InputRecorder::SaveCamera(Camera* pCamera)
+{
+	CAMERA_STATE state;
+	for (int i = 0; i < 3; i++)
+	{
+		state.position[i] = pCamera->Position[i];
+		state.front[i] = pCamera->Front[i];
+		state.up[i] = pCamera->Up[i];
+	}
+	state.yaw = pCamera->Yaw;
+	state.pitch = pCamera->Pitch;
+	state.zoom = pCamera->Zoom;
+
+	return(state);
+}
+
+/***********************************************************
+ *  LoadCamera()
+ *
+ *  This method is used for putting saved camera values back
+ *  into the camera.
+ ***********************************************************/
+void InputRecorder::LoadCamera(const CAMERA_STATE& state, Camera* pCamera)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		pCamera->Position[i] = state.position[i];
+		pCamera->Front[i] = state.front[i];
+		pCamera->Up[i] = state.up[i];
+	}
+	pCamera->Yaw = state.yaw;
+	pCamera->Pitch = state.pitch;
+	pCamera->Zoom = state.zoom;
+}
@@ -0,0 +1,129 @@
+///////////////////////////////////////////////////////////////////////////////
+// inputrecorder.h
+// ============
+// record the buffered input to a file and replay it at a fixed timestep
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "InputManager.h"
+#include "camera.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  InputRecorder
+ *
+ *  This class writes the input events applied for every
+ *  frame, along with the resulting camera state, to a
+ *  compact binary file.  A recorded file can be replayed by
+ *  feeding the events back into the input manager on a
+ *  fixed timestep instead of the wall clock, so every
+ *  replay takes exactly the same path through the scene
+ *  and the frame times of different builds can be compared.
+ ***********************************************************/
+class InputRecorder
+{
+public:
+	// camera values saved with every recorded frame
+	struct CAMERA_STATE
+	{
+		float position[3];
+		float front[3];
+		float up[3];
+		float yaw;
+		float pitch;
+		float zoom;
+	};
+
+	// constructor
+	InputRecorder();
+	// destructor
+	~InputRecorder();
+
+	// start writing the recorded frames into the passed in file
+	bool StartRecording(const char* filePath, Camera* pCamera);
+	// save one frame of applied input and the camera it produced
+	void RecordFrame(double frameTime, const InputManager* pInputManager, Camera* pCamera);
+	// finish the recorded file
+	void StopRecording();
+
+	// load a recorded file and reset the camera to its start
+	bool StartReplay(const char* filePath, Camera* pCamera);
+	// queue the recorded events for the next replay frame and
+	// return the fixed frame time it should be prepared with
+	double AdvanceReplay(InputManager* pInputManager, double realTime);
+	// check whether every recorded frame has been replayed
+	bool IsReplayFinished() const;
+	// report how the replay went, once it has finished
+	void FinishReplay(Camera* pCamera);
+
+	bool IsRecording() const;
+	bool IsReplaying() const;
+
+	// seconds between the frames of a replay
+	static const double REPLAY_TIMESTEP;
+
+private:
+	// start of a recorded file
+	struct FILE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t frameCount;
+		uint32_t eventCount;
+		CAMERA_STATE initialCamera;
+	};
+
+	// start of each recorded frame, followed by its events
+	struct FRAME_HEADER
+	{
+		// seconds since the first recorded frame
+		double frameTime;
+		uint32_t eventCount;
+		CAMERA_STATE camera;
+	};
+
+	// one recorded input event
+	struct RECORDED_EVENT
+	{
+		// seconds the event arrived before its frame
+		float delay;
+		uint8_t type;
+		uint8_t action;
+		int16_t key;
+		float xPosition;
+		float yPosition;
+	};
+
+	// file being recorded into
+	std::ofstream m_recordFile;
+	std::string m_recordFilePath;
+	bool m_bRecording;
+	// time of the first recorded frame
+	double m_recordStartTime;
+	uint32_t m_recordedFrames;
+	uint32_t m_recordedEvents;
+
+	// recorded events with their times since the first frame
+	std::vector<InputManager::INPUT_EVENT> m_replayEvents;
+	bool m_bReplaying;
+	size_t m_nextReplayEvent;
+	uint32_t m_replayFrame;
+	// time of the last recorded frame
+	double m_replayEndTime;
+	// camera state recorded with the last frame
+	CAMERA_STATE m_finalCamera;
+	// wall clock frame times measured during the replay
+	double m_lastRealTime;
+	std::vector<float> m_replayFrameTimes;
+
+	// copy between the camera and a saved camera state
+	static CAMERA_STATE SaveCamera(Camera* pCamera);
+	static void LoadCamera(const CAMERA_STATE& state, Camera* pCamera);
+};
@@ -0,0 +1,516 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// schedule small units of work across a pool of worker threads
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+/***********************************************************
+ *  JOB
+ *
+ *  A single unit of work, along with the counter that is
+ *  signalled when it finishes.
+ ***********************************************************/
+struct JOB
+{
+	std::function<void()> function;
+	JobCounter* pCounter;
+	// next job in a counter's waiting list
+	JOB* pNext;
+};
+
+// declaration of global variables
+namespace
+{
+	// deque index of the current thread - zero for the thread
+	// that created the job system
+	thread_local unsigned int t_dequeIndex = 0;
+
+	/***********************************************************
+	 *  SignalCounter()
+	 *
+	 *  This function is used for counting a finished job in
+	 *  the passed in counter.  It returns the list of waiting
+	 *  jobs when the counter reaches zero.
+	 ***********************************************************/
+	JOB* SignalCounter(JobCounter* pCounter, std::atomic<uint32_t>& signalling)
+	{
+		JOB* pWaiters = NULL;
+
+		// a waiting thread may let go of the counter as soon as it
+		// reaches zero, so stay visible until it is no longer used
+		signalling++;
+		if (pCounter->value.fetch_sub(1) == 1)
+		{
+			pWaiters = pCounter->waiters.exchange(NULL);
+		}
+		signalling--;
+
+		return(pWaiters);
+	}
+}
+
+/***********************************************************
+ *  JobCounter()
+ *
+ *  The constructor for the struct
+ ***********************************************************/
+JobCounter::JobCounter()
+{
+	value = 0;
+	waiters = NULL;
+}
+
+/***********************************************************
+ *  WORK_DEQUE()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::WORK_DEQUE::WORK_DEQUE()
+{
+	m_top = 0;
+	m_bottom = 0;
+	for (int64_t i = 0; i < CAPACITY; i++)
+	{
+		m_jobs[i] = NULL;
+	}
+}
+
+/***********************************************************
+ *  Push()
+ *
+ *  This method is used for adding a job to the bottom of
+ *  the deque.  Only the owning thread may call it.
+ ***********************************************************/
+bool JobSystem::WORK_DEQUE::Push(JOB* pJob)
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+	int64_t top = m_top.load(std::memory_order_acquire);
+
+	if ((bottom - top) >= CAPACITY)
+	{
+		return(false);
+	}
+
+	m_jobs[bottom & (CAPACITY - 1)].store(pJob, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Pop()
+ *
+ *  This method is used for taking the newest job from the
+ *  bottom of the deque.  Only the owning thread may call it.
+ ***********************************************************/
+JOB* JobSystem::WORK_DEQUE::Pop()
+{
+	int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = m_top.load(std::memory_order_relaxed);
+
+	if (top > bottom)
+	{
+		// the deque is empty
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return(NULL);
+	}
+
+	JOB* pJob = m_jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// last job in the deque - race the thieves for it
+		if (!m_top.compare_exchange_strong(top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			pJob = NULL;
+		}
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	return(pJob);
+}
+
+/***********************************************************
+ *  Steal()
+ *
+ *  This method is used for taking the oldest job from the
+ *  top of the deque.  Any thread may call it.
+ ***********************************************************/
+JOB* JobSystem::WORK_DEQUE::Steal()
+{
+	int64_t top = m_top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+	if (top >= bottom)
+	{
+		return(NULL);
+	}
+
+	JOB* pJob = m_jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+	if (!m_top.compare_exchange_strong(top, top + 1,
+		std::memory_order_seq_cst, std::memory_order_relaxed))
+	{
+		// another thread got to it first
+		return(NULL);
+	}
+
+	return(pJob);
+}
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	m_queuedJobs = 0;
+	m_signalling = 0;
+	m_bRunning = true;
+
+	// leave one core for the thread that submits the jobs
+	if (workerCount == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		workerCount = (cores > 1) ? (cores - 1) : 1;
+	}
+
+	// the submitting thread owns the first deque
+	t_dequeIndex = 0;
+	for (unsigned int i = 0; i <= workerCount; i++)
+	{
+		m_deques.push_back(new WORK_DEQUE());
+	}
+	for (unsigned int i = 1; i <= workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&JobSystem::WorkerLoop, this, i));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	// finish any outstanding work before stopping the workers
+	WaitAll();
+
+	{
+		std::lock_guard<std::mutex> lock(m_wakeLock);
+		m_bRunning = false;
+	}
+	m_wakeCondition.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+	m_workers.clear();
+
+	for (size_t i = 0; i < m_deques.size(); i++)
+	{
+		delete m_deques[i];
+	}
+	m_deques.clear();
+}
+
+/***********************************************************
+ *  Execute()
+ *
+ *  This method is used for submitting a job that can be run
+ *  on any of the threads.  When a counter is passed in, the
+ *  job is counted in it until it finishes.
+ ***********************************************************/
+void JobSystem::Execute(
+	const std::function<void()>& job,
+	JobCounter* pCounter)
+{
+	JOB* pJob = new JOB();
+	pJob->function = job;
+	pJob->pCounter = pCounter;
+	pJob->pNext = NULL;
+
+	m_allJobs.value++;
+	if (NULL != pCounter)
+	{
+		pCounter->value++;
+	}
+
+	Schedule(pJob);
+}
+
+/***********************************************************
+ *  ExecuteAfter()
+ *
+ *  This method is used for submitting a job that will not
+ *  start until every job counted in the dependency counter
+ *  has finished.
+ ***********************************************************/
+void JobSystem::ExecuteAfter(
+	JobCounter* pDependency,
+	const std::function<void()>& job,
+	JobCounter* pCounter)
+{
+	if (NULL == pDependency)
+	{
+		Execute(job, pCounter);
+		return;
+	}
+
+	JOB* pJob = new JOB();
+	pJob->function = job;
+	pJob->pCounter = pCounter;
+	pJob->pNext = NULL;
+
+	m_allJobs.value++;
+	if (NULL != pCounter)
+	{
+		pCounter->value++;
+	}
+
+	// add the job to the waiting list of the dependency
+	JOB* pHead = pDependency->waiters.load();
+	do
+	{
+		pJob->pNext = pHead;
+	} while (!pDependency->waiters.compare_exchange_weak(pHead, pJob));
+
+	// the dependency may have finished before the job was added,
+	// in which case nobody else is going to release the list
+	if (pDependency->value == 0)
+	{
+		ReleaseWaiters(pDependency);
+	}
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This method is used for splitting a range of items into
+ *  batches, running the batches across the workers, and
+ *  waiting for all of them to finish.
+ ***********************************************************/
+void JobSystem::ParallelFor(
+	uint32_t itemCount,
+	uint32_t batchSize,
+	const std::function<void(uint32_t, uint32_t)>& job)
+{
+	JobCounter batches;
+
+	if (itemCount == 0)
+	{
+		return;
+	}
+	if (batchSize == 0)
+	{
+		batchSize = 1;
+	}
+
+	for (uint32_t start = 0; start < itemCount; start += batchSize)
+	{
+		uint32_t end = start + batchSize;
+		if (end > itemCount)
+		{
+			end = itemCount;
+		}
+		Execute([&job, start, end]() { job(start, end); }, &batches);
+	}
+
+	Wait(&batches);
+}
+
+/***********************************************************
+ *  Wait()
+ *
+ *  This method is used for blocking until all the jobs in
+ *  the passed in counter are finished.  The calling thread
+ *  helps run jobs while it waits.
+ ***********************************************************/
+void JobSystem::Wait(JobCounter* pCounter)
+{
+	if (NULL == pCounter)
+	{
+		return;
+	}
+
+	while ((pCounter->value > 0) || (m_signalling > 0))
+	{
+		if (RunNextJob(t_dequeIndex) == false)
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+/***********************************************************
+ *  IsFinished()
+ *
+ *  This method is used for checking whether all the jobs in
+ *  the passed in counter are finished, without blocking.  A
+ *  counter is only finished once no worker is signalling, so
+ *  the caller may free it as soon as this returns true.
+ ***********************************************************/
+bool JobSystem::IsFinished(const JobCounter* pCounter) const
+{
+	if (NULL == pCounter)
+	{
+		return(true);
+	}
+
+	return((0 == pCounter->value) && (0 == m_signalling));
+}
+
+/***********************************************************
+ *  WaitAll()
+ *
+ *  This method is used for blocking until every submitted
+ *  job is finished.
+ ***********************************************************/
+void JobSystem::WaitAll()
+{
+	Wait(&m_allJobs);
+}
+
+/***********************************************************
+ *  GetWorkerCount()
+ *
+ *  This method is used for getting the number of worker
+ *  threads in the pool.
+ ***********************************************************/
+unsigned int JobSystem::GetWorkerCount() const
+{
+	return((unsigned int)m_workers.size());
+}
+
+/***********************************************************
+ *  Schedule()
+ *
+ *  This method is used for placing a job in the deque of
+ *  the calling thread and waking a worker to pick it up.
+ ***********************************************************/
+void JobSystem::Schedule(JOB* pJob)
+{
+	m_queuedJobs++;
+	if (m_deques[t_dequeIndex]->Push(pJob) == false)
+	{
+		// the deque is full, so just run the job right here
+		m_queuedJobs--;
+		RunJob(pJob);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_wakeLock);
+	}
+	m_wakeCondition.notify_one();
+}
+
+/***********************************************************
+ *  ReleaseWaiters()
+ *
+ *  This method is used for scheduling every job that was
+ *  waiting for the passed in counter to reach zero.
+ ***********************************************************/
+void JobSystem::ReleaseWaiters(JobCounter* pCounter)
+{
+	JOB* pJob = pCounter->waiters.exchange(NULL);
+
+	while (NULL != pJob)
+	{
+		JOB* pNext = pJob->pNext;
+		pJob->pNext = NULL;
+		Schedule(pJob);
+		pJob = pNext;
+	}
+}
+
+/***********************************************************
+ *  RunNextJob()
+ *
+ *  This method is used for running a single job from the
+ *  local deque, or one stolen from another thread.
+ ***********************************************************/
+bool JobSystem::RunNextJob(unsigned int dequeIndex)
+{
+	JOB* pJob = m_deques[dequeIndex]->Pop();
+	unsigned int dequeCount = (unsigned int)m_deques.size();
+
+	for (unsigned int i = 1; (NULL == pJob) && (i < dequeCount); i++)
+	{
+		pJob = m_deques[(dequeIndex + i) % dequeCount]->Steal();
+	}
+
+	if (NULL == pJob)
+	{
+		return(false);
+	}
+
+	m_queuedJobs--;
+	RunJob(pJob);
+
+	return(true);
+}
+
+/***********************************************************
+ *  RunJob()
+ *
+ *  This method is used for running a job, signalling its
+ *  counters, and releasing any jobs that depended on them.
+ ***********************************************************/
+void JobSystem::RunJob(JOB* pJob)
+{
+	pJob->function();
+
+	JobCounter* pCounter = pJob->pCounter;
+	delete pJob;
+
+	JOB* pWaiters = NULL;
+	if (NULL != pCounter)
+	{
+		pWaiters = SignalCounter(pCounter, m_signalling);
+	}
+
+	// schedule the jobs that depended on the finished counter
+	while (NULL != pWaiters)
+	{
+		JOB* pNext = pWaiters->pNext;
+		pWaiters->pNext = NULL;
+		Schedule(pWaiters);
+		pWaiters = pNext;
+	}
+
+	SignalCounter(&m_allJobs, m_signalling);
+}
+
+/***********************************************************
+ *  WorkerLoop()
+ *
+ *  This method is the main loop for each worker thread.  The
+ *  worker sleeps whenever there are no queued jobs.
+ ***********************************************************/
+void JobSystem::WorkerLoop(unsigned int dequeIndex)
+{
+	t_dequeIndex = dequeIndex;
+
+	while (m_bRunning)
+	{
+		if (RunNextJob(dequeIndex) == false)
+		{
+			std::unique_lock<std::mutex> lock(m_wakeLock);
+			m_wakeCondition.wait(lock, [this]()
+				{
+					return((m_queuedJobs > 0) || (m_bRunning == false));
+				});
+		}
+	}
+}
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// schedule small units of work across a pool of worker threads
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a single unit of work - defined in jobsystem.cpp
+struct JOB;
+
+/***********************************************************
+ *  JobCounter
+ *
+ *  Counts the unfinished jobs that were submitted with it.
+ *  Jobs can be made to wait for a counter to reach zero,
+ *  which is how dependencies between jobs are expressed.
+ ***********************************************************/
+struct JobCounter
+{
+	JobCounter();
+
+	// number of jobs still running against this counter
+	std::atomic<uint32_t> value;
+	// jobs waiting for the counter to reach zero
+	std::atomic<JOB*> waiters;
+};
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class owns a pool of worker threads, each with its
+ *  own lock-free work-stealing deque.  Workers take jobs from
+ *  the bottom of their own deque and steal from the top of
+ *  the other deques when they run out of work.
+ *
+ *  Jobs may only be submitted from the thread that created
+ *  the job system, or from inside another job.
+ ***********************************************************/
+class JobSystem
+{
+public:
+	// constructor - zero workers means one per spare core
+	JobSystem(unsigned int workerCount = 0);
+	// destructor
+	~JobSystem();
+
+	// run a job on any thread, optionally counting it in a counter
+	void Execute(
+		const std::function<void()>& job,
+		JobCounter* pCounter = NULL);
+	// run a job once the dependency counter has reached zero
+	void ExecuteAfter(
+		JobCounter* pDependency,
+		const std::function<void()>& job,
+		JobCounter* pCounter = NULL);
+	// split a range of items into batches and run them across the workers
+	void ParallelFor(
+		uint32_t itemCount,
+		uint32_t batchSize,
+		const std::function<void(uint32_t, uint32_t)>& job);
+	// block until the jobs in the counter have finished
+	void Wait(JobCounter* pCounter);
+	// check without blocking whether the jobs in the counter have
+	// finished and no worker is still using the counter
+	bool IsFinished(const JobCounter* pCounter) const;
+	// block until all submitted jobs have finished
+	void WaitAll();
+
+	// number of worker threads, not counting the submitting thread
+	unsigned int GetWorkerCount() const;
+
+private:
+	// fixed size Chase-Lev deque - only the owning thread pushes
+	// and pops, any thread may steal
+	class WORK_DEQUE
+	{
+	public:
+		WORK_DEQUE();
+
+		bool Push(JOB* pJob);
+		JOB* Pop();
+		JOB* Steal();
+
+	private:
+		static const int64_t CAPACITY = 4096;
+
+		std::atomic<int64_t> m_top;
+		std::atomic<int64_t> m_bottom;
+		std::atomic<JOB*> m_jobs[CAPACITY];
+	};
+
+	// worker threads in the pool
+	std::vector<std::thread> m_workers;
+	// one deque per thread, index 0 belongs to the submitting thread
+	std::vector<WORK_DEQUE*> m_deques;
+	// counts every job that has not finished yet
+	JobCounter m_allJobs;
+	// jobs that are sitting in a deque waiting to be run
+	std::atomic<uint32_t> m_queuedJobs;
+	// threads that are still signalling a finished counter
+	std::atomic<uint32_t> m_signalling;
+	// cleared when the pool is shutting down
+	std::atomic<bool> m_bRunning;
+	// used to put idle workers to sleep
+	std::mutex m_wakeLock;
+	std::condition_variable m_wakeCondition;
+
+	// place a job into the deque of the calling thread
+	void Schedule(JOB* pJob);
+	// schedule every job that was waiting on the counter
+	void ReleaseWaiters(JobCounter* pCounter);
+	// run one job from the local deque or a stolen one
+	bool RunNextJob(unsigned int dequeIndex);
+	// run a job and signal its counters
+	void RunJob(JOB* pJob);
+	// main loop for each worker thread
+	void WorkerLoop(unsigned int dequeIndex);
+};
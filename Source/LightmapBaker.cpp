@@ -0,0 +1,931 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.cpp
+// ============
+// bake and cache the light that reaches the static scene objects
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightmapBaker.h"
+#include "GLStateCache.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static_assert(sizeof(LightmapBaker::CACHE_HEADER) == 64, "CACHE_HEADER must stay 64 bytes so the texels stay aligned");
+
+namespace
+{
+	// identifies a lightmap cache file
+	const char g_CacheMagic[4] = { 'L', 'M', 'A', 'P' };
+	const float g_Pi = 3.14159265358979f;
+	// atlas texels for each unit of surface, and the limits on
+	// the size of an object's square - shapes with several
+	// charts need more texels to keep them apart
+	const float g_TexelsPerUnit = 4.0f;
+	const int g_MinRectSize = 8;
+	const int g_MinChartedRectSize = 16;
+	const int g_MaxRectSize = 128;
+	// texels left around every square, for the filtering
+	const int g_AtlasBorder = 2;
+	// paths traced for each texel, and the surfaces each one
+	// bounces off before it stops
+	const int g_SamplesPerTexel = 32;
+	const int g_MaxBounces = 3;
+	// distance rays start off the surface, so they do not hit
+	// the triangle they leave from
+	const float g_RayOffset = 0.002f;
+	// share of the paths that may start inside another object
+	// before the texel is treated as hidden
+	const float g_MaxBackfaceShare = 0.25f;
+	// atlas rows traced by each job
+	const int g_RowsPerJob = 8;
+	// passes that spread the charts into their border
+	const int g_DilatePasses = 4;
+	// the charts of an object are numbered below this
+	const int g_ChartsPerObject = 8;
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  This function is used for folding bytes into an FNV-1a
+	 *  hash.
+	 ***********************************************************/
+	uint64_t HashBytes(const void* pData, size_t size, uint64_t hash)
+	{
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash = (hash ^ pBytes[i]) * 1099511628211ULL;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  SeedRandom()
+	 *
+	 *  This function is used for scrambling a texel index into
+	 *  the starting state of its random numbers, so the bake
+	 *  comes out the same on every run.
+	 ***********************************************************/
+	uint32_t SeedRandom(uint32_t index)
+	{
+		uint32_t seed = index + 1;
+		seed = (seed ^ 61u) ^ (seed >> 16);
+		seed *= 9u;
+		seed = seed ^ (seed >> 4);
+		seed *= 0x27D4EB2Du;
+		seed = seed ^ (seed >> 15);
+
+		return((0 != seed) ? seed : 1u);
+	}
+
+	/***********************************************************
+	 *  NextRandom()
+	 *
+	 *  This function is used for getting the next xorshift
+	 *  random number from 0 to 1.
+	 ***********************************************************/
+	float NextRandom(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+
+		return((float)(state >> 8) * (1.0f / 16777216.0f));
+	}
+
+	/***********************************************************
+	 *  SampleCosine()
+	 *
+	 *  This function is used for picking a direction around
+	 *  the normal in proportion to the cosine of its angle, so
+	 *  averaging the light along them gives the irradiance
+	 *  without weighting each one.
+	 ***********************************************************/
+	glm::vec3 SampleCosine(const glm::vec3& normal, float u1, float u2)
+	{
+		float radius = sqrtf(u1);
+		float phi = 2.0f * g_Pi * u2;
+		glm::vec3 up = (fabsf(normal.z) < 0.999f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+		glm::vec3 tangent = glm::normalize(glm::cross(up, normal));
+		glm::vec3 bitangent = glm::cross(normal, tangent);
+
+		return(glm::normalize(
+			tangent * (radius * cosf(phi)) +
+			bitangent * (radius * sinf(phi)) +
+			normal * sqrtf(std::max(0.0f, 1.0f - u1))));
+	}
+
+	/***********************************************************
+	 *  GetNormalMatrix()
+	 *
+	 *  This function is used for getting the matrix that
+	 *  transforms the normals of a model.
+	 ***********************************************************/
+	glm::mat3 GetNormalMatrix(const glm::mat4& model)
+	{
+		return(glm::transpose(glm::inverse(glm::mat3(model))));
+	}
+}
+
+/***********************************************************
+ *  LightmapBaker()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightmapBaker::LightmapBaker()
+{
+	m_pSceneMeshes = NULL;
+	m_width = 0;
+	m_height = 0;
+	m_sceneHash = 0;
+	m_pJobSystem = NULL;
+	m_bBaked = false;
+	m_textureID = 0;
+}
+
+/***********************************************************
+ *  ~LightmapBaker()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightmapBaker::~LightmapBaker()
+{
+	if (NULL != m_pJobSystem)
+	{
+		m_pJobSystem->Wait(&m_jobs);
+	}
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking that the fragment shader
+ *  has a texture unit for the atlas after the scene textures
+ *  and the environment maps.
+ ***********************************************************/
+bool LightmapBaker::IsSupported()
+{
+	GLint unitCount = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &unitCount);
+
+	return(unitCount > LIGHTMAP_UNIT);
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a point light to the bake.
+ ***********************************************************/
+void LightmapBaker::AddLight(const BAKE_LIGHT& light)
+{
+	m_lights.push_back(light);
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for adding a static object to the
+ *  bake, returning the index its square is looked up by.
+ ***********************************************************/
+int LightmapBaker::AddObject(const BAKE_OBJECT& object)
+{
+	m_objects.push_back(object);
+
+	return((int)m_objects.size() - 1);
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for getting the atlas ready without
+ *  holding up the rest of the scene loading.  The squares
+ *  are laid out right away, so GetScaleOffset() can be used
+ *  after this returns.  An atlas cached from the same scene
+ *  is read, otherwise the texels are found and the light is
+ *  traced by jobs on the worker threads until Finish() is
+ *  called.
+ ***********************************************************/
+bool LightmapBaker::Start(const SceneMeshes* pSceneMeshes, const char* cachePath, JobSystem* pJobSystem)
+{
+	m_pSceneMeshes = pSceneMeshes;
+	m_cachePath = cachePath;
+	m_pJobSystem = pJobSystem;
+	m_bBaked = false;
+
+	if ((NULL == m_pSceneMeshes) || (true == m_objects.empty()) || (false == PackAtlas()))
+	{
+		return(false);
+	}
+
+	m_sceneHash = HashScene();
+	if (true == LoadCache())
+	{
+		return(true);
+	}
+
+	std::cout << "Baking the lightmaps of " << m_objects.size() << " objects into a "
+		<< m_width << "x" << m_height << " atlas" << std::endl;
+
+	m_bBaked = true;
+	BuildScene();
+
+	TEXEL emptyTexel;
+	emptyTexel.position = glm::vec3(0.0f);
+	emptyTexel.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+	emptyTexel.chart = -1;
+	m_texels.assign((size_t)m_width * m_height, emptyTexel);
+	m_data.assign((size_t)m_width * m_height * 3, 0.0f);
+
+	// the squares never overlap, so the objects are filled in
+	// side by side before any light is traced
+	m_pJobSystem->ParallelFor(
+		(uint32_t)m_objects.size(),
+		4,
+		[this](uint32_t start, uint32_t end)
+		{
+			for (uint32_t i = start; i < end; i++)
+			{
+				RasterizeObject((int)i);
+			}
+		});
+
+	for (int row = 0; row < m_height; row += g_RowsPerJob)
+	{
+		int lastRow = std::min(row + g_RowsPerJob, m_height);
+		m_pJobSystem->Execute([this, row, lastRow]() { BakeRows(row, lastRow); }, &m_jobs);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for waiting for the bake to finish,
+ *  cleaning it up and saving it, and handing the atlas to
+ *  OpenGL.  The CPU copies are freed afterwards.
+ ***********************************************************/
+bool LightmapBaker::Finish()
+{
+	if (NULL == m_pJobSystem)
+	{
+		return(false);
+	}
+	m_pJobSystem->Wait(&m_jobs);
+	if (m_data.size() != (size_t)m_width * m_height * 3)
+	{
+		return(false);
+	}
+
+	if (true == m_bBaked)
+	{
+		FilterAtlas();
+		WriteCache();
+	}
+	Upload();
+
+	std::vector<float>().swap(m_data);
+	std::vector<TEXEL>().swap(m_texels);
+	std::vector<TRIANGLE_INFO>().swap(m_triangleInfo);
+	m_bvh = TriangleBVH();
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the atlas texture.
+ ***********************************************************/
+void LightmapBaker::Destroy()
+{
+	if (0 != m_textureID)
+	{
+		GLStateCache::ForgetTexture(m_textureID);
+		glDeleteTextures(1, &m_textureID);
+		m_textureID = 0;
+	}
+}
+
+/***********************************************************
+ *  GetScaleOffset()
+ *
+ *  This method is used for getting the scale in xy and the
+ *  offset in zw that place an object's lightmap coordinates
+ *  in its square of the atlas.
+ ***********************************************************/
+glm::vec4 LightmapBaker::GetScaleOffset(int objectIndex) const
+{
+	if ((objectIndex < 0) || (objectIndex >= (int)m_rects.size()) || (0 == m_width) || (0 == m_height))
+	{
+		return(glm::vec4(0.0f));
+	}
+
+	const ATLAS_RECT& rect = m_rects[objectIndex];
+
+	return(glm::vec4(
+		(float)rect.size / (float)m_width,
+		(float)rect.size / (float)m_height,
+		(float)rect.x / (float)m_width,
+		(float)rect.y / (float)m_height));
+}
+
+/***********************************************************
+ *  PackAtlas()
+ *
+ *  This method is used for giving every object a square
+ *  that fits its surface area, and packing the squares into
+ *  rows of the atlas from the largest down.  If they do not
+ *  fit in the tallest atlas, the texel density is lowered
+ *  until they do.
+ ***********************************************************/
+bool LightmapBaker::PackAtlas()
+{
+	const std::vector<SceneMeshes::VERTEX>& vertices = m_pSceneMeshes->GetVertices();
+	const std::vector<uint32_t>& indices = m_pSceneMeshes->GetIndices();
+
+	std::vector<float> areas(m_objects.size(), 0.0f);
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		const BAKE_OBJECT& object = m_objects[i];
+		const SceneMeshes::MESH_LOD& meshLOD = m_pSceneMeshes->GetMeshLOD(object.mesh, 0);
+		for (uint32_t index = 0; index + 2 < meshLOD.indexCount; index += 3)
+		{
+			glm::vec3 corners[3];
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = (uint32_t)meshLOD.baseVertex + indices[meshLOD.firstIndex + index + corner];
+				corners[corner] = glm::vec3(object.model * glm::vec4(vertices[vertex].position, 1.0f));
+			}
+			areas[i] += 0.5f * glm::length(glm::cross(corners[1] - corners[0], corners[2] - corners[0]));
+		}
+	}
+
+	std::vector<int> order(m_objects.size());
+	float density = g_TexelsPerUnit;
+	for (int attempt = 0; attempt < 8; attempt++)
+	{
+		m_rects.resize(m_objects.size());
+		for (size_t i = 0; i < m_objects.size(); i++)
+		{
+			MESH_TYPE mesh = m_objects[i].mesh;
+			int minSize = ((MESH_BOX == mesh) || (MESH_PRISM == mesh) ||
+				(MESH_CYLINDER == mesh) || (MESH_TAPERED_CYLINDER == mesh)) ?
+				g_MinChartedRectSize : g_MinRectSize;
+			int size = ((int)ceilf(sqrtf(areas[i]) * density / 4.0f)) * 4;
+			m_rects[i].size = std::min(std::max(size, minSize), g_MaxRectSize);
+			order[i] = (int)i;
+		}
+		std::stable_sort(order.begin(), order.end(),
+			[this](int a, int b) { return(m_rects[a].size > m_rects[b].size); });
+
+		int x = 0;
+		int y = 0;
+		int rowHeight = 0;
+		for (size_t i = 0; i < order.size(); i++)
+		{
+			ATLAS_RECT& rect = m_rects[order[i]];
+			int cell = rect.size + g_AtlasBorder * 2;
+			if (x + cell > ATLAS_WIDTH)
+			{
+				x = 0;
+				y += rowHeight;
+				rowHeight = 0;
+			}
+			rect.x = x + g_AtlasBorder;
+			rect.y = y + g_AtlasBorder;
+			x += cell;
+			rowHeight = std::max(rowHeight, cell);
+		}
+
+		int usedHeight = y + rowHeight;
+		m_width = ATLAS_WIDTH;
+		m_height = 16;
+		while (m_height < usedHeight)
+		{
+			m_height *= 2;
+		}
+		if (m_height <= MAX_ATLAS_HEIGHT)
+		{
+			return(true);
+		}
+
+		density *= 0.7f;
+	}
+
+	std::cout << "The lightmap squares do not fit in the atlas" << std::endl;
+	m_rects.clear();
+	m_width = 0;
+	m_height = 0;
+
+	return(false);
+}
+
+/***********************************************************
+ *  HashScene()
+ *
+ *  This method is used for identifying everything that the
+ *  baked light depends on - the settings of the bake, the
+ *  shapes, the objects and the lights - which the cache is
+ *  checked against.
+ ***********************************************************/
+uint64_t LightmapBaker::HashScene() const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	const float settings[6] =
+	{
+		g_TexelsPerUnit,
+		(float)g_SamplesPerTexel,
+		(float)g_MaxBounces,
+		g_RayOffset,
+		(float)m_width,
+		(float)m_height
+	};
+	hash = HashBytes(settings, sizeof(settings), hash);
+
+	const std::vector<SceneMeshes::VERTEX>& vertices = m_pSceneMeshes->GetVertices();
+	const std::vector<uint32_t>& indices = m_pSceneMeshes->GetIndices();
+	for (int mesh = 0; mesh < MESH_TYPE_COUNT; mesh++)
+	{
+		const SceneMeshes::MESH_LOD& meshLOD = m_pSceneMeshes->GetMeshLOD((MESH_TYPE)mesh, 0);
+		hash = HashBytes(&vertices[meshLOD.baseVertex], meshLOD.vertexCount * sizeof(SceneMeshes::VERTEX), hash);
+		hash = HashBytes(&indices[meshLOD.firstIndex], meshLOD.indexCount * sizeof(uint32_t), hash);
+	}
+
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		const BAKE_OBJECT& object = m_objects[i];
+		const ATLAS_RECT& rect = m_rects[i];
+		int32_t mesh = (int32_t)object.mesh;
+		hash = HashBytes(&mesh, sizeof(mesh), hash);
+		hash = HashBytes(&object.model, sizeof(glm::mat4), hash);
+		hash = HashBytes(&object.albedo, sizeof(glm::vec3), hash);
+		hash = HashBytes(&rect, sizeof(ATLAS_RECT), hash);
+	}
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		hash = HashBytes(&m_lights[i].position, sizeof(glm::vec3), hash);
+		hash = HashBytes(&m_lights[i].color, sizeof(glm::vec3), hash);
+	}
+
+	return(hash);
+}
+
+/***********************************************************
+ *  BuildScene()
+ *
+ *  This method is used for transforming the triangles of
+ *  every object into world space and building the BVH over
+ *  them.  The shapes are not always wound the same way, so
+ *  each triangle's normal is turned to the side its vertex
+ *  normals face.
+ ***********************************************************/
+void LightmapBaker::BuildScene()
+{
+	const std::vector<SceneMeshes::VERTEX>& vertices = m_pSceneMeshes->GetVertices();
+	const std::vector<uint32_t>& indices = m_pSceneMeshes->GetIndices();
+
+	std::vector<glm::vec3> corners;
+	m_triangleInfo.clear();
+	for (size_t i = 0; i < m_objects.size(); i++)
+	{
+		const BAKE_OBJECT& object = m_objects[i];
+		const SceneMeshes::MESH_LOD& meshLOD = m_pSceneMeshes->GetMeshLOD(object.mesh, 0);
+		glm::mat3 normalMatrix = GetNormalMatrix(object.model);
+
+		for (uint32_t index = 0; index + 2 < meshLOD.indexCount; index += 3)
+		{
+			glm::vec3 triangle[3];
+			glm::vec3 vertexNormal = glm::vec3(0.0f);
+			for (int corner = 0; corner < 3; corner++)
+			{
+				const SceneMeshes::VERTEX& vertex = vertices[(uint32_t)meshLOD.baseVertex + indices[meshLOD.firstIndex + index + corner]];
+				triangle[corner] = glm::vec3(object.model * glm::vec4(vertex.position, 1.0f));
+				vertexNormal += normalMatrix * vertex.normal;
+				corners.push_back(triangle[corner]);
+			}
+
+			TRIANGLE_INFO info;
+			info.normal = glm::cross(triangle[1] - triangle[0], triangle[2] - triangle[0]);
+			float length = glm::length(info.normal);
+			info.normal = (length > 0.0f) ? info.normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+			if (glm::dot(info.normal, vertexNormal) < 0.0f)
+			{
+				info.normal = -info.normal;
+			}
+			info.objectIndex = (uint32_t)i;
+			m_triangleInfo.push_back(info);
+		}
+	}
+
+	m_bvh.Build(corners);
+}
+
+/***********************************************************
+ *  RasterizeObject()
+ *
+ *  This method is used for finding the surface point and
+ *  normal behind every texel of an object's square.  Each
+ *  triangle is drawn in the lightmap coordinates, and the
+ *  texel centers inside it interpolate its world space
+ *  corners.  Texels no triangle covers are left empty for
+ *  the filtering to fill.
+ ***********************************************************/
+void LightmapBaker::RasterizeObject(int objectIndex)
+{
+	const BAKE_OBJECT& object = m_objects[objectIndex];
+	const ATLAS_RECT& rect = m_rects[objectIndex];
+	const std::vector<SceneMeshes::VERTEX>& vertices = m_pSceneMeshes->GetVertices();
+	const std::vector<uint32_t>& indices = m_pSceneMeshes->GetIndices();
+	const std::vector<glm::vec2>& lightmapCoordinates = m_pSceneMeshes->GetLightmapCoordinates();
+	const SceneMeshes::MESH_LOD& meshLOD = m_pSceneMeshes->GetMeshLOD(object.mesh, 0);
+	glm::mat3 normalMatrix = GetNormalMatrix(object.model);
+
+	for (uint32_t index = 0; index + 2 < meshLOD.indexCount; index += 3)
+	{
+		uint32_t corners[3];
+		glm::vec2 points[3];
+		for (int corner = 0; corner < 3; corner++)
+		{
+			corners[corner] = (uint32_t)meshLOD.baseVertex + indices[meshLOD.firstIndex + index + corner];
+			points[corner] = lightmapCoordinates[corners[corner]] * (float)rect.size;
+		}
+
+		float area = (points[1].x - points[0].x) * (points[2].y - points[0].y) -
+			(points[2].x - points[0].x) * (points[1].y - points[0].y);
+		if (fabsf(area) < 1e-8f)
+		{
+			continue;
+		}
+
+		int chart = objectIndex * g_ChartsPerObject +
+			SceneMeshes::GetLightmapChart(object.mesh, vertices[corners[0]].normal);
+		glm::vec2 pointMin = glm::min(points[0], glm::min(points[1], points[2]));
+		glm::vec2 pointMax = glm::max(points[0], glm::max(points[1], points[2]));
+		int firstX = std::max(0, (int)floorf(pointMin.x - 0.5f));
+		int firstY = std::max(0, (int)floorf(pointMin.y - 0.5f));
+		int lastX = std::min(rect.size - 1, (int)ceilf(pointMax.x - 0.5f));
+		int lastY = std::min(rect.size - 1, (int)ceilf(pointMax.y - 0.5f));
+
+		for (int y = firstY; y <= lastY; y++)
+		{
+			for (int x = firstX; x <= lastX; x++)
+			{
+				glm::vec2 center = glm::vec2((float)x + 0.5f, (float)y + 0.5f);
+				float w1 = ((center.x - points[0].x) * (points[2].y - points[0].y) -
+					(points[2].x - points[0].x) * (center.y - points[0].y)) / area;
+				float w2 = ((points[1].x - points[0].x) * (center.y - points[0].y) -
+					(center.x - points[0].x) * (points[1].y - points[0].y)) / area;
+				float w0 = 1.0f - w1 - w2;
+				if ((w0 < -1e-4f) || (w1 < -1e-4f) || (w2 < -1e-4f))
+				{
+					continue;
+				}
+
+				const SceneMeshes::VERTEX& a = vertices[corners[0]];
+				const SceneMeshes::VERTEX& b = vertices[corners[1]];
+				const SceneMeshes::VERTEX& c = vertices[corners[2]];
+				glm::vec3 position = a.position * w0 + b.position * w1 + c.position * w2;
+				glm::vec3 normal = a.normal * w0 + b.normal * w1 + c.normal * w2;
+
+				TEXEL& texel = m_texels[(size_t)(rect.y + y) * m_width + (rect.x + x)];
+				texel.position = glm::vec3(object.model * glm::vec4(position, 1.0f));
+				texel.normal = glm::normalize(normalMatrix * normal);
+				texel.chart = chart;
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetDirectLight()
+ *
+ *  This method is used for adding up the light each point
+ *  light sends straight to a surface point, with a shadow
+ *  ray to check nothing is in the way.
+ ***********************************************************/
+glm::vec3 LightmapBaker::GetDirectLight(const glm::vec3& position, const glm::vec3& normal) const
+{
+	glm::vec3 light = glm::vec3(0.0f);
+	glm::vec3 origin = position + normal * g_RayOffset;
+
+	for (size_t i = 0; i < m_lights.size(); i++)
+	{
+		glm::vec3 toLight = m_lights[i].position - origin;
+		float distance = glm::length(toLight);
+		if (distance <= g_RayOffset)
+		{
+			continue;
+		}
+
+		glm::vec3 direction = toLight / distance;
+		float impact = glm::dot(normal, direction);
+		if ((impact > 0.0f) && (false == m_bvh.IsOccluded(origin, direction, distance)))
+		{
+			light += m_lights[i].color * impact;
+		}
+	}
+
+	return(light);
+}
+
+/***********************************************************
+ *  BakeRows()
+ *
+ *  This method is used for tracing the light of the texels
+ *  in a range of atlas rows.  Each texel gets its direct
+ *  light, and the average of a number of paths that bounce
+ *  around the scene - every surface a path reaches adds the
+ *  direct light it receives, dimmed by the surfaces it was
+ *  reflected off on the way.  A texel whose paths keep
+ *  hitting the inside of another object is buried in it,
+ *  so it is dropped and filled from its neighbors.
+ ***********************************************************/
+void LightmapBaker::BakeRows(int firstRow, int lastRow)
+{
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		for (int x = 0; x < m_width; x++)
+		{
+			size_t texelIndex = (size_t)y * m_width + x;
+			TEXEL& texel = m_texels[texelIndex];
+			if (texel.chart < 0)
+			{
+				continue;
+			}
+
+			uint32_t random = SeedRandom((uint32_t)texelIndex);
+			glm::vec3 indirect = glm::vec3(0.0f);
+			int backfaceCount = 0;
+
+			for (int sample = 0; sample < g_SamplesPerTexel; sample++)
+			{
+				// spread the first bounce over the hemisphere
+				float u1 = ((float)sample + NextRandom(random)) / (float)g_SamplesPerTexel;
+				glm::vec3 origin = texel.position + texel.normal * g_RayOffset;
+				glm::vec3 direction = SampleCosine(texel.normal, u1, NextRandom(random));
+				glm::vec3 throughput = glm::vec3(1.0f);
+
+				for (int bounce = 0; bounce < g_MaxBounces; bounce++)
+				{
+					TriangleBVH::RAY_HIT hit;
+					if (false == m_bvh.Intersect(origin, direction, FLT_MAX, hit))
+					{
+						break;
+					}
+
+					const TRIANGLE_INFO& info = m_triangleInfo[hit.triangle];
+					if (glm::dot(info.normal, direction) > 0.0f)
+					{
+						if (0 == bounce)
+						{
+							backfaceCount++;
+						}
+						break;
+					}
+
+					glm::vec3 position = origin + direction * hit.distance;
+					throughput *= m_objects[info.objectIndex].albedo;
+					indirect += throughput * GetDirectLight(position, info.normal);
+
+					origin = position + info.normal * g_RayOffset;
+					direction = SampleCosine(info.normal, NextRandom(random), NextRandom(random));
+				}
+			}
+
+			if ((float)backfaceCount > g_MaxBackfaceShare * (float)g_SamplesPerTexel)
+			{
+				texel.chart = -1;
+				continue;
+			}
+
+			glm::vec3 light = GetDirectLight(texel.position, texel.normal) + indirect / (float)g_SamplesPerTexel;
+			m_data[texelIndex * 3] = light.r;
+			m_data[texelIndex * 3 + 1] = light.g;
+			m_data[texelIndex * 3 + 2] = light.b;
+		}
+	}
+}
+
+/***********************************************************
+ *  FilterAtlas()
+ *
+ *  This method is used for smoothing the noise of the paths
+ *  with the neighboring texels of the same chart, so the
+ *  light never bleeds over the edge of a box, and then
+ *  growing every chart into the empty texels around it a
+ *  few times, so the filtering of the atlas texture near a
+ *  chart edge only reads the chart's own light.
+ ***********************************************************/
+void LightmapBaker::FilterAtlas()
+{
+	std::vector<float> filtered(m_data.size(), 0.0f);
+	for (int y = 0; y < m_height; y++)
+	{
+		for (int x = 0; x < m_width; x++)
+		{
+			size_t texelIndex = (size_t)y * m_width + x;
+			int chart = m_texels[texelIndex].chart;
+			if (chart < 0)
+			{
+				continue;
+			}
+
+			glm::vec3 sum = glm::vec3(0.0f);
+			float weight = 0.0f;
+			for (int dy = -1; dy <= 1; dy++)
+			{
+				for (int dx = -1; dx <= 1; dx++)
+				{
+					int nx = x + dx;
+					int ny = y + dy;
+					if ((nx < 0) || (ny < 0) || (nx >= m_width) || (ny >= m_height))
+					{
+						continue;
+					}
+					size_t neighbor = (size_t)ny * m_width + nx;
+					if (m_texels[neighbor].chart != chart)
+					{
+						continue;
+					}
+					sum += glm::vec3(m_data[neighbor * 3], m_data[neighbor * 3 + 1], m_data[neighbor * 3 + 2]);
+					weight += 1.0f;
+				}
+			}
+
+			sum /= weight;
+			filtered[texelIndex * 3] = sum.r;
+			filtered[texelIndex * 3 + 1] = sum.g;
+			filtered[texelIndex * 3 + 2] = sum.b;
+		}
+	}
+	m_data.swap(filtered);
+
+	std::vector<bool> bFilled(m_texels.size());
+	for (size_t i = 0; i < m_texels.size(); i++)
+	{
+		bFilled[i] = (m_texels[i].chart >= 0);
+	}
+
+	for (int pass = 0; pass < g_DilatePasses; pass++)
+	{
+		std::vector<bool> bWasFilled = bFilled;
+		std::vector<float> previous = m_data;
+		for (int y = 0; y < m_height; y++)
+		{
+			for (int x = 0; x < m_width; x++)
+			{
+				size_t texelIndex = (size_t)y * m_width + x;
+				if (true == bWasFilled[texelIndex])
+				{
+					continue;
+				}
+
+				glm::vec3 sum = glm::vec3(0.0f);
+				float weight = 0.0f;
+				for (int dy = -1; dy <= 1; dy++)
+				{
+					for (int dx = -1; dx <= 1; dx++)
+					{
+						int nx = x + dx;
+						int ny = y + dy;
+						if ((nx < 0) || (ny < 0) || (nx >= m_width) || (ny >= m_height))
+						{
+							continue;
+						}
+						size_t neighbor = (size_t)ny * m_width + nx;
+						if (false == bWasFilled[neighbor])
+						{
+							continue;
+						}
+						sum += glm::vec3(previous[neighbor * 3], previous[neighbor * 3 + 1], previous[neighbor * 3 + 2]);
+						weight += 1.0f;
+					}
+				}
+
+				if (weight > 0.0f)
+				{
+					sum /= weight;
+					m_data[texelIndex * 3] = sum.r;
+					m_data[texelIndex * 3 + 1] = sum.g;
+					m_data[texelIndex * 3 + 2] = sum.b;
+					bFilled[texelIndex] = true;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  LoadCache()
+ *
+ *  This method is used for reading the atlas from the cache
+ *  file, when it was baked from the same scene and layout.
+ ***********************************************************/
+bool LightmapBaker::LoadCache()
+{
+	MappedFile cacheFile;
+	if (false == cacheFile.Open(m_cachePath.c_str()))
+	{
+		return(false);
+	}
+
+	const CACHE_HEADER* pHeader = (const CACHE_HEADER*)cacheFile.GetData();
+	size_t floatCount = (size_t)m_width * m_height * 3;
+	size_t dataSize = floatCount * sizeof(float);
+	if ((cacheFile.GetSize() < sizeof(CACHE_HEADER)) ||
+		(memcmp(pHeader->magic, g_CacheMagic, sizeof(pHeader->magic)) != 0) ||
+		(CACHE_VERSION != pHeader->version) ||
+		(m_sceneHash != pHeader->sceneHash) ||
+		((uint32_t)m_width != pHeader->width) ||
+		((uint32_t)m_height != pHeader->height) ||
+		(pHeader->dataOffset < sizeof(CACHE_HEADER)) ||
+		(cacheFile.GetSize() < pHeader->dataOffset + dataSize))
+	{
+		return(false);
+	}
+
+	m_data.resize(floatCount);
+	memcpy(m_data.data(), cacheFile.GetData() + pHeader->dataOffset, dataSize);
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for writing the baked atlas into the
+ *  cache file, through a side file so a failed write never
+ *  leaves a broken cache.
+ ***********************************************************/
+bool LightmapBaker::WriteCache() const
+{
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_CacheMagic, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	header.sceneHash = m_sceneHash;
+	header.width = (uint32_t)m_width;
+	header.height = (uint32_t)m_height;
+	header.dataOffset = sizeof(CACHE_HEADER);
+
+	std::string newCachePath = m_cachePath + ".new";
+	std::ofstream cacheFile(newCachePath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!cacheFile.is_open())
+	{
+		std::cout << "Could not write lightmap cache " << m_cachePath << std::endl;
+		return(false);
+	}
+
+	cacheFile.write((const char*)&header, sizeof(header));
+	cacheFile.write((const char*)m_data.data(), m_data.size() * sizeof(float));
+	cacheFile.close();
+
+	if ((cacheFile.fail()) ||
+		(false == MappedFile::ReplaceFile(newCachePath.c_str(), m_cachePath.c_str())))
+	{
+		std::cout << "Could not write lightmap cache " << m_cachePath << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Upload()
+ *
+ *  This method is used for creating the atlas texture in
+ *  half floats and binding it to its texture unit, which
+ *  nothing else uses.
+ ***********************************************************/
+void LightmapBaker::Upload()
+{
+	Destroy();
+
+	glGenTextures(1, &m_textureID);
+	GLStateCache::BindTexture(LIGHTMAP_UNIT, GL_TEXTURE_2D, m_textureID);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGB16F, m_width, m_height);
+	glTexSubImage2D(
+		GL_TEXTURE_2D,
+		0,
+		0,
+		0,
+		m_width,
+		m_height,
+		GL_RGB,
+		GL_FLOAT,
+		m_data.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+}
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightmapbaker.h
+// ============
+// bake and cache the light that reaches the static scene objects
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "JobSystem.h"
+#include "SceneMeshes.h"
+#include "TriangleBVH.h"
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  LightmapBaker
+ *
+ *  This class works out the diffuse light arriving at every
+ *  point of the static scene objects ahead of time, so they
+ *  can read it from a texture instead of evaluating the
+ *  lights for every fragment.  Each object gets a square of
+ *  an atlas texture sized by its surface area, which its
+ *  shape's lightmap coordinates are mapped into.  The light
+ *  is path traced on the job system worker threads against
+ *  a BVH of the objects' triangles - the direct light of
+ *  the point lights with shadow rays, plus a few bounces of
+ *  indirect light.  The result is written to a cache file
+ *  that later runs load instead, as long as the objects and
+ *  lights have not changed.
+ ***********************************************************/
+class LightmapBaker
+{
+public:
+	// point light, without falloff like the Phong lights
+	struct BAKE_LIGHT
+	{
+		glm::vec3 position;
+		glm::vec3 color;
+	};
+
+	// static object the light is baked for, which also casts
+	// shadows and bounces light onto the others
+	struct BAKE_OBJECT
+	{
+		MESH_TYPE mesh;
+		glm::mat4 model;
+		// share of the light the surface reflects
+		glm::vec3 albedo;
+	};
+
+	// header at the start of the cache file, followed by the
+	// atlas texels as RGB floats
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		// hash of the objects and lights the atlas was baked from
+		uint64_t sceneHash;
+		uint32_t width;
+		uint32_t height;
+		// byte offset from the start of the file to the texels
+		uint32_t dataOffset;
+		uint32_t padding[9];
+	};
+
+	// bumped whenever the cache layout or the baking changes
+	static const uint32_t CACHE_VERSION = 1;
+	// width of the atlas - the height grows to fit the objects
+	static const int ATLAS_WIDTH = 1024;
+	static const int MAX_ATLAS_HEIGHT = 4096;
+	// texture unit of the atlas, after the environment maps
+	static const int LIGHTMAP_UNIT = 19;
+
+	// constructor
+	LightmapBaker();
+	// destructor
+	~LightmapBaker();
+
+	// check whether the fragment shader can sample the atlas
+	// next to the scene textures and the environment maps
+	static bool IsSupported();
+
+	// describe the scene - must be called before Start()
+	void AddLight(const BAKE_LIGHT& light);
+	int AddObject(const BAKE_OBJECT& object);
+
+	// lay out the atlas, then load it from the cache file, or
+	// start baking it on the worker threads when it is missing
+	// or was baked from another scene
+	bool Start(const SceneMeshes* pSceneMeshes, const char* cachePath, JobSystem* pJobSystem);
+	// wait for the bake, fill in the texels between the
+	// charts, write the cache when it was baked, and upload
+	// and bind the atlas
+	bool Finish();
+	// free the atlas
+	void Destroy();
+
+	// scale and offset that map an object's lightmap
+	// coordinates into its square of the atlas
+	glm::vec4 GetScaleOffset(int objectIndex) const;
+
+private:
+	// square of the atlas an object is baked into, inside
+	// its border
+	struct ATLAS_RECT
+	{
+		int x;
+		int y;
+		int size;
+	};
+
+	// surface point a texel of the atlas stands for
+	struct TEXEL
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		// object and chart the texel belongs to, or -1 when
+		// no triangle covers it
+		int32_t chart;
+	};
+
+	// what a traced ray needs to know about a triangle
+	struct TRIANGLE_INFO
+	{
+		// geometric normal, turned to the side the surface faces
+		glm::vec3 normal;
+		uint32_t objectIndex;
+	};
+
+	std::vector<BAKE_LIGHT> m_lights;
+	std::vector<BAKE_OBJECT> m_objects;
+	std::vector<ATLAS_RECT> m_rects;
+	const SceneMeshes* m_pSceneMeshes;
+	int m_width;
+	int m_height;
+	uint64_t m_sceneHash;
+	std::string m_cachePath;
+	JobSystem* m_pJobSystem;
+	// counts the bake jobs still running
+	JobCounter m_jobs;
+	// true when the atlas is being baked rather than loaded
+	bool m_bBaked;
+	TriangleBVH m_bvh;
+	std::vector<TRIANGLE_INFO> m_triangleInfo;
+	std::vector<TEXEL> m_texels;
+	// RGB light of every texel
+	std::vector<float> m_data;
+	GLuint m_textureID;
+
+	// size the objects' squares and pack them into rows
+	bool PackAtlas();
+	// hash of everything the baked light depends on
+	uint64_t HashScene() const;
+	// put the triangles of every object into the BVH
+	void BuildScene();
+	// find the surface point of every texel of an object
+	void RasterizeObject(int objectIndex);
+	// light from the point lights reaching a surface point
+	glm::vec3 GetDirectLight(const glm::vec3& position, const glm::vec3& normal) const;
+	// path trace the texels of a range of atlas rows
+	void BakeRows(int firstRow, int lastRow);
+	// smooth the noise inside each chart and spread the
+	// charts into the texels around them
+	void FilterAtlas();
+	// read the atlas from the cache file
+	bool LoadCache();
+	// write the baked atlas to the cache file
+	bool WriteCache() const;
+	// create the OpenGL texture of the atlas
+	void Upload();
+};
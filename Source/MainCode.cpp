@@ -1,5 +1,6 @@
 #include <iostream>         // error handling and output
-#include <cstdlib>          // EXIT_FAILURE
+#include <cstdlib>          // EXIT_FAILURE, atof, atoi
+#include <cstring>          // strcmp
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -12,7 +13,10 @@
 #include "SceneManager.h"
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
-#include "ShaderManager.h"
+#include "ShaderVariants.h"
+#include "JobSystem.h"
+#include "AssetPack.h"
+#include "GLStateCache.h"
 
 // Namespace for declaring global variables
 namespace
@@ -25,10 +29,19 @@ namespace
 
 	// scene manager object for managing the 3D scene prepare and render
 	SceneManager* g_SceneManager = nullptr;
-	// shader manager object for dynamic interaction with the shader code
-	ShaderManager* g_ShaderManager = nullptr;
+	// shader variants object for dynamic interaction with the shader code
+	ShaderVariants* g_ShaderVariants = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// job system object shared by all the managers for running work
+	// across the worker threads
+	JobSystem* g_JobSystem = nullptr;
+	// asset pack the textures and meshes are read from, falling
+	// back to the loose files for anything it does not hold
+	AssetPack* g_AssetPack = nullptr;
+
+	// pack file opened at startup when it exists
+	const char* const DEFAULT_ASSET_PACK = "assets.pak";
 }
 
 // Function declarations - all functions that are called manually
@@ -45,17 +58,43 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// start the worker threads before anything else, so that
+	// every manager can hand work off to them
+	g_JobSystem = new JobSystem();
+
+	// --build-pack <manifest> <pack> writes an asset pack and
+	// exits without opening a window
+	for (int i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--build-pack") == 0) && (i + 2 < argc))
+		{
+			bool bBuilt = AssetPack::Build(argv[i + 1], argv[i + 2]);
+			delete g_JobSystem;
+			g_JobSystem = NULL;
+			return((true == bBuilt) ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+
+	// read the assets from the default pack when there is one
+	g_AssetPack = new AssetPack();
+	uint64_t packSize = 0;
+	uint64_t packTime = 0;
+	if (true == MappedFile::GetFileInfo(DEFAULT_ASSET_PACK, packSize, packTime))
+	{
+		g_AssetPack->Open(DEFAULT_ASSET_PACK);
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
 		return(EXIT_FAILURE);
 	}
 
-	// try to create a new shader manager object
-	g_ShaderManager = new ShaderManager();
+	// try to create a new shader variants object
+	g_ShaderVariants = new ShaderVariants();
 	// try to create a new view manager object
 	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+		g_ShaderVariants);
 
 	// try to create the main display window
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
@@ -66,14 +105,192 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"../../Utilities/shaders/vertexShader.glsl",
-		"../../Utilities/shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
-
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	// try to create a new scene manager object and prepare the 3D scene -
+	// the shader code is loaded from the external GLSL files by
+	// PrepareScene(), which builds the shader variants it draws with
+	g_SceneManager = new SceneManager(g_ShaderVariants, g_JobSystem, g_AssetPack);
+	// process the command line options
+	//   --gpu-driven      let the GPU cull and draw the scene
+	//   --multi-pass-views draw the quad view one viewport at a time
+	//   --packed-vertices store the scene meshes in the packed layout
+	//   --mesh-detail <n> multiply the segments of the closest scene meshes
+	//   --import <file>   place an OBJ or glTF model on the desk
+	//   --texture-budget <MB> video memory for the streamed texture mips
+	//   --mip-filter <box|kaiser> filter the texture mips are built with
+	//   --image-simd <none|sse2|ssse3|avx2> limit the image pipeline kernels
+	//   --pack <file>     read the assets from this pack instead of assets.pak
+	//   --build-pack <manifest> <pack> write an asset pack and exit
+	//   --record <file>   record the camera input into a file
+	//   --replay <file>   replay recorded camera input on a fixed timestep
+	//   --target-fps <n>  frame rate the dynamic render scale aims for
+	//   --render-scale <s> fix the render scale instead, from 0.1 to 1
+	//   --no-state-filter issue the redundant GL state calls too
+	//   --no-program-cache compile the shader variants every run
+	//   --hot-reload      reload the shaders, textures and models when edited
+	//   --pbr             shade with metallic/roughness and environment lighting
+	//   --lightmaps       light the static objects from baked lightmaps
+	//   --ssao <full|half|quarter> darken the occluded parts of the frame
+	//   --aa <msaa2|msaa4|msaa8|taa> anti-alias the frame
+	//   --hdr             tone map the frame with bloom and auto exposure
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--gpu-driven") == 0)
+		{
+			g_SceneManager->SetGPUDrivenRendering(true);
+		}
+		else if (strcmp(argv[i], "--multi-pass-views") == 0)
+		{
+			g_SceneManager->SetSinglePassViews(false);
+		}
+		else if (strcmp(argv[i], "--packed-vertices") == 0)
+		{
+			g_SceneManager->SetPackedVertices(true);
+		}
+		else if ((strcmp(argv[i], "--mesh-detail") == 0) && (i + 1 < argc))
+		{
+			g_SceneManager->SetMeshDetail(atoi(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--import") == 0) && (i + 1 < argc))
+		{
+			g_SceneManager->AddImportedModel(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--texture-budget") == 0) && (i + 1 < argc))
+		{
+			g_SceneManager->SetTextureBudget(atoi(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--mip-filter") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "box") == 0)
+			{
+				g_SceneManager->SetMipFilter(ImagePipeline::MIP_FILTER_BOX);
+			}
+			else if (strcmp(argv[i], "kaiser") == 0)
+			{
+				g_SceneManager->SetMipFilter(ImagePipeline::MIP_FILTER_KAISER);
+			}
+			else
+			{
+				std::cout << "Unknown mip filter: " << argv[i] << std::endl;
+			}
+		}
+		else if ((strcmp(argv[i], "--image-simd") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "none") == 0)
+			{
+				ImagePipeline::SetSIMDLevel(ImagePipeline::SIMD_NONE);
+			}
+			else if (strcmp(argv[i], "sse2") == 0)
+			{
+				ImagePipeline::SetSIMDLevel(ImagePipeline::SIMD_SSE2);
+			}
+			else if (strcmp(argv[i], "ssse3") == 0)
+			{
+				ImagePipeline::SetSIMDLevel(ImagePipeline::SIMD_SSSE3);
+			}
+			else if (strcmp(argv[i], "avx2") == 0)
+			{
+				ImagePipeline::SetSIMDLevel(ImagePipeline::SIMD_AVX2);
+			}
+			else
+			{
+				std::cout << "Unknown image SIMD level: " << argv[i] << std::endl;
+			}
+		}
+		else if ((strcmp(argv[i], "--pack") == 0) && (i + 1 < argc))
+		{
+			g_AssetPack->Open(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--record") == 0) && (i + 1 < argc))
+		{
+			g_ViewManager->StartInputRecording(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--replay") == 0) && (i + 1 < argc))
+		{
+			g_ViewManager->StartInputReplay(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--target-fps") == 0) && (i + 1 < argc))
+		{
+			g_ViewManager->SetTargetFrameRate((float)atof(argv[++i]));
+		}
+		else if ((strcmp(argv[i], "--render-scale") == 0) && (i + 1 < argc))
+		{
+			g_ViewManager->SetRenderScale((float)atof(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--no-state-filter") == 0)
+		{
+			GLStateCache::SetFiltering(false);
+		}
+		else if (strcmp(argv[i], "--no-program-cache") == 0)
+		{
+			g_ShaderVariants->SetBinaryCache(false);
+		}
+		else if (strcmp(argv[i], "--hot-reload") == 0)
+		{
+			g_SceneManager->SetHotReload(true);
+		}
+		else if (strcmp(argv[i], "--pbr") == 0)
+		{
+			g_SceneManager->SetPhysicallyBasedShading(true);
+		}
+		else if (strcmp(argv[i], "--lightmaps") == 0)
+		{
+			g_SceneManager->SetLightmaps(true);
+		}
+		else if ((strcmp(argv[i], "--ssao") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "full") == 0)
+			{
+				g_ViewManager->SetAmbientOcclusion(1, g_AssetPack);
+			}
+			else if (strcmp(argv[i], "half") == 0)
+			{
+				g_ViewManager->SetAmbientOcclusion(2, g_AssetPack);
+			}
+			else if (strcmp(argv[i], "quarter") == 0)
+			{
+				g_ViewManager->SetAmbientOcclusion(4, g_AssetPack);
+			}
+			else
+			{
+				std::cout << "Unknown ambient occlusion resolution: " << argv[i] << std::endl;
+			}
+		}
+		else if ((strcmp(argv[i], "--aa") == 0) && (i + 1 < argc))
+		{
+			i++;
+			if (strcmp(argv[i], "taa") == 0)
+			{
+				g_ViewManager->SetTemporalAntiAliasing(g_AssetPack);
+			}
+			else if (strcmp(argv[i], "msaa2") == 0)
+			{
+				g_ViewManager->SetMultisampling(2);
+			}
+			else if (strcmp(argv[i], "msaa4") == 0)
+			{
+				g_ViewManager->SetMultisampling(4);
+			}
+			else if (strcmp(argv[i], "msaa8") == 0)
+			{
+				g_ViewManager->SetMultisampling(8);
+			}
+			else
+			{
+				std::cout << "Unknown anti-aliasing mode: " << argv[i] << std::endl;
+			}
+		}
+		else if (strcmp(argv[i], "--hdr") == 0)
+		{
+			g_ViewManager->SetToneMapping(g_AssetPack);
+		}
+		else
+		{
+			std::cout << "Unknown command line option: " << argv[i] << std::endl;
+		}
+	}
 	g_SceneManager->PrepareScene();
 
 	std::cout << "\n*** KEY FUNCTIONS: ***\n";
@@ -85,32 +302,80 @@ int main(int argc, char* argv[])
 	std::cout << "2 - side view (ortho)\n";
 	std::cout << "3 - top view (ortho)\n";
 	std::cout << "4 - perspective view\n";
+	std::cout << "5 - quad view (top, front, side and perspective)\n";
 
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		// swap in the edited assets between frames
+		g_SceneManager->UpdateHotReload();
+
+		// convert from 3D object space to 2D view
+		g_ViewManager->PrepareSceneView();
+
+		// draw into the offscreen target at the current render scale
+		g_ViewManager->BeginSceneRender();
+
+		// Enable z-depth - the state cache only passes this and
+		// the clear color on in the first frame
+		GLStateCache::SetEnabled(GL_DEPTH_TEST, true);
 
 		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		GLStateCache::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+		// the texture mips are chosen from the size of each view
+		for (int i = 0; i < g_ViewManager->GetViewCount(); i++)
+		{
+			g_SceneManager->SetViewportHeight(i, g_ViewManager->GetViewportHeight(i));
+		}
 
-		// refresh the 3D scene
-		g_SceneManager->RenderScene();
+		// refresh the 3D scene - several views share one recorded
+		// set of draw packets, and are drawn in a single pass when
+		// supported, or else one viewport at a time
+		if (g_ViewManager->GetViewCount() == 1)
+		{
+			g_SceneManager->RenderScene(g_ViewManager->GetViewProjection());
+		}
+		else if (true == g_SceneManager->IsSinglePassViews())
+		{
+			g_SceneManager->RecordScene(
+				g_ViewManager->GetViewProjections(),
+				g_ViewManager->GetViewCount());
+			g_ViewManager->ApplyAllViews();
+			g_SceneManager->SubmitSceneAllViews();
+			g_SceneManager->FinishScene();
+		}
+		else
+		{
+			g_SceneManager->RecordScene(
+				g_ViewManager->GetViewProjections(),
+				g_ViewManager->GetViewCount());
+			for (int i = 0; i < g_ViewManager->GetViewCount(); i++)
+			{
+				g_ViewManager->ApplyView(i);
+				g_SceneManager->SubmitScene(i);
+			}
+			g_SceneManager->FinishScene();
+		}
 
+		// scale the scene up into the display window
+		g_ViewManager->EndSceneRender();
 
 		// Flips the the back buffer with the front buffer every frame.
 		glfwSwapBuffers(g_Window);
+		GLStateCache::EndFrame();
 
 		// query the latest GLFW events
 		glfwPollEvents();
 	}
 
+	// report the GL state calls the cache issued and dropped,
+	// and the GPU time of the parts of the frame
+	GLStateCache::PrintStats();
+	g_ViewManager->PrintGPUProfile();
+
 	// clear the allocated manager objects from memory
 	if (NULL != g_SceneManager)
 	{
@@ -122,10 +387,20 @@ int main(int argc, char* argv[])
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
-	if (NULL != g_ShaderManager)
+	if (NULL != g_ShaderVariants)
+	{
+		delete g_ShaderVariants;
+		g_ShaderVariants = NULL;
+	}
+	if (NULL != g_AssetPack)
+	{
+		delete g_AssetPack;
+		g_AssetPack = NULL;
+	}
+	if (NULL != g_JobSystem)
 	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
+		delete g_JobSystem;
+		g_JobSystem = NULL;
 	}
 
 	// Terminates the program successfully
@@ -0,0 +1,258 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.cpp
+// ============
+// map a file read-only into memory
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <iostream>
+
+/***********************************************************
+ *  MappedFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MappedFile::MappedFile()
+{
+#ifdef _WIN32
+	m_fileHandle = INVALID_HANDLE_VALUE;
+	m_mappingHandle = NULL;
+#else
+	m_fileDescriptor = -1;
+#endif
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  ~MappedFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping the passed in file into
+ *  memory.  Empty files cannot be mapped.
+ ***********************************************************/
+bool MappedFile::Open(const char* filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	m_fileHandle = CreateFileA(
+		filePath,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		NULL,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		NULL);
+	if (INVALID_HANDLE_VALUE == m_fileHandle)
+	{
+		return(false);
+	}
+
+	LARGE_INTEGER fileSize;
+	if ((!GetFileSizeEx(m_fileHandle, &fileSize)) || (fileSize.QuadPart == 0))
+	{
+		Close();
+		return(false);
+	}
+
+	m_mappingHandle = CreateFileMappingA(m_fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL == m_mappingHandle)
+	{
+		Close();
+		return(false);
+	}
+
+	m_pData = (const unsigned char*)MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (NULL == m_pData)
+	{
+		Close();
+		return(false);
+	}
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	m_fileDescriptor = open(filePath, O_RDONLY);
+	if (m_fileDescriptor < 0)
+	{
+		return(false);
+	}
+
+	struct stat fileStatus;
+	if ((fstat(m_fileDescriptor, &fileStatus) != 0) || (fileStatus.st_size == 0))
+	{
+		Close();
+		return(false);
+	}
+
+	void* pMapping = mmap(NULL, (size_t)fileStatus.st_size, PROT_READ, MAP_PRIVATE, m_fileDescriptor, 0);
+	if (MAP_FAILED == pMapping)
+	{
+		Close();
+		return(false);
+	}
+	m_pData = (const unsigned char*)pMapping;
+	m_size = (size_t)fileStatus.st_size;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the file and closing
+ *  its handles.
+ ***********************************************************/
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (NULL != m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (NULL != m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+		m_mappingHandle = NULL;
+	}
+	if (INVALID_HANDLE_VALUE != m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+	}
+#else
+	if (NULL != m_pData)
+	{
+		munmap((void*)m_pData, m_size);
+	}
+	if (m_fileDescriptor >= 0)
+	{
+		close(m_fileDescriptor);
+		m_fileDescriptor = -1;
+	}
+#endif
+
+	m_pData = NULL;
+	m_size = 0;
+}
+
+/***********************************************************
+ *  IsOpen()
+ *
+ *  This method is used for checking whether a file is
+ *  mapped.
+ ***********************************************************/
+bool MappedFile::IsOpen() const
+{
+	return(NULL != m_pData);
+}
+
+/***********************************************************
+ *  GetData()
+ *
+ *  This method is used for getting the start of the mapped
+ *  file contents.
+ ***********************************************************/
+const unsigned char* MappedFile::GetData() const
+{
+	return(m_pData);
+}
+
+/***********************************************************
+ *  GetSize()
+ *
+ *  This method is used for getting the size of the mapped
+ *  file in bytes.
+ ***********************************************************/
+size_t MappedFile::GetSize() const
+{
+	return(m_size);
+}
+
+/***********************************************************
+ *  GetFileInfo()
+ *
+ *  This method is used for getting the size and the last
+ *  write time of a file, which is how caches built from the
+ *  file tell whether they are out of date.
+ ***********************************************************/
+bool MappedFile::GetFileInfo(const char* filePath, uint64_t& size, uint64_t& modifiedTime)
+{
+	size = 0;
+	modifiedTime = 0;
+
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(filePath, GetFileExInfoStandard, &attributes))
+	{
+		return(false);
+	}
+
+	size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	modifiedTime = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat fileStatus;
+	if (stat(filePath, &fileStatus) != 0)
+	{
+		return(false);
+	}
+
+	size = (uint64_t)fileStatus.st_size;
+	modifiedTime = (uint64_t)fileStatus.st_mtime;
+#endif
+
+	return(true);
+}
+
+/***********************************************************
+ *  ReplaceFile()
+ *
+ *  This method is used for moving a newly written file over
+ *  an existing one.  Truncating a file that is mapped would
+ *  pull the pages out from under its mapping, while a rename
+ *  leaves the old contents in place until they are unmapped.
+ *  Windows refuses to replace a mapped file, in which case
+ *  the new file is removed and the old one is kept.
+ ***********************************************************/
+bool MappedFile::ReplaceFile(const char* newFilePath, const char* filePath)
+{
+#ifdef _WIN32
+	if (!MoveFileExA(newFilePath, filePath, MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileA(newFilePath);
+		return(false);
+	}
+#else
+	if (rename(newFilePath, filePath) != 0)
+	{
+		unlink(newFilePath);
+		return(false);
+	}
+#endif
+
+	return(true);
+}
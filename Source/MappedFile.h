@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file read-only into memory
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps a whole file read-only into the address
+ *  space of the process.  The operating system pages the
+ *  contents in as they are touched, so a loader can read
+ *  the data in place without copying it into its own
+ *  buffers first.
+ ***********************************************************/
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+	// destructor
+	~MappedFile();
+
+	// map the passed in file
+	bool Open(const char* filePath);
+	// unmap the file
+	void Close();
+
+	bool IsOpen() const;
+	// start and size of the mapped contents
+	const unsigned char* GetData() const;
+	size_t GetSize() const;
+
+	// get the size and last write time of a file without
+	// opening it
+	static bool GetFileInfo(const char* filePath, uint64_t& size, uint64_t& modifiedTime);
+	// move a newly written file over another one, which stays
+	// intact for anyone who still has it mapped
+	static bool ReplaceFile(const char* newFilePath, const char* filePath);
+
+private:
+#ifdef _WIN32
+	// file and file mapping handles
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#else
+	int m_fileDescriptor;
+#endif
+	const unsigned char* m_pData;
+	size_t m_size;
+
+	// the mapping is owned, so it is not copied
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+};
@@ -0,0 +1,449 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshgenerator.h
+// ============
+// generate the tessellated mesh shapes at compile time or at runtime
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// basic mesh shapes that a scene object can be drawn with
+enum MESH_TYPE
+{
+	MESH_PLANE = 0,
+	MESH_BOX,
+	MESH_CYLINDER,
+	MESH_TAPERED_CYLINDER,
+	MESH_SPHERE,
+	MESH_TORUS,
+	MESH_PRISM,
+	MESH_TYPE_COUNT
+};
+
+// vertex written by the generator - the same layout as
+// SceneMeshes::VERTEX, in plain floats so it can be built
+// at compile time
+struct GENERATED_VERTEX
+{
+	float position[3];
+	float normal[3];
+	float textureCoordinate[2];
+};
+
+/***********************************************************
+ *  MESH_TABLE
+ *
+ *  Fixed size vertex and index tables for one tessellation
+ *  of a shape.  They are filled in by a constant expression,
+ *  so the finished tables are baked into the binary.
+ ***********************************************************/
+template <uint32_t VertexCount, uint32_t IndexCount>
+struct MESH_TABLE
+{
+	GENERATED_VERTEX vertices[VertexCount];
+	uint32_t indices[IndexCount];
+	uint32_t vertexCount;
+	uint32_t indexCount;
+
+	constexpr uint32_t AddVertex(
+		float x, float y, float z,
+		float nx, float ny, float nz,
+		float u, float v)
+	{
+		GENERATED_VERTEX& vertex = vertices[vertexCount];
+		vertex.position[0] = x;
+		vertex.position[1] = y;
+		vertex.position[2] = z;
+		vertex.normal[0] = nx;
+		vertex.normal[1] = ny;
+		vertex.normal[2] = nz;
+		vertex.textureCoordinate[0] = u;
+		vertex.textureCoordinate[1] = v;
+
+		return(vertexCount++);
+	}
+
+	constexpr void AddTriangle(uint32_t a, uint32_t b, uint32_t c)
+	{
+		indices[indexCount++] = a;
+		indices[indexCount++] = b;
+		indices[indexCount++] = c;
+	}
+};
+
+/***********************************************************
+ *  MESH_DATA
+ *
+ *  Growable vertex and index lists for a tessellation that
+ *  is generated at runtime.
+ ***********************************************************/
+struct MESH_DATA
+{
+	std::vector<GENERATED_VERTEX> vertices;
+	std::vector<uint32_t> indices;
+
+	uint32_t AddVertex(
+		float x, float y, float z,
+		float nx, float ny, float nz,
+		float u, float v)
+	{
+		GENERATED_VERTEX vertex = { { x, y, z }, { nx, ny, nz }, { u, v } };
+		vertices.push_back(vertex);
+
+		return((uint32_t)vertices.size() - 1);
+	}
+
+	void AddTriangle(uint32_t a, uint32_t b, uint32_t c)
+	{
+		indices.push_back(a);
+		indices.push_back(b);
+		indices.push_back(c);
+	}
+};
+
+/***********************************************************
+ *  MeshGenerator
+ *
+ *  This class generates the tessellated shapes - cylinders,
+ *  spheres and tori - for any segment counts.  The shape
+ *  code is written once against a writer template, so the
+ *  same code fills a MESH_TABLE in a constant expression
+ *  for the common tessellations, and a MESH_DATA at runtime
+ *  for any other counts.  The trigonometry is evaluated
+ *  with series that are valid in constant expressions.
+ ***********************************************************/
+class MeshGenerator
+{
+public:
+	static constexpr double PI = 3.14159265358979323846;
+
+	// size of the tapered cylinder top compared to its bottom
+	static constexpr float TAPERED_TOP_RADIUS = 0.5f;
+	// radius of the torus ring and of its tube
+	static constexpr float TORUS_MAIN_RADIUS = 1.0f;
+	static constexpr float TORUS_TUBE_RADIUS = 0.1f;
+
+	// sine and cosine that can run in constant expressions
+	static constexpr double Sin(double angle)
+	{
+		// bring the angle into -pi to pi, where the series is accurate
+		double turns = angle / (2.0 * PI);
+		long long wholeTurns = (long long)(turns + ((turns >= 0.0) ? 0.5 : -0.5));
+		double x = angle - (wholeTurns * 2.0 * PI);
+
+		double term = x;
+		double sum = x;
+		for (int n = 1; n < 12; n++)
+		{
+			term *= -(x * x) / ((2.0 * n) * (2.0 * n + 1.0));
+			sum += term;
+		}
+
+		return(sum);
+	}
+
+	static constexpr double Cos(double angle)
+	{
+		return(Sin(angle + (PI * 0.5)));
+	}
+
+	// square root by Newton iterations
+	static constexpr double Sqrt(double value)
+	{
+		if (value <= 0.0)
+		{
+			return(0.0);
+		}
+
+		double root = (value > 1.0) ? value : 1.0;
+		for (int i = 0; i < 64; i++)
+		{
+			double next = 0.5 * (root + (value / root));
+			if (next == root)
+			{
+				break;
+			}
+			root = next;
+		}
+
+		return(root);
+	}
+
+	// number of vertices and indices a tessellation produces -
+	// segments1 is the cylinder segments, sphere stacks or
+	// torus ring segments, and segments2 is the sphere slices
+	// or torus tube segments
+	static constexpr uint32_t GetVertexCount(MESH_TYPE mesh, int segments1, int segments2)
+	{
+		return(
+			((mesh == MESH_CYLINDER) || (mesh == MESH_TAPERED_CYLINDER)) ? (uint32_t)((4 * segments1) + 6) :
+			((mesh == MESH_SPHERE) || (mesh == MESH_TORUS)) ? (uint32_t)((segments1 + 1) * (segments2 + 1)) :
+			0);
+	}
+
+	static constexpr uint32_t GetIndexCount(MESH_TYPE mesh, int segments1, int segments2)
+	{
+		return(
+			((mesh == MESH_CYLINDER) || (mesh == MESH_TAPERED_CYLINDER)) ? (uint32_t)(12 * segments1) :
+			(mesh == MESH_SPHERE) ? (uint32_t)(6 * (segments1 - 1) * segments2) :
+			(mesh == MESH_TORUS) ? (uint32_t)(6 * segments1 * segments2) :
+			0);
+	}
+
+	// check whether a shape can be tessellated by the generator
+	static constexpr bool IsTessellated(MESH_TYPE mesh)
+	{
+		return((mesh == MESH_CYLINDER) ||
+			(mesh == MESH_TAPERED_CYLINDER) ||
+			(mesh == MESH_SPHERE) ||
+			(mesh == MESH_TORUS));
+	}
+
+	// write a tessellated shape into the passed in writer
+	template <typename WRITER>
+	static constexpr void GenerateShape(WRITER& writer, MESH_TYPE mesh, int segments1, int segments2)
+	{
+		switch (mesh)
+		{
+		case MESH_CYLINDER:
+			GenerateCylinder(writer, segments1, 1.0f);
+			break;
+		case MESH_TAPERED_CYLINDER:
+			GenerateCylinder(writer, segments1, TAPERED_TOP_RADIUS);
+			break;
+		case MESH_SPHERE:
+			GenerateSphere(writer, segments1, segments2);
+			break;
+		case MESH_TORUS:
+			GenerateTorus(writer, segments1, segments2);
+			break;
+		default:
+			break;
+		}
+	}
+
+	// generate a tessellation at runtime, which is safe to
+	// call from a worker thread
+	static void Generate(MESH_DATA& data, MESH_TYPE mesh, int segments1, int segments2)
+	{
+		data.vertices.clear();
+		data.indices.clear();
+		data.vertices.reserve(GetVertexCount(mesh, segments1, segments2));
+		data.indices.reserve(GetIndexCount(mesh, segments1, segments2));
+		GenerateShape(data, mesh, segments1, segments2);
+	}
+
+private:
+	/***********************************************************
+	 *  GenerateCylinder()
+	 *
+	 *  Generate a cylinder of height 1 standing on the origin,
+	 *  with a bottom radius of 1 and the passed in top radius.
+	 ***********************************************************/
+	template <typename WRITER>
+	static constexpr void GenerateCylinder(WRITER& writer, int segments, float topRadius)
+	{
+		// the side normals tilt up as the cylinder narrows
+		double normalY = 1.0 - topRadius;
+
+		// sides
+		uint32_t firstSide = 0;
+		for (int i = 0; i <= segments; i++)
+		{
+			double u = (double)i / segments;
+			double angle = u * 2.0 * PI;
+			double x = Cos(angle);
+			double z = Sin(angle);
+			double length = Sqrt((x * x) + (normalY * normalY) + (z * z));
+
+			uint32_t bottom = writer.AddVertex(
+				(float)x, 0.0f, (float)z,
+				(float)(x / length), (float)(normalY / length), (float)(z / length),
+				(float)u, 0.0f);
+			writer.AddVertex(
+				(float)(x * topRadius), 1.0f, (float)(z * topRadius),
+				(float)(x / length), (float)(normalY / length), (float)(z / length),
+				(float)u, 1.0f);
+			if (i == 0)
+			{
+				firstSide = bottom;
+			}
+		}
+		for (int i = 0; i < segments; i++)
+		{
+			uint32_t bottom = firstSide + (i * 2);
+			writer.AddTriangle(bottom, bottom + 1, bottom + 3);
+			writer.AddTriangle(bottom, bottom + 3, bottom + 2);
+		}
+
+		// top and bottom caps
+		for (int cap = 0; cap < 2; cap++)
+		{
+			bool bTop = (cap == 0);
+			float y = bTop ? 1.0f : 0.0f;
+			double radius = bTop ? topRadius : 1.0;
+			float normalCapY = bTop ? 1.0f : -1.0f;
+
+			uint32_t center = writer.AddVertex(0.0f, y, 0.0f, 0.0f, normalCapY, 0.0f, 0.5f, 0.5f);
+			for (int i = 0; i <= segments; i++)
+			{
+				double angle = ((double)i / segments) * 2.0 * PI;
+				double x = Cos(angle);
+				double z = Sin(angle);
+				writer.AddVertex(
+					(float)(x * radius), y, (float)(z * radius),
+					0.0f, normalCapY, 0.0f,
+					(float)((x * 0.5) + 0.5), (float)((z * 0.5) + 0.5));
+			}
+			for (int i = 0; i < segments; i++)
+			{
+				uint32_t ring = center + 1 + i;
+				if (bTop)
+				{
+					writer.AddTriangle(center, ring + 1, ring);
+				}
+				else
+				{
+					writer.AddTriangle(center, ring, ring + 1);
+				}
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  GenerateSphere()
+	 *
+	 *  Generate a unit sphere centered on the origin from
+	 *  rings of latitude, without the triangles that collapse
+	 *  at the poles.
+	 ***********************************************************/
+	template <typename WRITER>
+	static constexpr void GenerateSphere(WRITER& writer, int stacks, int slices)
+	{
+		uint32_t first = 0;
+
+		for (int stack = 0; stack <= stacks; stack++)
+		{
+			double v = (double)stack / stacks;
+			double phi = v * PI;
+			double y = Cos(phi);
+			double ringRadius = Sin(phi);
+
+			for (int slice = 0; slice <= slices; slice++)
+			{
+				double u = (double)slice / slices;
+				double theta = u * 2.0 * PI;
+				float x = (float)(ringRadius * Cos(theta));
+				float z = (float)(ringRadius * Sin(theta));
+
+				uint32_t index = writer.AddVertex(
+					x, (float)y, z,
+					x, (float)y, z,
+					(float)u, (float)(1.0 - v));
+				if ((stack == 0) && (slice == 0))
+				{
+					first = index;
+				}
+			}
+		}
+
+		for (int stack = 0; stack < stacks; stack++)
+		{
+			for (int slice = 0; slice < slices; slice++)
+			{
+				uint32_t a = first + (stack * (slices + 1)) + slice;
+				uint32_t b = a + slices + 1;
+				uint32_t c = b + 1;
+				uint32_t d = a + 1;
+
+				if (stack != 0)
+				{
+					writer.AddTriangle(a, d, c);
+				}
+				if (stack != (stacks - 1))
+				{
+					writer.AddTriangle(a, c, b);
+				}
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  GenerateTorus()
+	 *
+	 *  Generate a torus lying in the XY plane around the
+	 *  origin.
+	 ***********************************************************/
+	template <typename WRITER>
+	static constexpr void GenerateTorus(WRITER& writer, int mainSegments, int tubeSegments)
+	{
+		uint32_t first = 0;
+
+		for (int i = 0; i <= mainSegments; i++)
+		{
+			double u = (double)i / mainSegments;
+			double mainAngle = u * 2.0 * PI;
+			double ringX = Cos(mainAngle);
+			double ringY = Sin(mainAngle);
+
+			for (int j = 0; j <= tubeSegments; j++)
+			{
+				double v = (double)j / tubeSegments;
+				double tubeAngle = v * 2.0 * PI;
+				double tubeCos = Cos(tubeAngle);
+				double nx = ringX * tubeCos;
+				double ny = ringY * tubeCos;
+				double nz = Sin(tubeAngle);
+
+				uint32_t index = writer.AddVertex(
+					(float)((ringX * TORUS_MAIN_RADIUS) + (nx * TORUS_TUBE_RADIUS)),
+					(float)((ringY * TORUS_MAIN_RADIUS) + (ny * TORUS_TUBE_RADIUS)),
+					(float)(nz * TORUS_TUBE_RADIUS),
+					(float)nx, (float)ny, (float)nz,
+					(float)u, (float)v);
+				if ((i == 0) && (j == 0))
+				{
+					first = index;
+				}
+			}
+		}
+
+		for (int i = 0; i < mainSegments; i++)
+		{
+			for (int j = 0; j < tubeSegments; j++)
+			{
+				uint32_t a = first + (i * (tubeSegments + 1)) + j;
+				uint32_t b = a + tubeSegments + 1;
+				writer.AddTriangle(a, b, b + 1);
+				writer.AddTriangle(a, b + 1, a + 1);
+			}
+		}
+	}
+};
+
+/***********************************************************
+ *  MeshTessellation
+ *
+ *  Compile time description of one tessellation of a shape.
+ *  Bake() runs the generator in a constant expression, so
+ *  a constexpr table built from it costs nothing at startup.
+ ***********************************************************/
+template <MESH_TYPE Mesh, int Segments1, int Segments2 = 0>
+struct MeshTessellation
+{
+	static constexpr uint32_t VERTEX_COUNT = MeshGenerator::GetVertexCount(Mesh, Segments1, Segments2);
+	static constexpr uint32_t INDEX_COUNT = MeshGenerator::GetIndexCount(Mesh, Segments1, Segments2);
+
+	typedef MESH_TABLE<VERTEX_COUNT, INDEX_COUNT> TABLE;
+
+	static constexpr TABLE Bake()
+	{
+		TABLE table = {};
+		MeshGenerator::GenerateShape(table, Mesh, Segments1, Segments2);
+		return(table);
+	}
+};
@@ -0,0 +1,1814 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.cpp
+// ============
+// import authored meshes and cache them in a binary file
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshImporter.h"
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// the cache stores the vertices exactly as they are uploaded
+static_assert(sizeof(GENERATED_VERTEX) == 32, "GENERATED_VERTEX must match the 32 byte scene mesh vertex");
+static_assert(sizeof(MeshImporter::CACHE_HEADER) == 64, "CACHE_HEADER must stay 64 bytes so the vertices stay aligned");
+
+namespace
+{
+	// identifies a mesh cache file
+	const char g_CacheMagic[4] = { 'M', 'S', 'H', 'C' };
+	// the vertex and index arrays start on this boundary
+	const uint32_t g_CacheAlignment = 16;
+
+	// glTF binary container values
+	const uint32_t g_GLBMagic = 0x46546C67;
+	const uint32_t g_GLBChunkJSON = 0x4E4F534A;
+	const uint32_t g_GLBChunkBIN = 0x004E4942;
+	// glTF primitive mode for triangle lists
+	const int g_GLTFTriangles = 4;
+	// deepest nesting followed in the JSON and node hierarchy
+	const int g_MaxDepth = 64;
+
+	/***********************************************************
+	 *  JSON_VALUE
+	 *
+	 *  One parsed value of a glTF JSON document.  Objects keep
+	 *  their keys in a list next to the values, since glTF
+	 *  objects only have a handful of keys each.
+	 ***********************************************************/
+	struct JSON_VALUE
+	{
+		enum TYPE
+		{
+			JSON_NULL,
+			JSON_BOOL,
+			JSON_NUMBER,
+			JSON_STRING,
+			JSON_ARRAY,
+			JSON_OBJECT
+		};
+
+		TYPE type;
+		double number;
+		std::string text;
+		std::vector<JSON_VALUE> items;
+		std::vector<std::string> keys;
+
+		JSON_VALUE()
+		{
+			type = JSON_NULL;
+			number = 0.0;
+		}
+
+		const JSON_VALUE* Find(const char* key) const
+		{
+			if (JSON_OBJECT != type)
+			{
+				return(NULL);
+			}
+			for (size_t i = 0; i < keys.size(); i++)
+			{
+				if (keys[i] == key)
+				{
+					return(&items[i]);
+				}
+			}
+			return(NULL);
+		}
+
+		const JSON_VALUE* At(int index) const
+		{
+			if ((JSON_ARRAY != type) || (index < 0) || ((size_t)index >= items.size()))
+			{
+				return(NULL);
+			}
+			return(&items[index]);
+		}
+
+		double GetNumber(const char* key, double defaultValue) const
+		{
+			const JSON_VALUE* pValue = Find(key);
+			if ((NULL == pValue) || (JSON_NUMBER != pValue->type))
+			{
+				return(defaultValue);
+			}
+			return(pValue->number);
+		}
+
+		int GetInt(const char* key, int defaultValue) const
+		{
+			return((int)GetNumber(key, (double)defaultValue));
+		}
+
+		std::string GetString(const char* key) const
+		{
+			const JSON_VALUE* pValue = Find(key);
+			if ((NULL == pValue) || (JSON_STRING != pValue->type))
+			{
+				return(std::string());
+			}
+			return(pValue->text);
+		}
+	};
+
+	/***********************************************************
+	 *  JSON_PARSER
+	 *
+	 *  Recursive descent parser for the JSON chunk of a glTF
+	 *  file.
+	 ***********************************************************/
+	class JSON_PARSER
+	{
+	public:
+		JSON_PARSER(const char* pText, size_t length)
+		{
+			m_p = pText;
+			m_end = pText + length;
+		}
+
+		bool Parse(JSON_VALUE& value)
+		{
+			if (false == ParseValue(value, 0))
+			{
+				return(false);
+			}
+			SkipSpaces();
+			return(true);
+		}
+
+	private:
+		const char* m_p;
+		const char* m_end;
+
+		void SkipSpaces()
+		{
+			while ((m_p < m_end) &&
+				((*m_p == ' ') || (*m_p == '\t') || (*m_p == '\n') || (*m_p == '\r')))
+			{
+				m_p++;
+			}
+		}
+
+		bool Match(const char* pWord)
+		{
+			size_t length = strlen(pWord);
+			if (((size_t)(m_end - m_p) < length) || (strncmp(m_p, pWord, length) != 0))
+			{
+				return(false);
+			}
+			m_p += length;
+			return(true);
+		}
+
+		bool ParseValue(JSON_VALUE& value, int depth)
+		{
+			if (depth > g_MaxDepth)
+			{
+				return(false);
+			}
+
+			SkipSpaces();
+			if (m_p >= m_end)
+			{
+				return(false);
+			}
+
+			switch (*m_p)
+			{
+			case '{':
+				return(ParseObject(value, depth));
+			case '[':
+				return(ParseArray(value, depth));
+			case '"':
+				value.type = JSON_VALUE::JSON_STRING;
+				return(ParseString(value.text));
+			case 't':
+				value.type = JSON_VALUE::JSON_BOOL;
+				value.number = 1.0;
+				return(Match("true"));
+			case 'f':
+				value.type = JSON_VALUE::JSON_BOOL;
+				value.number = 0.0;
+				return(Match("false"));
+			case 'n':
+				value.type = JSON_VALUE::JSON_NULL;
+				return(Match("null"));
+			default:
+				value.type = JSON_VALUE::JSON_NUMBER;
+				return(ParseNumber(value.number));
+			}
+		}
+
+		bool ParseObject(JSON_VALUE& value, int depth)
+		{
+			value.type = JSON_VALUE::JSON_OBJECT;
+			m_p++;
+
+			SkipSpaces();
+			if ((m_p < m_end) && (*m_p == '}'))
+			{
+				m_p++;
+				return(true);
+			}
+
+			while (m_p < m_end)
+			{
+				SkipSpaces();
+				std::string key;
+				if ((m_p >= m_end) || (*m_p != '"') || (false == ParseString(key)))
+				{
+					return(false);
+				}
+				SkipSpaces();
+				if ((m_p >= m_end) || (*m_p != ':'))
+				{
+					return(false);
+				}
+				m_p++;
+
+				value.keys.push_back(key);
+				value.items.push_back(JSON_VALUE());
+				if (false == ParseValue(value.items.back(), depth + 1))
+				{
+					return(false);
+				}
+
+				SkipSpaces();
+				if ((m_p < m_end) && (*m_p == ','))
+				{
+					m_p++;
+				}
+				else if ((m_p < m_end) && (*m_p == '}'))
+				{
+					m_p++;
+					return(true);
+				}
+				else
+				{
+					return(false);
+				}
+			}
+
+			return(false);
+		}
+
+		bool ParseArray(JSON_VALUE& value, int depth)
+		{
+			value.type = JSON_VALUE::JSON_ARRAY;
+			m_p++;
+
+			SkipSpaces();
+			if ((m_p < m_end) && (*m_p == ']'))
+			{
+				m_p++;
+				return(true);
+			}
+
+			while (m_p < m_end)
+			{
+				value.items.push_back(JSON_VALUE());
+				if (false == ParseValue(value.items.back(), depth + 1))
+				{
+					return(false);
+				}
+
+				SkipSpaces();
+				if ((m_p < m_end) && (*m_p == ','))
+				{
+					m_p++;
+				}
+				else if ((m_p < m_end) && (*m_p == ']'))
+				{
+					m_p++;
+					return(true);
+				}
+				else
+				{
+					return(false);
+				}
+			}
+
+			return(false);
+		}
+
+		bool ParseString(std::string& text)
+		{
+			m_p++;
+			while (m_p < m_end)
+			{
+				char c = *m_p++;
+				if (c == '"')
+				{
+					return(true);
+				}
+				if (c != '\\')
+				{
+					text.push_back(c);
+					continue;
+				}
+				if (m_p >= m_end)
+				{
+					return(false);
+				}
+
+				c = *m_p++;
+				switch (c)
+				{
+				case 'b': text.push_back('\b'); break;
+				case 'f': text.push_back('\f'); break;
+				case 'n': text.push_back('\n'); break;
+				case 'r': text.push_back('\r'); break;
+				case 't': text.push_back('\t'); break;
+				case 'u':
+				{
+					// the names and URIs that are read are plain
+					// ASCII, so only the basic plane is encoded
+					if (m_end - m_p < 4)
+					{
+						return(false);
+					}
+					unsigned int codePoint = 0;
+					for (int i = 0; i < 4; i++)
+					{
+						char h = *m_p++;
+						codePoint <<= 4;
+						if ((h >= '0') && (h <= '9')) codePoint |= (unsigned int)(h - '0');
+						else if ((h >= 'a') && (h <= 'f')) codePoint |= (unsigned int)(h - 'a' + 10);
+						else if ((h >= 'A') && (h <= 'F')) codePoint |= (unsigned int)(h - 'A' + 10);
+						else return(false);
+					}
+					if (codePoint < 0x80)
+					{
+						text.push_back((char)codePoint);
+					}
+					else if (codePoint < 0x800)
+					{
+						text.push_back((char)(0xC0 | (codePoint >> 6)));
+						text.push_back((char)(0x80 | (codePoint & 0x3F)));
+					}
+					else
+					{
+						text.push_back((char)(0xE0 | (codePoint >> 12)));
+						text.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+						text.push_back((char)(0x80 | (codePoint & 0x3F)));
+					}
+					break;
+				}
+				default:
+					text.push_back(c);
+					break;
+				}
+			}
+
+			return(false);
+		}
+
+		bool ParseNumber(double& number)
+		{
+			const char* pStart = m_p;
+			while ((m_p < m_end) &&
+				(((*m_p >= '0') && (*m_p <= '9')) ||
+				(*m_p == '-') || (*m_p == '+') || (*m_p == '.') || (*m_p == 'e') || (*m_p == 'E')))
+			{
+				m_p++;
+			}
+			if (m_p == pStart)
+			{
+				return(false);
+			}
+
+			std::string digits(pStart, m_p);
+			char* pEnd = NULL;
+			number = strtod(digits.c_str(), &pEnd);
+			return(pEnd == digits.c_str() + digits.size());
+		}
+	};
+
+	/***********************************************************
+	 *  SkipSpaces()
+	 *
+	 *  This function is used for skipping the spaces and tabs
+	 *  inside an OBJ line.
+	 ***********************************************************/
+	inline void SkipSpaces(const char*& p, const char* end)
+	{
+		while ((p < end) && ((*p == ' ') || (*p == '\t')))
+		{
+			p++;
+		}
+	}
+
+	/***********************************************************
+	 *  ParseFloat()
+	 *
+	 *  This function is used for reading a decimal number from
+	 *  an OBJ file.  It is much faster than strtod, which has
+	 *  to handle the locale and every special case, and is
+	 *  exact enough for single precision.
+	 ***********************************************************/
+	float ParseFloat(const char*& p, const char* end)
+	{
+		static const double powers[] =
+		{
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+			1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18
+		};
+
+		SkipSpaces(p, end);
+
+		bool bNegative = false;
+		if ((p < end) && ((*p == '-') || (*p == '+')))
+		{
+			bNegative = (*p == '-');
+			p++;
+		}
+
+		// collect up to 18 significant digits as an integer
+		uint64_t mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		while ((p < end) && (*p >= '0') && (*p <= '9'))
+		{
+			if (digits < 18)
+			{
+				mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+				digits += (mantissa != 0) ? 1 : 0;
+			}
+			else
+			{
+				exponent++;
+			}
+			p++;
+		}
+		if ((p < end) && (*p == '.'))
+		{
+			p++;
+			while ((p < end) && (*p >= '0') && (*p <= '9'))
+			{
+				if (digits < 18)
+				{
+					mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+					digits += (mantissa != 0) ? 1 : 0;
+					exponent--;
+				}
+				p++;
+			}
+		}
+		if ((p < end) && ((*p == 'e') || (*p == 'E')))
+		{
+			p++;
+			bool bNegativeExponent = false;
+			if ((p < end) && ((*p == '-') || (*p == '+')))
+			{
+				bNegativeExponent = (*p == '-');
+				p++;
+			}
+			int value = 0;
+			while ((p < end) && (*p >= '0') && (*p <= '9'))
+			{
+				if (value < 1000)
+				{
+					value = value * 10 + (*p - '0');
+				}
+				p++;
+			}
+			exponent += (true == bNegativeExponent) ? -value : value;
+		}
+
+		double result = (double)mantissa;
+		if ((exponent >= 0) && (exponent <= 18))
+		{
+			result *= powers[exponent];
+		}
+		else if ((exponent < 0) && (exponent >= -18))
+		{
+			result /= powers[-exponent];
+		}
+		else
+		{
+			result *= pow(10.0, (double)exponent);
+		}
+
+		return((float)((true == bNegative) ? -result : result));
+	}
+
+	/***********************************************************
+	 *  ParseInt()
+	 *
+	 *  This function is used for reading a signed index of an
+	 *  OBJ face.  Zero is returned when there is no number.
+	 ***********************************************************/
+	long ParseInt(const char*& p, const char* end)
+	{
+		bool bNegative = false;
+		if ((p < end) && (*p == '-'))
+		{
+			bNegative = true;
+			p++;
+		}
+
+		long value = 0;
+		while ((p < end) && (*p >= '0') && (*p <= '9'))
+		{
+			value = value * 10 + (*p - '0');
+			p++;
+		}
+
+		return((true == bNegative) ? -value : value);
+	}
+
+	/***********************************************************
+	 *  ResolveIndex()
+	 *
+	 *  This function is used for turning a one based or
+	 *  negative relative OBJ index into a zero based index.
+	 ***********************************************************/
+	bool ResolveIndex(long index, size_t count, uint32_t& resolved)
+	{
+		if (index > 0)
+		{
+			resolved = (uint32_t)(index - 1);
+		}
+		else if (index < 0)
+		{
+			resolved = (uint32_t)((long)count + index);
+		}
+		else
+		{
+			return(false);
+		}
+
+		return((size_t)resolved < count);
+	}
+
+	/***********************************************************
+	 *  AddFaceNormal()
+	 *
+	 *  This function is used for adding the area weighted
+	 *  normal of a triangle to a normal sum.
+	 ***********************************************************/
+	void AddFaceNormal(
+		const float a[3],
+		const float b[3],
+		const float c[3],
+		float normal[3])
+	{
+		float ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		float ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+		normal[0] += ab[1] * ac[2] - ab[2] * ac[1];
+		normal[1] += ab[2] * ac[0] - ab[0] * ac[2];
+		normal[2] += ab[0] * ac[1] - ab[1] * ac[0];
+	}
+
+	/***********************************************************
+	 *  Normalize()
+	 *
+	 *  This function is used for normalizing a normal, falling
+	 *  back to straight up for degenerate ones.
+	 ***********************************************************/
+	void Normalize(float normal[3])
+	{
+		float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 1e-20f)
+		{
+			normal[0] /= length;
+			normal[1] /= length;
+			normal[2] /= length;
+		}
+		else
+		{
+			normal[0] = 0.0f;
+			normal[1] = 1.0f;
+			normal[2] = 0.0f;
+		}
+	}
+
+	/***********************************************************
+	 *  GenerateNormals()
+	 *
+	 *  This function is used for giving the vertices added
+	 *  since firstVertex smooth normals, from the triangles
+	 *  added since firstIndex.
+	 ***********************************************************/
+	void GenerateNormals(MESH_DATA& mesh, size_t firstVertex, size_t firstIndex)
+	{
+		for (size_t i = firstVertex; i < mesh.vertices.size(); i++)
+		{
+			mesh.vertices[i].normal[0] = 0.0f;
+			mesh.vertices[i].normal[1] = 0.0f;
+			mesh.vertices[i].normal[2] = 0.0f;
+		}
+
+		for (size_t i = firstIndex; i + 2 < mesh.indices.size(); i += 3)
+		{
+			GENERATED_VERTEX& a = mesh.vertices[mesh.indices[i]];
+			GENERATED_VERTEX& b = mesh.vertices[mesh.indices[i + 1]];
+			GENERATED_VERTEX& c = mesh.vertices[mesh.indices[i + 2]];
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+
+			AddFaceNormal(a.position, b.position, c.position, normal);
+			for (int k = 0; k < 3; k++)
+			{
+				a.normal[k] += normal[k];
+				b.normal[k] += normal[k];
+				c.normal[k] += normal[k];
+			}
+		}
+
+		for (size_t i = firstVertex; i < mesh.vertices.size(); i++)
+		{
+			Normalize(mesh.vertices[i].normal);
+		}
+	}
+
+	/***********************************************************
+	 *  DecodeBase64()
+	 *
+	 *  This function is used for decoding the data URIs that
+	 *  glTF files can embed their buffers in.
+	 ***********************************************************/
+	bool DecodeBase64(const std::string& text, size_t start, std::vector<unsigned char>& data)
+	{
+		uint32_t bits = 0;
+		int bitCount = 0;
+
+		for (size_t i = start; i < text.size(); i++)
+		{
+			char c = text[i];
+			int value = -1;
+			if ((c >= 'A') && (c <= 'Z')) value = c - 'A';
+			else if ((c >= 'a') && (c <= 'z')) value = c - 'a' + 26;
+			else if ((c >= '0') && (c <= '9')) value = c - '0' + 52;
+			else if (c == '+') value = 62;
+			else if (c == '/') value = 63;
+			else if (c == '=') break;
+			else return(false);
+
+			bits = (bits << 6) | (uint32_t)value;
+			bitCount += 6;
+			if (bitCount >= 8)
+			{
+				bitCount -= 8;
+				data.push_back((unsigned char)((bits >> bitCount) & 0xFF));
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  DecodeURI()
+	 *
+	 *  This function is used for turning the percent escapes
+	 *  in a relative buffer URI back into characters.
+	 ***********************************************************/
+	std::string DecodeURI(const std::string& uri)
+	{
+		std::string path;
+		for (size_t i = 0; i < uri.size(); i++)
+		{
+			if ((uri[i] == '%') && (i + 2 < uri.size()))
+			{
+				path.push_back((char)strtol(uri.substr(i + 1, 2).c_str(), NULL, 16));
+				i += 2;
+			}
+			else
+			{
+				path.push_back(uri[i]);
+			}
+		}
+		return(path);
+	}
+
+	/***********************************************************
+	 *  GLTF_FILE
+	 *
+	 *  Parsed glTF document and the contents of its buffers.
+	 ***********************************************************/
+	struct GLTF_FILE
+	{
+		JSON_VALUE root;
+		std::vector<std::vector<unsigned char> > buffers;
+	};
+
+	/***********************************************************
+	 *  LoadGLTFBuffers()
+	 *
+	 *  This function is used for reading every buffer of a
+	 *  glTF document, from the GLB binary chunk, a data URI,
+	 *  or a file next to the document.
+	 ***********************************************************/
+	bool LoadGLTFBuffers(
+		GLTF_FILE& file,
+		const std::string& directory,
+		const unsigned char* pBinaryChunk,
+		size_t binaryChunkSize)
+	{
+		const JSON_VALUE* pBuffers = file.root.Find("buffers");
+		if (NULL == pBuffers)
+		{
+			return(true);
+		}
+
+		file.buffers.resize(pBuffers->items.size());
+		for (size_t i = 0; i < pBuffers->items.size(); i++)
+		{
+			const JSON_VALUE& buffer = pBuffers->items[i];
+			std::string uri = buffer.GetString("uri");
+			std::vector<unsigned char>& data = file.buffers[i];
+
+			if (uri.empty())
+			{
+				// only the first buffer of a GLB file may have no URI
+				if ((i != 0) || (NULL == pBinaryChunk))
+				{
+					std::cout << "glTF buffer " << i << " has no data" << std::endl;
+					return(false);
+				}
+				data.assign(pBinaryChunk, pBinaryChunk + binaryChunkSize);
+			}
+			else if (uri.compare(0, 5, "data:") == 0)
+			{
+				size_t comma = uri.find(',');
+				if ((comma == std::string::npos) ||
+					(uri.rfind(";base64", comma) == std::string::npos) ||
+					(false == DecodeBase64(uri, comma + 1, data)))
+				{
+					std::cout << "glTF buffer " << i << " has an unsupported data URI" << std::endl;
+					return(false);
+				}
+			}
+			else
+			{
+				std::string bufferPath = directory + DecodeURI(uri);
+				MappedFile bufferFile;
+				if (false == bufferFile.Open(bufferPath.c_str()))
+				{
+					std::cout << "Could not open glTF buffer " << bufferPath << std::endl;
+					return(false);
+				}
+				data.assign(bufferFile.GetData(), bufferFile.GetData() + bufferFile.GetSize());
+			}
+
+			if (data.size() < (size_t)buffer.GetNumber("byteLength", 0.0))
+			{
+				std::cout << "glTF buffer " << i << " is shorter than its byteLength" << std::endl;
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ACCESSOR_VIEW
+	 *
+	 *  Location and format of the elements of a glTF accessor.
+	 ***********************************************************/
+	struct ACCESSOR_VIEW
+	{
+		const unsigned char* pData;
+		size_t stride;
+		size_t count;
+		int componentType;
+		int componentCount;
+		bool bNormalized;
+	};
+
+	/***********************************************************
+	 *  GetComponentSize()
+	 *
+	 *  This function is used for getting the byte size of a
+	 *  glTF component type, or zero for an unknown type.
+	 ***********************************************************/
+	size_t GetComponentSize(int componentType)
+	{
+		switch (componentType)
+		{
+		case 5120:	// byte
+		case 5121:	// unsigned byte
+			return(1);
+		case 5122:	// short
+		case 5123:	// unsigned short
+			return(2);
+		case 5125:	// unsigned int
+		case 5126:	// float
+			return(4);
+		default:
+			return(0);
+		}
+	}
+
+	/***********************************************************
+	 *  GetAccessorView()
+	 *
+	 *  This function is used for finding the elements of a glTF
+	 *  accessor inside its buffer, checking that all of them
+	 *  are inside the buffer.
+	 ***********************************************************/
+	bool GetAccessorView(const GLTF_FILE& file, int accessorIndex, ACCESSOR_VIEW& view)
+	{
+		const JSON_VALUE* pAccessors = file.root.Find("accessors");
+		const JSON_VALUE* pAccessor = (NULL != pAccessors) ? pAccessors->At(accessorIndex) : NULL;
+		if (NULL == pAccessor)
+		{
+			return(false);
+		}
+		if (NULL != pAccessor->Find("sparse"))
+		{
+			std::cout << "glTF sparse accessors are not supported" << std::endl;
+			return(false);
+		}
+
+		std::string type = pAccessor->GetString("type");
+		if (type == "SCALAR") view.componentCount = 1;
+		else if (type == "VEC2") view.componentCount = 2;
+		else if (type == "VEC3") view.componentCount = 3;
+		else if (type == "VEC4") view.componentCount = 4;
+		else return(false);
+
+		view.componentType = pAccessor->GetInt("componentType", 0);
+		view.count = (size_t)pAccessor->GetNumber("count", 0.0);
+		const JSON_VALUE* pNormalized = pAccessor->Find("normalized");
+		view.bNormalized = (NULL != pNormalized) && (pNormalized->number != 0.0);
+
+		size_t elementSize = GetComponentSize(view.componentType) * view.componentCount;
+		const JSON_VALUE* pBufferViews = file.root.Find("bufferViews");
+		const JSON_VALUE* pBufferView = (NULL != pBufferViews) ? pBufferViews->At(pAccessor->GetInt("bufferView", -1)) : NULL;
+		if ((0 == elementSize) || (NULL == pBufferView))
+		{
+			return(false);
+		}
+
+		int bufferIndex = pBufferView->GetInt("buffer", -1);
+		if ((bufferIndex < 0) || ((size_t)bufferIndex >= file.buffers.size()))
+		{
+			return(false);
+		}
+		const std::vector<unsigned char>& buffer = file.buffers[bufferIndex];
+
+		size_t viewOffset = (size_t)pBufferView->GetNumber("byteOffset", 0.0);
+		size_t viewLength = (size_t)pBufferView->GetNumber("byteLength", 0.0);
+		size_t accessorOffset = (size_t)pAccessor->GetNumber("byteOffset", 0.0);
+		view.stride = (size_t)pBufferView->GetNumber("byteStride", 0.0);
+		if (0 == view.stride)
+		{
+			view.stride = elementSize;
+		}
+
+		if ((viewOffset + viewLength > buffer.size()) ||
+			((view.count > 0) && (accessorOffset + (view.count - 1) * view.stride + elementSize > viewLength)))
+		{
+			std::cout << "glTF accessor " << accessorIndex << " reads past the end of its buffer" << std::endl;
+			return(false);
+		}
+
+		view.pData = buffer.data() + viewOffset + accessorOffset;
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadComponent()
+	 *
+	 *  This function is used for reading one component of an
+	 *  accessor element as a float.
+	 ***********************************************************/
+	float ReadComponent(const unsigned char* p, int componentType, bool bNormalized)
+	{
+		switch (componentType)
+		{
+		case 5120:
+		{
+			int8_t value = (int8_t)*p;
+			return((true == bNormalized) ? fmaxf(value / 127.0f, -1.0f) : (float)value);
+		}
+		case 5121:
+			return((true == bNormalized) ? *p / 255.0f : (float)*p);
+		case 5122:
+		{
+			int16_t value;
+			memcpy(&value, p, sizeof(value));
+			return((true == bNormalized) ? fmaxf(value / 32767.0f, -1.0f) : (float)value);
+		}
+		case 5123:
+		{
+			uint16_t value;
+			memcpy(&value, p, sizeof(value));
+			return((true == bNormalized) ? value / 65535.0f : (float)value);
+		}
+		case 5125:
+		{
+			uint32_t value;
+			memcpy(&value, p, sizeof(value));
+			return((float)value);
+		}
+		default:
+		{
+			float value;
+			memcpy(&value, p, sizeof(value));
+			return(value);
+		}
+		}
+	}
+
+	/***********************************************************
+	 *  ReadFloats()
+	 *
+	 *  This function is used for reading a glTF accessor into
+	 *  a float array with the passed in components per element.
+	 ***********************************************************/
+	bool ReadFloats(
+		const GLTF_FILE& file,
+		int accessorIndex,
+		int componentCount,
+		std::vector<float>& values)
+	{
+		ACCESSOR_VIEW view;
+		if ((false == GetAccessorView(file, accessorIndex, view)) ||
+			(view.componentCount < componentCount))
+		{
+			return(false);
+		}
+
+		size_t componentSize = GetComponentSize(view.componentType);
+		values.resize(view.count * componentCount);
+		for (size_t i = 0; i < view.count; i++)
+		{
+			const unsigned char* pElement = view.pData + i * view.stride;
+			for (int k = 0; k < componentCount; k++)
+			{
+				values[i * componentCount + k] = ReadComponent(pElement + k * componentSize, view.componentType, view.bNormalized);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadIndices()
+	 *
+	 *  This function is used for reading a glTF index accessor
+	 *  of 8, 16 or 32 bit indices.
+	 ***********************************************************/
+	bool ReadIndices(const GLTF_FILE& file, int accessorIndex, std::vector<uint32_t>& indices)
+	{
+		ACCESSOR_VIEW view;
+		if ((false == GetAccessorView(file, accessorIndex, view)) ||
+			(view.componentCount != 1) ||
+			((view.componentType != 5121) && (view.componentType != 5123) && (view.componentType != 5125)))
+		{
+			return(false);
+		}
+
+		indices.resize(view.count);
+		for (size_t i = 0; i < view.count; i++)
+		{
+			const unsigned char* pElement = view.pData + i * view.stride;
+			if (view.componentType == 5121)
+			{
+				indices[i] = *pElement;
+			}
+			else if (view.componentType == 5123)
+			{
+				uint16_t value;
+				memcpy(&value, pElement, sizeof(value));
+				indices[i] = value;
+			}
+			else
+			{
+				memcpy(&indices[i], pElement, sizeof(uint32_t));
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  MultiplyMatrix()
+	 *
+	 *  This function is used for multiplying two column major
+	 *  4x4 matrices.
+	 ***********************************************************/
+	void MultiplyMatrix(const float a[16], const float b[16], float result[16])
+	{
+		float product[16];
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				product[column * 4 + row] =
+					a[0 * 4 + row] * b[column * 4 + 0] +
+					a[1 * 4 + row] * b[column * 4 + 1] +
+					a[2 * 4 + row] * b[column * 4 + 2] +
+					a[3 * 4 + row] * b[column * 4 + 3];
+			}
+		}
+		memcpy(result, product, sizeof(product));
+	}
+
+	/***********************************************************
+	 *  GetNodeMatrix()
+	 *
+	 *  This function is used for getting the local transform
+	 *  of a glTF node, from its matrix or from its translation,
+	 *  rotation and scale.
+	 ***********************************************************/
+	void GetNodeMatrix(const JSON_VALUE& node, float matrix[16])
+	{
+		const JSON_VALUE* pMatrix = node.Find("matrix");
+		if ((NULL != pMatrix) && (pMatrix->items.size() == 16))
+		{
+			for (int i = 0; i < 16; i++)
+			{
+				matrix[i] = (float)pMatrix->items[i].number;
+			}
+			return;
+		}
+
+		float t[3] = { 0.0f, 0.0f, 0.0f };
+		float r[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		float s[3] = { 1.0f, 1.0f, 1.0f };
+		const JSON_VALUE* pTranslation = node.Find("translation");
+		const JSON_VALUE* pRotation = node.Find("rotation");
+		const JSON_VALUE* pScale = node.Find("scale");
+		for (int i = 0; (NULL != pTranslation) && (i < 3) && ((size_t)i < pTranslation->items.size()); i++)
+		{
+			t[i] = (float)pTranslation->items[i].number;
+		}
+		for (int i = 0; (NULL != pRotation) && (i < 4) && ((size_t)i < pRotation->items.size()); i++)
+		{
+			r[i] = (float)pRotation->items[i].number;
+		}
+		for (int i = 0; (NULL != pScale) && (i < 3) && ((size_t)i < pScale->items.size()); i++)
+		{
+			s[i] = (float)pScale->items[i].number;
+		}
+
+		float xx = r[0] * r[0], yy = r[1] * r[1], zz = r[2] * r[2];
+		float xy = r[0] * r[1], xz = r[0] * r[2], yz = r[1] * r[2];
+		float wx = r[3] * r[0], wy = r[3] * r[1], wz = r[3] * r[2];
+
+		matrix[0] = (1.0f - 2.0f * (yy + zz)) * s[0];
+		matrix[1] = 2.0f * (xy + wz) * s[0];
+		matrix[2] = 2.0f * (xz - wy) * s[0];
+		matrix[3] = 0.0f;
+		matrix[4] = 2.0f * (xy - wz) * s[1];
+		matrix[5] = (1.0f - 2.0f * (xx + zz)) * s[1];
+		matrix[6] = 2.0f * (yz + wx) * s[1];
+		matrix[7] = 0.0f;
+		matrix[8] = 2.0f * (xz + wy) * s[2];
+		matrix[9] = 2.0f * (yz - wx) * s[2];
+		matrix[10] = (1.0f - 2.0f * (xx + yy)) * s[2];
+		matrix[11] = 0.0f;
+		matrix[12] = t[0];
+		matrix[13] = t[1];
+		matrix[14] = t[2];
+		matrix[15] = 1.0f;
+	}
+
+	/***********************************************************
+	 *  AddGLTFPrimitive()
+	 *
+	 *  This function is used for transforming one triangle
+	 *  primitive of a glTF mesh into the imported mesh.
+	 ***********************************************************/
+	bool AddGLTFPrimitive(
+		const GLTF_FILE& file,
+		const JSON_VALUE& primitive,
+		const float matrix[16],
+		MESH_DATA& mesh)
+	{
+		const JSON_VALUE* pAttributes = primitive.Find("attributes");
+		if (NULL == pAttributes)
+		{
+			return(false);
+		}
+
+		std::vector<float> positions;
+		std::vector<float> normals;
+		std::vector<float> textureCoordinates;
+		if (false == ReadFloats(file, pAttributes->GetInt("POSITION", -1), 3, positions))
+		{
+			std::cout << "glTF primitive has no readable POSITION attribute" << std::endl;
+			return(false);
+		}
+		size_t vertexCount = positions.size() / 3;
+
+		bool bNormals = (NULL != pAttributes->Find("NORMAL")) &&
+			(true == ReadFloats(file, pAttributes->GetInt("NORMAL", -1), 3, normals)) &&
+			(normals.size() == vertexCount * 3);
+		bool bTextureCoordinates = (NULL != pAttributes->Find("TEXCOORD_0")) &&
+			(true == ReadFloats(file, pAttributes->GetInt("TEXCOORD_0", -1), 2, textureCoordinates)) &&
+			(textureCoordinates.size() == vertexCount * 2);
+
+		std::vector<uint32_t> indices;
+		if (NULL != primitive.Find("indices"))
+		{
+			if (false == ReadIndices(file, primitive.GetInt("indices", -1), indices))
+			{
+				std::cout << "glTF primitive has unreadable indices" << std::endl;
+				return(false);
+			}
+		}
+		else
+		{
+			indices.resize(vertexCount);
+			for (size_t i = 0; i < vertexCount; i++)
+			{
+				indices[i] = (uint32_t)i;
+			}
+		}
+
+		// normals go through the inverse transpose of the upper
+		// 3x3, which is the cofactor matrix over the determinant
+		const float* m = matrix;
+		float cofactor[9] =
+		{
+			m[5] * m[10] - m[9] * m[6], m[9] * m[2] - m[1] * m[10], m[1] * m[6] - m[5] * m[2],
+			m[8] * m[6] - m[4] * m[10], m[0] * m[10] - m[8] * m[2], m[4] * m[2] - m[0] * m[6],
+			m[4] * m[9] - m[8] * m[5], m[8] * m[1] - m[0] * m[9], m[0] * m[5] - m[4] * m[1]
+		};
+		float determinant = m[0] * cofactor[0] + m[4] * cofactor[1] + m[8] * cofactor[2];
+		float normalSign = (determinant < 0.0f) ? -1.0f : 1.0f;
+
+		size_t firstVertex = mesh.vertices.size();
+		size_t firstIndex = mesh.indices.size();
+		mesh.vertices.resize(firstVertex + vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
+		{
+			GENERATED_VERTEX& vertex = mesh.vertices[firstVertex + i];
+			const float* p = &positions[i * 3];
+
+			for (int k = 0; k < 3; k++)
+			{
+				vertex.position[k] = m[k] * p[0] + m[4 + k] * p[1] + m[8 + k] * p[2] + m[12 + k];
+			}
+			if (true == bNormals)
+			{
+				const float* n = &normals[i * 3];
+				for (int k = 0; k < 3; k++)
+				{
+					vertex.normal[k] = normalSign * (cofactor[k * 3] * n[0] + cofactor[k * 3 + 1] * n[1] + cofactor[k * 3 + 2] * n[2]);
+				}
+				Normalize(vertex.normal);
+			}
+			// glTF puts the texture origin at the top left, and
+			// the textures are loaded bottom row first
+			vertex.textureCoordinate[0] = (true == bTextureCoordinates) ? textureCoordinates[i * 2] : 0.0f;
+			vertex.textureCoordinate[1] = (true == bTextureCoordinates) ? 1.0f - textureCoordinates[i * 2 + 1] : 0.0f;
+		}
+
+		// a mirroring transform turns the triangles inside out
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			uint32_t a = indices[i];
+			uint32_t b = indices[i + 1];
+			uint32_t c = indices[i + 2];
+			if ((a >= vertexCount) || (b >= vertexCount) || (c >= vertexCount))
+			{
+				std::cout << "glTF primitive has an index past the end of its vertices" << std::endl;
+				mesh.vertices.resize(firstVertex);
+				mesh.indices.resize(firstIndex);
+				return(false);
+			}
+			if (determinant < 0.0f)
+			{
+				std::swap(b, c);
+			}
+			mesh.AddTriangle(
+				(uint32_t)firstVertex + a,
+				(uint32_t)firstVertex + b,
+				(uint32_t)firstVertex + c);
+		}
+
+		if (false == bNormals)
+		{
+			GenerateNormals(mesh, firstVertex, firstIndex);
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  AddGLTFNode()
+	 *
+	 *  This function is used for adding the mesh of a glTF node
+	 *  and of all its children.
+	 ***********************************************************/
+	bool AddGLTFNode(
+		const GLTF_FILE& file,
+		int nodeIndex,
+		const float parentMatrix[16],
+		int depth,
+		MESH_DATA& mesh,
+		int& skippedPrimitives)
+	{
+		const JSON_VALUE* pNodes = file.root.Find("nodes");
+		const JSON_VALUE* pNode = (NULL != pNodes) ? pNodes->At(nodeIndex) : NULL;
+		if ((NULL == pNode) || (depth > g_MaxDepth))
+		{
+			return(false);
+		}
+
+		float localMatrix[16];
+		float matrix[16];
+		GetNodeMatrix(*pNode, localMatrix);
+		MultiplyMatrix(parentMatrix, localMatrix, matrix);
+
+		const JSON_VALUE* pMeshes = file.root.Find("meshes");
+		const JSON_VALUE* pMesh = (NULL != pMeshes) ? pMeshes->At(pNode->GetInt("mesh", -1)) : NULL;
+		const JSON_VALUE* pPrimitives = (NULL != pMesh) ? pMesh->Find("primitives") : NULL;
+		for (size_t i = 0; (NULL != pPrimitives) && (i < pPrimitives->items.size()); i++)
+		{
+			const JSON_VALUE& primitive = pPrimitives->items[i];
+			if (primitive.GetInt("mode", g_GLTFTriangles) != g_GLTFTriangles)
+			{
+				skippedPrimitives++;
+				continue;
+			}
+			if (false == AddGLTFPrimitive(file, primitive, matrix, mesh))
+			{
+				return(false);
+			}
+		}
+
+		const JSON_VALUE* pChildren = pNode->Find("children");
+		for (size_t i = 0; (NULL != pChildren) && (i < pChildren->items.size()); i++)
+		{
+			if (false == AddGLTFNode(file, (int)pChildren->items[i].number, matrix, depth + 1, mesh, skippedPrimitives))
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetLowerExtension()
+	 *
+	 *  This function is used for getting the lower case file
+	 *  extension of a path, including the dot.
+	 ***********************************************************/
+	std::string GetLowerExtension(const char* filePath)
+	{
+		std::string path = filePath;
+		size_t dot = path.find_last_of('.');
+		size_t slash = path.find_last_of("/\\");
+		if ((dot == std::string::npos) || ((slash != std::string::npos) && (dot < slash)))
+		{
+			return(std::string());
+		}
+
+		std::string extension = path.substr(dot);
+		for (size_t i = 0; i < extension.size(); i++)
+		{
+			if ((extension[i] >= 'A') && (extension[i] <= 'Z'))
+			{
+				extension[i] = (char)(extension[i] - 'A' + 'a');
+			}
+		}
+		return(extension);
+	}
+}
+
+/***********************************************************
+ *  Import()
+ *
+ *  This method is used for importing an OBJ, glTF or GLB
+ *  file and optimizing the result for drawing.
+ ***********************************************************/
+bool MeshImporter::Import(const char* filePath, MESH_DATA& mesh)
+{
+	std::string extension = GetLowerExtension(filePath);
+	bool bImported = false;
+
+	mesh.vertices.clear();
+	mesh.indices.clear();
+
+	if (extension == ".obj")
+	{
+		bImported = ImportOBJ(filePath, mesh);
+	}
+	else if ((extension == ".gltf") || (extension == ".glb"))
+	{
+		bImported = ImportGLTF(filePath, mesh);
+	}
+	else
+	{
+		std::cout << "Unsupported mesh file type: " << filePath << std::endl;
+		return(false);
+	}
+
+	if ((false == bImported) || (mesh.indices.empty()))
+	{
+		std::cout << "Could not import any triangles from " << filePath << std::endl;
+		return(false);
+	}
+
+	OptimizeMesh(mesh);
+
+	return(true);
+}
+
+/***********************************************************
+ *  ImportOBJ()
+ *
+ *  This method is used for reading the positions, texture
+ *  coordinates, normals and faces of a Wavefront OBJ file.
+ *  The file is mapped and parsed in place, polygons are
+ *  split into triangle fans, and every face corner becomes
+ *  its own vertex until OptimizeMesh() merges them.  Faces
+ *  without normals are given smooth ones.
+ ***********************************************************/
+bool MeshImporter::ImportOBJ(const char* filePath, MESH_DATA& mesh)
+{
+	MappedFile file;
+	if (false == file.Open(filePath))
+	{
+		std::cout << "Could not open mesh file " << filePath << std::endl;
+		return(false);
+	}
+
+	std::vector<float> positions;
+	std::vector<float> textureCoordinates;
+	std::vector<float> normals;
+	// position index of every corner, and whether the corner
+	// still needs a generated normal
+	std::vector<uint32_t> cornerPositions;
+	std::vector<unsigned char> cornerNeedsNormal;
+	std::vector<uint32_t> faceCorners;
+	bool bMissingNormals = false;
+	size_t lineNumber = 0;
+
+	const char* p = (const char*)file.GetData();
+	const char* end = p + file.GetSize();
+	while (p < end)
+	{
+		lineNumber++;
+		SkipSpaces(p, end);
+
+		if ((end - p > 2) && (p[0] == 'v') && ((p[1] == ' ') || (p[1] == '\t')))
+		{
+			p += 2;
+			for (int i = 0; i < 3; i++)
+			{
+				positions.push_back(ParseFloat(p, end));
+			}
+		}
+		else if ((end - p > 3) && (p[0] == 'v') && (p[1] == 't') && ((p[2] == ' ') || (p[2] == '\t')))
+		{
+			p += 3;
+			for (int i = 0; i < 2; i++)
+			{
+				textureCoordinates.push_back(ParseFloat(p, end));
+			}
+		}
+		else if ((end - p > 3) && (p[0] == 'v') && (p[1] == 'n') && ((p[2] == ' ') || (p[2] == '\t')))
+		{
+			p += 3;
+			for (int i = 0; i < 3; i++)
+			{
+				normals.push_back(ParseFloat(p, end));
+			}
+		}
+		else if ((end - p > 2) && (p[0] == 'f') && ((p[1] == ' ') || (p[1] == '\t')))
+		{
+			p += 2;
+			faceCorners.clear();
+			for (;;)
+			{
+				SkipSpaces(p, end);
+				if ((p >= end) || (*p == '\n') || (*p == '\r') || (*p == '#'))
+				{
+					break;
+				}
+
+				long positionIndex = ParseInt(p, end);
+				long textureIndex = 0;
+				long normalIndex = 0;
+				if ((p < end) && (*p == '/'))
+				{
+					p++;
+					textureIndex = ParseInt(p, end);
+					if ((p < end) && (*p == '/'))
+					{
+						p++;
+						normalIndex = ParseInt(p, end);
+					}
+				}
+
+				GENERATED_VERTEX vertex = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f } };
+				uint32_t index = 0;
+				if (false == ResolveIndex(positionIndex, positions.size() / 3, index))
+				{
+					std::cout << filePath << "(" << lineNumber << "): face uses a missing position" << std::endl;
+					return(false);
+				}
+				memcpy(vertex.position, &positions[index * 3], sizeof(vertex.position));
+				cornerPositions.push_back(index);
+
+				if ((textureIndex != 0) &&
+					(true == ResolveIndex(textureIndex, textureCoordinates.size() / 2, index)))
+				{
+					memcpy(vertex.textureCoordinate, &textureCoordinates[index * 2], sizeof(vertex.textureCoordinate));
+				}
+
+				if ((normalIndex != 0) &&
+					(true == ResolveIndex(normalIndex, normals.size() / 3, index)))
+				{
+					memcpy(vertex.normal, &normals[index * 3], sizeof(vertex.normal));
+					cornerNeedsNormal.push_back(0);
+				}
+				else
+				{
+					cornerNeedsNormal.push_back(1);
+					bMissingNormals = true;
+				}
+
+				faceCorners.push_back((uint32_t)mesh.vertices.size());
+				mesh.vertices.push_back(vertex);
+
+				// stop at anything that is not a separator, so a
+				// malformed corner cannot stall the parser
+				if ((p < end) && (*p != ' ') && (*p != '\t') && (*p != '\r') && (*p != '\n'))
+				{
+					break;
+				}
+			}
+
+			for (size_t i = 2; i < faceCorners.size(); i++)
+			{
+				mesh.AddTriangle(faceCorners[0], faceCorners[i - 1], faceCorners[i]);
+			}
+		}
+
+		// everything else, such as groups and materials, is skipped
+		while ((p < end) && (*p != '\n'))
+		{
+			p++;
+		}
+		if (p < end)
+		{
+			p++;
+		}
+	}
+
+	if (true == bMissingNormals)
+	{
+		// smooth the generated normals across every corner that
+		// shares a position
+		std::vector<float> positionNormals(positions.size(), 0.0f);
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			float normal[3] = { 0.0f, 0.0f, 0.0f };
+			AddFaceNormal(
+				mesh.vertices[mesh.indices[i]].position,
+				mesh.vertices[mesh.indices[i + 1]].position,
+				mesh.vertices[mesh.indices[i + 2]].position,
+				normal);
+			for (int corner = 0; corner < 3; corner++)
+			{
+				float* pSum = &positionNormals[cornerPositions[mesh.indices[i + corner]] * 3];
+				pSum[0] += normal[0];
+				pSum[1] += normal[1];
+				pSum[2] += normal[2];
+			}
+		}
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			if (0 != cornerNeedsNormal[i])
+			{
+				memcpy(mesh.vertices[i].normal, &positionNormals[cornerPositions[i] * 3], sizeof(mesh.vertices[i].normal));
+				Normalize(mesh.vertices[i].normal);
+			}
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ImportGLTF()
+ *
+ *  This method is used for reading the triangle primitives
+ *  of a glTF 2.0 file, either the JSON form with external or
+ *  embedded buffers or the GLB binary form.  The meshes of
+ *  the default scene are baked into one mesh with their node
+ *  transforms applied.  Only the positions, normals and the
+ *  first texture coordinates are read.
+ ***********************************************************/
+bool MeshImporter::ImportGLTF(const char* filePath, MESH_DATA& mesh)
+{
+	MappedFile file;
+	if (false == file.Open(filePath))
+	{
+		std::cout << "Could not open mesh file " << filePath << std::endl;
+		return(false);
+	}
+
+	const unsigned char* pData = file.GetData();
+	size_t size = file.GetSize();
+	const char* pJSON = (const char*)pData;
+	size_t JSONSize = size;
+	const unsigned char* pBinaryChunk = NULL;
+	size_t binaryChunkSize = 0;
+
+	uint32_t magic = 0;
+	if (size >= sizeof(magic))
+	{
+		memcpy(&magic, pData, sizeof(magic));
+	}
+	if (g_GLBMagic == magic)
+	{
+		// GLB - 12 byte header, then the JSON chunk and an
+		// optional binary chunk
+		pJSON = NULL;
+		size_t offset = 12;
+		while (offset + 8 <= size)
+		{
+			uint32_t chunkHeader[2];
+			memcpy(chunkHeader, pData + offset, sizeof(chunkHeader));
+			offset += 8;
+			if (chunkHeader[0] > size - offset)
+			{
+				break;
+			}
+
+			if ((g_GLBChunkJSON == chunkHeader[1]) && (NULL == pJSON))
+			{
+				pJSON = (const char*)pData + offset;
+				JSONSize = chunkHeader[0];
+			}
+			else if ((g_GLBChunkBIN == chunkHeader[1]) && (NULL == pBinaryChunk))
+			{
+				pBinaryChunk = pData + offset;
+				binaryChunkSize = chunkHeader[0];
+			}
+			offset += (chunkHeader[0] + 3) & ~(size_t)3;
+		}
+		if (NULL == pJSON)
+		{
+			std::cout << filePath << " has no JSON chunk" << std::endl;
+			return(false);
+		}
+	}
+
+	GLTF_FILE gltf;
+	JSON_PARSER parser(pJSON, JSONSize);
+	if ((false == parser.Parse(gltf.root)) || (JSON_VALUE::JSON_OBJECT != gltf.root.type))
+	{
+		std::cout << filePath << " is not a valid glTF document" << std::endl;
+		return(false);
+	}
+
+	std::string directory = filePath;
+	size_t slash = directory.find_last_of("/\\");
+	directory = (slash == std::string::npos) ? std::string() : directory.substr(0, slash + 1);
+	if (false == LoadGLTFBuffers(gltf, directory, pBinaryChunk, binaryChunkSize))
+	{
+		return(false);
+	}
+
+	const float identity[16] =
+	{
+		1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+	int skippedPrimitives = 0;
+
+	const JSON_VALUE* pScenes = gltf.root.Find("scenes");
+	const JSON_VALUE* pScene = (NULL != pScenes) ? pScenes->At(gltf.root.GetInt("scene", 0)) : NULL;
+	const JSON_VALUE* pSceneNodes = (NULL != pScene) ? pScene->Find("nodes") : NULL;
+	if (NULL != pSceneNodes)
+	{
+		for (size_t i = 0; i < pSceneNodes->items.size(); i++)
+		{
+			if (false == AddGLTFNode(gltf, (int)pSceneNodes->items[i].number, identity, 0, mesh, skippedPrimitives))
+			{
+				std::cout << "Could not read the node hierarchy of " << filePath << std::endl;
+				return(false);
+			}
+		}
+	}
+	else
+	{
+		// without a scene every mesh is taken as it is
+		const JSON_VALUE* pMeshes = gltf.root.Find("meshes");
+		for (size_t i = 0; (NULL != pMeshes) && (i < pMeshes->items.size()); i++)
+		{
+			const JSON_VALUE* pPrimitives = pMeshes->items[i].Find("primitives");
+			for (size_t j = 0; (NULL != pPrimitives) && (j < pPrimitives->items.size()); j++)
+			{
+				const JSON_VALUE& primitive = pPrimitives->items[j];
+				if (primitive.GetInt("mode", g_GLTFTriangles) != g_GLTFTriangles)
+				{
+					skippedPrimitives++;
+				}
+				else if (false == AddGLTFPrimitive(gltf, primitive, identity, mesh))
+				{
+					return(false);
+				}
+			}
+		}
+	}
+
+	if (skippedPrimitives > 0)
+	{
+		std::cout << "Skipped " << skippedPrimitives << " glTF primitives that are not triangle lists" << std::endl;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This method is used for merging the identical vertices
+ *  of an imported mesh, reordering its triangles for the
+ *  vertex cache and its vertices for fetching, the same way
+ *  the scene meshes are optimized.
+ ***********************************************************/
+void MeshImporter::OptimizeMesh(MESH_DATA& mesh)
+{
+	uint32_t* pIndices = mesh.indices.data();
+	size_t indexCount = mesh.indices.size();
+	size_t vertexCount = mesh.vertices.size();
+
+	std::vector<uint32_t> remap;
+	std::vector<GENERATED_VERTEX> uniqueVertices(vertexCount);
+	uint32_t uniqueCount = MeshOptimizer::GenerateVertexRemap(
+		remap, mesh.vertices.data(), vertexCount, sizeof(GENERATED_VERTEX), pIndices, indexCount);
+	MeshOptimizer::RemapVertices(uniqueVertices.data(), mesh.vertices.data(), vertexCount, sizeof(GENERATED_VERTEX), remap);
+	MeshOptimizer::RemapIndices(pIndices, indexCount, remap);
+
+	MeshOptimizer::OptimizeVertexCache(pIndices, indexCount, uniqueCount);
+
+	uint32_t fetchCount = MeshOptimizer::GenerateFetchRemap(remap, pIndices, indexCount, uniqueCount);
+	MeshOptimizer::RemapVertices(mesh.vertices.data(), uniqueVertices.data(), uniqueCount, sizeof(GENERATED_VERTEX), remap);
+	MeshOptimizer::RemapIndices(pIndices, indexCount, remap);
+
+	mesh.vertices.resize(fetchCount);
+}
+
+/***********************************************************
+ *  GetBounds()
+ *
+ *  This method is used for getting the object space bounding
+ *  box of the vertices of a mesh.
+ ***********************************************************/
+void MeshImporter::GetBounds(const MESH_DATA& mesh, float boundsMin[3], float boundsMax[3])
+{
+	for (int k = 0; k < 3; k++)
+	{
+		boundsMin[k] = (mesh.vertices.empty()) ? 0.0f : mesh.vertices[0].position[k];
+		boundsMax[k] = boundsMin[k];
+	}
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		for (int k = 0; k < 3; k++)
+		{
+			boundsMin[k] = fminf(boundsMin[k], mesh.vertices[i].position[k]);
+			boundsMax[k] = fmaxf(boundsMax[k], mesh.vertices[i].position[k]);
+		}
+	}
+}
+
+/***********************************************************
+ *  GetCachePath()
+ *
+ *  This method is used for getting the path of the cache
+ *  file that is written next to a mesh file.
+ ***********************************************************/
+std::string MeshImporter::GetCachePath(const char* filePath)
+{
+	return(std::string(filePath) + ".meshcache");
+}
+
+/***********************************************************
+ *  BuildCache()
+ *
+ *  This method is used for laying out the cache contents of
+ *  an imported mesh - the header, then the aligned vertices
+ *  and indices.  The header records the size and write time
+ *  of the source file, so an edited source is imported
+ *  again.
+ ***********************************************************/
+void MeshImporter::BuildCache(const char* filePath, const MESH_DATA& mesh, std::vector<unsigned char>& cache)
+{
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_CacheMagic, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	MappedFile::GetFileInfo(filePath, header.sourceSize, header.sourceTime);
+	header.vertexCount = (uint32_t)mesh.vertices.size();
+	header.indexCount = (uint32_t)mesh.indices.size();
+	header.vertexOffset = (sizeof(CACHE_HEADER) + g_CacheAlignment - 1) & ~(g_CacheAlignment - 1);
+	uint32_t vertexBytes = header.vertexCount * (uint32_t)sizeof(GENERATED_VERTEX);
+	header.indexOffset = (header.vertexOffset + vertexBytes + g_CacheAlignment - 1) & ~(g_CacheAlignment - 1);
+	uint32_t indexBytes = header.indexCount * (uint32_t)sizeof(uint32_t);
+
+	GetBounds(mesh, header.boundsMin, header.boundsMax);
+
+	cache.assign(header.indexOffset + indexBytes, 0);
+	memcpy(cache.data(), &header, sizeof(header));
+	memcpy(cache.data() + header.vertexOffset, mesh.vertices.data(), vertexBytes);
+	memcpy(cache.data() + header.indexOffset, mesh.indices.data(), indexBytes);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for writing an imported mesh into
+ *  its cache file next to the source file.
+ ***********************************************************/
+bool MeshImporter::WriteCache(const char* filePath, const MESH_DATA& mesh)
+{
+	std::vector<unsigned char> cache;
+	BuildCache(filePath, mesh, cache);
+
+	std::string cachePath = GetCachePath(filePath);
+	// the cache may still be mapped by a load of the old version,
+	// so it is written next to it and then moved over it
+	std::string newCachePath = cachePath + ".new";
+	std::ofstream cacheFile(newCachePath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!cacheFile.is_open())
+	{
+		std::cout << "Could not write mesh cache " << cachePath << std::endl;
+		return(false);
+	}
+
+	cacheFile.write((const char*)cache.data(), cache.size());
+	cacheFile.close();
+
+	if ((cacheFile.fail()) ||
+		(false == MappedFile::ReplaceFile(newCachePath.c_str(), cachePath.c_str())))
+	{
+		std::cout << "Could not write mesh cache " << cachePath << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ValidateCache()
+ *
+ *  This method is used for checking the header of the cache
+ *  contents before they are used.  When the source file is
+ *  missing, or no file path is passed in because the cache
+ *  came from an asset pack, the cache is used as it is, so a
+ *  model can be shipped as just its cache.  The contents
+ *  must be at least 4 byte aligned.
+ ***********************************************************/
+const MeshImporter::CACHE_HEADER* MeshImporter::ValidateCache(const unsigned char* pCache, size_t cacheSize, const char* filePath)
+{
+	if ((NULL == pCache) || (cacheSize < sizeof(CACHE_HEADER)))
+	{
+		return(NULL);
+	}
+
+	const CACHE_HEADER* pHeader = (const CACHE_HEADER*)pCache;
+	if ((memcmp(pHeader->magic, g_CacheMagic, sizeof(pHeader->magic)) != 0) ||
+		(CACHE_VERSION != pHeader->version))
+	{
+		return(NULL);
+	}
+
+	uint64_t sourceSize = 0;
+	uint64_t sourceTime = 0;
+	if ((NULL != filePath) &&
+		(true == MappedFile::GetFileInfo(filePath, sourceSize, sourceTime)) &&
+		((sourceSize != pHeader->sourceSize) || (sourceTime != pHeader->sourceTime)))
+	{
+		return(NULL);
+	}
+
+	uint64_t vertexEnd = (uint64_t)pHeader->vertexOffset + (uint64_t)pHeader->vertexCount * sizeof(GENERATED_VERTEX);
+	uint64_t indexEnd = (uint64_t)pHeader->indexOffset + (uint64_t)pHeader->indexCount * sizeof(uint32_t);
+	if ((pHeader->vertexOffset < sizeof(CACHE_HEADER)) ||
+		((pHeader->vertexOffset % g_CacheAlignment) != 0) ||
+		((pHeader->indexOffset % g_CacheAlignment) != 0) ||
+		(pHeader->indexOffset < vertexEnd) ||
+		(vertexEnd > cacheSize) ||
+		(indexEnd > cacheSize) ||
+		(0 == pHeader->indexCount) ||
+		((pHeader->indexCount % 3) != 0))
+	{
+		return(NULL);
+	}
+
+	return(pHeader);
+}
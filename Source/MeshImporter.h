@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshimporter.h
+// ============
+// import authored meshes and cache them in a binary file
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGenerator.h"
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MeshImporter
+ *
+ *  This class converts Wavefront OBJ and glTF 2.0 files into
+ *  the interleaved vertex layout and 32 bit indices used by
+ *  the scene meshes, and runs them through the mesh
+ *  optimizer.  The result is written to a binary cache file
+ *  next to the source, laid out so that it can be mapped
+ *  into memory and handed to OpenGL without any parsing.
+ ***********************************************************/
+class MeshImporter
+{
+public:
+	// header at the start of a mesh cache file, followed by
+	// the vertices and then the indices
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		// size and last write time of the source file the
+		// cache was built from
+		uint64_t sourceSize;
+		uint64_t sourceTime;
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		// byte offsets from the start of the file
+		uint32_t vertexOffset;
+		uint32_t indexOffset;
+		// object space bounding box of the vertices
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// bumped whenever the cache layout or the import changes
+	static const uint32_t CACHE_VERSION = 1;
+
+	// import a mesh file, choosing the format by its extension
+	static bool Import(const char* filePath, MESH_DATA& mesh);
+	static bool ImportOBJ(const char* filePath, MESH_DATA& mesh);
+	static bool ImportGLTF(const char* filePath, MESH_DATA& mesh);
+
+	// deduplicate and reorder an imported mesh for the GPU
+	static void OptimizeMesh(MESH_DATA& mesh);
+	// object space bounding box of a mesh
+	static void GetBounds(const MESH_DATA& mesh, float boundsMin[3], float boundsMax[3]);
+
+	// path of the cache file built from a mesh file
+	static std::string GetCachePath(const char* filePath);
+	// lay out the cache file contents of an imported mesh
+	static void BuildCache(const char* filePath, const MESH_DATA& mesh, std::vector<unsigned char>& cache);
+	// write the cache file of an imported mesh
+	static bool WriteCache(const char* filePath, const MESH_DATA& mesh);
+	// check that cache contents are complete and, unless the
+	// file path is NULL, were built from the current version
+	// of the source file
+	static const CACHE_HEADER* ValidateCache(const unsigned char* pCache, size_t cacheSize, const char* filePath);
+};
@@ -0,0 +1,386 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// deduplicate and reorder indexed meshes for the GPU vertex caches
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <cstring>
+
+// storage for the constants that are passed by reference
+const uint32_t MeshOptimizer::CACHE_SIZE;
+const uint32_t MeshOptimizer::UNUSED_VERTEX;
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  HashVertex()
+	 *
+	 *  Hash the bytes of one vertex with FNV-1a.
+	 ***********************************************************/
+	uint32_t HashVertex(const unsigned char* pVertex, size_t vertexSize)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < vertexSize; i++)
+		{
+			hash ^= pVertex[i];
+			hash *= 16777619u;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  SkipDeadEnd()
+	 *
+	 *  Find the next vertex that still has triangles to emit,
+	 *  first from the recently used vertices and then in input
+	 *  order, or return UNUSED_VERTEX when every triangle has
+	 *  been emitted.
+	 ***********************************************************/
+	uint32_t SkipDeadEnd(
+		std::vector<uint32_t>& deadEndStack,
+		const std::vector<uint32_t>& liveTriangles,
+		uint32_t& inputCursor,
+		size_t vertexCount)
+	{
+		while (false == deadEndStack.empty())
+		{
+			uint32_t vertex = deadEndStack.back();
+			deadEndStack.pop_back();
+			if (liveTriangles[vertex] > 0)
+			{
+				return(vertex);
+			}
+		}
+
+		while (inputCursor < vertexCount)
+		{
+			if (liveTriangles[inputCursor] > 0)
+			{
+				return(inputCursor);
+			}
+			inputCursor++;
+		}
+
+		return(MeshOptimizer::UNUSED_VERTEX);
+	}
+}
+
+/***********************************************************
+ *  GenerateVertexRemap()
+ *
+ *  This method is used for building a table that maps every
+ *  vertex to its new index, so that vertices with identical
+ *  bytes share one index and vertices that no triangle uses
+ *  are dropped.  New indices are handed out in the order the
+ *  indices first reach each vertex.
+ ***********************************************************/
+uint32_t MeshOptimizer::GenerateVertexRemap(
+	std::vector<uint32_t>& remap,
+	const void* pVertices,
+	size_t vertexCount,
+	size_t vertexSize,
+	const uint32_t* pIndices,
+	size_t indexCount)
+{
+	const unsigned char* pBytes = (const unsigned char*)pVertices;
+
+	remap.assign(vertexCount, UNUSED_VERTEX);
+
+	// open addressing table of the first vertex seen with each
+	// distinct value, sized to stay at most half full
+	size_t tableSize = 1;
+	while (tableSize < (vertexCount * 2))
+	{
+		tableSize *= 2;
+	}
+	std::vector<uint32_t> table(tableSize, UNUSED_VERTEX);
+
+	uint32_t uniqueCount = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t vertex = pIndices[i];
+		if ((vertex >= vertexCount) || (UNUSED_VERTEX != remap[vertex]))
+		{
+			continue;
+		}
+
+		const unsigned char* pVertex = pBytes + (vertex * vertexSize);
+		size_t slot = HashVertex(pVertex, vertexSize) & (tableSize - 1);
+		while (UNUSED_VERTEX != table[slot])
+		{
+			uint32_t other = table[slot];
+			if (memcmp(pBytes + (other * vertexSize), pVertex, vertexSize) == 0)
+			{
+				break;
+			}
+			slot = (slot + 1) & (tableSize - 1);
+		}
+
+		if (UNUSED_VERTEX == table[slot])
+		{
+			table[slot] = vertex;
+			remap[vertex] = uniqueCount++;
+		}
+		else
+		{
+			remap[vertex] = remap[table[slot]];
+		}
+	}
+
+	return(uniqueCount);
+}
+
+/***********************************************************
+ *  GenerateFetchRemap()
+ *
+ *  This method is used for building a table that puts the
+ *  vertices in the order the indices first use them, so the
+ *  vertex fetches walk forward through memory.  It should
+ *  be run after the triangles have been reordered.
+ ***********************************************************/
+uint32_t MeshOptimizer::GenerateFetchRemap(
+	std::vector<uint32_t>& remap,
+	const uint32_t* pIndices,
+	size_t indexCount,
+	size_t vertexCount)
+{
+	remap.assign(vertexCount, UNUSED_VERTEX);
+
+	uint32_t nextVertex = 0;
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		uint32_t vertex = pIndices[i];
+		if ((vertex < vertexCount) && (UNUSED_VERTEX == remap[vertex]))
+		{
+			remap[vertex] = nextVertex++;
+		}
+	}
+
+	return(nextVertex);
+}
+
+/***********************************************************
+ *  RemapVertices()
+ *
+ *  This method is used for copying every used vertex to its
+ *  new place in the destination.  Vertices that were merged
+ *  write the same bytes to the same place.
+ ***********************************************************/
+void MeshOptimizer::RemapVertices(
+	void* pDestination,
+	const void* pVertices,
+	size_t vertexCount,
+	size_t vertexSize,
+	const std::vector<uint32_t>& remap)
+{
+	unsigned char* pDestinationBytes = (unsigned char*)pDestination;
+	const unsigned char* pSourceBytes = (const unsigned char*)pVertices;
+
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		if (UNUSED_VERTEX != remap[i])
+		{
+			memcpy(
+				pDestinationBytes + (remap[i] * vertexSize),
+				pSourceBytes + (i * vertexSize),
+				vertexSize);
+		}
+	}
+}
+
+/***********************************************************
+ *  RemapIndices()
+ *
+ *  This method is used for replacing every index with its
+ *  entry in the remap table.
+ ***********************************************************/
+void MeshOptimizer::RemapIndices(
+	uint32_t* pIndices,
+	size_t indexCount,
+	const std::vector<uint32_t>& remap)
+{
+	for (size_t i = 0; i < indexCount; i++)
+	{
+		pIndices[i] = remap[pIndices[i]];
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for reordering the triangles with
+ *  the Tipsify algorithm (Sander, Nehab and Barczak 2007).
+ *  It fans out around one vertex at a time, emitting all of
+ *  its remaining triangles, and then moves to the vertex
+ *  that is most likely still in the cache.  It runs in
+ *  linear time, so it is cheap enough for meshes generated
+ *  at load time.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(
+	uint32_t* pIndices,
+	size_t indexCount,
+	size_t vertexCount)
+{
+	size_t triangleCount = indexCount / 3;
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return;
+	}
+
+	// triangles still to be emitted around each vertex
+	std::vector<uint32_t> liveTriangles(vertexCount, 0);
+	for (size_t i = 0; i < (triangleCount * 3); i++)
+	{
+		liveTriangles[pIndices[i]]++;
+	}
+
+	// triangles using each vertex, packed one vertex after another
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (size_t vertex = 0; vertex < vertexCount; vertex++)
+	{
+		adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + liveTriangles[vertex];
+	}
+
+	std::vector<uint32_t> adjacency(adjacencyOffsets[vertexCount]);
+	std::vector<uint32_t> fillCounts(vertexCount, 0);
+	for (size_t triangle = 0; triangle < triangleCount; triangle++)
+	{
+		for (int corner = 0; corner < 3; corner++)
+		{
+			uint32_t vertex = pIndices[(triangle * 3) + corner];
+			adjacency[adjacencyOffsets[vertex] + fillCounts[vertex]++] = (uint32_t)triangle;
+		}
+	}
+
+	std::vector<uint32_t> output;
+	output.reserve(triangleCount * 3);
+	std::vector<bool> emitted(triangleCount, false);
+	// time each vertex last entered the simulated cache
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	std::vector<uint32_t> deadEndStack;
+	std::vector<uint32_t> candidates;
+	uint32_t time = CACHE_SIZE + 1;
+	uint32_t inputCursor = 0;
+
+	uint32_t fanVertex = SkipDeadEnd(deadEndStack, liveTriangles, inputCursor, vertexCount);
+	while (UNUSED_VERTEX != fanVertex)
+	{
+		candidates.clear();
+
+		// emit every remaining triangle around the fan vertex
+		for (uint32_t i = adjacencyOffsets[fanVertex]; i < adjacencyOffsets[fanVertex + 1]; i++)
+		{
+			uint32_t triangle = adjacency[i];
+			if (true == emitted[triangle])
+			{
+				continue;
+			}
+
+			for (int corner = 0; corner < 3; corner++)
+			{
+				uint32_t vertex = pIndices[(triangle * 3) + corner];
+				output.push_back(vertex);
+				deadEndStack.push_back(vertex);
+				candidates.push_back(vertex);
+				liveTriangles[vertex]--;
+
+				if ((time - cacheTimes[vertex]) > CACHE_SIZE)
+				{
+					cacheTimes[vertex] = time;
+					time++;
+				}
+			}
+			emitted[triangle] = true;
+		}
+
+		// prefer the candidate that has been in the cache longest
+		// while still being there after its own triangles are drawn
+		uint32_t nextVertex = UNUSED_VERTEX;
+		int bestPriority = -1;
+		for (size_t i = 0; i < candidates.size(); i++)
+		{
+			uint32_t vertex = candidates[i];
+			if (liveTriangles[vertex] == 0)
+			{
+				continue;
+			}
+
+			int priority = 0;
+			if (((time - cacheTimes[vertex]) + (2 * liveTriangles[vertex])) <= CACHE_SIZE)
+			{
+				priority = (int)(time - cacheTimes[vertex]);
+			}
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				nextVertex = vertex;
+			}
+		}
+
+		if (UNUSED_VERTEX == nextVertex)
+		{
+			nextVertex = SkipDeadEnd(deadEndStack, liveTriangles, inputCursor, vertexCount);
+		}
+		fanVertex = nextVertex;
+	}
+
+	memcpy(pIndices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This method is used for counting how many vertices a
+ *  FIFO post-transform cache of CACHE_SIZE entries would
+ *  have to shade for the passed in indices.
+ ***********************************************************/
+MeshOptimizer::VERTEX_CACHE_STATS MeshOptimizer::AnalyzeVertexCache(
+	const uint32_t* pIndices,
+	size_t indexCount,
+	size_t vertexCount)
+{
+	VERTEX_CACHE_STATS stats;
+	stats.ACMR = 0.0f;
+	stats.ATVR = 0.0f;
+
+	size_t triangleCount = indexCount / 3;
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return(stats);
+	}
+
+	// a vertex is still cached while fewer than CACHE_SIZE
+	// misses have happened since it was loaded
+	std::vector<uint32_t> cacheTimes(vertexCount, 0);
+	std::vector<bool> referenced(vertexCount, false);
+	uint32_t time = CACHE_SIZE + 1;
+	uint32_t misses = 0;
+	uint32_t referencedCount = 0;
+
+	for (size_t i = 0; i < (triangleCount * 3); i++)
+	{
+		uint32_t vertex = pIndices[i];
+		if ((time - cacheTimes[vertex]) > CACHE_SIZE)
+		{
+			cacheTimes[vertex] = time;
+			time++;
+			misses++;
+		}
+		if (false == referenced[vertex])
+		{
+			referenced[vertex] = true;
+			referencedCount++;
+		}
+	}
+
+	stats.ACMR = (float)misses / (float)triangleCount;
+	stats.ATVR = (float)misses / (float)referencedCount;
+
+	return(stats);
+}
@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// deduplicate and reorder indexed meshes for the GPU vertex caches
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class holds the steps used for optimizing indexed
+ *  triangle meshes after they are generated.  Identical
+ *  vertices are merged, the triangles are reordered so the
+ *  post-transform vertex cache is hit more often (Tipsify),
+ *  and the vertices are reordered into the order they are
+ *  first used so the vertex fetches stay sequential.  The
+ *  methods work on raw vertex bytes, so any vertex layout
+ *  can be passed in.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+	// vertex cache efficiency of an index buffer
+	struct VERTEX_CACHE_STATS
+	{
+		// average cache miss ratio - vertices shaded per triangle
+		float ACMR;
+		// average transformed vertex ratio - vertices shaded per
+		// vertex referenced, where 1.0 is the best possible
+		float ATVR;
+	};
+
+	// number of entries in the FIFO vertex cache that the
+	// triangle order is optimized and measured for
+	static const uint32_t CACHE_SIZE = 16;
+
+	// value of a remap table entry for an unused vertex
+	static const uint32_t UNUSED_VERTEX = 0xFFFFFFFF;
+
+	// build a remap table that merges binary identical vertices
+	// and drops the unused ones, and return the vertex count left
+	static uint32_t GenerateVertexRemap(
+		std::vector<uint32_t>& remap,
+		const void* pVertices,
+		size_t vertexCount,
+		size_t vertexSize,
+		const uint32_t* pIndices,
+		size_t indexCount);
+	// build a remap table that puts the vertices in the order
+	// the indices first use them, and return the vertex count
+	static uint32_t GenerateFetchRemap(
+		std::vector<uint32_t>& remap,
+		const uint32_t* pIndices,
+		size_t indexCount,
+		size_t vertexCount);
+
+	// apply a remap table to the vertices - the destination
+	// must not overlap the source
+	static void RemapVertices(
+		void* pDestination,
+		const void* pVertices,
+		size_t vertexCount,
+		size_t vertexSize,
+		const std::vector<uint32_t>& remap);
+	// apply a remap table to the indices in place
+	static void RemapIndices(
+		uint32_t* pIndices,
+		size_t indexCount,
+		const std::vector<uint32_t>& remap);
+
+	// reorder the triangles in place for the vertex cache
+	static void OptimizeVertexCache(
+		uint32_t* pIndices,
+		size_t indexCount,
+		size_t vertexCount);
+
+	// simulate the FIFO vertex cache over the indices
+	static VERTEX_CACHE_STATS AnalyzeVertexCache(
+		const uint32_t* pIndices,
+		size_t indexCount,
+		size_t vertexCount);
+};
@@ -8,6 +8,8 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "GLStateCache.h"
+#include "MeshImporter.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -16,14 +18,212 @@
 
 #include <glm/gtx/transform.hpp>
 
+#include <chrono>
+#include <iostream>
+
 // declaration of global variables
 namespace
 {
-	const char* g_ModelName = "model";
-	const char* g_ColorValueName = "objectColor";
-	const char* g_TextureValueName = "objectTexture";
-	const char* g_UseTextureName = "bUseTexture";
-	const char* g_UseLightingName = "bUseLighting";
+	// shader storage binding point of the material table
+	const GLuint g_MaterialBinding = 1;
+
+	// shader files the scene is drawn with
+	const char* g_VertexShaderPath = "shaders/vertexShader.glsl";
+	const char* g_FragmentShaderPath = "shaders/fragmentShader.glsl";
+	const char* g_CullShaderPath = "shaders/cullComputeShader.glsl";
+	// cache file of the precomputed environment lighting maps
+	const char* g_EnvironmentCachePath = "textures/environment.iblcache";
+	// cache file of the baked lightmap atlas
+	const char* g_LightmapCachePath = "textures/scene.lightmap";
+	// share of the light a textured surface bounces onto the
+	// others in the lightmap bake, since the texels of its
+	// image are not read on the CPU
+	const float g_TexturedAlbedo = 0.5f;
+
+	// number of scene objects handled by each recording job
+	const uint32_t g_DrawPacketBatchSize = 16;
+
+	// the object flags of the shader variant drawn in each
+	// pass of the recorded draw packets - opaque ones first
+	const uint8_t g_VariantPasses[] =
+	{
+		0,
+		ShaderVariants::VARIANT_TEXTURED,
+		ShaderVariants::VARIANT_TRANSPARENT,
+		ShaderVariants::VARIANT_TEXTURED | ShaderVariants::VARIANT_TRANSPARENT
+	};
+	const int g_VariantPassCount = sizeof(g_VariantPasses) / sizeof(g_VariantPasses[0]);
+
+	// conservative bounding spheres for the basic mesh shapes
+	// in their local space - xyz is the center, w is the radius
+	const glm::vec4 g_MeshBounds[MESH_TYPE_COUNT] =
+	{
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.42f),		// plane
+		glm::vec4(0.0f, 0.0f, 0.0f, 0.87f),		// box
+		glm::vec4(0.0f, 0.5f, 0.0f, 1.12f),		// cylinder
+		glm::vec4(0.0f, 0.5f, 0.0f, 1.12f),		// tapered cylinder
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.0f),		// sphere
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.25f),		// torus
+		glm::vec4(0.0f, 0.0f, 0.0f, 1.0f)		// prism
+	};
+
+	/***********************************************************
+	 *  BuildModelMatrix()
+	 *
+	 *  This function is used for building the model matrix
+	 *  from the passed in transformation values.
+	 ***********************************************************/
+	glm::mat4 BuildModelMatrix(
+		glm::vec3 scaleXYZ,
+		glm::vec3 rotationDegrees,
+		glm::vec3 positionXYZ)
+	{
+		glm::mat4 scale = glm::scale(scaleXYZ);
+		glm::mat4 rotationX = glm::rotate(glm::radians(rotationDegrees.x), glm::vec3(1.0f, 0.0f, 0.0f));
+		glm::mat4 rotationY = glm::rotate(glm::radians(rotationDegrees.y), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 rotationZ = glm::rotate(glm::radians(rotationDegrees.z), glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 translation = glm::translate(positionXYZ);
+
+		return(translation * rotationX * rotationY * rotationZ * scale);
+	}
+
+	/***********************************************************
+	 *  ExtractFrustumPlanes()
+	 *
+	 *  This function is used for getting the six clipping
+	 *  planes from the passed in view projection matrix.
+	 ***********************************************************/
+	void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			glm::vec4 row = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+			glm::vec4 lastRow = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+			planes[i * 2] = lastRow + row;
+			planes[i * 2 + 1] = lastRow - row;
+		}
+		for (int i = 0; i < 6; i++)
+		{
+			planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+		}
+	}
+
+	/***********************************************************
+	 *  GetWorldBounds()
+	 *
+	 *  This function is used for transforming the bounding
+	 *  sphere of a mesh into world space.
+	 ***********************************************************/
+	glm::vec4 GetWorldBounds(
+		glm::vec4 bounds,
+		const glm::mat4& model,
+		glm::vec3 scaleXYZ)
+	{
+		glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(bounds), 1.0f));
+		float maxScale = glm::max(glm::abs(scaleXYZ.x), glm::max(glm::abs(scaleXYZ.y), glm::abs(scaleXYZ.z)));
+
+		return(glm::vec4(center, bounds.w * maxScale));
+	}
+
+	/***********************************************************
+	 *  GetProjectedDiameter()
+	 *
+	 *  This function is used for estimating how many pixels a
+	 *  world space bounding sphere covers on screen, from the
+	 *  vertical scale and the depth of the view projection.
+	 ***********************************************************/
+	float GetProjectedDiameter(
+		glm::vec4 bounds,
+		const glm::mat4& viewProjection,
+		int viewportHeight)
+	{
+		glm::vec3 center = glm::vec3(bounds);
+		glm::vec3 yRow = glm::vec3(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1]);
+		glm::vec4 wRow = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+		float clipW = glm::dot(glm::vec3(wRow), center) + wRow.w;
+
+		// the camera is inside the sphere, so it fills the view
+		if (clipW <= bounds.w)
+		{
+			return((float)viewportHeight * 16.0f);
+		}
+
+		return(bounds.w * glm::length(yRow) * (float)viewportHeight / clipW);
+	}
+
+	/***********************************************************
+	 *  IsMeshInFrustum()
+	 *
+	 *  This function is used for testing the bounding sphere
+	 *  of a transformed mesh against the frustum planes.
+	 ***********************************************************/
+	bool IsMeshInFrustum(
+		glm::vec4 localBounds,
+		const glm::mat4& model,
+		glm::vec3 scaleXYZ,
+		const glm::vec4 planes[6])
+	{
+		glm::vec4 bounds = GetWorldBounds(localBounds, model, scaleXYZ);
+		glm::vec3 center = glm::vec3(bounds);
+		float radius = bounds.w;
+
+		for (int i = 0; i < 6; i++)
+		{
+			if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  BuildDrawRecord()
+	 *
+	 *  This function is used for filling in the per-draw shader
+	 *  values of a scene object.
+	 ***********************************************************/
+	DrawDataBuffer::DRAW_RECORD BuildDrawRecord(const SceneManager::SCENE_OBJECT& object)
+	{
+		DrawDataBuffer::DRAW_RECORD record;
+
+		record.model = BuildModelMatrix(
+			object.scaleXYZ,
+			object.rotationDegrees,
+			object.positionXYZ);
+		record.color = object.color;
+		record.UVscale = object.UVscale;
+		record.materialIndex = object.materialRecord;
+		record.padding[0] = 0;
+		record.padding[1] = 0;
+		record.padding[2] = 0;
+		record.lightmapScaleOffset = object.lightmapScaleOffset;
+
+		return(record);
+	}
+
+	/***********************************************************
+	 *  GetObjectVariant()
+	 *
+	 *  This function is used for getting the shader variant
+	 *  flags that depend on the scene object itself.
+	 ***********************************************************/
+	uint8_t GetObjectVariant(const SceneManager::SCENE_OBJECT& object)
+	{
+		uint8_t variant = 0;
+		if ((object.bUseTexture == true) && (object.textureSlot >= 0))
+		{
+			variant |= ShaderVariants::VARIANT_TEXTURED;
+		}
+		if (object.color.a < 1.0f)
+		{
+			variant |= ShaderVariants::VARIANT_TRANSPARENT;
+		}
+
+		return(variant);
+	}
 }
 
 /***********************************************************
@@ -31,9 +231,17 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager *pShaderManager)
+SceneManager::SceneManager(ShaderVariants* pShaderVariants, JobSystem* pJobSystem, const AssetPack* pAssetPack)
 {
-	m_pShaderManager = pShaderManager;
+	m_pShaderVariants = pShaderVariants;
+	m_bUseLighting = false;
+	m_lightCount = 0;
+	m_bPhysicallyBased = false;
+	m_pEnvironment = NULL;
+	m_bLightmaps = false;
+	m_pLightmaps = NULL;
+	m_pJobSystem = pJobSystem;
+	m_pAssetPack = pAssetPack;
 	m_basicMeshes = new ShapeMeshes();
 
 	// initialize the texture collection
@@ -43,6 +251,45 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 		m_textureIDs[i].ID = -1;
 	}
 	m_loadedTextures = 0;
+	m_pTextureStreamer = new TextureStreamer();
+
+	// default settings for the scene objects
+	m_pendingObject.mesh = MESH_BOX;
+	m_pendingObject.scaleXYZ = glm::vec3(1.0f, 1.0f, 1.0f);
+	m_pendingObject.rotationDegrees = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_pendingObject.positionXYZ = glm::vec3(0.0f, 0.0f, 0.0f);
+	m_pendingObject.bUseTexture = false;
+	m_pendingObject.textureSlot = -1;
+	m_pendingObject.UVscale = glm::vec2(1.0f, 1.0f);
+	m_pendingObject.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	m_pendingObject.materialIndex = -1;
+	m_pendingObject.materialRecord = 0;
+	m_pendingObject.importedMesh = -1;
+	m_pendingObject.lightmapScaleOffset = glm::vec4(0.0f);
+	for (int i = 0; i < MAX_VIEWS; i++)
+	{
+		m_viewProjections[i] = glm::mat4(1.0f);
+	}
+	m_viewCount = 1;
+	for (int i = 0; i < MAX_VIEWS; i++)
+	{
+		m_viewportHeights[i] = 0;
+	}
+
+	m_pDrawData = new DrawDataBuffer();
+	m_materialBufferID = 0;
+	m_bDrawPacketsRecorded = false;
+	m_bDrawDataMissingReported = false;
+
+	m_pSceneMeshes = NULL;
+	m_pGPURenderer = NULL;
+	m_bGPUDriven = false;
+	m_bSinglePassViews = true;
+	m_bPackedVertices = false;
+	m_meshDetail = 1;
+	m_mipFilter = TextureImporter::DEFAULT_FILTER;
+	m_bHotReload = false;
+	m_pFileWatcher = NULL;
 }
 
 /***********************************************************
@@ -52,323 +299,1426 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
  ***********************************************************/
 SceneManager::~SceneManager()
 {
-	m_pShaderManager = NULL;
+	// stop watching before the reloads still running are
+	// waited on and thrown away
+	delete m_pFileWatcher;
+	m_pFileWatcher = NULL;
+	for (size_t i = 0; i < m_assetReloads.size(); i++)
+	{
+		m_pJobSystem->Wait(&m_assetReloads[i]->job);
+		TextureStreamer::ReleaseMipChain(m_assetReloads[i]->mipChain);
+		delete m_assetReloads[i];
+	}
+	m_assetReloads.clear();
+
+	m_pShaderVariants = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	m_pJobSystem = NULL;
+	m_pAssetPack = NULL;
+	delete m_pDrawData;
+	m_pDrawData = NULL;
+	delete m_pGPURenderer;
+	m_pGPURenderer = NULL;
+	delete m_pSceneMeshes;
+	m_pSceneMeshes = NULL;
+	delete m_pEnvironment;
+	m_pEnvironment = NULL;
+	delete m_pLightmaps;
+	m_pLightmaps = NULL;
+	for (size_t i = 0; i < m_importedMeshes.size(); i++)
+	{
+		delete m_importedMeshes[i];
+	}
+	m_importedMeshes.clear();
+	if (0 != m_materialBufferID)
+	{
+		GLStateCache::ForgetBuffer(m_materialBufferID);
+		glDeleteBuffers(1, &m_materialBufferID);
+		m_materialBufferID = 0;
+	}
 	DestroyGLTextures();
+	delete m_pTextureStreamer;
+	m_pTextureStreamer = NULL;
 }
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for reserving the next available
+ *  texture slot for an image file and starting to load its
+ *  mip chain on the job system worker threads.  The mips are
+ *  read from the texture cache, or built from the image the
+ *  first time.  They are handed to the texture streamer
+ *  later, when UploadGLTextures() is called.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
+	if (m_loadedTextures >= 16)
+	{
+		std::cout << "Could not load image:" << filename << ", all texture slots are in use" << std::endl;
+		return false;
+	}
+
+	// reserve the texture slot and associate it with the special tag string
+	TEXTURE_IMAGE* pImage = &m_textureImages[m_loadedTextures];
+	pImage->filename = filename;
+	pImage->bDecoded = false;
+	pImage->bFromCache = false;
+	pImage->colorChannels = 0;
+	pImage->milliseconds = 0.0;
+	m_textureIDs[m_loadedTextures].ID = 0;
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_loadedTextures++;
+
+	// the image and its cache are read from the asset pack, or
+	// from the files when they are not packed
+	const AssetPack* pAssetPack = m_pAssetPack;
+	ImagePipeline::MIP_FILTER mipFilter = m_mipFilter;
+	m_pJobSystem->Execute([pImage, pAssetPack, mipFilter]()
+		{
+			std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+			pImage->bDecoded = TextureImporter::Load(
+				pImage->filename.c_str(),
+				pAssetPack,
+				mipFilter,
+				pImage->mipChain,
+				pImage->colorChannels,
+				pImage->bFromCache);
+			pImage->milliseconds = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - startTime).count();
+		}, &m_textureDecodeJobs);
+
+	return true;
+}
+
+/***********************************************************
+ *  UploadGLTextures()
+ *
+ *  This method is used for waiting on the texture images to
+ *  be loaded and handing their mip chains to the texture
+ *  streamer, which creates each texture with only its small
+ *  mips.  The larger mips are streamed in once the scene is
+ *  drawn.  Slots whose image could not be loaded are
+ *  released.
+ ***********************************************************/
+void SceneManager::UploadGLTextures()
+{
+	int loadedTextures = 0;
 
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
+	// the worker threads help finish the decoding while we wait
+	m_pJobSystem->Wait(&m_textureDecodeJobs);
 
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		TEXTURE_IMAGE& image = m_textureImages[i];
+
+		// if the image was not successfully read from the image file
+		if (false == image.bDecoded)
+		{
+			std::cout << "Could not load image:" << image.filename << std::endl;
+			TextureStreamer::ReleaseMipChain(image.mipChain);
+			continue;
+		}
+
+		std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.mipChain.levels[0].width << ", height:" << image.mipChain.levels[0].height << ", channels:" << image.colorChannels
+			<< ((true == image.bFromCache) ? ", cached mips in " : ", built mips in ") << image.milliseconds << " ms" << std::endl;
+
+		// the streamer takes over the mip chain, and its texture
+		// index always matches the slot
+		m_pTextureStreamer->AddTexture(image.mipChain);
+
+		// register the loaded texture, moving it down into any
+		// slot that was released by an earlier failed image
+		m_textureIDs[loadedTextures].ID = m_pTextureStreamer->GetTextureID(loadedTextures);
+		m_textureIDs[loadedTextures].tag = m_textureIDs[i].tag;
+		m_textureImages[loadedTextures].filename = image.filename;
+		loadedTextures++;
+	}
+
+	m_loadedTextures = loadedTextures;
+
+	std::cout << "Streaming " << m_loadedTextures << " textures, "
+		<< m_pTextureStreamer->GetResidentBytes() / 1024 << " KB resident at startup" << std::endl;
+}
+
+/***********************************************************
+ *  BindGLTextures()
+ *
+ *  This method is used for binding the loaded textures to
+ *  OpenGL texture memory slots.  There are up to 16 slots.
+ ***********************************************************/
+void SceneManager::BindGLTextures()
+{
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		// bind textures on corresponding texture units - units
+		// that already hold their texture are skipped
+		GLStateCache::BindTexture(i, GL_TEXTURE_2D, m_textureIDs[i].ID);
+	}
+}
+
+/***********************************************************
+ *  DestroyGLTextures()
+ *
+ *  This method is used for freeing the memory in all the
+ *  used texture memory slots.
+ ***********************************************************/
+void SceneManager::DestroyGLTextures()
+{
+	m_pTextureStreamer->Destroy();
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		m_textureIDs[i].ID = 0;
+	}
+	m_loadedTextures = 0;
+}
+
+/***********************************************************
+ *  UpdateTextureStreaming()
+ *
+ *  This method is used for requesting the texture mip each
+ *  textured object needs in every view it is visible in,
+ *  from the size of its bounding sphere on screen, and then
+ *  letting the streamer load or drop mips.  The texture
+ *  units are bound again when any texture was re-allocated.
+ ***********************************************************/
+void SceneManager::UpdateTextureStreaming()
+{
+	glm::vec4 frustumPlanes[MAX_VIEWS][6];
+	for (int view = 0; view < m_viewCount; view++)
+	{
+		ExtractFrustumPlanes(m_viewProjections[view], frustumPlanes[view]);
+	}
+
+	m_pTextureStreamer->BeginFrame();
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		// the albedo, normal and roughness textures of the
+		// object are all sampled at the same scale
+		const glm::ivec4& textureSet = m_materialRecords[object.materialRecord].textureSet;
+		if ((textureSet.x < 0) && (textureSet.y < 0) && (textureSet.z < 0))
+		{
+			continue;
+		}
+
+		glm::mat4 model = BuildModelMatrix(
+			object.scaleXYZ,
+			object.rotationDegrees,
+			object.positionXYZ);
+		glm::vec4 localBounds = GetLocalBounds(object);
+		glm::vec4 bounds = GetWorldBounds(localBounds, model, object.scaleXYZ);
+		float uvScale = glm::max(object.UVscale.x, object.UVscale.y);
+
+		for (int view = 0; view < m_viewCount; view++)
+		{
+			if (false == IsMeshInFrustum(localBounds, model, object.scaleXYZ, frustumPlanes[view]))
+			{
+				continue;
+			}
+
+			float diameter = GetProjectedDiameter(bounds, m_viewProjections[view], m_viewportHeights[view]);
+			for (int texture = 0; texture < 3; texture++)
+			{
+				if (textureSet[texture] >= 0)
+				{
+					m_pTextureStreamer->RequestFootprint(textureSet[texture], uvScale, diameter);
+				}
+			}
+		}
+	}
+
+	if (true == m_pTextureStreamer->Update())
+	{
+		for (int i = 0; i < m_loadedTextures; i++)
+		{
+			m_textureIDs[i].ID = m_pTextureStreamer->GetTextureID(i);
+		}
+		BindGLTextures();
+	}
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(std::string tag)
+{
+	int textureID = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureID = m_textureIDs[index].ID;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting a slot index for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureSlot(std::string tag)
+{
+	int textureSlot = -1;
+	int index = 0;
+	bool bFound = false;
+
+	while ((index < m_loadedTextures) && (bFound == false))
+	{
+		if (m_textureIDs[index].tag.compare(tag) == 0)
+		{
+			textureSlot = index;
+			bFound = true;
+		}
+		else
+			index++;
+	}
+
+	return(textureSlot);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a material
+ *  in the previously defined materials list that is
+ *  associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(std::string tag)
+{
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		if (m_objectMaterials[index].tag.compare(tag) == 0)
+		{
+			return(index);
+		}
+	}
+
+	return(-1);
+}
+
+/***********************************************************
+ *  MakeTextureSet()
+ *
+ *  This method is used for getting the texture slots of the
+ *  passed in texture tags for a material.  Tags that are not
+ *  loaded are reported, and that texture is left out.
+ ***********************************************************/
+SceneManager::TEXTURE_SET SceneManager::MakeTextureSet(
+	const char* albedoTag,
+	const char* normalTag,
+	const char* roughnessTag)
+{
+	const char* tags[3] = { albedoTag, normalTag, roughnessTag };
+	int slots[3] = { -1, -1, -1 };
+
+	for (int i = 0; i < 3; i++)
+	{
+		if (NULL == tags[i])
+		{
+			continue;
+		}
+
+		slots[i] = FindTextureSlot(tags[i]);
+		if (slots[i] < 0)
+		{
+			std::cout << "Material texture \"" << tags[i] << "\" is not loaded" << std::endl;
+		}
+	}
+
+	TEXTURE_SET textures;
+	textures.albedoSlot = slots[0];
+	textures.normalSlot = slots[1];
+	textures.roughnessSlot = slots[2];
+
+	return(textures);
+}
+
+/***********************************************************
+ *  FindMaterialRecord()
+ *
+ *  This method is used for getting the material table entry
+ *  that pairs the material of an object with its texture.
+ *  Objects that share both share the entry, so the table
+ *  only grows with the pairings the scene really uses.
+ ***********************************************************/
+uint16_t SceneManager::FindMaterialRecord(const SCENE_OBJECT& object)
+{
+	int materialIndex = glm::max(object.materialIndex, 0);
+	TEXTURE_SET textures = { -1, -1, -1 };
+	if (materialIndex < (int)m_objectMaterials.size())
+	{
+		textures = m_objectMaterials[materialIndex].textures;
+	}
+	if (true == object.bUseTexture)
+	{
+		textures.albedoSlot = object.textureSlot;
+	}
 
-	// if the image was successfully read from the image file
-	if (image)
+	// the slots are below 16, so each fits in 5 bits with
+	// room for the -1
+	uint64_t key = ((uint64_t)materialIndex << 15) |
+		((uint64_t)(textures.albedoSlot + 1) << 10) |
+		((uint64_t)(textures.normalSlot + 1) << 5) |
+		(uint64_t)(textures.roughnessSlot + 1);
+	std::unordered_map<uint64_t, uint16_t>::const_iterator found = m_materialRecordIndices.find(key);
+	if (found != m_materialRecordIndices.end())
+	{
+		return(found->second);
+	}
+
+	if ((int)m_materialRecords.size() >= MAX_MATERIAL_RECORDS)
+	{
+		std::cout << "The material table is full, drawing with the first material" << std::endl;
+		return(0);
+	}
+
+	MATERIAL_RECORD record;
+	if (materialIndex < (int)m_objectMaterials.size())
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[materialIndex];
+		record.ambientColorStrength = glm::vec4(material.ambientColor, material.ambientStrength);
+		record.diffuseColor = glm::vec4(material.diffuseColor, 0.0f);
+		record.specularColorShininess = glm::vec4(material.specularColor, material.shininess);
+		record.metallicRoughness = glm::vec4(material.metallic, material.roughness, 0.0f, 0.0f);
+	}
+	else
+	{
+		record.ambientColorStrength = glm::vec4(0.0f);
+		record.diffuseColor = glm::vec4(0.0f);
+		record.specularColorShininess = glm::vec4(0.0f);
+		record.metallicRoughness = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+	}
+	record.textureSet = glm::ivec4(textures.albedoSlot, textures.normalSlot, textures.roughnessSlot, -1);
+
+	uint16_t recordIndex = (uint16_t)m_materialRecords.size();
+	m_materialRecords.push_back(record);
+	m_materialRecordIndices[key] = recordIndex;
+
+	return(recordIndex);
+}
+
+/***********************************************************
+ *  ResolveObjectMaterial()
+ *
+ *  This method is used for giving an object the albedo
+ *  texture of its material when it has no texture of its
+ *  own, and the material table entry it is drawn with.
+ ***********************************************************/
+void SceneManager::ResolveObjectMaterial(SCENE_OBJECT& object)
+{
+	int materialIndex = glm::max(object.materialIndex, 0);
+	if ((false == object.bUseTexture) &&
+		(materialIndex < (int)m_objectMaterials.size()) &&
+		(m_objectMaterials[materialIndex].textures.albedoSlot >= 0))
+	{
+		object.bUseTexture = true;
+		object.textureSlot = m_objectMaterials[materialIndex].textures.albedoSlot;
+	}
+
+	object.materialRecord = FindMaterialRecord(object);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transformation values
+ *  of the next scene object that is added.
+ ***********************************************************/
+void SceneManager::SetTransformations(
+	glm::vec3 scaleXYZ,
+	float XrotationDegrees,
+	float YrotationDegrees,
+	float ZrotationDegrees,
+	glm::vec3 positionXYZ)
+{
+	m_pendingObject.scaleXYZ = scaleXYZ;
+	m_pendingObject.rotationDegrees = glm::vec3(
+		XrotationDegrees,
+		YrotationDegrees,
+		ZrotationDegrees);
+	m_pendingObject.positionXYZ = positionXYZ;
+}
+
+/***********************************************************
+ *  SetShaderColor()
+ *
+ *  This method is used for setting the passed in color
+ *  for the next scene object that is added.
+ ***********************************************************/
+void SceneManager::SetShaderColor(
+	float redColorValue,
+	float greenColorValue,
+	float blueColorValue,
+	float alphaValue)
+{
+	m_pendingObject.bUseTexture = false;
+	m_pendingObject.color = glm::vec4(
+		redColorValue,
+		greenColorValue,
+		blueColorValue,
+		alphaValue);
+}
+
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture associated
+ *  with the passed in tag for the next scene object.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	std::string textureTag)
+{
+	m_pendingObject.bUseTexture = true;
+	m_pendingObject.textureSlot = FindTextureSlot(textureTag);
+}
+
+/***********************************************************
+ *  SetTextureUVScale()
+ *
+ *  This method is used for setting the texture UV scale
+ *  values for the next scene object.
+ ***********************************************************/
+void SceneManager::SetTextureUVScale(float u, float v)
+{
+	m_pendingObject.UVscale = glm::vec2(u, v);
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for setting the material for the
+ *  next scene object.  The objects are defined while the
+ *  scene loads, so an unknown material is reported there
+ *  and the object keeps the previous material.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	std::string materialTag)
+{
+	int materialIndex = FindMaterialIndex(materialTag);
+	if (materialIndex < 0)
+	{
+		std::cout << "Unknown material \"" << materialTag << "\", keeping the previous material" << std::endl;
+		return;
+	}
+
+	m_pendingObject.materialIndex = materialIndex;
+}
+
+/***********************************************************
+ *  AddSceneObject()
+ *
+ *  This method is used for adding an object to the scene
+ *  using the transformation, color, texture and material
+ *  settings made since the previous object.  The settings
+ *  carry over to the next object, the same way the shader
+ *  values would.
+ ***********************************************************/
+void SceneManager::AddSceneObject(MESH_TYPE mesh)
+{
+	SCENE_OBJECT object = m_pendingObject;
+	object.mesh = mesh;
+	ResolveObjectMaterial(object);
+
+	m_sceneObjects.push_back(object);
+}
+
+/***********************************************************
+ *  AddImportedObject()
+ *
+ *  This method is used for adding an object that draws one
+ *  of the imported meshes, using the current settings.  Its
+ *  mesh type is MESH_TYPE_COUNT, which the culling shader
+ *  skips.
+ ***********************************************************/
+void SceneManager::AddImportedObject(int importedMesh)
+{
+	SCENE_OBJECT object = m_pendingObject;
+	object.mesh = MESH_TYPE_COUNT;
+	object.importedMesh = importedMesh;
+	ResolveObjectMaterial(object);
+
+	m_importedObjects.push_back((uint32_t)m_sceneObjects.size());
+	m_sceneObjects.push_back(object);
+}
+
+/***********************************************************
+ *  GetLocalBounds()
+ *
+ *  This method is used for getting the object space
+ *  bounding sphere of the mesh a scene object draws.
+ ***********************************************************/
+glm::vec4 SceneManager::GetLocalBounds(const SCENE_OBJECT& object) const
+{
+	if (object.importedMesh >= 0)
+	{
+		return(m_importedMeshes[object.importedMesh]->GetBoundingSphere());
+	}
+
+	return(g_MeshBounds[object.mesh]);
+}
+
+/***********************************************************
+ *  RecordDrawPackets()
+ *
+ *  This method is used for computing the model matrix of
+ *  every scene object, culling the objects against the
+ *  frustum of every view, and writing a draw packet for
+ *  each one.  The draw records read by the shaders are
+ *  written straight into the mapped per-draw buffer, once
+ *  for all the views.  The scene objects are split into
+ *  batches that run on the job system worker threads.
+ ***********************************************************/
+void SceneManager::RecordDrawPackets()
+{
+	glm::vec4 frustumPlanes[MAX_VIEWS][6];
+	for (int view = 0; view < m_viewCount; view++)
+	{
+		ExtractFrustumPlanes(m_viewProjections[view], frustumPlanes[view]);
+	}
+
+	// wait for the GPU to let go of the next frame region
+	DrawDataBuffer::DRAW_RECORD* pRecords = m_pDrawData->BeginFrame();
+	if (NULL == pRecords)
+	{
+		// the frame is skipped rather than drawn from records that
+		// were never written, and the packets are kept sized for
+		// the next frame
+		if (false == m_bDrawDataMissingReported)
+		{
+			std::cout << "The per-draw data buffer is not mapped, so the scene is not drawn" << std::endl;
+			m_bDrawDataMissingReported = true;
+		}
+		m_bDrawPacketsRecorded = false;
+		return;
+	}
+	m_bDrawPacketsRecorded = true;
+
+	m_pJobSystem->ParallelFor(
+		(uint32_t)m_sceneObjects.size(),
+		g_DrawPacketBatchSize,
+		[this, &frustumPlanes, pRecords](uint32_t start, uint32_t end)
+		{
+			for (uint32_t i = start; i < end; i++)
+			{
+				const SCENE_OBJECT& object = m_sceneObjects[i];
+				DrawDataBuffer::DRAW_RECORD record = BuildDrawRecord(object);
+				DRAW_PACKET& packet = m_drawPackets[i];
+
+				// the mapped memory is write-only, so fill it in one go
+				pRecords[i] = record;
+
+				// imported meshes are numbered after the basic shapes
+				packet.objectIndex = i;
+				packet.mesh = (object.importedMesh >= 0) ?
+					(uint16_t)(MESH_TYPE_COUNT + object.importedMesh) :
+					(uint16_t)object.mesh;
+				packet.variant = GetObjectVariant(object);
+				packet.visibleViews = 0;
+				for (int view = 0; view < m_viewCount; view++)
+				{
+					if (IsMeshInFrustum(
+						GetLocalBounds(object),
+						record.model,
+						object.scaleXYZ,
+						frustumPlanes[view]))
+					{
+						packet.visibleViews |= (uint8_t)(1 << view);
+					}
+				}
+			}
+		});
+}
+
+/***********************************************************
+ *  SubmitDrawPackets()
+ *
+ *  This method is used for drawing the meshes of the draw
+ *  packets that are visible in the passed in view.  Each
+ *  draw only selects its record in the per-draw buffer, so
+ *  there are no uniform calls per draw.  The packets are
+ *  drawn in one pass per shader variant, with the opaque
+ *  variants first and blending off, and the transparent
+ *  ones blending over them.  It must be called on the GL
+ *  thread.
+ ***********************************************************/
+void SceneManager::SubmitDrawPackets(int viewIndex)
+{
+	uint8_t viewBit = (uint8_t)(1 << viewIndex);
+	// the ShapeMeshes have no lightmap coordinates, so the
+	// basic shapes come from the scene meshes when they are
+	// lightmapped, and the imported meshes follow them
+	bool bSceneMeshes = (NULL != m_pLightmaps);
+
+	if (false == m_bDrawPacketsRecorded)
+	{
+		return;
+	}
+
+	m_pDrawData->BindFrame();
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, g_MaterialBinding, m_materialBufferID);
+
+	for (int pass = 0; pass < g_VariantPassCount; pass++)
+	{
+		uint8_t passVariant = g_VariantPasses[pass];
+		UseVariant(passVariant);
+		SetVertexDecode(bSceneMeshes);
+		GLStateCache::SetEnabled(GL_BLEND, ((passVariant & ShaderVariants::VARIANT_TRANSPARENT) != 0));
+		if (true == bSceneMeshes)
+		{
+			GLStateCache::BindVertexArray(m_pSceneMeshes->GetVertexArray());
+		}
+		for (size_t i = 0; i < m_drawPackets.size(); i++)
+		{
+			const DRAW_PACKET& packet = m_drawPackets[i];
+			if (((packet.visibleViews & viewBit) == 0) ||
+				(packet.variant != passVariant) ||
+				((true == bSceneMeshes) && (packet.mesh >= MESH_TYPE_COUNT)))
+			{
+				continue;
+			}
+
+			m_pDrawData->SetDrawIndex(packet.objectIndex);
+			if (packet.mesh >= MESH_TYPE_COUNT)
+			{
+				m_importedMeshes[packet.mesh - MESH_TYPE_COUNT]->Draw(1);
+			}
+			else if (true == bSceneMeshes)
+			{
+				DrawSceneMesh((MESH_TYPE)packet.mesh);
+			}
+			else
+			{
+				DrawMesh((MESH_TYPE)packet.mesh);
+			}
+		}
+
+		if ((true == bSceneMeshes) && (false == m_importedObjects.empty()))
+		{
+			SetVertexDecode(false);
+			for (size_t i = 0; i < m_importedObjects.size(); i++)
+			{
+				const DRAW_PACKET& packet = m_drawPackets[m_importedObjects[i]];
+				if (((packet.visibleViews & viewBit) != 0) && (packet.variant == passVariant))
+				{
+					m_pDrawData->SetDrawIndex(packet.objectIndex);
+					m_importedMeshes[packet.mesh - MESH_TYPE_COUNT]->Draw(1);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  SubmitDrawPacketsAllViews()
+ *
+ *  This method is used for drawing the meshes of the draw
+ *  packets that are visible in any of the views with one
+ *  instanced draw each.  The vertex shader sends every
+ *  instance to the viewport of its view, so the scene is
+ *  submitted once however many views there are.  Like the
+ *  single view submit, there is one pass per shader variant
+ *  and the transparent objects are drawn last with blending
+ *  on.  It must be called on the GL thread.
+ ***********************************************************/
+void SceneManager::SubmitDrawPacketsAllViews()
+{
+	if (false == m_bDrawPacketsRecorded)
+	{
+		return;
+	}
+
+	m_pDrawData->BindFrame();
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, g_MaterialBinding, m_materialBufferID);
+
+	for (int pass = 0; pass < g_VariantPassCount; pass++)
+	{
+		uint8_t passVariant = g_VariantPasses[pass];
+		UseVariant(passVariant);
+		GLStateCache::SetEnabled(GL_BLEND, ((passVariant & ShaderVariants::VARIANT_TRANSPARENT) != 0));
+		SetVertexDecode(true);
+		GLStateCache::BindVertexArray(m_pSceneMeshes->GetVertexArray());
+
+		for (size_t i = 0; i < m_drawPackets.size(); i++)
+		{
+			const DRAW_PACKET& packet = m_drawPackets[i];
+			if ((packet.visibleViews == 0) ||
+				(packet.mesh >= MESH_TYPE_COUNT) ||
+				(packet.variant != passVariant))
+			{
+				continue;
+			}
+
+			const SceneMeshes::MESH_LOD& meshLOD = m_pSceneMeshes->GetMeshLOD((MESH_TYPE)packet.mesh, 0);
+			m_pDrawData->SetDrawIndex(packet.objectIndex);
+			glDrawElementsInstancedBaseVertex(
+				GL_TRIANGLES,
+				meshLOD.indexCount,
+				GL_UNSIGNED_INT,
+				(void*)(meshLOD.firstIndex * sizeof(uint32_t)),
+				m_viewCount,
+				meshLOD.baseVertex);
+		}
+
+		// the imported meshes have their own full float buffers
+		if (false == m_importedObjects.empty())
+		{
+			SetVertexDecode(false);
+			for (size_t i = 0; i < m_importedObjects.size(); i++)
+			{
+				const DRAW_PACKET& packet = m_drawPackets[m_importedObjects[i]];
+				if ((packet.visibleViews != 0) && (packet.variant == passVariant))
+				{
+					m_pDrawData->SetDrawIndex(packet.objectIndex);
+					m_importedMeshes[packet.mesh - MESH_TYPE_COUNT]->Draw(m_viewCount);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  SetGPUDrivenRendering()
+ *
+ *  This method is used for choosing whether the scene is
+ *  culled and drawn by the GPU.  It must be called before
+ *  PrepareScene().
+ ***********************************************************/
+void SceneManager::SetGPUDrivenRendering(bool bGPUDriven)
+{
+	m_bGPUDriven = bGPUDriven;
+}
+
+/***********************************************************
+ *  SetSinglePassViews()
+ *
+ *  This method is used for choosing whether the scene is
+ *  drawn into all of its views in a single pass, when the
+ *  OpenGL context supports it.  It must be called before
+ *  PrepareScene().
+ ***********************************************************/
+void SceneManager::SetSinglePassViews(bool bSinglePass)
+{
+	m_bSinglePassViews = bSinglePass;
+}
+
+/***********************************************************
+ *  IsSinglePassViews()
+ *
+ *  This method is used for checking whether the views are
+ *  drawn in a single pass with SubmitSceneAllViews().
+ ***********************************************************/
+bool SceneManager::IsSinglePassViews() const
+{
+	return(m_bSinglePassViews);
+}
+
+/***********************************************************
+ *  SetPackedVertices()
+ *
+ *  This method is used for choosing whether the shared
+ *  scene meshes are uploaded in the packed vertex layout,
+ *  which is half the size.  It must be called before
+ *  PrepareScene().
+ ***********************************************************/
+void SceneManager::SetPackedVertices(bool bPacked)
+{
+	m_bPackedVertices = bPacked;
+}
+
+/***********************************************************
+ *  SetMeshDetail()
+ *
+ *  This method is used for multiplying the segment counts
+ *  of the closest level of detail of the curved scene
+ *  meshes.  Only the standard counts are baked, so other
+ *  counts are generated on the worker threads.  It must be
+ *  called before PrepareScene().
+ ***********************************************************/
+void SceneManager::SetMeshDetail(int detail)
+{
+	m_meshDetail = (detail > 1) ? detail : 1;
+}
+
+/***********************************************************
+ *  AddImportedModel()
+ *
+ *  This method is used for adding an OBJ or glTF model file
+ *  to the scene.  The model is loaded, or imported the first
+ *  time, by PrepareScene(), so this must be called before
+ *  it.
+ ***********************************************************/
+void SceneManager::AddImportedModel(const char* filePath)
+{
+	m_importPaths.push_back(filePath);
+}
+
+/***********************************************************
+ *  SetMipFilter()
+ *
+ *  This method is used for choosing the filter the texture
+ *  mips are built with.  Cached mips built with another
+ *  filter are built again.
+ ***********************************************************/
+void SceneManager::SetMipFilter(ImagePipeline::MIP_FILTER filter)
+{
+	m_mipFilter = filter;
+}
+
+/***********************************************************
+ *  SetTextureBudget()
+ *
+ *  This method is used for setting how many megabytes of
+ *  video memory the streamed texture mips may use.
+ ***********************************************************/
+void SceneManager::SetTextureBudget(int megabytes)
+{
+	m_pTextureStreamer->SetBudget((size_t)glm::max(megabytes, 1) * 1024 * 1024);
+}
+
+/***********************************************************
+ *  SetViewportHeight()
+ *
+ *  This method is used for setting the height in pixels of
+ *  one of the views, which the texture mips its objects
+ *  need are worked out from.
+ ***********************************************************/
+void SceneManager::SetViewportHeight(int viewIndex, int height)
+{
+	if ((viewIndex < 0) || (viewIndex >= MAX_VIEWS))
+	{
+		return;
+	}
+
+	m_viewportHeights[viewIndex] = height;
+}
+
+/***********************************************************
+ *  SetPhysicallyBasedShading()
+ *
+ *  This method is used for choosing whether the scene is
+ *  shaded with the metallic and roughness of its materials
+ *  and lit by the environment lighting maps as well as the
+ *  light sources.  It must be called before PrepareScene().
+ ***********************************************************/
+void SceneManager::SetPhysicallyBasedShading(bool bPhysicallyBased)
+{
+	m_bPhysicallyBased = bPhysicallyBased;
+}
+
+/***********************************************************
+ *  SetLightmaps()
+ *
+ *  This method is used for choosing whether the light that
+ *  reaches the static objects is baked into lightmaps, which
+ *  they read instead of evaluating the light sources.  It
+ *  must be called before PrepareScene().
+ ***********************************************************/
+void SceneManager::SetLightmaps(bool bLightmaps)
+{
+	m_bLightmaps = bLightmaps;
+}
+
+/***********************************************************
+ *  SetHotReload()
+ *
+ *  This method is used for choosing whether the shader,
+ *  texture and model files are watched for edits, which
+ *  are then loaded while the scene keeps running.  It must
+ *  be called before PrepareScene().
+ ***********************************************************/
+void SceneManager::SetHotReload(bool bHotReload)
+{
+	m_bHotReload = bHotReload;
+}
+
+/***********************************************************
+ *  StartHotReload()
+ *
+ *  This method is used for watching the files the scene
+ *  was loaded from.  The object layout is compiled into the
+ *  Define methods, so it still needs a rebuild.
+ ***********************************************************/
+void SceneManager::StartHotReload()
+{
+	m_pFileWatcher = new FileWatcher();
+	m_pFileWatcher->Watch(g_VertexShaderPath);
+	m_pFileWatcher->Watch(g_FragmentShaderPath);
+	if (true == m_bGPUDriven)
+	{
+		m_pFileWatcher->Watch(g_CullShaderPath);
+	}
+	for (int i = 0; i < m_loadedTextures; i++)
+	{
+		m_pFileWatcher->Watch(m_textureImages[i].filename);
+	}
+	for (size_t i = 0; i < m_importedMeshes.size(); i++)
+	{
+		m_pFileWatcher->Watch(m_importedMeshes[i]->GetFilePath());
+	}
+
+	if (true == m_pFileWatcher->Start())
+	{
+		std::cout << "Watching the shaders, textures and models for changes" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  UpdateHotReload()
+ *
+ *  This method is used for starting to load the files that
+ *  were edited, and swapping in the ones that have finished
+ *  loading.  It is called between frames, so a frame is
+ *  always drawn with one version of every asset, and the
+ *  rest of the GPU resources stay as they are.
+ ***********************************************************/
+void SceneManager::UpdateHotReload()
+{
+	if (NULL == m_pFileWatcher)
+	{
+		return;
+	}
+
+	std::vector<std::string> changedFiles;
+	bool bShadersChanged = false;
+	m_pFileWatcher->TakeChanges(changedFiles);
+	for (size_t i = 0; i < changedFiles.size(); i++)
+	{
+		const std::string& filePath = changedFiles[i];
+		if ((filePath == g_VertexShaderPath) || (filePath == g_FragmentShaderPath))
+		{
+			bShadersChanged = true;
+		}
+		else if (filePath == g_CullShaderPath)
+		{
+			// the culling shader is a single small program, so
+			// it is simply built right away
+			if ((NULL != m_pGPURenderer) &&
+				(true == m_pGPURenderer->LoadCullShader(g_CullShaderPath, &m_looseFiles)))
+			{
+				std::cout << "Reloaded the culling shader" << std::endl;
+			}
+		}
+		else
+		{
+			for (int slot = 0; slot < m_loadedTextures; slot++)
+			{
+				if (m_textureImages[slot].filename == filePath)
+				{
+					StartAssetReload(filePath, slot, true);
+				}
+			}
+			for (size_t mesh = 0; mesh < m_importedMeshes.size(); mesh++)
+			{
+				if (m_importedMeshes[mesh]->GetFilePath() == filePath)
+				{
+					StartAssetReload(filePath, (int)mesh, false);
+				}
+			}
+		}
+	}
+
+	// the shader variants are built by the driver while the
+	// current ones keep drawing
+	if (true == bShadersChanged)
+	{
+		m_pShaderVariants->BeginReload(&m_looseFiles);
+	}
+	if (true == m_pShaderVariants->IsReloading())
+	{
+		m_pShaderVariants->FinishReload();
+	}
+
+	size_t pendingCount = 0;
+	for (size_t i = 0; i < m_assetReloads.size(); i++)
+	{
+		ASSET_RELOAD* pReload = m_assetReloads[i];
+		if (false == m_pJobSystem->IsFinished(&pReload->job))
+		{
+			m_assetReloads[pendingCount++] = pReload;
+			continue;
+		}
+
+		FinishAssetReload(*pReload);
+		delete pReload;
+	}
+	m_assetReloads.resize(pendingCount);
+}
+
+/***********************************************************
+ *  StartAssetReload()
+ *
+ *  This method is used for loading an edited texture or
+ *  model on the job system worker threads.  Textures are
+ *  imported again even when their cache looks current, and
+ *  both write their caches for the next run.
+ ***********************************************************/
+void SceneManager::StartAssetReload(const std::string& filePath, int index, bool bTexture)
+{
+	for (size_t i = 0; i < m_assetReloads.size(); i++)
+	{
+		if (m_assetReloads[i]->filePath == filePath)
+		{
+			m_assetReloads[i]->bStale = true;
+		}
+	}
+
+	ASSET_RELOAD* pReload = new ASSET_RELOAD();
+	pReload->filePath = filePath;
+	pReload->index = index;
+	pReload->bTexture = bTexture;
+	pReload->bLoaded = false;
+	pReload->bStale = false;
+	pReload->milliseconds = 0.0;
+	pReload->colorChannels = 0;
+	m_assetReloads.push_back(pReload);
+
+	const AssetPack* pLooseFiles = &m_looseFiles;
+	ImagePipeline::MIP_FILTER mipFilter = m_mipFilter;
+	m_pJobSystem->Execute([pReload, pLooseFiles, mipFilter]()
+		{
+			std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+			if (true == pReload->bTexture)
+			{
+				pReload->bLoaded = TextureImporter::ImportFile(
+					pReload->filePath.c_str(),
+					pLooseFiles,
+					mipFilter,
+					pReload->mipChain,
+					pReload->colorChannels);
+			}
+			else
+			{
+				pReload->bLoaded = MeshImporter::Import(pReload->filePath.c_str(), pReload->mesh);
+				if (true == pReload->bLoaded)
+				{
+					MeshImporter::WriteCache(pReload->filePath.c_str(), pReload->mesh);
+				}
+			}
+			pReload->milliseconds = std::chrono::duration<double, std::milli>(
+				std::chrono::steady_clock::now() - startTime).count();
+		}, &pReload->job);
+}
+
+/***********************************************************
+ *  FinishAssetReload()
+ *
+ *  This method is used for swapping a reloaded texture or
+ *  model in for the old one.  A file that failed to load,
+ *  like one caught half written, leaves the old version in
+ *  place.
+ ***********************************************************/
+void SceneManager::FinishAssetReload(ASSET_RELOAD& reload)
+{
+	if (true == reload.bStale)
 	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		TextureStreamer::ReleaseMipChain(reload.mipChain);
+		return;
+	}
+	if (false == reload.bLoaded)
+	{
+		std::cout << "Could not reload " << reload.filePath << ", keeping the loaded version" << std::endl;
+		TextureStreamer::ReleaseMipChain(reload.mipChain);
+		return;
+	}
 
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
+	if (true == reload.bTexture)
+	{
+		if (false == m_pTextureStreamer->ReplaceTexture(reload.index, reload.mipChain))
 		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
+			TextureStreamer::ReleaseMipChain(reload.mipChain);
+			return;
 		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
-
-		return true;
+		m_textureIDs[reload.index].ID = m_pTextureStreamer->GetTextureID(reload.index);
+		BindGLTextures();
+	}
+	else
+	{
+		ImportedMesh* pMesh = new ImportedMesh();
+		pMesh->Create(reload.filePath.c_str(), reload.mesh);
+		delete m_importedMeshes[reload.index];
+		m_importedMeshes[reload.index] = pMesh;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
-
-	// Error loading the image
-	return false;
+	std::cout << "Reloaded " << reload.filePath << " in " << reload.milliseconds << " ms" << std::endl;
 }
 
 /***********************************************************
- *  BindGLTextures()
+ *  SetVertexDecode()
  *
- *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  This method is used for setting the shader values that
+ *  decode the packed vertices.  The ShapeMeshes draws always
+ *  use full float vertices.
  ***********************************************************/
-void SceneManager::BindGLTextures()
+void SceneManager::SetVertexDecode(bool bSceneMeshes)
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	if ((true == bSceneMeshes) &&
+		(NULL != m_pSceneMeshes) &&
+		(true == m_pSceneMeshes->IsPackedVertices()))
 	{
-		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		m_pShaderVariants->SetBoolValue("bPackedVertices", true);
+		m_pShaderVariants->SetVec3Value("packedPositionOffset", m_pSceneMeshes->GetPositionOffset());
+		m_pShaderVariants->SetVec3Value("packedPositionScale", m_pSceneMeshes->GetPositionScale());
+	}
+	else
+	{
+		m_pShaderVariants->SetBoolValue("bPackedVertices", false);
 	}
 }
 
 /***********************************************************
- *  DestroyGLTextures()
+ *  DrawSceneMesh()
  *
- *  This method is used for freeing the memory in all the
- *  used texture memory slots.
+ *  This method is used for drawing the most detailed level
+ *  of a basic shape from the shared scene meshes, for the
+ *  single view submit.
  ***********************************************************/
-void SceneManager::DestroyGLTextures()
+void SceneManager::DrawSceneMesh(MESH_TYPE mesh)
 {
-	for (int i = 0; i < m_loadedTextures; i++)
-	{
-		glGenTextures(1, &m_textureIDs[i].ID);
-	}
+	const SceneMeshes::MESH_LOD& meshLOD = m_pSceneMeshes->GetMeshLOD(mesh, 0);
+
+	glDrawElementsBaseVertex(
+		GL_TRIANGLES,
+		meshLOD.indexCount,
+		GL_UNSIGNED_INT,
+		(void*)(meshLOD.firstIndex * sizeof(uint32_t)),
+		meshLOD.baseVertex);
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  IsSinglePassViewsSupported()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for checking whether the context has
+ *  viewport arrays and lets the vertex shader write the
+ *  viewport index.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+bool SceneManager::IsSinglePassViewsSupported()
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
-	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
-		}
-		else
-			index++;
-	}
-
-	return(textureID);
+	return((GLEW_ARB_viewport_array) &&
+		((GLEW_ARB_shader_viewport_layer_array) || (GLEW_AMD_vertex_shader_viewport_index)));
 }
 
 /***********************************************************
- *  FindTextureSlot()
+ *  CreateSceneMeshes()
  *
- *  This method is used for getting a slot index for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for generating the shared scene
+ *  meshes that the GPU-driven and single pass multi-view
+ *  paths draw from, since they need instanced draws.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+bool SceneManager::CreateSceneMeshes()
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
+	m_pSceneMeshes = new SceneMeshes();
+	if (m_meshDetail > 1)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		const MESH_TYPE curvedMeshes[] = { MESH_CYLINDER, MESH_TAPERED_CYLINDER, MESH_SPHERE, MESH_TORUS };
+		for (size_t i = 0; i < sizeof(curvedMeshes) / sizeof(curvedMeshes[0]); i++)
 		{
-			textureSlot = index;
-			bFound = true;
+			int segments1 = 0;
+			int segments2 = 0;
+			m_pSceneMeshes->GetTessellation(curvedMeshes[i], 0, segments1, segments2);
+			m_pSceneMeshes->SetTessellation(curvedMeshes[i], 0, segments1 * m_meshDetail, segments2 * m_meshDetail);
 		}
-		else
-			index++;
+	}
+	m_pSceneMeshes->GenerateMeshes(m_pJobSystem);
+	m_pSceneMeshes->SetPackedVertices(m_bPackedVertices);
+	if (false == m_pSceneMeshes->UploadMeshes())
+	{
+		delete m_pSceneMeshes;
+		m_pSceneMeshes = NULL;
+		return(false);
 	}
 
-	return(textureSlot);
+	return(true);
 }
 
 /***********************************************************
- *  FindMaterial()
+ *  CreateGPUDrivenScene()
  *
- *  This method is used for getting a material from the previously
- *  defined materials list that is associated with the passed in tag.
+ *  This method is used for copying the scene objects into
+ *  the buffers read by the culling shader.  If any of it
+ *  fails, the scene falls back to the CPU recorded draw
+ *  packets.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+bool SceneManager::CreateGPUDrivenScene()
 {
-	if (m_objectMaterials.size() == 0)
+	if (false == GPUDrivenRenderer::IsSupported())
 	{
+		std::cout << "GPU-driven rendering needs OpenGL 4.6 or ARB_indirect_parameters" << std::endl;
 		return(false);
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	std::vector<DrawDataBuffer::DRAW_RECORD> drawRecords(m_sceneObjects.size());
+	std::vector<GPUDrivenRenderer::OBJECT_RECORD> objectRecords(m_sceneObjects.size());
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
-		{
-			index++;
-		}
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		GPUDrivenRenderer::OBJECT_RECORD& objectRecord = objectRecords[i];
+
+		drawRecords[i] = BuildDrawRecord(object);
+		objectRecord.boundingSphere = GetWorldBounds(GetLocalBounds(object), drawRecords[i].model, object.scaleXYZ);
+		objectRecord.mesh = (uint32_t)object.mesh;
+		objectRecord.bTransparent = (object.color.a < 1.0f) ? 1 : 0;
+		objectRecord.padding[0] = 0;
+		objectRecord.padding[1] = 0;
 	}
 
-	return(true);
+	m_pGPURenderer = new GPUDrivenRenderer();
+
+	return(m_pGPURenderer->Create(
+		g_CullShaderPath,
+		m_pAssetPack,
+		m_pSceneMeshes,
+		drawRecords,
+		objectRecords));
 }
 
 /***********************************************************
- *  SetTransformations()
+ *  DrawMesh()
  *
- *  This method is used for setting the transform buffer
- *  using the passed in transformation values.
+ *  This method is used for drawing the basic mesh shape
+ *  associated with the passed in mesh type.  The basic
+ *  shapes bind their own vertex arrays, so the state cache
+ *  is told to forget its binding.
  ***********************************************************/
-void SceneManager::SetTransformations(
-	glm::vec3 scaleXYZ,
-	float XrotationDegrees,
-	float YrotationDegrees,
-	float ZrotationDegrees,
-	glm::vec3 positionXYZ)
+void SceneManager::DrawMesh(MESH_TYPE mesh)
 {
-	// variables for this method
-	glm::mat4 modelView;
-	glm::mat4 scale;
-	glm::mat4 rotationX;
-	glm::mat4 rotationY;
-	glm::mat4 rotationZ;
-	glm::mat4 translation;
-
-	// set the scale value in the transform buffer
-	scale = glm::scale(scaleXYZ);
-	// set the rotation values in the transform buffer
-	rotationX = glm::rotate(glm::radians(XrotationDegrees), glm::vec3(1.0f, 0.0f, 0.0f));
-	rotationY = glm::rotate(glm::radians(YrotationDegrees), glm::vec3(0.0f, 1.0f, 0.0f));
-	rotationZ = glm::rotate(glm::radians(ZrotationDegrees), glm::vec3(0.0f, 0.0f, 1.0f));
-	// set the translation value in the transform buffer
-	translation = glm::translate(positionXYZ);
-
-	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
+	switch (mesh)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+	case MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case MESH_BOX:
+		m_basicMeshes->DrawBoxMesh();
+		break;
+	case MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh();
+		break;
+	case MESH_TAPERED_CYLINDER:
+		m_basicMeshes->DrawTaperedCylinderMesh();
+		break;
+	case MESH_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	case MESH_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		break;
+	case MESH_PRISM:
+		m_basicMeshes->DrawPrismMesh();
+		break;
+	default:
+		break;
 	}
+
+	GLStateCache::InvalidateVertexArray();
 }
 
 /***********************************************************
- *  SetShaderColor()
+ *  UseVariant()
  *
- *  This method is used for setting the passed in color
- *  into the shader for the next draw command
+ *  This method is used for making the scene shader variant
+ *  current, from the flags of the objects about to be drawn
+ *  and the scene lighting.
  ***********************************************************/
-void SceneManager::SetShaderColor(
-	float redColorValue,
-	float greenColorValue,
-	float blueColorValue,
-	float alphaValue)
+void SceneManager::UseVariant(uint32_t objectFlags)
 {
-	// variables for this method
-	glm::vec4 currentColor;
-
-	currentColor.r = redColorValue;
-	currentColor.g = greenColorValue;
-	currentColor.b = blueColorValue;
-	currentColor.a = alphaValue;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
+	m_pShaderVariants->Use(ShaderVariants::MakeVariant(objectFlags | GetLightingFlags(), m_lightCount));
 }
 
 /***********************************************************
- *  SetShaderTexture()
+ *  GetLightingFlags()
  *
- *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  This method is used for getting the variant flags that
+ *  are the same for every object in the scene.
  ***********************************************************/
-void SceneManager::SetShaderTexture(
-	std::string textureTag)
+uint32_t SceneManager::GetLightingFlags() const
 {
-	if (NULL != m_pShaderManager)
+	uint32_t flags = 0;
+	if (true == m_bUseLighting)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
-
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		flags |= ShaderVariants::VARIANT_LIT;
+	}
+	if (true == m_bPhysicallyBased)
+	{
+		flags |= ShaderVariants::VARIANT_PBR;
 	}
+	if (NULL != m_pLightmaps)
+	{
+		flags |= ShaderVariants::VARIANT_LIGHTMAPPED;
+	}
+
+	return(flags);
 }
 
 /***********************************************************
- *  SetTextureUVScale()
+ *  DrawGPUDrivenScene()
  *
- *  This method is used for setting the texture UV scale
- *  values into the shader.
+ *  This method is used for drawing the buckets the culling
+ *  shader filled in.  A bucket mixes textured and plain
+ *  objects, so it is drawn with the variant that checks the
+ *  texture of each draw record, and the transparent bucket
+ *  gets its own variant.
  ***********************************************************/
-void SceneManager::SetTextureUVScale(float u, float v)
+void SceneManager::DrawGPUDrivenScene()
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
-	}
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, g_MaterialBinding, m_materialBufferID);
+
+	// the culling shader replaced the scene shader program
+	UseVariant(ShaderVariants::VARIANT_MIXED_TEXTURE);
+	SetVertexDecode(true);
+	m_pGPURenderer->Draw(false);
+
+	UseVariant(ShaderVariants::VARIANT_MIXED_TEXTURE | ShaderVariants::VARIANT_TRANSPARENT);
+	SetVertexDecode(true);
+	m_pGPURenderer->Draw(true);
 }
 
 /***********************************************************
- *  SetShaderMaterial()
+ *  DrawImportedObjects()
  *
- *  This method is used for passing the material values
- *  into the shader.
+ *  This method is used for drawing the imported objects
+ *  that are inside the frustum of any of the views, once
+ *  per view.  The culling shader only knows the shared
+ *  scene meshes, so the GPU-driven path draws these after
+ *  its indirect draws, from the same draw records.
  ***********************************************************/
-void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+void SceneManager::DrawImportedObjects(const glm::vec4 frustumPlanes[][6], int viewCount)
 {
-	if (m_objectMaterials.size() > 0)
+	if (true == m_importedObjects.empty())
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_importedObjects.size(); i++)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		const SCENE_OBJECT& object = m_sceneObjects[m_importedObjects[i]];
+		glm::mat4 model = BuildModelMatrix(object.scaleXYZ, object.rotationDegrees, object.positionXYZ);
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
+		bool bVisible = false;
+		for (int view = 0; (view < viewCount) && (false == bVisible); view++)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			bVisible = IsMeshInFrustum(GetLocalBounds(object), model, object.scaleXYZ, frustumPlanes[view]);
+		}
+		if (true == bVisible)
+		{
+			UseVariant(GetObjectVariant(object));
+			SetVertexDecode(false);
+			GLStateCache::SetEnabled(GL_BLEND, (object.color.a < 1.0f));
+			m_pDrawData->SetDrawIndex(m_importedObjects[i]);
+			m_importedMeshes[object.importedMesh]->Draw(viewCount);
 		}
 	}
 }
@@ -439,6 +1789,10 @@ void SceneManager::LoadSceneTextures()
 	bReturn = CreateGLTexture(
 		"textures/blackplasticmaterial.jpg", "blackpl");
 
+	// wait for the image files to finish decoding on the worker
+	// threads, and then convert them to OpenGL texture data
+	UploadGLTextures();
+
 	// after the texture image data is loaded into memory, the
 	// loaded textures need to be bound to texture slots - there
 	// are a total of 16 available slots for scene textures
@@ -459,6 +1813,9 @@ void SceneManager::DefineObjectMaterials()
 	goldMaterial.diffuseColor = glm::vec3(0.2f, 0.2f, 0.2f);
 	goldMaterial.specularColor = glm::vec3(0.5f, 0.5f, 0.5f);
 	goldMaterial.shininess = 25.0;
+	goldMaterial.metallic = 1.0f;
+	goldMaterial.roughness = 0.35f;
+	goldMaterial.textures = MakeTextureSet(NULL, NULL, NULL);
 	goldMaterial.tag = "metal";
 
 	m_objectMaterials.push_back(goldMaterial);
@@ -469,6 +1826,9 @@ void SceneManager::DefineObjectMaterials()
 	woodMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
 	woodMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
 	woodMaterial.shininess = 0.3;
+	woodMaterial.metallic = 0.0f;
+	woodMaterial.roughness = 0.7f;
+	woodMaterial.textures = MakeTextureSet("wood", NULL, NULL);
 	woodMaterial.tag = "wood";
 
 	m_objectMaterials.push_back(woodMaterial);
@@ -479,14 +1839,22 @@ void SceneManager::DefineObjectMaterials()
 	glassMaterial.diffuseColor = glm::vec3(0.3f, 0.3f, 0.3f);
 	glassMaterial.specularColor = glm::vec3(0.6f, 0.6f, 0.6f);
 	glassMaterial.shininess = 85.0;
+	glassMaterial.metallic = 0.0f;
+	glassMaterial.roughness = 0.05f;
+	glassMaterial.textures = MakeTextureSet(NULL, NULL, NULL);
 	glassMaterial.tag = "glass";
 
+	m_objectMaterials.push_back(glassMaterial);
+
 	OBJECT_MATERIAL wallMaterial;
 	wallMaterial.ambientColor = glm::vec3(0.1f, 0.1f, 0.1f);
 	wallMaterial.ambientStrength = 0.2f;
 	wallMaterial.diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
 	wallMaterial.specularColor = glm::vec3(0.1f, 0.1f, 0.1f);
 	wallMaterial.shininess = 0.0;
+	wallMaterial.metallic = 0.0f;
+	wallMaterial.roughness = 0.9f;
+	wallMaterial.textures = MakeTextureSet("wall", NULL, NULL);
 	wallMaterial.tag = "walls";
 
 	m_objectMaterials.push_back(wallMaterial);
@@ -497,11 +1865,51 @@ void SceneManager::DefineObjectMaterials()
 	grapeMaterial.diffuseColor = glm::vec3(0.3f, 0.2f, 0.3f);
 	grapeMaterial.specularColor = glm::vec3(0.4f, 0.2f, 0.2f);
 	grapeMaterial.shininess = 0.5;
+	grapeMaterial.metallic = 0.0f;
+	grapeMaterial.roughness = 0.45f;
+	grapeMaterial.textures = MakeTextureSet(NULL, NULL, NULL);
 	grapeMaterial.tag = "plastic";
 
 	m_objectMaterials.push_back(grapeMaterial);
 }
 
+/***********************************************************
+ *  UploadObjectMaterials()
+ *
+ *  This method is used for copying the material table into
+ *  a shader storage buffer, so the shaders can look the
+ *  materials up by the 16 bit index in each draw record.
+ *  The table is filled in as the objects are defined.
+ ***********************************************************/
+void SceneManager::UploadObjectMaterials()
+{
+	// the shaders need at least one valid entry to read
+	if (m_materialRecords.empty())
+	{
+		MATERIAL_RECORD record;
+		record.ambientColorStrength = glm::vec4(0.0f);
+		record.diffuseColor = glm::vec4(0.0f);
+		record.specularColorShininess = glm::vec4(0.0f);
+		record.textureSet = glm::ivec4(-1);
+		record.metallicRoughness = glm::vec4(0.0f, 1.0f, 0.0f, 0.0f);
+		m_materialRecords.push_back(record);
+	}
+
+	if (0 != m_materialBufferID)
+	{
+		GLStateCache::ForgetBuffer(m_materialBufferID);
+		glDeleteBuffers(1, &m_materialBufferID);
+	}
+	glGenBuffers(1, &m_materialBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_materialBufferID);
+	glBufferStorage(
+		GL_SHADER_STORAGE_BUFFER,
+		m_materialRecords.size() * sizeof(MATERIAL_RECORD),
+		m_materialRecords.data(),
+		0);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
 /***********************************************************
  *  SetupSceneLights()
  *
@@ -510,31 +1918,128 @@ void SceneManager::DefineObjectMaterials()
  ***********************************************************/
 void SceneManager::SetupSceneLights()
 {
-	// this line of code is NEEDED for telling the shaders to render 
-	// the 3D scene with custom lighting - to use the default rendered 
-	// lighting then comment out the following line
-	m_pShaderManager->setBoolValue(g_UseLightingName, true);
+	// this line of code is NEEDED for drawing the 3D scene with
+	// the shader variants that do the custom lighting - to use
+	// the default rendered lighting then comment out the
+	// following line
+	m_bUseLighting = true;
+	// the light count is compiled into the shader variants, so
+	// it must match the light sources set below
+	m_lightCount = 3;
+
+	m_pShaderVariants->SetVec3Value("lightSources[0].position", 13.5f, 15.79f, 1.9f);
+	m_pShaderVariants->SetVec3Value("lightSources[0].ambientColor", 0.2f, 0.2f, 0.2f);
+	m_pShaderVariants->SetVec3Value("lightSources[0].diffuseColor", 0.949f, 0.184f, 0.863f);
+	m_pShaderVariants->SetVec3Value("lightSources[0].specularColor", 0.949f, 0.184f, 0.863f);
+	m_pShaderVariants->SetFloatValue("lightSources[0].focalStrength", 1.0f);
+	m_pShaderVariants->SetFloatValue("lightSources[0].specularIntensity", 15.0f);
+
+	m_pShaderVariants->SetVec3Value("lightSources[1].position", -13.5f, 15.79f, 1.9f);
+	m_pShaderVariants->SetVec3Value("lightSources[1].ambientColor", 0.2f, 0.2f, 0.2f);
+	m_pShaderVariants->SetVec3Value("lightSources[1].diffuseColor", 0.949f, 0.184f, 0.863f);
+	m_pShaderVariants->SetVec3Value("lightSources[1].specularColor", 0.949f, 0.184f, 0.863f);
+	m_pShaderVariants->SetFloatValue("lightSources[1].focalStrength", 1.0f);
+	m_pShaderVariants->SetFloatValue("lightSources[1].specularIntensity", 15.0f);
+
+	m_pShaderVariants->SetVec3Value("lightSources[2].position", 0.0f, 3.0f, 20.0f);
+	m_pShaderVariants->SetVec3Value("lightSources[2].ambientColor", 0.2f, 0.2f, 0.2f);
+	m_pShaderVariants->SetVec3Value("lightSources[2].diffuseColor", 0.8f, 0.8f, 0.8f);
+	m_pShaderVariants->SetVec3Value("lightSources[2].specularColor", 0.0f, 0.0f, 0.0f);
+	m_pShaderVariants->SetFloatValue("lightSources[2].focalStrength", 12.0f);
+	m_pShaderVariants->SetFloatValue("lightSources[2].specularIntensity", 0.2f);
+
+	// the lightmapped objects skip the light sources, so they
+	// are given the ambient colors of all of them at once
+	m_pShaderVariants->SetVec3Value("ambientLight", 0.6f, 0.6f, 0.6f);
+}
+
+/***********************************************************
+ *  DefineEnvironment()
+ *
+ *  This method is used for describing the room around the
+ *  desk for the environment lighting - a pale ceiling, grey
+ *  walls and a dark floor, with bright spots where the scene
+ *  lights are, seen from the middle of the desk.
+ ***********************************************************/
+void SceneManager::DefineEnvironment(EnvironmentLighting::ENVIRONMENT& environment)
+{
+	const glm::vec3 deskCenter = glm::vec3(0.0f, 5.0f, 0.0f);
+
+	environment.skyColor = glm::vec3(0.35f, 0.33f, 0.36f);
+	environment.horizonColor = glm::vec3(0.22f, 0.22f, 0.24f);
+	environment.groundColor = glm::vec3(0.06f, 0.05f, 0.05f);
+	environment.lights.clear();
+
+	EnvironmentLighting::ENVIRONMENT_LIGHT light;
+	light.direction = glm::normalize(glm::vec3(13.5f, 15.79f, 1.9f) - deskCenter);
+	light.color = glm::vec3(0.949f, 0.184f, 0.863f) * 6.0f;
+	light.angle = 0.2f;
+	environment.lights.push_back(light);
+
+	light.direction = glm::normalize(glm::vec3(-13.5f, 15.79f, 1.9f) - deskCenter);
+	environment.lights.push_back(light);
+
+	light.direction = glm::normalize(glm::vec3(0.0f, 3.0f, 20.0f) - deskCenter);
+	light.color = glm::vec3(0.8f, 0.8f, 0.8f) * 4.0f;
+	light.angle = 0.35f;
+	environment.lights.push_back(light);
+}
+
+/***********************************************************
+ *  StartLightmapBake()
+ *
+ *  This method is used for starting the lightmap baker on
+ *  the light sources and the opaque basic shape objects.
+ *  The imported models and the glass stay lit per fragment.
+ *  The objects get their squares of the atlas right away,
+ *  and the light is loaded or baked on the worker threads
+ *  while the rest of the scene is prepared.
+ ***********************************************************/
+bool SceneManager::StartLightmapBake()
+{
+	m_pLightmaps = new LightmapBaker();
+
+	// the same lights as SetupSceneLights(), with their
+	// diffuse colors
+	LightmapBaker::BAKE_LIGHT light;
+	light.position = glm::vec3(13.5f, 15.79f, 1.9f);
+	light.color = glm::vec3(0.949f, 0.184f, 0.863f);
+	m_pLightmaps->AddLight(light);
+	light.position = glm::vec3(-13.5f, 15.79f, 1.9f);
+	m_pLightmaps->AddLight(light);
+	light.position = glm::vec3(0.0f, 3.0f, 20.0f);
+	light.color = glm::vec3(0.8f, 0.8f, 0.8f);
+	m_pLightmaps->AddLight(light);
+
+	std::vector<int> bakeIndices(m_sceneObjects.size(), -1);
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		const SCENE_OBJECT& object = m_sceneObjects[i];
+		if ((object.importedMesh >= 0) || (object.color.a < 1.0f))
+		{
+			continue;
+		}
+
+		const OBJECT_MATERIAL& material = m_objectMaterials[(object.materialIndex >= 0) ? object.materialIndex : 0];
+		LightmapBaker::BAKE_OBJECT bakeObject;
+		bakeObject.mesh = object.mesh;
+		bakeObject.model = BuildModelMatrix(object.scaleXYZ, object.rotationDegrees, object.positionXYZ);
+		bakeObject.albedo = material.diffuseColor *
+			(((true == object.bUseTexture) && (object.textureSlot >= 0)) ? glm::vec3(g_TexturedAlbedo) : glm::vec3(object.color));
+		bakeIndices[i] = m_pLightmaps->AddObject(bakeObject);
+	}
 
-	m_pShaderManager->setVec3Value("lightSources[0].position", 13.5f, 15.79f, 1.9f);
-	m_pShaderManager->setVec3Value("lightSources[0].ambientColor", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", 0.949f, 0.184f, 0.863f);
-	m_pShaderManager->setVec3Value("lightSources[0].specularColor", 0.949f, 0.184f, 0.863f);
-	m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 15.0f);
+	if (false == m_pLightmaps->Start(m_pSceneMeshes, g_LightmapCachePath, m_pJobSystem))
+	{
+		return(false);
+	}
 
-	m_pShaderManager->setVec3Value("lightSources[1].position", -13.5f, 15.79f, 1.9f);
-	m_pShaderManager->setVec3Value("lightSources[1].ambientColor", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", 0.949f, 0.184f, 0.863f);
-	m_pShaderManager->setVec3Value("lightSources[1].specularColor", 0.949f, 0.184f, 0.863f);
-	m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 1.0f);
-	m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 15.0f);
+	for (size_t i = 0; i < m_sceneObjects.size(); i++)
+	{
+		m_sceneObjects[i].lightmapScaleOffset = m_pLightmaps->GetScaleOffset(bakeIndices[i]);
+	}
 
-	m_pShaderManager->setVec3Value("lightSources[2].position", 0.0f, 3.0f, 20.0f);
-	m_pShaderManager->setVec3Value("lightSources[2].ambientColor", 0.2f, 0.2f, 0.2f);
-	m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", 0.8f, 0.8f, 0.8f);
-	m_pShaderManager->setVec3Value("lightSources[2].specularColor", 0.0f, 0.0f, 0.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 12.0f);
-	m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 0.2f);
+	return(true);
 }
 
 /***********************************************************
@@ -546,6 +2051,28 @@ void SceneManager::SetupSceneLights()
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
+	// the shader sources are shared by every variant of the
+	// scene program, which are built at the end
+	m_pShaderVariants->Load(
+		g_VertexShaderPath,
+		g_FragmentShaderPath,
+		m_pAssetPack);
+
+	// the environment lighting maps are loaded or computed on
+	// the worker threads while the rest of the scene loads
+	if ((true == m_bPhysicallyBased) && (false == EnvironmentLighting::IsSupported()))
+	{
+		std::cout << "Physically based shading needs more than 18 texture units, using Phong shading" << std::endl;
+		m_bPhysicallyBased = false;
+	}
+	if (true == m_bPhysicallyBased)
+	{
+		EnvironmentLighting::ENVIRONMENT environment;
+		DefineEnvironment(environment);
+		m_pEnvironment = new EnvironmentLighting();
+		m_pEnvironment->Start(environment, g_EnvironmentCachePath, m_pJobSystem);
+	}
+
 	LoadSceneTextures();
 	// only one instance of a particular mesh needs to be
 	// loaded in memory no matter how many times it is drawn
@@ -563,32 +2090,239 @@ void SceneManager::PrepareScene()
 	m_basicMeshes->LoadCylinderMesh();
 	m_basicMeshes->LoadTorusMesh();
 	m_basicMeshes->LoadPrismMesh();
+	// the basic shapes left their own vertex arrays bound
+	GLStateCache::InvalidateVertexArray();
+
+	// the scene objects are defined once, and then traversed
+	// on the worker threads every frame
+	m_sceneObjects.clear();
+	m_importedObjects.clear();
+	m_materialRecords.clear();
+	m_materialRecordIndices.clear();
+	DefineDeskandwalls();
+	DefineKeyboardandmat();
+	DefineMouse();
+	DefinePCexterior();
+	DefinePCinterior();
+	DefineMonitor();
+	DefineGlass();
+	DefineImportedModels();
+	// the material table holds the pairings the objects use
+	UploadObjectMaterials();
+
+	m_drawPackets.resize(m_sceneObjects.size());
+
+	// the per-draw buffer holds one record for every scene object
+	m_pDrawData->Create((uint32_t)m_sceneObjects.size());
+
+	if ((true == m_bSinglePassViews) && (false == IsSinglePassViewsSupported()))
+	{
+		std::cout << "Single pass views need ARB_viewport_array and ARB_shader_viewport_layer_array, drawing each view separately" << std::endl;
+		m_bSinglePassViews = false;
+	}
+
+	if ((true == m_bLightmaps) && (false == LightmapBaker::IsSupported()))
+	{
+		std::cout << "Lightmaps need more than 19 texture units, lighting every fragment" << std::endl;
+		m_bLightmaps = false;
+	}
+
+	// the lightmaps are drawn through the scene meshes, which
+	// carry the lightmap coordinates
+	if (((true == m_bGPUDriven) || (true == m_bSinglePassViews) || (true == m_bLightmaps)) &&
+		(false == CreateSceneMeshes()))
+	{
+		m_bGPUDriven = false;
+		m_bSinglePassViews = false;
+		m_bLightmaps = false;
+	}
+
+	// the atlas squares go into the draw records, so the bake
+	// starts before the GPU-driven buffers are filled
+	if ((true == m_bLightmaps) && (false == StartLightmapBake()))
+	{
+		std::cout << "Could not lay out the lightmaps, lighting every fragment" << std::endl;
+		delete m_pLightmaps;
+		m_pLightmaps = NULL;
+		m_bLightmaps = false;
+	}
+
+	if ((true == m_bGPUDriven) && (false == CreateGPUDrivenScene()))
+	{
+		std::cout << "Falling back to CPU recorded draw packets" << std::endl;
+		delete m_pGPURenderer;
+		m_pGPURenderer = NULL;
+		m_bGPUDriven = false;
+	}
+
+	if ((NULL != m_pEnvironment) && (false == m_pEnvironment->Finish()))
+	{
+		std::cout << "Could not prepare the environment lighting, using Phong shading" << std::endl;
+		delete m_pEnvironment;
+		m_pEnvironment = NULL;
+		m_bPhysicallyBased = false;
+	}
+
+	// the draw records keep their atlas squares, which the
+	// variants without lightmaps never read
+	if ((NULL != m_pLightmaps) && (false == m_pLightmaps->Finish()))
+	{
+		std::cout << "Could not prepare the lightmaps, lighting every fragment" << std::endl;
+		delete m_pLightmaps;
+		m_pLightmaps = NULL;
+		m_bLightmaps = false;
+	}
+
+	// build every variant the scene can draw with now, so no
+	// shader is compiled in the middle of a frame
+	std::vector<uint32_t> variants;
+	for (int pass = 0; pass < g_VariantPassCount; pass++)
+	{
+		variants.push_back(ShaderVariants::MakeVariant(
+			g_VariantPasses[pass] | GetLightingFlags(),
+			m_lightCount));
+	}
+	if (true == m_bGPUDriven)
+	{
+		variants.push_back(ShaderVariants::MakeVariant(
+			ShaderVariants::VARIANT_MIXED_TEXTURE | GetLightingFlags(),
+			m_lightCount));
+		variants.push_back(ShaderVariants::MakeVariant(
+			ShaderVariants::VARIANT_MIXED_TEXTURE | ShaderVariants::VARIANT_TRANSPARENT | GetLightingFlags(),
+			m_lightCount));
+	}
+	m_pShaderVariants->Prepare(variants);
+
+	if (true == m_bHotReload)
+	{
+		StartHotReload();
+	}
 }
 
 /***********************************************************
  *  RenderScene()
  *
- *  This method is used for rendering the 3D scene by
- *  transforming and drawing the basic 3D shapes
+ *  This method is used for rendering the 3D scene from a
+ *  single view, by recording the draw packets on the worker
+ *  threads and then drawing the basic 3D shapes on the GL
+ *  thread
+ ***********************************************************/
+void SceneManager::RenderScene(glm::mat4 viewProjection)
+{
+	RecordScene(&viewProjection, 1);
+	SubmitScene(0);
+	FinishScene();
+}
+
+/***********************************************************
+ *  RecordScene()
+ *
+ *  This method is used for recording the draw packets of
+ *  the scene for several views at once.  The model matrices
+ *  and draw records are shared by all the views, and each
+ *  packet is marked with the views it is visible in.
+ ***********************************************************/
+void SceneManager::RecordScene(const glm::mat4 viewProjections[], int viewCount)
+{
+	m_viewCount = glm::clamp(viewCount, 1, MAX_VIEWS);
+	for (int view = 0; view < m_viewCount; view++)
+	{
+		m_viewProjections[view] = viewProjections[view];
+	}
+
+	// the GPU culls each view when it is submitted
+	if (false == m_bGPUDriven)
+	{
+		RecordDrawPackets();
+	}
+}
+
+/***********************************************************
+ *  SubmitScene()
+ *
+ *  This method is used for drawing the recorded scene from
+ *  one of its views.  The viewport and the view uniforms of
+ *  that view must already be set.
+ ***********************************************************/
+void SceneManager::SubmitScene(int viewIndex)
+{
+	if ((viewIndex < 0) || (viewIndex >= m_viewCount))
+	{
+		return;
+	}
+
+	if (true == m_bGPUDriven)
+	{
+		glm::vec4 frustumPlanes[1][6];
+		ExtractFrustumPlanes(m_viewProjections[viewIndex], frustumPlanes[0]);
+
+		m_pGPURenderer->Cull(&m_viewProjections[viewIndex], frustumPlanes, 1);
+		DrawGPUDrivenScene();
+		DrawImportedObjects(frustumPlanes, 1);
+		return;
+	}
+
+	SubmitDrawPackets(viewIndex);
+}
+
+/***********************************************************
+ *  SubmitSceneAllViews()
+ *
+ *  This method is used for drawing the recorded scene into
+ *  all of its views with a single submission.  Each draw is
+ *  instanced once per view, and the vertex shader picks the
+ *  viewport of the instance, so the viewports and the view
+ *  uniforms of every view must already be set.
+ ***********************************************************/
+void SceneManager::SubmitSceneAllViews()
+{
+	if (true == m_bGPUDriven)
+	{
+		glm::vec4 frustumPlanes[MAX_VIEWS][6];
+		for (int view = 0; view < m_viewCount; view++)
+		{
+			ExtractFrustumPlanes(m_viewProjections[view], frustumPlanes[view]);
+		}
+
+		m_pGPURenderer->Cull(m_viewProjections, frustumPlanes, m_viewCount);
+		DrawGPUDrivenScene();
+		DrawImportedObjects(frustumPlanes, m_viewCount);
+		return;
+	}
+
+	if ((false == m_bSinglePassViews) || (NULL == m_pSceneMeshes))
+	{
+		return;
+	}
+
+	SubmitDrawPacketsAllViews();
+}
+
+/***********************************************************
+ *  FinishScene()
+ *
+ *  This method is used for finishing the frame once every
+ *  view has been submitted.
  ***********************************************************/
-void SceneManager::RenderScene()
+void SceneManager::FinishScene()
 {
-	RenderDeskandwalls();
-	RenderKeyboardandmat();
-	RenderMouse();
-	RenderPCexterior();
-	RenderPCinterior();
-	RenderMonitor();
-	RenderGlass();
+	if (false == m_bGPUDriven)
+	{
+		// fence the frame region so it is not overwritten too early
+		m_pDrawData->EndFrame();
+	}
+
+	// the mips streamed in now are used from the next frame
+	UpdateTextureStreaming();
 }
 
 /***********************************************************
- *  RenderDeskandwalls()
+ *  DefineDeskandwalls()
  *
- *  This method is called to render the shapes for the desk
+ *  This method is called to define the shapes for the desk
  *  and wall objects.
  ***********************************************************/
-void SceneManager::RenderDeskandwalls()
+void SceneManager::DefineDeskandwalls()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -628,8 +2362,8 @@ void SceneManager::RenderDeskandwalls()
 	SetShaderMaterial("walls");
 
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_PLANE);
 
 	// set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(10.0f, 1.0f, 10.0f);
@@ -656,8 +2390,8 @@ void SceneManager::RenderDeskandwalls()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("walls");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_PLANE);
 
 	// set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(20.0f, 1.0f, 10.0f);
@@ -683,18 +2417,18 @@ void SceneManager::RenderDeskandwalls()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("wood");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_PLANE);
 }
 
 
 /***********************************************************
- *  RenderKeyboardandmat()
+ *  DefineKeyboardandmat()
  *
- *  This method is called to render the shapes for the mat
+ *  This method is called to define the shapes for the mat
  *  and keyboard objects.
  ***********************************************************/
-void SceneManager::RenderKeyboardandmat()
+void SceneManager::DefineKeyboardandmat()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -728,8 +2462,8 @@ void SceneManager::RenderKeyboardandmat()
 	SetShaderTexture("pad2");
 	SetTextureUVScale(1.0, 1.0);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(14.0f, 0.5f, 5.0f);
@@ -755,8 +2489,8 @@ void SceneManager::RenderKeyboardandmat()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(1.0f, 14.0f, 0.5f);
@@ -782,8 +2516,8 @@ void SceneManager::RenderKeyboardandmat()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPrismMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_PRISM);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(14.01f, 0.49f, 5.01f);
@@ -809,18 +2543,18 @@ void SceneManager::RenderKeyboardandmat()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 }
 
 /***********************************************************
- *  RenderMouse()
+ *  DefineMouse()
  *
- *  This method is called to render the shapes for the mouse
+ *  This method is called to define the shapes for the mouse
  *  object.
  ***********************************************************/
-void SceneManager::RenderMouse()
+void SceneManager::DefineMouse()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -853,8 +2587,8 @@ void SceneManager::RenderMouse()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_CYLINDER);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(1.0f, 0.5f, 2.0f);
@@ -880,8 +2614,8 @@ void SceneManager::RenderMouse()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawSphereMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_SPHERE);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(0.35f, 0.35f, 0.35f);
@@ -904,8 +2638,8 @@ void SceneManager::RenderMouse()
 
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_TORUS);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(0.15f, 0.15f, 0.15f);
@@ -928,8 +2662,8 @@ void SceneManager::RenderMouse()
 
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(0.15f, 0.3f, 0.15f);
@@ -952,8 +2686,8 @@ void SceneManager::RenderMouse()
 
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(0.15f, 0.3f, 0.15f);
@@ -976,8 +2710,8 @@ void SceneManager::RenderMouse()
 
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(1.0f, 1.8f, 0.5f);
@@ -1000,17 +2734,17 @@ void SceneManager::RenderMouse()
 
 	SetShaderColor(0.949, 0.184, 0.863, 1);
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_TORUS);
 }
 
 /***********************************************************
- *  RenderMonitor()
+ *  DefineMonitor()
  *
- *  This method is called to render the shapes for the monitor
+ *  This method is called to define the shapes for the monitor
  *  object.
  ***********************************************************/
-void SceneManager::RenderMonitor()
+void SceneManager::DefineMonitor()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -1043,8 +2777,8 @@ void SceneManager::RenderMonitor()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawPrismMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_PRISM);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(1.15f, 6.3f, 1.15f);
@@ -1070,8 +2804,8 @@ void SceneManager::RenderMonitor()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	// set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(1.0f, 1.0f, 0.85f);
@@ -1097,8 +2831,8 @@ void SceneManager::RenderMonitor()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	// set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(12.0f, 0.1f, 6.0f);
@@ -1124,8 +2858,8 @@ void SceneManager::RenderMonitor()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	// set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(12.25f, 0.25f, 6.25f);
@@ -1151,17 +2885,17 @@ void SceneManager::RenderMonitor()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 }
 	
 /***********************************************************
- *  RenderPCexterior()
+ *  DefinePCexterior()
  *
- *  This method is called to render the shapes for the PC
+ *  This method is called to define the shapes for the PC
  *  exterior objects.
  ***********************************************************/
-void SceneManager::RenderPCexterior()
+void SceneManager::DefinePCexterior()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -1193,8 +2927,8 @@ void SceneManager::RenderPCexterior()
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_CYLINDER);
 
 	//PC FOOT BL ***************
 // set the XYZ scale for the mesh
@@ -1219,8 +2953,8 @@ void SceneManager::RenderPCexterior()
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_CYLINDER);
 
 	//PC FOOT FR ***************
 // set the XYZ scale for the mesh
@@ -1245,8 +2979,8 @@ void SceneManager::RenderPCexterior()
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_CYLINDER);
 
 	//PC FOOT BR ***************
 // set the XYZ scale for the mesh
@@ -1271,8 +3005,8 @@ void SceneManager::RenderPCexterior()
 	SetShaderColor(0.071, 0.071, 0.071, 1);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_CYLINDER);
 
 	//PC BOTTOM ***************
 // set the XYZ scale for the mesh
@@ -1299,8 +3033,8 @@ void SceneManager::RenderPCexterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC TOP ***************
 // set the XYZ scale for the mesh
@@ -1327,8 +3061,8 @@ void SceneManager::RenderPCexterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC BACK ***************
 // set the XYZ scale for the mesh
@@ -1355,8 +3089,8 @@ void SceneManager::RenderPCexterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC SIDE 1 ***************
 // set the XYZ scale for the mesh
@@ -1383,8 +3117,8 @@ void SceneManager::RenderPCexterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC MOTHERBOARD ***************
 	// set the XYZ scale for the mesh
@@ -1411,8 +3145,8 @@ void SceneManager::RenderPCexterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC FRONT ***************
 // set the XYZ scale for the mesh
@@ -1439,17 +3173,17 @@ void SceneManager::RenderPCexterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 }
 
 /***********************************************************
- *  RenderPCinterior()
+ *  DefinePCinterior()
  *
- *  This method is called to render the shapes for the PC
+ *  This method is called to define the shapes for the PC
  *  interior objects.
  ***********************************************************/
-void SceneManager::RenderPCinterior()
+void SceneManager::DefinePCinterior()
 {
 	// declare the variables for the transformations
 	glm::vec3 scaleXYZ;
@@ -1483,8 +3217,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_CYLINDER);
 
 	// CPU COOLER SCREEN ***************
 // set the XYZ scale for the mesh
@@ -1511,8 +3245,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawCylinderMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_CYLINDER);
 
 	//PC COOLER COVER ***************
 // set the XYZ scale for the mesh
@@ -1539,8 +3273,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_TORUS);
 
 	//PC RAM STICK L ***************
 // set the XYZ scale for the mesh
@@ -1567,8 +3301,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC RAM STICK R ***************
 // set the XYZ scale for the mesh
@@ -1595,8 +3329,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC RAM STICK RGB R ***************
 // set the XYZ scale for the mesh
@@ -1623,8 +3357,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC RAM STICK RGB L ***************
 // set the XYZ scale for the mesh
@@ -1651,8 +3385,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("plastic");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC MOTHERBOARD BACKPLATE ***************
 // set the XYZ scale for the mesh
@@ -1679,8 +3413,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC MOTHERBOARD BACKPLATE P2 ***************
 // set the XYZ scale for the mesh
@@ -1707,8 +3441,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 	//PC FRONT FAN M ***************
 // set the XYZ scale for the mesh
@@ -1735,8 +3469,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("wood");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_TORUS);
 
 	//PC FRONT FAN T ***************
 // set the XYZ scale for the mesh
@@ -1763,8 +3497,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("wood");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_TORUS);
 
 	//PC FRONT FAN B ***************
 // set the XYZ scale for the mesh
@@ -1791,8 +3525,8 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("wood");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawTorusMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_TORUS);
 
 
 	//PC PSU BLOCK ***************
@@ -1820,17 +3554,17 @@ void SceneManager::RenderPCinterior()
 	SetTextureUVScale(1.0, 1.0);
 	SetShaderMaterial("metal");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 	}
 
 	/***********************************************************
- *  RenderGlass()
+ *  DefineGlass()
  *
- *  This method is called to render the shapes for the PC
+ *  This method is called to define the shapes for the PC
  *  glass objects.
  ***********************************************************/
-	void SceneManager::RenderGlass()
+	void SceneManager::DefineGlass()
 	{
 		// declare the variables for the transformations
 		glm::vec3 scaleXYZ;
@@ -1861,8 +3595,8 @@ void SceneManager::RenderPCinterior()
 	SetShaderColor(.7, .7, .8, 0.3);
 	SetShaderMaterial("glass");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
 
 // set the XYZ scale for the mesh
 	scaleXYZ = glm::vec3(5.404f, 0.05f, 9.8f);
@@ -1886,6 +3620,58 @@ void SceneManager::RenderPCinterior()
 	SetShaderColor(.7, .7, .8, 0.3);
 	SetShaderMaterial("glass");
 
-	// draw the mesh with transformation values
-	m_basicMeshes->DrawBoxMesh();
+	// add the mesh with transformation values to the scene
+	AddSceneObject(MESH_BOX);
+}
+
+/***********************************************************
+ *  DefineImportedModels()
+ *
+ *  This method is called to load the imported models and
+ *  define their objects.  Each model is scaled to fit a
+ *  spot along the front left of the desk, standing on it.
+ ***********************************************************/
+void SceneManager::DefineImportedModels()
+{
+	// size of the largest side of a model on the desk, and
+	// the spacing between the models
+	const float modelSize = 4.0f;
+	const float modelSpacing = 5.0f;
+
+	for (size_t i = 0; i < m_importPaths.size(); i++)
+	{
+		ImportedMesh* pMesh = new ImportedMesh();
+		if (false == pMesh->Load(m_importPaths[i].c_str(), m_pAssetPack))
+		{
+			std::cout << "Could not load the model " << m_importPaths[i] << std::endl;
+			delete pMesh;
+			continue;
+		}
+
+		glm::vec3 boundsMin = pMesh->GetBoundsMin();
+		glm::vec3 boundsMax = pMesh->GetBoundsMax();
+		glm::vec3 size = boundsMax - boundsMin;
+		float largestSide = glm::max(size.x, glm::max(size.y, size.z));
+		float scale = (largestSide > 0.0f) ? modelSize / largestSide : 1.0f;
+
+		// center the model on its spot, with its lowest point
+		// on the desk top
+		glm::vec3 spot = glm::vec3(-16.0f + modelSpacing * (float)(m_importedMeshes.size() % 4), 0.0f, 5.0f);
+		glm::vec3 offset = glm::vec3(
+			(boundsMin.x + boundsMax.x) * 0.5f,
+			boundsMin.y,
+			(boundsMin.z + boundsMax.z) * 0.5f) * scale;
+
+		SetTransformations(
+			glm::vec3(scale, scale, scale),
+			0.0f,
+			0.0f,
+			0.0f,
+			spot - offset);
+		SetShaderColor(0.8f, 0.8f, 0.8f, 1.0f);
+		SetShaderMaterial("plastic");
+
+		m_importedMeshes.push_back(pMesh);
+		AddImportedObject((int)m_importedMeshes.size() - 1);
+	}
 }
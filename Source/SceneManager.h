@@ -9,10 +9,22 @@
 
 #pragma once
 
-#include "ShaderManager.h"
+#include "ShaderVariants.h"
 #include "ShapeMeshes.h"
+#include "JobSystem.h"
+#include "DrawDataBuffer.h"
+#include "SceneMeshes.h"
+#include "GPUDrivenRenderer.h"
+#include "ImportedMesh.h"
+#include "AssetPack.h"
+#include "TextureStreamer.h"
+#include "TextureImporter.h"
+#include "FileWatcher.h"
+#include "EnvironmentLighting.h"
+#include "LightmapBaker.h"
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 /***********************************************************
@@ -25,16 +37,27 @@ class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(ShaderVariants* pShaderVariants, JobSystem* pJobSystem, const AssetPack* pAssetPack);
 	// destructor
 	~SceneManager();
 
+	// most views the scene can be recorded for at once
+	static const int MAX_VIEWS = 4;
+
 	struct TEXTURE_INFO
 	{
 		std::string tag;
 		uint32_t ID;
 	};
 
+	// texture slots a material samples, -1 where it has none
+	struct TEXTURE_SET
+	{
+		int albedoSlot;
+		int normalSlot;
+		int roughnessSlot;
+	};
+
 	struct OBJECT_MATERIAL
 	{
 		float ambientStrength;
@@ -42,23 +65,198 @@ public:
 		glm::vec3 diffuseColor;
 		glm::vec3 specularColor;
 		float shininess;
+		// surface of the material for the physically based
+		// shading, from 0 to 1
+		float metallic;
+		float roughness;
+		// textures of the material - an object's own texture
+		// takes the place of the albedo
+		TEXTURE_SET textures;
 		std::string tag;
 	};
 
+	// everything needed to transform and draw one object
+	struct SCENE_OBJECT
+	{
+		MESH_TYPE mesh;
+		glm::vec3 scaleXYZ;
+		glm::vec3 rotationDegrees;
+		glm::vec3 positionXYZ;
+		bool bUseTexture;
+		int textureSlot;
+		glm::vec2 UVscale;
+		glm::vec4 color;
+		// defined material, or -1 for the first one
+		int materialIndex;
+		// entry of the material table the object is drawn with
+		uint16_t materialRecord;
+		// index of the imported mesh drawn for the object, or
+		// -1 when it is one of the basic shapes
+		int importedMesh;
+		// square of the lightmap atlas the object reads its
+		// baked light from, all zero when it is lit per fragment
+		glm::vec4 lightmapScaleOffset;
+	};
+
+	// compact draw command recorded by the worker threads
+	// and consumed by the GL thread
+	struct DRAW_PACKET
+	{
+		uint32_t objectIndex;
+		uint16_t mesh;
+		// one bit for each view the object is visible in
+		uint8_t visibleViews;
+		// shader variant flags of the object - the transparent
+		// objects are drawn after the opaque ones, with
+		// blending on
+		uint8_t variant;
+	};
+
+	// material values as laid out in the shader storage
+	// buffer - must match the Material struct in the shaders
+	struct MATERIAL_RECORD
+	{
+		glm::vec4 ambientColorStrength;
+		glm::vec4 diffuseColor;
+		glm::vec4 specularColorShininess;
+		// albedo, normal and roughness texture slots, -1 where
+		// there is none
+		glm::ivec4 textureSet;
+		// metallic and roughness, for the physically based
+		// shading
+		glm::vec4 metallicRoughness;
+	};
+
+	// most entries the material table can hold, which keeps
+	// the material index of a draw in 16 bits
+	static const int MAX_MATERIAL_RECORDS = 65536;
+
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
+	// mip chain of a texture file loaded on a worker thread
+	struct TEXTURE_IMAGE
+	{
+		std::string filename;
+		bool bDecoded;
+		// true when the mips were read from the texture cache
+		bool bFromCache;
+		// channels of the image file, before it was expanded
+		int colorChannels;
+		double milliseconds;
+		// every mip level of the image
+		TextureStreamer::MIP_CHAIN mipChain;
+	};
+
+	// pointer to the shader variants the scene is drawn with
+	ShaderVariants* m_pShaderVariants;
+	// lighting shared by every variant the scene uses
+	bool m_bUseLighting;
+	int m_lightCount;
+	// true when the scene is shaded with metallic and
+	// roughness and lit by the environment maps as well
+	bool m_bPhysicallyBased;
+	EnvironmentLighting* m_pEnvironment;
+	// true when the static objects read their diffuse light
+	// from the baked lightmaps instead of the light sources
+	bool m_bLightmaps;
+	LightmapBaker* m_pLightmaps;
 	// pointer to basic shapes object
 	ShapeMeshes* m_basicMeshes;
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
+	// texture images waiting to be uploaded into OpenGL
+	TEXTURE_IMAGE m_textureImages[16];
+	// counts the texture images still being decoded
+	JobCounter m_textureDecodeJobs;
+	// keeps the texture mips the views need resident
+	TextureStreamer* m_pTextureStreamer;
+	// height in pixels of each view, for the texture footprints
+	int m_viewportHeights[MAX_VIEWS];
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// material table entries, one for each pairing of a
+	// defined material with the textures an object uses, and
+	// the entry of each pairing
+	std::vector<MATERIAL_RECORD> m_materialRecords;
+	std::unordered_map<uint64_t, uint16_t> m_materialRecordIndices;
+	// pointer to the shared job system
+	JobSystem* m_pJobSystem;
+	// pointer to the asset pack the textures and meshes are
+	// read from
+	const AssetPack* m_pAssetPack;
+	// objects defined for the 3D scene
+	std::vector<SCENE_OBJECT> m_sceneObjects;
+	// object settings collected until the next AddSceneObject()
+	SCENE_OBJECT m_pendingObject;
+	// persistently mapped buffer for the per-draw shader data
+	DrawDataBuffer* m_pDrawData;
+	// shader storage buffer holding the material table
+	GLuint m_materialBufferID;
+	// draw packets recorded for the current frame
+	std::vector<DRAW_PACKET> m_drawPackets;
+	// whether the packets and draw records of the current frame
+	// were written, and whether a missing per-draw buffer has
+	// already been reported
+	bool m_bDrawPacketsRecorded;
+	bool m_bDrawDataMissingReported;
+	// view projection matrices of the views being recorded,
+	// used for frustum culling
+	glm::mat4 m_viewProjections[MAX_VIEWS];
+	int m_viewCount;
+	// shared meshes and GPU culling used when the scene is
+	// drawn with GPU-driven rendering
+	SceneMeshes* m_pSceneMeshes;
+	GPUDrivenRenderer* m_pGPURenderer;
+	bool m_bGPUDriven;
+	// true when all the views can be drawn in a single pass
+	bool m_bSinglePassViews;
+	// true when the scene meshes use the packed vertex layout
+	bool m_bPackedVertices;
+	// multiplier for the segment counts of the closest level
+	// of detail of the curved scene meshes
+	int m_meshDetail;
+	// filter the texture mips are built with
+	ImagePipeline::MIP_FILTER m_mipFilter;
+	// model files to import, and the meshes loaded from them
+	std::vector<std::string> m_importPaths;
+	std::vector<ImportedMesh*> m_importedMeshes;
+	// scene objects that draw an imported mesh
+	std::vector<uint32_t> m_importedObjects;
+
+	// texture or model file being loaded again on a worker
+	// thread after it was edited
+	struct ASSET_RELOAD
+	{
+		std::string filePath;
+		// texture slot or imported mesh the file replaces
+		int index;
+		bool bTexture;
+		bool bLoaded;
+		// set when the file was edited again before this load
+		// finished, so its result is thrown away
+		bool bStale;
+		double milliseconds;
+		TextureStreamer::MIP_CHAIN mipChain;
+		int colorChannels;
+		MESH_DATA mesh;
+		JobCounter job;
+	};
+
+	// true when edited asset files are loaded again while the
+	// scene is running
+	bool m_bHotReload;
+	FileWatcher* m_pFileWatcher;
+	// asset pack that is never opened, so the edited files are
+	// read from disk even when an older version is packed
+	AssetPack m_looseFiles;
+	// edited files still loading, in the order they were edited
+	std::vector<ASSET_RELOAD*> m_assetReloads;
 
-	// load texture images and convert to OpenGL texture data
+	// start decoding a texture image on the worker threads
 	bool CreateGLTexture(const char* filename, std::string tag);
+	// convert the decoded texture images to OpenGL texture data
+	void UploadGLTextures();
 	// bind loaded OpenGL textures to slots in memory
 	void BindGLTextures();
 	// free the loaded OpenGL textures
@@ -67,7 +265,14 @@ private:
 	int FindTextureID(std::string tag);
 	int FindTextureSlot(std::string tag);
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	int FindMaterialIndex(std::string tag);
+	// build a texture set from texture tags, which may be NULL
+	TEXTURE_SET MakeTextureSet(const char* albedoTag, const char* normalTag, const char* roughnessTag);
+	// get the material table entry for the material and
+	// texture of an object, adding it when it is new
+	uint16_t FindMaterialRecord(const SCENE_OBJECT& object);
+	// fill in the material table entry of a new object
+	void ResolveObjectMaterial(SCENE_OBJECT& object);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -97,26 +302,128 @@ private:
 	void SetShaderMaterial(
 		std::string materialTag);
 
+	// add an object to the scene using the current settings
+	void AddSceneObject(MESH_TYPE mesh);
+	// add an object that draws one of the imported meshes
+	void AddImportedObject(int importedMesh);
+	// object space bounding sphere of a scene object's mesh
+	glm::vec4 GetLocalBounds(const SCENE_OBJECT& object) const;
+	// compute the model matrices and cull the scene objects
+	// on the worker threads
+	void RecordDrawPackets();
+	// issue the recorded draw packets of one view on the GL thread
+	void SubmitDrawPackets(int viewIndex);
+	// issue the recorded draw packets once for all of the views
+	void SubmitDrawPacketsAllViews();
+	// draw the specified basic mesh shape
+	void DrawMesh(MESH_TYPE mesh);
+	// make the shader variant current for objects with the
+	// passed in texture and transparency flags
+	void UseVariant(uint32_t objectFlags);
+	// variant flags of the lighting the whole scene shares
+	uint32_t GetLightingFlags() const;
+	// draw the imported objects visible in any of the views,
+	// which the GPU-driven path leaves to the CPU
+	void DrawImportedObjects(const glm::vec4 frustumPlanes[][6], int viewCount);
+	// generate and upload the shared scene meshes
+	bool CreateSceneMeshes();
+	// tell the vertex shader whether the next draws read the
+	// packed vertices of the scene meshes
+	void SetVertexDecode(bool bSceneMeshes);
+	// draw a basic shape from the shared scene meshes, which
+	// must already be bound
+	void DrawSceneMesh(MESH_TYPE mesh);
+	// create the buffers used by GPU-driven rendering
+	bool CreateGPUDrivenScene();
+	// draw the buckets the culling shader filled in
+	void DrawGPUDrivenScene();
+	// request the texture mips the visible objects need and
+	// stream them in or out
+	void UpdateTextureStreaming();
+	// start watching the files the scene was loaded from
+	void StartHotReload();
+	// load an edited texture or model again on a worker thread,
+	// and swap it in once it has loaded
+	void StartAssetReload(const std::string& filePath, int index, bool bTexture);
+	void FinishAssetReload(ASSET_RELOAD& reload);
+
 public:
 
+	// choose whether the GPU culls and draws the scene
+	void SetGPUDrivenRendering(bool bGPUDriven);
+	// choose whether several views are drawn in a single pass
+	// when the OpenGL context supports it
+	void SetSinglePassViews(bool bSinglePass);
+	bool IsSinglePassViews() const;
+	// choose whether the shared scene meshes are stored in the
+	// packed vertex layout
+	void SetPackedVertices(bool bPacked);
+	// multiply the segment counts of the most detailed curved
+	// scene meshes, which are then generated at startup
+	void SetMeshDetail(int detail);
+	// import an OBJ or glTF model and place it on the desk
+	void AddImportedModel(const char* filePath);
+	// choose the filter the texture mips are built with
+	void SetMipFilter(ImagePipeline::MIP_FILTER filter);
+	// set the video memory the streamed texture mips may use
+	void SetTextureBudget(int megabytes);
+	// set the height in pixels of a view, which decides the
+	// texture mips its objects need
+	void SetViewportHeight(int viewIndex, int height);
+	// choose whether edited shaders, textures and models are
+	// loaded again while the scene runs
+	void SetHotReload(bool bHotReload);
+	// swap in the edited assets that have finished loading -
+	// called between frames
+	void UpdateHotReload();
+	// choose whether the scene is shaded with metallic and
+	// roughness materials and the precomputed environment
+	// lighting - must be called before PrepareScene()
+	void SetPhysicallyBasedShading(bool bPhysicallyBased);
+	// choose whether the light of the static objects is baked
+	// into lightmaps - must be called before PrepareScene()
+	void SetLightmaps(bool bLightmaps);
+	// check whether the OpenGL context can send each instance
+	// of a draw to its own viewport
+	static bool IsSinglePassViewsSupported();
+
 	// The following methods are for the students to 
 	// customize for their own 3D scene
 	void PrepareScene();
-	void RenderScene();
+	void RenderScene(glm::mat4 viewProjection);
+
+	// render the scene from several views that share one
+	// recorded set of draw packets
+	void RecordScene(const glm::mat4 viewProjections[], int viewCount);
+	void SubmitScene(int viewIndex);
+	// draw the recorded scene into every view at once - the
+	// viewports and view uniforms of all the views must be set
+	void SubmitSceneAllViews();
+	void FinishScene();
 
 	// loads textures from image files
 	void LoadSceneTextures();
 	// define all the object materials before rendering
 	void DefineObjectMaterials();
+	// copy the material table into GPU memory, after the
+	// objects are defined
+	void UploadObjectMaterials();
 	// add and define the light sources before rendering
 	void SetupSceneLights();
+	// describe the surroundings the environment lighting is
+	// computed from
+	void DefineEnvironment(EnvironmentLighting::ENVIRONMENT& environment);
+	// hand the light sources and the static objects to the
+	// lightmap baker and start it
+	bool StartLightmapBake();
 
-	// methods for rendering the various objects in the 3D scene
-	void RenderDeskandwalls();
-	void RenderKeyboardandmat();
-	void RenderMouse();
-	void RenderPCexterior();
-	void RenderPCinterior();
-	void RenderMonitor();
-	void RenderGlass();
+	// methods for defining the various objects in the 3D scene
+	void DefineDeskandwalls();
+	void DefineKeyboardandmat();
+	void DefineMouse();
+	void DefinePCexterior();
+	void DefinePCinterior();
+	void DefineMonitor();
+	void DefineGlass();
+	void DefineImportedModels();
 };
\ No newline at end of file
@@ -0,0 +1,1109 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenemeshes.cpp
+// ============
+// generate the basic mesh shapes into one shared set of GPU buffers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneMeshes.h"
+#include "GLStateCache.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// segment counts for each level of detail of the curved shapes
+	constexpr int g_CylinderSegments[SceneMeshes::LOD_COUNT] = { 36, 18, 8 };
+	constexpr int g_SphereStacks[SceneMeshes::LOD_COUNT] = { 18, 10, 6 };
+	constexpr int g_SphereSlices[SceneMeshes::LOD_COUNT] = { 36, 20, 12 };
+	constexpr int g_TorusMainSegments[SceneMeshes::LOD_COUNT] = { 36, 18, 10 };
+	constexpr int g_TorusTubeSegments[SceneMeshes::LOD_COUNT] = { 18, 9, 6 };
+
+	// the standard tessellations, generated by the compiler
+	template <MESH_TYPE Mesh, int Segments1, int Segments2>
+	struct BAKED
+	{
+		typedef MeshTessellation<Mesh, Segments1, Segments2> TESSELLATION;
+		static constexpr typename TESSELLATION::TABLE TABLE = TESSELLATION::Bake();
+	};
+
+	template <MESH_TYPE Mesh, int Segments1, int Segments2>
+	constexpr typename BAKED<Mesh, Segments1, Segments2>::TESSELLATION::TABLE BAKED<Mesh, Segments1, Segments2>::TABLE;
+
+	// a baked table along with the tessellation it was made for
+	struct BAKED_MESH
+	{
+		MESH_TYPE mesh;
+		int segments1;
+		int segments2;
+		const GENERATED_VERTEX* pVertices;
+		uint32_t vertexCount;
+		const uint32_t* pIndices;
+		uint32_t indexCount;
+	};
+
+	// describe the baked table of one tessellation
+	template <MESH_TYPE Mesh, int Segments1, int Segments2>
+	constexpr BAKED_MESH MakeBakedMesh()
+	{
+		return(BAKED_MESH{
+			Mesh,
+			Segments1,
+			Segments2,
+			BAKED<Mesh, Segments1, Segments2>::TABLE.vertices,
+			BAKED<Mesh, Segments1, Segments2>::TABLE.vertexCount,
+			BAKED<Mesh, Segments1, Segments2>::TABLE.indices,
+			BAKED<Mesh, Segments1, Segments2>::TABLE.indexCount });
+	}
+
+	// every level of detail of the curved shapes is baked
+	const BAKED_MESH g_BakedMeshes[] =
+	{
+		MakeBakedMesh<MESH_CYLINDER, g_CylinderSegments[0], 0>(),
+		MakeBakedMesh<MESH_CYLINDER, g_CylinderSegments[1], 0>(),
+		MakeBakedMesh<MESH_CYLINDER, g_CylinderSegments[2], 0>(),
+		MakeBakedMesh<MESH_TAPERED_CYLINDER, g_CylinderSegments[0], 0>(),
+		MakeBakedMesh<MESH_TAPERED_CYLINDER, g_CylinderSegments[1], 0>(),
+		MakeBakedMesh<MESH_TAPERED_CYLINDER, g_CylinderSegments[2], 0>(),
+		MakeBakedMesh<MESH_SPHERE, g_SphereStacks[0], g_SphereSlices[0]>(),
+		MakeBakedMesh<MESH_SPHERE, g_SphereStacks[1], g_SphereSlices[1]>(),
+		MakeBakedMesh<MESH_SPHERE, g_SphereStacks[2], g_SphereSlices[2]>(),
+		MakeBakedMesh<MESH_TORUS, g_TorusMainSegments[0], g_TorusTubeSegments[0]>(),
+		MakeBakedMesh<MESH_TORUS, g_TorusMainSegments[1], g_TorusTubeSegments[1]>(),
+		MakeBakedMesh<MESH_TORUS, g_TorusMainSegments[2], g_TorusTubeSegments[2]>()
+	};
+
+	/***********************************************************
+	 *  FindBakedMesh()
+	 *
+	 *  Find the baked table for a tessellation, or return NULL
+	 *  when it has to be generated at runtime.
+	 ***********************************************************/
+	const BAKED_MESH* FindBakedMesh(MESH_TYPE mesh, int segments1, int segments2)
+	{
+		for (size_t i = 0; i < sizeof(g_BakedMeshes) / sizeof(g_BakedMeshes[0]); i++)
+		{
+			const BAKED_MESH& baked = g_BakedMeshes[i];
+			if ((baked.mesh == mesh) &&
+				(baked.segments1 == segments1) &&
+				(baked.segments2 == segments2))
+			{
+				return(&baked);
+			}
+		}
+
+		return(NULL);
+	}
+
+	/***********************************************************
+	 *  FloatToHalf()
+	 *
+	 *  Convert a float to the bits of a half float, rounding
+	 *  to nearest.  Values too small for a half become zero
+	 *  and values too large become infinity.
+	 ***********************************************************/
+	uint16_t FloatToHalf(float value)
+	{
+		uint32_t bits = 0;
+		memcpy(&bits, &value, sizeof(bits));
+
+		uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+		int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+		uint32_t mantissa = bits & 0x007FFFFF;
+
+		if (exponent <= 0)
+		{
+			return(sign);
+		}
+		if (exponent >= 31)
+		{
+			return((uint16_t)(sign | 0x7C00));
+		}
+
+		// round the dropped mantissa bits to nearest
+		uint32_t half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+		if ((mantissa & 0x1000) != 0)
+		{
+			half++;
+		}
+
+		return((uint16_t)(sign | half));
+	}
+
+	/***********************************************************
+	 *  ToSnorm16()
+	 *
+	 *  Convert a value from -1 to 1 into a signed normalized
+	 *  16 bit value.
+	 ***********************************************************/
+	int16_t ToSnorm16(float value)
+	{
+		value = fminf(fmaxf(value, -1.0f), 1.0f);
+		return((int16_t)lroundf(value * 32767.0f));
+	}
+
+	/***********************************************************
+	 *  EncodeOctahedral()
+	 *
+	 *  Project a unit normal onto the octahedron and unfold it
+	 *  into the -1 to 1 square, so it can be stored in two
+	 *  values.  The vertex shader reverses this.
+	 ***********************************************************/
+	glm::vec2 EncodeOctahedral(glm::vec3 normal)
+	{
+		float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+		if (length <= 0.0f)
+		{
+			return(glm::vec2(0.0f, 0.0f));
+		}
+
+		glm::vec2 encoded = glm::vec2(normal.x / length, normal.y / length);
+		if (normal.z < 0.0f)
+		{
+			// fold the lower half over the diagonals
+			glm::vec2 folded;
+			folded.x = (1.0f - fabsf(encoded.y)) * ((encoded.x >= 0.0f) ? 1.0f : -1.0f);
+			folded.y = (1.0f - fabsf(encoded.x)) * ((encoded.y >= 0.0f) ? 1.0f : -1.0f);
+			encoded = folded;
+		}
+
+		return(encoded);
+	}
+
+	// share of each lightmap chart cell left empty around the
+	// chart, so filtering one chart does not pick up the next
+	const float g_LightmapChartMargin = 0.04f;
+
+	/***********************************************************
+	 *  GetLightmapChartRect()
+	 *
+	 *  Get the cell of the unit square that a chart of a shape
+	 *  is laid out in - xy is the size and zw the corner.  The
+	 *  box faces and the prism faces share a 3 by 2 grid, and
+	 *  the cylinders put the side across the bottom half with
+	 *  the caps above it.  The other shapes are one chart.
+	 ***********************************************************/
+	glm::vec4 GetLightmapChartRect(MESH_TYPE mesh, int chart)
+	{
+		glm::vec4 rect = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+
+		switch (mesh)
+		{
+		case MESH_BOX:
+		case MESH_PRISM:
+			rect = glm::vec4(1.0f / 3.0f, 0.5f, (float)(chart % 3) / 3.0f, (float)(chart / 3) * 0.5f);
+			break;
+		case MESH_CYLINDER:
+		case MESH_TAPERED_CYLINDER:
+			if (0 == chart)
+			{
+				rect = glm::vec4(1.0f, 0.5f, 0.0f, 0.0f);
+			}
+			else
+			{
+				rect = glm::vec4(0.5f, 0.5f, (float)(chart - 1) * 0.5f, 0.5f);
+			}
+			break;
+		default:
+			break;
+		}
+
+		glm::vec2 margin = glm::vec2(rect.x, rect.y) * g_LightmapChartMargin;
+
+		return(glm::vec4(
+			rect.x - margin.x * 2.0f,
+			rect.y - margin.y * 2.0f,
+			rect.z + margin.x,
+			rect.w + margin.y));
+	}
+}
+
+/***********************************************************
+ *  SceneMeshes()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneMeshes::SceneMeshes()
+{
+	m_pCurrentLOD = NULL;
+	m_bPackedVertices = false;
+	m_positionOffset = glm::vec3(0.0f);
+	m_positionScale = glm::vec3(1.0f);
+	m_vertexArrayID = 0;
+	m_vertexBufferID = 0;
+	m_indexBufferID = 0;
+	m_lightmapBufferID = 0;
+
+	for (int mesh = 0; mesh < MESH_TYPE_COUNT; mesh++)
+	{
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			m_meshLODs[mesh][lod].firstIndex = 0;
+			m_meshLODs[mesh][lod].indexCount = 0;
+			m_meshLODs[mesh][lod].baseVertex = 0;
+			m_meshLODs[mesh][lod].vertexCount = 0;
+			m_generatedStats[mesh][lod].ACMR = 0.0f;
+			m_generatedStats[mesh][lod].ATVR = 0.0f;
+			m_optimizedStats[mesh][lod].ACMR = 0.0f;
+			m_optimizedStats[mesh][lod].ATVR = 0.0f;
+		}
+	}
+	m_currentMesh = MESH_PLANE;
+	m_currentLODIndex = 0;
+
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		SetTessellation(MESH_CYLINDER, lod, g_CylinderSegments[lod], 0);
+		SetTessellation(MESH_TAPERED_CYLINDER, lod, g_CylinderSegments[lod], 0);
+		SetTessellation(MESH_SPHERE, lod, g_SphereStacks[lod], g_SphereSlices[lod]);
+		SetTessellation(MESH_TORUS, lod, g_TorusMainSegments[lod], g_TorusTubeSegments[lod]);
+	}
+}
+
+/***********************************************************
+ *  ~SceneMeshes()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneMeshes::~SceneMeshes()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  GenerateMeshes()
+ *
+ *  This method is used for generating the vertex and index
+ *  data of every basic shape at every level of detail.  The
+ *  flat shapes only have one level, which is shared by all
+ *  the level of detail slots.  Curved shapes with a baked
+ *  tessellation are copied from its table, and the others
+ *  are generated on the worker threads while the rest is
+ *  added.  No OpenGL calls are made.
+ ***********************************************************/
+void SceneMeshes::GenerateMeshes(JobSystem* pJobSystem)
+{
+	const MESH_TYPE curvedMeshes[] = { MESH_CYLINDER, MESH_TAPERED_CYLINDER, MESH_SPHERE, MESH_TORUS };
+	const int curvedCount = sizeof(curvedMeshes) / sizeof(curvedMeshes[0]);
+
+	// start generating the tessellations that were not baked
+	const BAKED_MESH* pBaked[curvedCount][LOD_COUNT];
+	MESH_DATA generated[curvedCount][LOD_COUNT];
+	JobCounter generateJobs;
+	int generatedCount = 0;
+	for (int i = 0; i < curvedCount; i++)
+	{
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			MESH_TYPE mesh = curvedMeshes[i];
+			int segments1 = m_tessellations[mesh][lod][0];
+			int segments2 = m_tessellations[mesh][lod][1];
+
+			pBaked[i][lod] = FindBakedMesh(mesh, segments1, segments2);
+			if (NULL != pBaked[i][lod])
+			{
+				continue;
+			}
+
+			MESH_DATA* pData = &generated[i][lod];
+			generatedCount++;
+			if (NULL != pJobSystem)
+			{
+				pJobSystem->Execute(
+					[pData, mesh, segments1, segments2]()
+					{
+						MeshGenerator::Generate(*pData, mesh, segments1, segments2);
+					},
+					&generateJobs);
+			}
+			else
+			{
+				MeshGenerator::Generate(*pData, mesh, segments1, segments2);
+			}
+		}
+	}
+
+	m_vertices.clear();
+	m_indices.clear();
+
+	BeginMesh(MESH_PLANE, 0);
+	AddPlane();
+	EndMesh();
+
+	BeginMesh(MESH_BOX, 0);
+	AddBox();
+	EndMesh();
+
+	BeginMesh(MESH_PRISM, 0);
+	AddPrism();
+	EndMesh();
+
+	if (NULL != pJobSystem)
+	{
+		pJobSystem->Wait(&generateJobs);
+	}
+
+	for (int lod = 0; lod < LOD_COUNT; lod++)
+	{
+		for (int i = 0; i < curvedCount; i++)
+		{
+			BeginMesh(curvedMeshes[i], lod);
+			if (NULL != pBaked[i][lod])
+			{
+				AddGenerated(
+					pBaked[i][lod]->pVertices,
+					pBaked[i][lod]->vertexCount,
+					pBaked[i][lod]->pIndices,
+					pBaked[i][lod]->indexCount);
+			}
+			else
+			{
+				const MESH_DATA& data = generated[i][lod];
+				AddGenerated(
+					data.vertices.data(),
+					(uint32_t)data.vertices.size(),
+					data.indices.data(),
+					(uint32_t)data.indices.size());
+			}
+			EndMesh();
+		}
+	}
+
+	if (generatedCount > 0)
+	{
+		std::cout << "Generated " << generatedCount << " custom mesh tessellations at runtime" << std::endl;
+	}
+
+	// the flat shapes look the same at any distance
+	for (int lod = 1; lod < LOD_COUNT; lod++)
+	{
+		m_meshLODs[MESH_PLANE][lod] = m_meshLODs[MESH_PLANE][0];
+		m_meshLODs[MESH_BOX][lod] = m_meshLODs[MESH_BOX][0];
+		m_meshLODs[MESH_PRISM][lod] = m_meshLODs[MESH_PRISM][0];
+		m_generatedStats[MESH_PLANE][lod] = m_generatedStats[MESH_PLANE][0];
+		m_generatedStats[MESH_BOX][lod] = m_generatedStats[MESH_BOX][0];
+		m_generatedStats[MESH_PRISM][lod] = m_generatedStats[MESH_PRISM][0];
+		m_optimizedStats[MESH_PLANE][lod] = m_optimizedStats[MESH_PLANE][0];
+		m_optimizedStats[MESH_BOX][lod] = m_optimizedStats[MESH_BOX][0];
+		m_optimizedStats[MESH_PRISM][lod] = m_optimizedStats[MESH_PRISM][0];
+	}
+
+	// the lightmap layout is worked out from the optimized
+	// vertices, so it follows their order
+	m_lightmapCoordinates.resize(m_vertices.size());
+	for (int mesh = 0; mesh < MESH_TYPE_COUNT; mesh++)
+	{
+		for (int lod = 0; lod < LOD_COUNT; lod++)
+		{
+			const MESH_LOD& meshLOD = m_meshLODs[mesh][lod];
+			for (uint32_t i = 0; i < meshLOD.vertexCount; i++)
+			{
+				uint32_t vertex = (uint32_t)meshLOD.baseVertex + i;
+				m_lightmapCoordinates[vertex] = GetLightmapCoordinate((MESH_TYPE)mesh, m_vertices[vertex]);
+			}
+		}
+	}
+
+	ReportCacheStats();
+}
+
+/***********************************************************
+ *  SetTessellation()
+ *
+ *  This method is used for choosing the segment counts of
+ *  a curved shape at one level of detail.  It must be called
+ *  before GenerateMeshes().  Counts that match a baked table
+ *  cost nothing to generate.
+ ***********************************************************/
+void SceneMeshes::SetTessellation(MESH_TYPE mesh, int lod, int segments1, int segments2)
+{
+	if ((false == MeshGenerator::IsTessellated(mesh)) || (lod < 0) || (lod >= LOD_COUNT))
+	{
+		return;
+	}
+
+	// cylinders need three sides, spheres two stacks and
+	// three slices, and tori three segments each way
+	int minimum2 = ((mesh == MESH_CYLINDER) || (mesh == MESH_TAPERED_CYLINDER)) ? 0 : 3;
+	int minimum1 = (mesh == MESH_SPHERE) ? 2 : 3;
+	m_tessellations[mesh][lod][0] = (segments1 > minimum1) ? segments1 : minimum1;
+	m_tessellations[mesh][lod][1] = (segments2 > minimum2) ? segments2 : minimum2;
+}
+
+/***********************************************************
+ *  GetTessellation()
+ *
+ *  This method is used for getting the segment counts of a
+ *  curved shape at one level of detail.
+ ***********************************************************/
+void SceneMeshes::GetTessellation(MESH_TYPE mesh, int lod, int& segments1, int& segments2) const
+{
+	segments1 = 0;
+	segments2 = 0;
+	if ((false == MeshGenerator::IsTessellated(mesh)) || (lod < 0) || (lod >= LOD_COUNT))
+	{
+		return;
+	}
+
+	segments1 = m_tessellations[mesh][lod][0];
+	segments2 = m_tessellations[mesh][lod][1];
+}
+
+/***********************************************************
+ *  SetPackedVertices()
+ *
+ *  This method is used for choosing whether the vertices
+ *  are uploaded in the packed layout.  It must be called
+ *  before UploadMeshes().
+ ***********************************************************/
+void SceneMeshes::SetPackedVertices(bool bPacked)
+{
+	m_bPackedVertices = bPacked;
+}
+
+/***********************************************************
+ *  IsPackedVertices()
+ *
+ *  This method is used for checking whether the vertices
+ *  are stored in the packed layout.
+ ***********************************************************/
+bool SceneMeshes::IsPackedVertices() const
+{
+	return(m_bPackedVertices);
+}
+
+/***********************************************************
+ *  UploadMeshes()
+ *
+ *  This method is used for copying the generated vertex and
+ *  index data into OpenGL buffers, and describing the vertex
+ *  layout in a single vertex array object.
+ ***********************************************************/
+bool SceneMeshes::UploadMeshes()
+{
+	if (m_vertices.empty() || m_indices.empty())
+	{
+		std::cout << "No scene mesh data has been generated" << std::endl;
+		return(false);
+	}
+
+	Destroy();
+
+	glGenVertexArrays(1, &m_vertexArrayID);
+	GLStateCache::BindVertexArray(m_vertexArrayID);
+
+	glGenBuffers(1, &m_vertexBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+	if (true == m_bPackedVertices)
+	{
+		std::vector<PACKED_VERTEX> packedVertices;
+		PackVertices(packedVertices);
+		glBufferData(GL_ARRAY_BUFFER, packedVertices.size() * sizeof(PACKED_VERTEX), packedVertices.data(), GL_STATIC_DRAW);
+	}
+	else
+	{
+		glBufferData(GL_ARRAY_BUFFER, m_vertices.size() * sizeof(VERTEX), m_vertices.data(), GL_STATIC_DRAW);
+	}
+
+	glGenBuffers(1, &m_indexBufferID);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferID);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, m_indices.size() * sizeof(uint32_t), m_indices.data(), GL_STATIC_DRAW);
+
+	// the lightmap coordinates have their own buffer, so the
+	// packed layout keeps its 16 bytes
+	glGenBuffers(1, &m_lightmapBufferID);
+	glBindBuffer(GL_ARRAY_BUFFER, m_lightmapBufferID);
+	glBufferData(GL_ARRAY_BUFFER, m_lightmapCoordinates.size() * sizeof(glm::vec2), m_lightmapCoordinates.data(), GL_STATIC_DRAW);
+	glEnableVertexAttribArray(LIGHTMAP_COORDINATE_LOCATION);
+	glVertexAttribPointer(LIGHTMAP_COORDINATE_LOCATION, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void*)0);
+	glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferID);
+
+	// the attribute locations match the ShapeMeshes layout
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	if (true == m_bPackedVertices)
+	{
+		// the packed values are normalized by the fetch, and the
+		// vertex shader finishes decoding the position and normal
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, position));
+		glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PACKED_VERTEX), (void*)offsetof(PACKED_VERTEX, textureCoordinate));
+	}
+	else
+	{
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, position));
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, normal));
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VERTEX), (void*)offsetof(VERTEX, textureCoordinate));
+	}
+
+	GLStateCache::BindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the OpenGL buffers.
+ ***********************************************************/
+void SceneMeshes::Destroy()
+{
+	if (0 != m_vertexArrayID)
+	{
+		GLStateCache::ForgetVertexArray(m_vertexArrayID);
+		glDeleteVertexArrays(1, &m_vertexArrayID);
+		m_vertexArrayID = 0;
+	}
+	if (0 != m_vertexBufferID)
+	{
+		glDeleteBuffers(1, &m_vertexBufferID);
+		m_vertexBufferID = 0;
+	}
+	if (0 != m_indexBufferID)
+	{
+		glDeleteBuffers(1, &m_indexBufferID);
+		m_indexBufferID = 0;
+	}
+	if (0 != m_lightmapBufferID)
+	{
+		glDeleteBuffers(1, &m_lightmapBufferID);
+		m_lightmapBufferID = 0;
+	}
+}
+
+/***********************************************************
+ *  GetVertexArray()
+ *
+ *  This method is used for getting the vertex array object
+ *  that holds every shape.
+ ***********************************************************/
+GLuint SceneMeshes::GetVertexArray() const
+{
+	return(m_vertexArrayID);
+}
+
+/***********************************************************
+ *  GetPositionOffset()
+ *
+ *  This method is used for getting the object space corner
+ *  that a packed position of zero stands for.
+ ***********************************************************/
+glm::vec3 SceneMeshes::GetPositionOffset() const
+{
+	return(m_positionOffset);
+}
+
+/***********************************************************
+ *  GetPositionScale()
+ *
+ *  This method is used for getting the object space size
+ *  that a packed position of one stands for.
+ ***********************************************************/
+glm::vec3 SceneMeshes::GetPositionScale() const
+{
+	return(m_positionScale);
+}
+
+/***********************************************************
+ *  PackVertices()
+ *
+ *  This method is used for converting the generated vertices
+ *  to the packed layout.  The positions are stored relative
+ *  to the bounds of all the shapes, so one offset and scale
+ *  decode every draw from the shared buffer - the shapes are
+ *  all about two units across, so the 16 bit steps are a few
+ *  hundred thousandths of a unit.
+ ***********************************************************/
+void SceneMeshes::PackVertices(std::vector<PACKED_VERTEX>& packedVertices)
+{
+	glm::vec3 boundsMin = m_vertices[0].position;
+	glm::vec3 boundsMax = m_vertices[0].position;
+	for (size_t i = 1; i < m_vertices.size(); i++)
+	{
+		const glm::vec3& position = m_vertices[i].position;
+		boundsMin.x = fminf(boundsMin.x, position.x);
+		boundsMin.y = fminf(boundsMin.y, position.y);
+		boundsMin.z = fminf(boundsMin.z, position.z);
+		boundsMax.x = fmaxf(boundsMax.x, position.x);
+		boundsMax.y = fmaxf(boundsMax.y, position.y);
+		boundsMax.z = fmaxf(boundsMax.z, position.z);
+	}
+
+	m_positionOffset = boundsMin;
+	m_positionScale = boundsMax - boundsMin;
+	// keep a flat axis from dividing by zero
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (m_positionScale[axis] <= 0.0f)
+		{
+			m_positionScale[axis] = 1.0f;
+		}
+	}
+
+	packedVertices.resize(m_vertices.size());
+	for (size_t i = 0; i < m_vertices.size(); i++)
+	{
+		const VERTEX& vertex = m_vertices[i];
+		PACKED_VERTEX& packed = packedVertices[i];
+
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float unit = (vertex.position[axis] - m_positionOffset[axis]) / m_positionScale[axis];
+			unit = fminf(fmaxf(unit, 0.0f), 1.0f);
+			packed.position[axis] = (uint16_t)lroundf(unit * 65535.0f);
+		}
+		packed.position[3] = 0;
+
+		glm::vec2 octahedral = EncodeOctahedral(vertex.normal);
+		packed.normal[0] = ToSnorm16(octahedral.x);
+		packed.normal[1] = ToSnorm16(octahedral.y);
+
+		packed.textureCoordinate[0] = FloatToHalf(vertex.textureCoordinate.x);
+		packed.textureCoordinate[1] = FloatToHalf(vertex.textureCoordinate.y);
+	}
+}
+
+/***********************************************************
+ *  GetMeshLOD()
+ *
+ *  This method is used for getting the buffer ranges of a
+ *  shape at the passed in level of detail.
+ ***********************************************************/
+const SceneMeshes::MESH_LOD& SceneMeshes::GetMeshLOD(MESH_TYPE mesh, int lod) const
+{
+	if (lod < 0)
+	{
+		lod = 0;
+	}
+	if (lod >= LOD_COUNT)
+	{
+		lod = LOD_COUNT - 1;
+	}
+
+	return(m_meshLODs[mesh][lod]);
+}
+
+/***********************************************************
+ *  GetCacheStats()
+ *
+ *  This method is used for getting the vertex cache
+ *  efficiency of a shape, either as it was generated or
+ *  after it was optimized.
+ ***********************************************************/
+const MeshOptimizer::VERTEX_CACHE_STATS& SceneMeshes::GetCacheStats(MESH_TYPE mesh, int lod, bool bOptimized) const
+{
+	if (lod < 0)
+	{
+		lod = 0;
+	}
+	if (lod >= LOD_COUNT)
+	{
+		lod = LOD_COUNT - 1;
+	}
+
+	if (true == bOptimized)
+	{
+		return(m_optimizedStats[mesh][lod]);
+	}
+	return(m_generatedStats[mesh][lod]);
+}
+
+/***********************************************************
+ *  GetVertices()
+ *
+ *  This method is used for getting the generated vertices.
+ ***********************************************************/
+const std::vector<SceneMeshes::VERTEX>& SceneMeshes::GetVertices() const
+{
+	return(m_vertices);
+}
+
+/***********************************************************
+ *  GetIndices()
+ *
+ *  This method is used for getting the generated indices.
+ ***********************************************************/
+const std::vector<uint32_t>& SceneMeshes::GetIndices() const
+{
+	return(m_indices);
+}
+
+/***********************************************************
+ *  GetLightmapCoordinates()
+ *
+ *  This method is used for getting the lightmap coordinates
+ *  of the generated vertices, in the same order.
+ ***********************************************************/
+const std::vector<glm::vec2>& SceneMeshes::GetLightmapCoordinates() const
+{
+	return(m_lightmapCoordinates);
+}
+
+/***********************************************************
+ *  GetLightmapChart()
+ *
+ *  This method is used for finding which flat piece of a
+ *  shape a vertex normal belongs to.  The shapes have hard
+ *  edges between their pieces, so the vertices there are
+ *  never shared.
+ ***********************************************************/
+int SceneMeshes::GetLightmapChart(MESH_TYPE mesh, const glm::vec3& normal)
+{
+	int chart = 0;
+
+	switch (mesh)
+	{
+	case MESH_BOX:
+		// +X, -X, +Y, -Y, +Z, -Z like the faces are added
+		if ((fabsf(normal.x) >= fabsf(normal.y)) && (fabsf(normal.x) >= fabsf(normal.z)))
+		{
+			chart = (normal.x > 0.0f) ? 0 : 1;
+		}
+		else if (fabsf(normal.y) >= fabsf(normal.z))
+		{
+			chart = (normal.y > 0.0f) ? 2 : 3;
+		}
+		else
+		{
+			chart = (normal.z > 0.0f) ? 4 : 5;
+		}
+		break;
+	case MESH_PRISM:
+		// front and back, then the bottom side and the two
+		// sloped ones
+		if (normal.z > 0.5f)
+		{
+			chart = 0;
+		}
+		else if (normal.z < -0.5f)
+		{
+			chart = 1;
+		}
+		else if (normal.y < -0.5f)
+		{
+			chart = 2;
+		}
+		else
+		{
+			chart = (normal.x > 0.0f) ? 3 : 4;
+		}
+		break;
+	case MESH_CYLINDER:
+	case MESH_TAPERED_CYLINDER:
+		// the side normals never point straight up or down
+		if (normal.y > 0.99f)
+		{
+			chart = 1;
+		}
+		else if (normal.y < -0.99f)
+		{
+			chart = 2;
+		}
+		break;
+	default:
+		break;
+	}
+
+	return(chart);
+}
+
+/***********************************************************
+ *  GetLightmapCoordinate()
+ *
+ *  This method is used for placing a vertex in the lightmap
+ *  layout of its shape.  Every chart is already mapped to
+ *  the unit square by its texture coordinates, so they are
+ *  scaled into the cell of the chart.
+ ***********************************************************/
+glm::vec2 SceneMeshes::GetLightmapCoordinate(MESH_TYPE mesh, const VERTEX& vertex)
+{
+	glm::vec4 rect = GetLightmapChartRect(mesh, GetLightmapChart(mesh, vertex.normal));
+	glm::vec2 coordinate = glm::clamp(vertex.textureCoordinate, 0.0f, 1.0f);
+
+	return(coordinate * glm::vec2(rect.x, rect.y) + glm::vec2(rect.z, rect.w));
+}
+
+/***********************************************************
+ *  BeginMesh()
+ *
+ *  This method is used for starting a new level of detail.
+ *  The indices that follow are relative to its first vertex.
+ ***********************************************************/
+void SceneMeshes::BeginMesh(MESH_TYPE mesh, int lod)
+{
+	m_pCurrentLOD = &m_meshLODs[mesh][lod];
+	m_currentMesh = mesh;
+	m_currentLODIndex = lod;
+	m_pCurrentLOD->firstIndex = (uint32_t)m_indices.size();
+	m_pCurrentLOD->baseVertex = (int32_t)m_vertices.size();
+	m_pCurrentLOD->indexCount = 0;
+	m_pCurrentLOD->vertexCount = 0;
+}
+
+/***********************************************************
+ *  EndMesh()
+ *
+ *  This method is used for finishing the current level of
+ *  detail, optimizing it, and recording how much of the
+ *  buffers it uses.
+ ***********************************************************/
+void SceneMeshes::EndMesh()
+{
+	m_pCurrentLOD->indexCount = (uint32_t)m_indices.size() - m_pCurrentLOD->firstIndex;
+	m_pCurrentLOD->vertexCount = (uint32_t)m_vertices.size() - m_pCurrentLOD->baseVertex;
+	OptimizeMesh();
+	m_pCurrentLOD = NULL;
+}
+
+/***********************************************************
+ *  OptimizeMesh()
+ *
+ *  This method is used for running the current level of
+ *  detail through the mesh optimizer.  Identical vertices
+ *  are merged, the triangles are reordered for the vertex
+ *  cache, and then the vertices are put in the order the
+ *  triangles use them.  The vertex buffer is trimmed to the
+ *  vertices that are left.
+ ***********************************************************/
+void SceneMeshes::OptimizeMesh()
+{
+	uint32_t* pIndices = m_indices.data() + m_pCurrentLOD->firstIndex;
+	size_t indexCount = m_pCurrentLOD->indexCount;
+	VERTEX* pVertices = m_vertices.data() + m_pCurrentLOD->baseVertex;
+	size_t vertexCount = m_pCurrentLOD->vertexCount;
+
+	m_generatedStats[m_currentMesh][m_currentLODIndex] =
+		MeshOptimizer::AnalyzeVertexCache(pIndices, indexCount, vertexCount);
+
+	std::vector<uint32_t> remap;
+	std::vector<VERTEX> uniqueVertices(vertexCount);
+	uint32_t uniqueCount = MeshOptimizer::GenerateVertexRemap(
+		remap, pVertices, vertexCount, sizeof(VERTEX), pIndices, indexCount);
+	MeshOptimizer::RemapVertices(uniqueVertices.data(), pVertices, vertexCount, sizeof(VERTEX), remap);
+	MeshOptimizer::RemapIndices(pIndices, indexCount, remap);
+
+	MeshOptimizer::OptimizeVertexCache(pIndices, indexCount, uniqueCount);
+
+	uint32_t fetchCount = MeshOptimizer::GenerateFetchRemap(remap, pIndices, indexCount, uniqueCount);
+	MeshOptimizer::RemapVertices(pVertices, uniqueVertices.data(), uniqueCount, sizeof(VERTEX), remap);
+	MeshOptimizer::RemapIndices(pIndices, indexCount, remap);
+
+	m_vertices.resize(m_pCurrentLOD->baseVertex + fetchCount);
+	m_pCurrentLOD->vertexCount = fetchCount;
+
+	m_optimizedStats[m_currentMesh][m_currentLODIndex] =
+		MeshOptimizer::AnalyzeVertexCache(pIndices, indexCount, fetchCount);
+}
+
+/***********************************************************
+ *  ReportCacheStats()
+ *
+ *  This method is used for printing the vertex cache
+ *  efficiency of every generated shape, as generated and
+ *  after optimizing.  ACMR is the number of vertices shaded
+ *  per triangle, and ATVR is the number shaded per unique
+ *  vertex.
+ ***********************************************************/
+void SceneMeshes::ReportCacheStats() const
+{
+	const char* meshNames[MESH_TYPE_COUNT] =
+	{
+		"plane", "box", "cylinder", "tapered cylinder", "sphere", "torus", "prism"
+	};
+
+	std::cout << "Scene mesh vertex cache (FIFO " << MeshOptimizer::CACHE_SIZE << "), ACMR / ATVR:" << std::endl;
+	for (int mesh = 0; mesh < MESH_TYPE_COUNT; mesh++)
+	{
+		// the flat shapes share one level of detail
+		int lodCount = ((mesh == MESH_PLANE) || (mesh == MESH_BOX) || (mesh == MESH_PRISM)) ? 1 : LOD_COUNT;
+		for (int lod = 0; lod < lodCount; lod++)
+		{
+			const MeshOptimizer::VERTEX_CACHE_STATS& generated = m_generatedStats[mesh][lod];
+			const MeshOptimizer::VERTEX_CACHE_STATS& optimized = m_optimizedStats[mesh][lod];
+			char line[160];
+			snprintf(line, sizeof(line), "  %-16s LOD %d  %5u verts  %.3f / %.3f  ->  %.3f / %.3f",
+				meshNames[mesh], lod, m_meshLODs[mesh][lod].vertexCount,
+				generated.ACMR, generated.ATVR, optimized.ACMR, optimized.ATVR);
+			std::cout << line << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *  AddVertex()
+ *
+ *  This method is used for appending a vertex to the current
+ *  level of detail and returning its relative index.
+ ***********************************************************/
+uint32_t SceneMeshes::AddVertex(glm::vec3 position, glm::vec3 normal, glm::vec2 textureCoordinate)
+{
+	VERTEX vertex;
+	vertex.position = position;
+	vertex.normal = normal;
+	vertex.textureCoordinate = textureCoordinate;
+	m_vertices.push_back(vertex);
+
+	return((uint32_t)m_vertices.size() - 1 - m_pCurrentLOD->baseVertex);
+}
+
+/***********************************************************
+ *  AddTriangle()
+ *
+ *  This method is used for appending a triangle - the
+ *  vertices are given counter-clockwise from the front.
+ ***********************************************************/
+void SceneMeshes::AddTriangle(uint32_t a, uint32_t b, uint32_t c)
+{
+	m_indices.push_back(a);
+	m_indices.push_back(b);
+	m_indices.push_back(c);
+}
+
+/***********************************************************
+ *  AddQuad()
+ *
+ *  This method is used for appending a quad as two triangles
+ *  - the corners are given counter-clockwise from the front.
+ ***********************************************************/
+void SceneMeshes::AddQuad(uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	AddTriangle(a, b, c);
+	AddTriangle(a, c, d);
+}
+
+/***********************************************************
+ *  AddGenerated()
+ *
+ *  This method is used for appending the vertices and
+ *  indices written by the mesh generator to the current
+ *  level of detail.
+ ***********************************************************/
+void SceneMeshes::AddGenerated(
+	const GENERATED_VERTEX* pVertices,
+	uint32_t vertexCount,
+	const uint32_t* pIndices,
+	uint32_t indexCount)
+{
+	uint32_t first = (uint32_t)m_vertices.size() - m_pCurrentLOD->baseVertex;
+
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const GENERATED_VERTEX& vertex = pVertices[i];
+		AddVertex(
+			glm::vec3(vertex.position[0], vertex.position[1], vertex.position[2]),
+			glm::vec3(vertex.normal[0], vertex.normal[1], vertex.normal[2]),
+			glm::vec2(vertex.textureCoordinate[0], vertex.textureCoordinate[1]));
+	}
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		AddTriangle(first + pIndices[i], first + pIndices[i + 1], first + pIndices[i + 2]);
+	}
+}
+
+/***********************************************************
+ *  AddPlane()
+ *
+ *  This method is used for generating a flat plane on the
+ *  XZ axes, from -1 to 1, facing up.
+ ***********************************************************/
+void SceneMeshes::AddPlane()
+{
+	glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);
+
+	uint32_t a = AddVertex(glm::vec3(-1.0f, 0.0f, 1.0f), normal, glm::vec2(0.0f, 0.0f));
+	uint32_t b = AddVertex(glm::vec3(1.0f, 0.0f, 1.0f), normal, glm::vec2(1.0f, 0.0f));
+	uint32_t c = AddVertex(glm::vec3(1.0f, 0.0f, -1.0f), normal, glm::vec2(1.0f, 1.0f));
+	uint32_t d = AddVertex(glm::vec3(-1.0f, 0.0f, -1.0f), normal, glm::vec2(0.0f, 1.0f));
+	AddQuad(a, b, c, d);
+}
+
+/***********************************************************
+ *  AddBox()
+ *
+ *  This method is used for generating a unit box centered
+ *  on the origin, with each face mapped to the full texture.
+ ***********************************************************/
+void SceneMeshes::AddBox()
+{
+	// normal, and the directions of the U and V texture axes
+	// for each face - U cross V always points along the normal
+	const glm::vec3 faces[6][3] =
+	{
+		{ glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) },
+		{ glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) },
+		{ glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) }
+	};
+
+	for (int face = 0; face < 6; face++)
+	{
+		glm::vec3 normal = faces[face][0];
+		glm::vec3 center = normal * 0.5f;
+		glm::vec3 u = faces[face][1] * 0.5f;
+		glm::vec3 v = faces[face][2] * 0.5f;
+
+		uint32_t a = AddVertex(center - u - v, normal, glm::vec2(0.0f, 0.0f));
+		uint32_t b = AddVertex(center + u - v, normal, glm::vec2(1.0f, 0.0f));
+		uint32_t c = AddVertex(center + u + v, normal, glm::vec2(1.0f, 1.0f));
+		uint32_t d = AddVertex(center - u + v, normal, glm::vec2(0.0f, 1.0f));
+		AddQuad(a, b, c, d);
+	}
+}
+
+/***********************************************************
+ *  AddPrism()
+ *
+ *  This method is used for generating a triangular prism
+ *  with its triangle on the XY axes, extruded along Z.
+ ***********************************************************/
+void SceneMeshes::AddPrism()
+{
+	// corners of the triangle, counter-clockwise from the front
+	const glm::vec2 corners[3] =
+	{
+		glm::vec2(-0.5f, -0.5f),
+		glm::vec2(0.5f, -0.5f),
+		glm::vec2(0.0f, 0.5f)
+	};
+
+	// front and back triangles
+	glm::vec3 frontNormal = glm::vec3(0.0f, 0.0f, 1.0f);
+	uint32_t a = AddVertex(glm::vec3(corners[0], 0.5f), frontNormal, corners[0] + glm::vec2(0.5f));
+	uint32_t b = AddVertex(glm::vec3(corners[1], 0.5f), frontNormal, corners[1] + glm::vec2(0.5f));
+	uint32_t c = AddVertex(glm::vec3(corners[2], 0.5f), frontNormal, corners[2] + glm::vec2(0.5f));
+	AddTriangle(a, b, c);
+
+	glm::vec3 backNormal = glm::vec3(0.0f, 0.0f, -1.0f);
+	a = AddVertex(glm::vec3(corners[0], -0.5f), backNormal, corners[0] + glm::vec2(0.5f));
+	b = AddVertex(glm::vec3(corners[1], -0.5f), backNormal, corners[1] + glm::vec2(0.5f));
+	c = AddVertex(glm::vec3(corners[2], -0.5f), backNormal, corners[2] + glm::vec2(0.5f));
+	AddTriangle(a, c, b);
+
+	// one side quad for each edge of the triangle
+	for (int i = 0; i < 3; i++)
+	{
+		glm::vec2 p = corners[i];
+		glm::vec2 q = corners[(i + 1) % 3];
+		glm::vec3 pFront = glm::vec3(p, 0.5f);
+		glm::vec3 pBack = glm::vec3(p, -0.5f);
+		glm::vec3 qBack = glm::vec3(q, -0.5f);
+		glm::vec3 qFront = glm::vec3(q, 0.5f);
+		glm::vec3 normal = glm::normalize(glm::cross(pBack - pFront, qBack - pFront));
+
+		uint32_t v0 = AddVertex(pFront, normal, glm::vec2(0.0f, 0.0f));
+		uint32_t v1 = AddVertex(pBack, normal, glm::vec2(1.0f, 0.0f));
+		uint32_t v2 = AddVertex(qBack, normal, glm::vec2(1.0f, 1.0f));
+		uint32_t v3 = AddVertex(qFront, normal, glm::vec2(0.0f, 1.0f));
+		AddQuad(v0, v1, v2, v3);
+	}
+}
@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenemeshes.h
+// ============
+// generate the basic mesh shapes into one shared set of GPU buffers
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "MeshGenerator.h"
+#include "MeshOptimizer.h"
+#include "JobSystem.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SceneMeshes
+ *
+ *  This class generates the same basic shapes as the
+ *  ShapeMeshes class, at several levels of detail, and
+ *  stores all of them in a single vertex buffer and index
+ *  buffer.  Every shape can then be drawn from the one
+ *  vertex array object, which is what indirect drawing
+ *  needs.  The standard tessellations of the curved shapes
+ *  are copied from tables baked at compile time, and any
+ *  other tessellation is generated on the worker threads.
+ *  Each shape is run through the mesh optimizer as it is
+ *  added.
+ ***********************************************************/
+class SceneMeshes
+{
+public:
+	// interleaved vertex layout - position, normal, UV
+	struct VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 textureCoordinate;
+	};
+
+	// packed vertex layout - 16 bytes instead of 32
+	struct PACKED_VERTEX
+	{
+		// unsigned normalized position inside the bounds of
+		// all the shapes, the fourth value keeps it aligned
+		uint16_t position[4];
+		// octahedral encoded normal, signed normalized
+		int16_t normal[2];
+		// half float texture coordinate
+		uint16_t textureCoordinate[2];
+	};
+
+	// range of the shared buffers used by one level of detail
+	struct MESH_LOD
+	{
+		uint32_t firstIndex;
+		uint32_t indexCount;
+		int32_t baseVertex;
+		uint32_t vertexCount;
+	};
+
+	// number of levels of detail generated for every shape
+	static const int LOD_COUNT = 3;
+	// vertex attribute location of the lightmap coordinates
+	static const GLuint LIGHTMAP_COORDINATE_LOCATION = 3;
+
+	// constructor
+	SceneMeshes();
+	// destructor
+	~SceneMeshes();
+
+	// choose the segment counts of a curved shape at one level
+	// of detail - see MeshGenerator for what the counts mean
+	void SetTessellation(MESH_TYPE mesh, int lod, int segments1, int segments2);
+	void GetTessellation(MESH_TYPE mesh, int lod, int& segments1, int& segments2) const;
+	// generate the vertex and index data for all the shapes,
+	// using the worker threads when a job system is passed in
+	void GenerateMeshes(JobSystem* pJobSystem = NULL);
+	// choose whether UploadMeshes() stores the packed vertex
+	// layout instead of the full float one
+	void SetPackedVertices(bool bPacked);
+	bool IsPackedVertices() const;
+	// copy the generated data into the OpenGL buffers
+	bool UploadMeshes();
+	// free the OpenGL buffers
+	void Destroy();
+
+	// vertex array object holding every shape
+	GLuint GetVertexArray() const;
+	// values that turn a packed position back into object
+	// space - offset + position * scale
+	glm::vec3 GetPositionOffset() const;
+	glm::vec3 GetPositionScale() const;
+	// buffer ranges for a shape at the passed in level of detail
+	const MESH_LOD& GetMeshLOD(MESH_TYPE mesh, int lod) const;
+	// vertex cache efficiency of a shape before and after it
+	// was optimized
+	const MeshOptimizer::VERTEX_CACHE_STATS& GetCacheStats(MESH_TYPE mesh, int lod, bool bOptimized) const;
+	// generated vertex and index data
+	const std::vector<VERTEX>& GetVertices() const;
+	const std::vector<uint32_t>& GetIndices() const;
+	// second UV set of every vertex, laying each shape out
+	// flat in the unit square for its lightmap
+	const std::vector<glm::vec2>& GetLightmapCoordinates() const;
+
+	// flat piece of the lightmap layout a vertex of a shape
+	// belongs to, and where in the unit square it lands - the
+	// layout only depends on the texture coordinate and the
+	// normal, so every level of detail shares it
+	static int GetLightmapChart(MESH_TYPE mesh, const glm::vec3& normal);
+	static glm::vec2 GetLightmapCoordinate(MESH_TYPE mesh, const VERTEX& vertex);
+
+private:
+	// generated vertex and index data for all the shapes
+	std::vector<VERTEX> m_vertices;
+	std::vector<uint32_t> m_indices;
+	std::vector<glm::vec2> m_lightmapCoordinates;
+	// buffer ranges for every shape and level of detail
+	MESH_LOD m_meshLODs[MESH_TYPE_COUNT][LOD_COUNT];
+	// vertex cache efficiency of every shape and level of
+	// detail, as generated and after optimizing
+	MeshOptimizer::VERTEX_CACHE_STATS m_generatedStats[MESH_TYPE_COUNT][LOD_COUNT];
+	MeshOptimizer::VERTEX_CACHE_STATS m_optimizedStats[MESH_TYPE_COUNT][LOD_COUNT];
+	// segment counts of every curved shape and level of detail
+	int m_tessellations[MESH_TYPE_COUNT][LOD_COUNT][2];
+	// level of detail currently being generated
+	MESH_LOD* m_pCurrentLOD;
+	MESH_TYPE m_currentMesh;
+	int m_currentLODIndex;
+
+	// packed vertex layout and the bounds it is relative to
+	bool m_bPackedVertices;
+	glm::vec3 m_positionOffset;
+	glm::vec3 m_positionScale;
+
+	// OpenGL objects
+	GLuint m_vertexArrayID;
+	GLuint m_vertexBufferID;
+	GLuint m_indexBufferID;
+	GLuint m_lightmapBufferID;
+
+	// convert the generated vertices to the packed layout
+	void PackVertices(std::vector<PACKED_VERTEX>& packedVertices);
+
+	// start and finish generating one level of detail
+	void BeginMesh(MESH_TYPE mesh, int lod);
+	void EndMesh();
+	// deduplicate and reorder the current level of detail
+	void OptimizeMesh();
+	// print the vertex cache efficiency of all the shapes
+	void ReportCacheStats() const;
+	// append a vertex or triangle to the current level of detail
+	uint32_t AddVertex(glm::vec3 position, glm::vec3 normal, glm::vec2 textureCoordinate);
+	void AddTriangle(uint32_t a, uint32_t b, uint32_t c);
+	void AddQuad(uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+	// append generated vertices and indices to the current
+	// level of detail
+	void AddGenerated(
+		const GENERATED_VERTEX* pVertices,
+		uint32_t vertexCount,
+		const uint32_t* pIndices,
+		uint32_t indexCount);
+
+	// methods for generating the basic shapes
+	void AddPlane();
+	void AddBox();
+	void AddPrism();
+};
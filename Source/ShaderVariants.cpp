@@ -0,0 +1,1009 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.cpp
+// ============
+// compile specialized permutations of the scene shaders and cache them
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShaderVariants.h"
+#include "GLStateCache.h"
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	// folder the program binaries are written to
+	const char* g_CacheDirectory = "shadercache";
+	// identifies a program binary file
+	const char g_BinaryMagic[4] = { 'S', 'P', 'B', 'C' };
+
+	// header at the start of a program binary file
+	struct BINARY_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t sourceHash;
+		uint64_t driverHash;
+		uint32_t variant;
+		uint32_t binaryFormat;
+		uint32_t binarySize;
+		uint32_t padding;
+	};
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  This function is used for adding bytes to a 64 bit
+	 *  FNV-1a hash.
+	 ***********************************************************/
+	uint64_t HashBytes(const void* pData, size_t size, uint64_t hash)
+	{
+		const unsigned char* pBytes = (const unsigned char*)pData;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= pBytes[i];
+			hash *= 1099511628211ULL;
+		}
+
+		return(hash);
+	}
+
+	/***********************************************************
+	 *  HashGLString()
+	 *
+	 *  This function is used for adding one of the driver
+	 *  strings to a hash, with its terminator so the strings
+	 *  cannot run together.
+	 ***********************************************************/
+	uint64_t HashGLString(GLenum name, uint64_t hash)
+	{
+		const char* pString = (const char*)glGetString(name);
+		if (NULL == pString)
+		{
+			pString = "";
+		}
+
+		return(HashBytes(pString, strlen(pString) + 1, hash));
+	}
+
+	/***********************************************************
+	 *  InjectDefines()
+	 *
+	 *  This function is used for inserting #define lines right
+	 *  after the #version line of a shader, followed by a #line
+	 *  directive so the compile errors keep the line numbers
+	 *  of the file.
+	 ***********************************************************/
+	std::string InjectDefines(const std::string& source, const std::string& defines)
+	{
+		size_t versionStart = source.find("#version");
+		size_t lineEnd = (std::string::npos == versionStart) ? std::string::npos : source.find('\n', versionStart);
+		if (std::string::npos == lineEnd)
+		{
+			return(defines + source);
+		}
+
+		int nextLine = 1;
+		for (size_t i = 0; i <= lineEnd; i++)
+		{
+			if ('\n' == source[i])
+			{
+				nextLine++;
+			}
+		}
+
+		return(source.substr(0, lineEnd + 1) +
+			defines +
+			"#line " + std::to_string(nextLine) + "\n" +
+			source.substr(lineEnd + 1));
+	}
+
+	/***********************************************************
+	 *  CheckShader()
+	 *
+	 *  This function is used for checking whether a shader
+	 *  stage compiled, printing its log when it did not.
+	 ***********************************************************/
+	bool CheckShader(GLuint shaderID, GLenum type, const std::string& variantName)
+	{
+		GLint success = 0;
+		char infoLog[512];
+
+		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+			std::cout << "Failed to compile the " << ((GL_VERTEX_SHADER == type) ? "vertex" : "fragment")
+				<< " shader of variant " << variantName << ": " << infoLog << std::endl;
+			return(false);
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  ReadSource()
+	 *
+	 *  This function is used for reading a shader source from
+	 *  the asset pack, or from its file when it is not packed.
+	 ***********************************************************/
+	bool ReadSource(const std::string& filePath, const AssetPack* pAssetPack, std::string& source)
+	{
+		AssetPack::ASSET_DATA shaderFile;
+		if (false == pAssetPack->Read(filePath.c_str(), shaderFile))
+		{
+			std::cout << "Could not open the shader: " << filePath << std::endl;
+			return(false);
+		}
+
+		source.assign((const char*)shaderFile.pData, shaderFile.size);
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  HashSources()
+	 *
+	 *  This function is used for hashing the vertex and
+	 *  fragment shader sources together.
+	 ***********************************************************/
+	uint64_t HashSources(const std::string& vertexSource, const std::string& fragmentSource)
+	{
+		uint64_t hash = HashBytes(vertexSource.data(), vertexSource.size() + 1, 14695981039346656037ULL);
+
+		return(HashBytes(fragmentSource.data(), fragmentSource.size() + 1, hash));
+	}
+}
+
+/***********************************************************
+ *  ShaderVariants()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderVariants::ShaderVariants()
+{
+	m_sourceHash = 0;
+	m_driverHash = 0;
+	m_bBinaryCache = true;
+	m_currentProgram = -1;
+	m_uniformVersion = 0;
+	m_cachedCount = 0;
+	m_compiledCount = 0;
+	m_buildMilliseconds = 0.0;
+}
+
+/***********************************************************
+ *  ~ShaderVariants()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShaderVariants::~ShaderVariants()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  MakeVariant()
+ *
+ *  This method is used for combining the variant flags and
+ *  the number of lights.  Lighting without any lights is
+ *  the same as no lighting.
+ ***********************************************************/
+uint32_t ShaderVariants::MakeVariant(uint32_t flags, int lightCount)
+{
+	lightCount = glm::clamp(lightCount, 0, MAX_LIGHTS);
+	if ((0 == lightCount) || (0 == (flags & VARIANT_LIT)))
+	{
+		flags &= ~(uint32_t)VARIANT_LIT;
+		lightCount = 0;
+	}
+
+	return(flags | ((uint32_t)lightCount << LIGHT_COUNT_SHIFT));
+}
+
+/***********************************************************
+ *  GetVariantName()
+ *
+ *  This method is used for getting a readable name of a
+ *  variant, like textured_lit3_opaque.
+ ***********************************************************/
+std::string ShaderVariants::GetVariantName(uint32_t variant)
+{
+	std::string name;
+
+	if ((variant & VARIANT_MIXED_TEXTURE) != 0)
+	{
+		name = "mixed";
+	}
+	else if ((variant & VARIANT_TEXTURED) != 0)
+	{
+		name = "textured";
+	}
+	else
+	{
+		name = "untextured";
+	}
+
+	if ((variant & VARIANT_LIT) != 0)
+	{
+		name += "_lit" + std::to_string(variant >> LIGHT_COUNT_SHIFT);
+	}
+	else
+	{
+		name += "_unlit";
+	}
+
+	if ((variant & VARIANT_PBR) != 0)
+	{
+		name += "_pbr";
+	}
+	if ((variant & VARIANT_LIGHTMAPPED) != 0)
+	{
+		name += "_lightmapped";
+	}
+	name += ((variant & VARIANT_TRANSPARENT) != 0) ? "_transparent" : "_opaque";
+
+	return(name);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading the vertex and fragment
+ *  shader sources from the asset pack, or from the passed
+ *  in files when they are not packed.  The hashes that the
+ *  program binaries are checked against are taken here.
+ ***********************************************************/
+bool ShaderVariants::Load(const char* vertexFilePath, const char* fragmentFilePath, const AssetPack* pAssetPack)
+{
+	Destroy();
+
+	m_vertexFilePath = vertexFilePath;
+	m_fragmentFilePath = fragmentFilePath;
+	if ((false == ReadSource(m_vertexFilePath, pAssetPack, m_vertexSource)) ||
+		(false == ReadSource(m_fragmentFilePath, pAssetPack, m_fragmentSource)))
+	{
+		m_vertexSource.clear();
+		m_fragmentSource.clear();
+		return(false);
+	}
+	m_sourceHash = HashSources(m_vertexSource, m_fragmentSource);
+
+	// a driver update can change the binary format, so the
+	// binaries are only used with the driver they came from
+	m_driverHash = HashGLString(GL_VENDOR, 14695981039346656037ULL);
+	m_driverHash = HashGLString(GL_RENDERER, m_driverHash);
+	m_driverHash = HashGLString(GL_VERSION, m_driverHash);
+	m_driverHash = HashGLString(GL_SHADING_LANGUAGE_VERSION, m_driverHash);
+
+	if (true == m_bBinaryCache)
+	{
+		GLint formatCount = 0;
+		if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+		{
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		}
+		if (formatCount <= 0)
+		{
+			std::cout << "The driver has no program binary formats, the shader variants are compiled every run" << std::endl;
+			m_bBinaryCache = false;
+		}
+	}
+
+	// let the driver compile on its own threads, so a reload
+	// can build while the current programs keep drawing
+	if (GLEW_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing every variant program.
+ *  The shared uniform values are kept for the next ones.
+ ***********************************************************/
+void ShaderVariants::Destroy()
+{
+	DiscardReload();
+	for (size_t i = 0; i < m_programs.size(); i++)
+	{
+		GLStateCache::ForgetProgram(m_programs[i].programID);
+		glDeleteProgram(m_programs[i].programID);
+	}
+	m_programs.clear();
+	m_currentProgram = -1;
+}
+
+/***********************************************************
+ *  SetBinaryCache()
+ *
+ *  This method is used for choosing whether the program
+ *  binaries are loaded and saved.  It must be called before
+ *  Load().
+ ***********************************************************/
+void ShaderVariants::SetBinaryCache(bool bEnabled)
+{
+	m_bBinaryCache = bEnabled;
+}
+
+/***********************************************************
+ *  Prepare()
+ *
+ *  This method is used for building the programs of every
+ *  passed in variant before the first frame, and printing
+ *  how many came from the binary cache.
+ ***********************************************************/
+void ShaderVariants::Prepare(const std::vector<uint32_t>& variants)
+{
+	for (size_t i = 0; i < variants.size(); i++)
+	{
+		FindProgram(variants[i]);
+	}
+
+	std::cout << "Shader variants: " << m_cachedCount << " loaded from program binaries, "
+		<< m_compiledCount << " compiled, in " << m_buildMilliseconds << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  GetProgram()
+ *
+ *  This method is used for getting the program ID of a
+ *  variant, or 0 when it failed to build.
+ ***********************************************************/
+GLuint ShaderVariants::GetProgram(uint32_t variant)
+{
+	int index = FindProgram(variant);
+
+	return((index >= 0) ? m_programs[index].programID : 0);
+}
+
+/***********************************************************
+ *  Use()
+ *
+ *  This method is used for making the program of a variant
+ *  current, and sending it the shared uniforms that changed
+ *  since it was last used.
+ ***********************************************************/
+void ShaderVariants::Use(uint32_t variant)
+{
+	int index = FindProgram(variant);
+	if (index < 0)
+	{
+		return;
+	}
+
+	GLStateCache::UseProgram(m_programs[index].programID);
+	m_currentProgram = index;
+	ApplySharedValues(m_programs[index]);
+}
+
+/***********************************************************
+ *  FindProgram()
+ *
+ *  This method is used for finding the program of a variant
+ *  and building it the first time it is asked for.  A
+ *  variant that fails to build is kept with program 0, so
+ *  it is not tried again every frame.
+ ***********************************************************/
+int ShaderVariants::FindProgram(uint32_t variant)
+{
+	for (size_t i = 0; i < m_programs.size(); i++)
+	{
+		if (m_programs[i].variant == variant)
+		{
+			return((0 != m_programs[i].programID) ? (int)i : -1);
+		}
+	}
+
+	if (true == m_vertexSource.empty())
+	{
+		return(-1);
+	}
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+	VARIANT_PROGRAM program;
+	program.variant = variant;
+	program.programID = 0;
+	program.uniformVersion = 0;
+
+	if (true == m_bBinaryCache)
+	{
+		program.programID = LoadBinary(variant);
+	}
+	if (0 != program.programID)
+	{
+		m_cachedCount++;
+	}
+	else
+	{
+		program.programID = CompileProgram(variant);
+		if (0 != program.programID)
+		{
+			m_compiledCount++;
+			if (true == m_bBinaryCache)
+			{
+				SaveBinary(variant, program.programID);
+			}
+		}
+	}
+
+	m_buildMilliseconds += std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+
+	m_programs.push_back(program);
+
+	// a variant first asked for during a reload is also built
+	// from the new sources, so it is swapped with the rest
+	if (true == IsReloading())
+	{
+		PENDING_PROGRAM pending;
+		StartProgram(variant, m_reloadVertexSource, m_reloadFragmentSource, pending);
+		m_pendingPrograms.push_back(pending);
+	}
+
+	return((0 != program.programID) ? (int)(m_programs.size() - 1) : -1);
+}
+
+/***********************************************************
+ *  CompileProgram()
+ *
+ *  This method is used for compiling and linking a variant
+ *  from the current sources.
+ ***********************************************************/
+GLuint ShaderVariants::CompileProgram(uint32_t variant)
+{
+	PENDING_PROGRAM pending;
+	StartProgram(variant, m_vertexSource, m_fragmentSource, pending);
+
+	return(FinishProgram(pending));
+}
+
+/***********************************************************
+ *  StartProgram()
+ *
+ *  This method is used for compiling and linking a variant
+ *  with its switches injected as #defines.  Nothing is read
+ *  back from the driver here, so with parallel compiling the
+ *  build carries on while the frames are drawn.
+ ***********************************************************/
+void ShaderVariants::StartProgram(
+	uint32_t variant,
+	const std::string& vertexSource,
+	const std::string& fragmentSource,
+	PENDING_PROGRAM& pending)
+{
+	std::string defines;
+	int textureMode = 0;
+	if ((variant & VARIANT_MIXED_TEXTURE) != 0)
+	{
+		textureMode = 2;
+	}
+	else if ((variant & VARIANT_TEXTURED) != 0)
+	{
+		textureMode = 1;
+	}
+	defines += "#define TEXTURE_MODE " + std::to_string(textureMode) + "\n";
+	defines += "#define USE_LIGHTING " + std::string(((variant & VARIANT_LIT) != 0) ? "1" : "0") + "\n";
+	defines += "#define LIGHT_COUNT " + std::to_string(variant >> LIGHT_COUNT_SHIFT) + "\n";
+	defines += "#define TRANSPARENT " + std::string(((variant & VARIANT_TRANSPARENT) != 0) ? "1" : "0") + "\n";
+	defines += "#define USE_PBR " + std::string(((variant & VARIANT_PBR) != 0) ? "1" : "0") + "\n";
+	defines += "#define USE_LIGHTMAPS " + std::string(((variant & VARIANT_LIGHTMAPPED) != 0) ? "1" : "0") + "\n";
+
+	std::string vertexCode = InjectDefines(vertexSource, defines);
+	std::string fragmentCode = InjectDefines(fragmentSource, defines);
+	const char* pVertexCode = vertexCode.c_str();
+	const char* pFragmentCode = fragmentCode.c_str();
+
+	pending.variant = variant;
+	pending.vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(pending.vertexShaderID, 1, &pVertexCode, NULL);
+	glCompileShader(pending.vertexShaderID);
+	pending.fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(pending.fragmentShaderID, 1, &pFragmentCode, NULL);
+	glCompileShader(pending.fragmentShaderID);
+
+	pending.programID = glCreateProgram();
+	if (true == m_bBinaryCache)
+	{
+		glProgramParameteri(pending.programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	glAttachShader(pending.programID, pending.vertexShaderID);
+	glAttachShader(pending.programID, pending.fragmentShaderID);
+	glLinkProgram(pending.programID);
+}
+
+/***********************************************************
+ *  IsProgramBuilt()
+ *
+ *  This method is used for checking whether the driver has
+ *  finished building a program.  Without parallel compiling
+ *  the status queries wait for the build anyway.
+ ***********************************************************/
+bool ShaderVariants::IsProgramBuilt(const PENDING_PROGRAM& pending) const
+{
+	if (!GLEW_KHR_parallel_shader_compile)
+	{
+		return(true);
+	}
+
+	GLint bCompleted = GL_FALSE;
+	glGetProgramiv(pending.programID, GL_COMPLETION_STATUS_KHR, &bCompleted);
+
+	return(GL_TRUE == bCompleted);
+}
+
+/***********************************************************
+ *  FinishProgram()
+ *
+ *  This method is used for checking the build of a program,
+ *  printing the compile or link errors and freeing the
+ *  program when it failed.
+ ***********************************************************/
+GLuint ShaderVariants::FinishProgram(PENDING_PROGRAM& pending)
+{
+	std::string variantName = GetVariantName(pending.variant);
+	GLuint programID = pending.programID;
+
+	GLint success = 0;
+	char infoLog[512];
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		// the compile errors say more than the link error
+		// they cause
+		bool bVertexCompiled = CheckShader(pending.vertexShaderID, GL_VERTEX_SHADER, variantName);
+		bool bFragmentCompiled = CheckShader(pending.fragmentShaderID, GL_FRAGMENT_SHADER, variantName);
+		if ((true == bVertexCompiled) && (true == bFragmentCompiled))
+		{
+			glGetProgramInfoLog(programID, 512, NULL, infoLog);
+			std::cout << "Failed to link shader variant " << variantName << ": " << infoLog << std::endl;
+		}
+		glDeleteProgram(programID);
+		programID = 0;
+	}
+
+	glDeleteShader(pending.vertexShaderID);
+	glDeleteShader(pending.fragmentShaderID);
+	pending.programID = 0;
+	pending.vertexShaderID = 0;
+	pending.fragmentShaderID = 0;
+
+	return(programID);
+}
+
+/***********************************************************
+ *  BeginReload()
+ *
+ *  This method is used for reading the shader files again
+ *  and starting to build every variant that has been asked
+ *  for from them.  An edit made while a reload is building
+ *  starts it over.
+ ***********************************************************/
+bool ShaderVariants::BeginReload(const AssetPack* pAssetPack)
+{
+	if (true == m_vertexFilePath.empty())
+	{
+		return(false);
+	}
+
+	DiscardReload();
+	if ((false == ReadSource(m_vertexFilePath, pAssetPack, m_reloadVertexSource)) ||
+		(false == ReadSource(m_fragmentFilePath, pAssetPack, m_reloadFragmentSource)))
+	{
+		return(false);
+	}
+
+	m_reloadStartTime = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < m_programs.size(); i++)
+	{
+		PENDING_PROGRAM pending;
+		StartProgram(m_programs[i].variant, m_reloadVertexSource, m_reloadFragmentSource, pending);
+		m_pendingPrograms.push_back(pending);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  FinishReload()
+ *
+ *  This method is used for swapping in the programs of the
+ *  reload once the driver has built all of them.  If any of
+ *  them failed, none are swapped and the current programs
+ *  stay in use.  The new programs get every shared uniform
+ *  the next time they are used, and their binaries replace
+ *  the cached ones.
+ ***********************************************************/
+bool ShaderVariants::FinishReload()
+{
+	if (true == m_pendingPrograms.empty())
+	{
+		return(false);
+	}
+
+	for (size_t i = 0; i < m_pendingPrograms.size(); i++)
+	{
+		if (false == IsProgramBuilt(m_pendingPrograms[i]))
+		{
+			return(false);
+		}
+	}
+
+	std::vector<GLuint> programIDs(m_pendingPrograms.size());
+	bool bBuilt = true;
+	for (size_t i = 0; i < m_pendingPrograms.size(); i++)
+	{
+		programIDs[i] = FinishProgram(m_pendingPrograms[i]);
+		if (0 == programIDs[i])
+		{
+			bBuilt = false;
+		}
+	}
+	m_pendingPrograms.clear();
+
+	if (false == bBuilt)
+	{
+		for (size_t i = 0; i < programIDs.size(); i++)
+		{
+			glDeleteProgram(programIDs[i]);
+		}
+		std::cout << "Shader reload failed, still drawing with the last working shaders" << std::endl;
+		return(false);
+	}
+
+	m_vertexSource.swap(m_reloadVertexSource);
+	m_fragmentSource.swap(m_reloadFragmentSource);
+	m_reloadVertexSource.clear();
+	m_reloadFragmentSource.clear();
+	m_sourceHash = HashSources(m_vertexSource, m_fragmentSource);
+
+	for (size_t i = 0; i < programIDs.size(); i++)
+	{
+		VARIANT_PROGRAM& program = m_programs[i];
+		if (0 != program.programID)
+		{
+			GLStateCache::ForgetProgram(program.programID);
+			glDeleteProgram(program.programID);
+		}
+		program.programID = programIDs[i];
+		program.uniformVersion = 0;
+		if (true == m_bBinaryCache)
+		{
+			SaveBinary(program.variant, program.programID);
+		}
+	}
+	m_currentProgram = -1;
+
+	double milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - m_reloadStartTime).count();
+	std::cout << "Reloaded " << programIDs.size() << " shader variants in " << milliseconds << " ms" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  IsReloading()
+ *
+ *  This method is used for checking whether a reload is
+ *  still being built.
+ ***********************************************************/
+bool ShaderVariants::IsReloading() const
+{
+	return(false == m_pendingPrograms.empty());
+}
+
+/***********************************************************
+ *  DiscardReload()
+ *
+ *  This method is used for freeing the programs of a reload
+ *  that has not been swapped in.
+ ***********************************************************/
+void ShaderVariants::DiscardReload()
+{
+	for (size_t i = 0; i < m_pendingPrograms.size(); i++)
+	{
+		glDeleteShader(m_pendingPrograms[i].vertexShaderID);
+		glDeleteShader(m_pendingPrograms[i].fragmentShaderID);
+		glDeleteProgram(m_pendingPrograms[i].programID);
+	}
+	m_pendingPrograms.clear();
+}
+
+/***********************************************************
+ *  LoadBinary()
+ *
+ *  This method is used for creating a variant program from
+ *  its saved binary.  The binary is only used when it was
+ *  saved from the same shader sources and driver, and the
+ *  driver can still refuse it, in which case the variant is
+ *  compiled instead.
+ ***********************************************************/
+GLuint ShaderVariants::LoadBinary(uint32_t variant)
+{
+	std::string binaryPath = std::string(g_CacheDirectory) + "/" + GetVariantName(variant) + ".bin";
+	std::ifstream binaryFile(binaryPath.c_str(), std::ios::binary);
+	if (!binaryFile.is_open())
+	{
+		return(0);
+	}
+
+	BINARY_HEADER header;
+	binaryFile.read((char*)&header, sizeof(header));
+	if ((!binaryFile) ||
+		(memcmp(header.magic, g_BinaryMagic, sizeof(header.magic)) != 0) ||
+		(BINARY_VERSION != header.version) ||
+		(m_sourceHash != header.sourceHash) ||
+		(m_driverHash != header.driverHash) ||
+		(variant != header.variant) ||
+		(0 == header.binarySize))
+	{
+		return(0);
+	}
+
+	std::vector<char> binary(header.binarySize);
+	binaryFile.read(binary.data(), binary.size());
+	if (!binaryFile)
+	{
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glProgramBinary(programID, (GLenum)header.binaryFormat, binary.data(), (GLsizei)binary.size());
+
+	GLint success = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	return(programID);
+}
+
+/***********************************************************
+ *  SaveBinary()
+ *
+ *  This method is used for writing the binary of a linked
+ *  variant program into the cache folder.
+ ***********************************************************/
+void ShaderVariants::SaveBinary(uint32_t variant, GLuint programID)
+{
+	GLint binarySize = 0;
+	glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+	if (binarySize <= 0)
+	{
+		return;
+	}
+
+	std::vector<char> binary(binarySize);
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(programID, binarySize, &binarySize, &binaryFormat, binary.data());
+
+	BINARY_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_BinaryMagic, sizeof(header.magic));
+	header.version = BINARY_VERSION;
+	header.sourceHash = m_sourceHash;
+	header.driverHash = m_driverHash;
+	header.variant = variant;
+	header.binaryFormat = (uint32_t)binaryFormat;
+	header.binarySize = (uint32_t)binarySize;
+
+	// the folder may already be there
+#ifdef _WIN32
+	_mkdir(g_CacheDirectory);
+#else
+	mkdir(g_CacheDirectory, 0755);
+#endif
+
+	std::string binaryPath = std::string(g_CacheDirectory) + "/" + GetVariantName(variant) + ".bin";
+	std::ofstream binaryFile(binaryPath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!binaryFile.is_open())
+	{
+		std::cout << "Could not write program binary " << binaryPath << std::endl;
+		return;
+	}
+
+	binaryFile.write((const char*)&header, sizeof(header));
+	binaryFile.write(binary.data(), binarySize);
+	binaryFile.close();
+
+	if (binaryFile.fail())
+	{
+		std::cout << "Could not write program binary " << binaryPath << std::endl;
+	}
+}
+
+/***********************************************************
+ *  SetBoolValue()
+ *
+ *  This method is used for setting a shared bool uniform.
+ ***********************************************************/
+void ShaderVariants::SetBoolValue(const std::string& name, bool value)
+{
+	int intValue = (true == value) ? 1 : 0;
+	SetSharedValue(name, UNIFORM_BOOL, &intValue, sizeof(intValue));
+}
+
+/***********************************************************
+ *  SetIntValue()
+ *
+ *  This method is used for setting a shared int uniform.
+ ***********************************************************/
+void ShaderVariants::SetIntValue(const std::string& name, int value)
+{
+	SetSharedValue(name, UNIFORM_INT, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  SetFloatValue()
+ *
+ *  This method is used for setting a shared float uniform.
+ ***********************************************************/
+void ShaderVariants::SetFloatValue(const std::string& name, float value)
+{
+	SetSharedValue(name, UNIFORM_FLOAT, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  SetVec3Value()
+ *
+ *  This method is used for setting a shared vec3 uniform.
+ ***********************************************************/
+void ShaderVariants::SetVec3Value(const std::string& name, const glm::vec3& value)
+{
+	SetSharedValue(name, UNIFORM_VEC3, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  SetVec3Value()
+ *
+ *  This method is used for setting a shared vec3 uniform
+ *  from its components.
+ ***********************************************************/
+void ShaderVariants::SetVec3Value(const std::string& name, float x, float y, float z)
+{
+	SetVec3Value(name, glm::vec3(x, y, z));
+}
+
+/***********************************************************
+ *  SetMat4Value()
+ *
+ *  This method is used for setting a shared mat4 uniform.
+ ***********************************************************/
+void ShaderVariants::SetMat4Value(const std::string& name, const glm::mat4& value)
+{
+	SetSharedValue(name, UNIFORM_MAT4, &value, sizeof(value));
+}
+
+/***********************************************************
+ *  SetSharedValue()
+ *
+ *  This method is used for storing a shared uniform value.
+ *  When it changed, the current variant program gets it
+ *  right away, and the others when they are next used.
+ ***********************************************************/
+void ShaderVariants::SetSharedValue(const std::string& name, UNIFORM_KIND kind, const void* pData, size_t size)
+{
+	std::unordered_map<std::string, size_t>::iterator found = m_sharedUniformIndices.find(name);
+	if (found == m_sharedUniformIndices.end())
+	{
+		SHARED_UNIFORM uniform;
+		uniform.name = name;
+		uniform.kind = kind;
+		uniform.version = 0;
+		found = m_sharedUniformIndices.insert(std::make_pair(name, m_sharedUniforms.size())).first;
+		m_sharedUniforms.push_back(uniform);
+	}
+
+	SHARED_UNIFORM& uniform = m_sharedUniforms[found->second];
+	if ((uniform.value.size() == size) && (memcmp(uniform.value.data(), pData, size) == 0))
+	{
+		return;
+	}
+
+	uniform.kind = kind;
+	uniform.value.assign((const unsigned char*)pData, (const unsigned char*)pData + size);
+	uniform.version = ++m_uniformVersion;
+
+	// other code can have made another program current since
+	// the last Use()
+	if ((m_currentProgram >= 0) &&
+		(GLStateCache::GetProgram() == m_programs[m_currentProgram].programID))
+	{
+		VARIANT_PROGRAM& program = m_programs[m_currentProgram];
+		ApplySharedValue(uniform);
+		if (program.uniformVersion + 1 == m_uniformVersion)
+		{
+			program.uniformVersion = m_uniformVersion;
+		}
+	}
+}
+
+/***********************************************************
+ *  ApplySharedValues()
+ *
+ *  This method is used for sending the shared uniforms that
+ *  changed since a program was last brought up to date.
+ ***********************************************************/
+void ShaderVariants::ApplySharedValues(VARIANT_PROGRAM& program)
+{
+	if (program.uniformVersion == m_uniformVersion)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_sharedUniforms.size(); i++)
+	{
+		if (m_sharedUniforms[i].version > program.uniformVersion)
+		{
+			ApplySharedValue(m_sharedUniforms[i]);
+		}
+	}
+	program.uniformVersion = m_uniformVersion;
+}
+
+/***********************************************************
+ *  ApplySharedValue()
+ *
+ *  This method is used for sending one shared uniform to
+ *  the current program through the state cache.
+ ***********************************************************/
+void ShaderVariants::ApplySharedValue(const SHARED_UNIFORM& uniform)
+{
+	switch (uniform.kind)
+	{
+	case UNIFORM_BOOL:
+	case UNIFORM_INT:
+	{
+		int value = 0;
+		memcpy(&value, uniform.value.data(), sizeof(value));
+		if (UNIFORM_BOOL == uniform.kind)
+		{
+			GLStateCache::SetBoolValue(uniform.name, (0 != value));
+		}
+		else
+		{
+			GLStateCache::SetIntValue(uniform.name, value);
+		}
+		break;
+	}
+	case UNIFORM_FLOAT:
+	{
+		float value = 0.0f;
+		memcpy(&value, uniform.value.data(), sizeof(value));
+		GLStateCache::SetFloatValue(uniform.name, value);
+		break;
+	}
+	case UNIFORM_VEC3:
+	{
+		glm::vec3 value;
+		memcpy(&value, uniform.value.data(), sizeof(value));
+		GLStateCache::SetVec3Value(uniform.name, value);
+		break;
+	}
+	case UNIFORM_MAT4:
+	{
+		glm::mat4 value;
+		memcpy(&value, uniform.value.data(), sizeof(value));
+		GLStateCache::SetMat4Value(uniform.name, value);
+		break;
+	}
+	}
+}
@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////
+// shadervariants.h
+// ============
+// compile specialized permutations of the scene shaders and cache them
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+
+#include <GL/glew.h>
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  ShaderVariants
+ *
+ *  This class builds the scene shader program in several
+ *  variants, each compiled with #defines injected after the
+ *  #version line, so the fragment shader has no run time
+ *  branches on texturing, lighting or transparency.  The
+ *  linked programs are saved with glGetProgramBinary, and
+ *  later runs on the same driver load them back instead of
+ *  compiling the shaders again.
+ *  The uniforms the scene and view code set are shared by
+ *  every variant - each value is kept here and sent to a
+ *  program the next time it is used.
+ *  When the shader files are edited, every variant is built
+ *  again from the new sources while the current programs
+ *  keep drawing, and they are swapped all at once when the
+ *  build has finished without errors.
+ ***********************************************************/
+class ShaderVariants
+{
+public:
+	// switches that select a variant - the texture and the
+	// transparency come from each object, and the lighting
+	// is the same for the whole scene
+	enum VARIANT_FLAGS
+	{
+		// always samples the texture of the draw record
+		VARIANT_TEXTURED = 1,
+		// samples the texture only when the draw record has
+		// one, for draws that mix textured and plain objects
+		VARIANT_MIXED_TEXTURE = 2,
+		VARIANT_LIT = 4,
+		// keeps the alpha, for drawing with blending on
+		VARIANT_TRANSPARENT = 8,
+		// metallic and roughness shading with the environment
+		// lighting maps, instead of the Phong terms
+		VARIANT_PBR = 16,
+		// draw records with a lightmap rectangle read their
+		// diffuse light from the baked lightmap
+		VARIANT_LIGHTMAPPED = 32
+	};
+
+	// number of lights, stored in the variant above the flags
+	static const int LIGHT_COUNT_SHIFT = 8;
+	static const int MAX_LIGHTS = 4;
+	// bumped whenever the program binary file layout changes
+	static const uint32_t BINARY_VERSION = 1;
+
+	// constructor
+	ShaderVariants();
+	// destructor
+	~ShaderVariants();
+
+	// combine the flags and the light count into a variant
+	static uint32_t MakeVariant(uint32_t flags, int lightCount);
+	// readable name of a variant, also used for its binary
+	static std::string GetVariantName(uint32_t variant);
+
+	// read the shader sources, which every variant shares
+	bool Load(const char* vertexFilePath, const char* fragmentFilePath, const AssetPack* pAssetPack);
+	// free every program
+	void Destroy();
+	// turn the program binary cache on or off
+	void SetBinaryCache(bool bEnabled);
+
+	// build the programs of the passed in variants up front,
+	// so no shader is compiled while drawing
+	void Prepare(const std::vector<uint32_t>& variants);
+	// get the program of a variant, building it when needed
+	GLuint GetProgram(uint32_t variant);
+	// make the program of a variant current and bring its
+	// shared uniforms up to date
+	void Use(uint32_t variant);
+
+	// read the shader files again and start building every
+	// variant from them
+	bool BeginReload(const AssetPack* pAssetPack);
+	// swap in the programs of the reload once they are all
+	// built, returning true when they were swapped - called
+	// between frames until the reload is done
+	bool FinishReload();
+	bool IsReloading() const;
+
+	// uniforms shared by all of the variants
+	void SetBoolValue(const std::string& name, bool value);
+	void SetIntValue(const std::string& name, int value);
+	void SetFloatValue(const std::string& name, float value);
+	void SetVec3Value(const std::string& name, const glm::vec3& value);
+	void SetVec3Value(const std::string& name, float x, float y, float z);
+	void SetMat4Value(const std::string& name, const glm::mat4& value);
+
+private:
+	// how a shared uniform is sent
+	enum UNIFORM_KIND
+	{
+		UNIFORM_BOOL,
+		UNIFORM_INT,
+		UNIFORM_FLOAT,
+		UNIFORM_VEC3,
+		UNIFORM_MAT4
+	};
+
+	// last value of a shared uniform, and the change number
+	// it was set at
+	struct SHARED_UNIFORM
+	{
+		std::string name;
+		UNIFORM_KIND kind;
+		std::vector<unsigned char> value;
+		uint64_t version;
+	};
+
+	// one linked variant, and the change number its shared
+	// uniforms are up to date with
+	struct VARIANT_PROGRAM
+	{
+		uint32_t variant;
+		GLuint programID;
+		uint64_t uniformVersion;
+	};
+
+	// program whose shaders were handed to the driver and
+	// may still be building
+	struct PENDING_PROGRAM
+	{
+		uint32_t variant;
+		GLuint programID;
+		GLuint vertexShaderID;
+		GLuint fragmentShaderID;
+	};
+
+	std::string m_vertexFilePath;
+	std::string m_fragmentFilePath;
+	std::string m_vertexSource;
+	std::string m_fragmentSource;
+	// identify the sources and the driver the binaries of
+	// the programs were saved from
+	uint64_t m_sourceHash;
+	uint64_t m_driverHash;
+	bool m_bBinaryCache;
+	std::vector<VARIANT_PROGRAM> m_programs;
+	// program last made current by Use(), or -1
+	int m_currentProgram;
+	std::vector<SHARED_UNIFORM> m_sharedUniforms;
+	std::unordered_map<std::string, size_t> m_sharedUniformIndices;
+	uint64_t m_uniformVersion;
+	// programs loaded from binaries and compiled, and the
+	// time spent building them
+	int m_cachedCount;
+	int m_compiledCount;
+	double m_buildMilliseconds;
+	// sources and programs of the reload being built - each
+	// pending program replaces the program at the same index
+	std::string m_reloadVertexSource;
+	std::string m_reloadFragmentSource;
+	std::vector<PENDING_PROGRAM> m_pendingPrograms;
+	std::chrono::steady_clock::time_point m_reloadStartTime;
+
+	// find a program, building it when it is not there yet
+	int FindProgram(uint32_t variant);
+	// compile and link a variant from the sources
+	GLuint CompileProgram(uint32_t variant);
+	// hand the shaders of a variant to the driver, check if
+	// they have been built, and get the linked program or 0
+	void StartProgram(
+		uint32_t variant,
+		const std::string& vertexSource,
+		const std::string& fragmentSource,
+		PENDING_PROGRAM& pending);
+	bool IsProgramBuilt(const PENDING_PROGRAM& pending) const;
+	GLuint FinishProgram(PENDING_PROGRAM& pending);
+	// free the programs of an unfinished reload
+	void DiscardReload();
+	// load and save the binary of a linked variant
+	GLuint LoadBinary(uint32_t variant);
+	void SaveBinary(uint32_t variant, GLuint programID);
+	// store a shared uniform value and send it to the current
+	// variant program
+	void SetSharedValue(const std::string& name, UNIFORM_KIND kind, const void* pData, size_t size);
+	// send the shared uniforms changed since a program was
+	// last used
+	void ApplySharedValues(VARIANT_PROGRAM& program);
+	void ApplySharedValue(const SHARED_UNIFORM& uniform);
+};
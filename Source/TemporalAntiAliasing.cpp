@@ -0,0 +1,320 @@
+///////////////////////////////////////////////////////////////////////////////
+// temporalantialiasing.cpp
+// ============
+// smooth the edges of the drawn frame over several jittered frames
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TemporalAntiAliasing.h"
+#include "DynamicResolution.h"
+#include "GLStateCache.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// width and height of the work groups - must match the shader
+	const int g_GroupSize = 8;
+	// image units the pass reads and writes
+	const GLuint g_FrameImageUnit = 0;
+	const GLuint g_HistoryImageUnit = 1;
+
+	// frames the sub-pixel offsets repeat after
+	const uint32_t g_JitterCount = 8;
+	// weight of the new frame in the history
+	const float g_HistoryBlend = 0.1f;
+
+	/***********************************************************
+	 *  Halton()
+	 *
+	 *  This function is used for getting an element of the
+	 *  Halton sequence of a base, which spreads the points of
+	 *  any run of frames evenly over a pixel.
+	 ***********************************************************/
+	float Halton(uint32_t index, uint32_t base)
+	{
+		float fraction = 1.0f;
+		float result = 0.0f;
+
+		while (index > 0)
+		{
+			fraction /= (float)base;
+			result += fraction * (float)(index % base);
+			index /= base;
+		}
+
+		return(result);
+	}
+}
+
+/***********************************************************
+ *  TemporalAntiAliasing()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TemporalAntiAliasing::TemporalAntiAliasing()
+{
+	m_programID = 0;
+	m_historyTextureIDs[0] = 0;
+	m_historyTextureIDs[1] = 0;
+	m_historyIndex = 0;
+	m_bHistoryValid = false;
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_historyWidth = 0;
+	m_historyHeight = 0;
+	m_previousViewProjection = glm::mat4(1.0f);
+	m_frameIndex = 0;
+}
+
+/***********************************************************
+ *  ~TemporalAntiAliasing()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TemporalAntiAliasing::~TemporalAntiAliasing()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking whether the context has
+ *  compute shaders and image load and store.
+ ***********************************************************/
+bool TemporalAntiAliasing::IsSupported()
+{
+	return(GLEW_VERSION_4_3);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for compiling and linking the
+ *  resolve compute shader.  The history textures are
+ *  created by the first Apply(), once the frame size is
+ *  known.
+ ***********************************************************/
+bool TemporalAntiAliasing::Create(const char* shaderFilePath, const AssetPack* pAssetPack)
+{
+	Destroy();
+
+	AssetPack::ASSET_DATA shaderFile;
+	if (false == pAssetPack->Read(shaderFilePath, shaderFile))
+	{
+		std::cout << "Could not open the temporal anti-aliasing shader: " << shaderFilePath << std::endl;
+		return(false);
+	}
+
+	// the source is passed with its length, since the asset
+	// data is not null terminated
+	const char* pShaderCode = (const char*)shaderFile.pData;
+	GLint shaderLength = (GLint)shaderFile.size;
+
+	GLint success = 0;
+	char infoLog[512];
+
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shaderID, 1, &pShaderCode, &shaderLength);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+		std::cout << "Failed to compile the temporal anti-aliasing shader: " << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(false);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, shaderID);
+	glLinkProgram(programID);
+	glDeleteShader(shaderID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(programID, 512, NULL, infoLog);
+		std::cout << "Failed to link the temporal anti-aliasing shader: " << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(false);
+	}
+
+	m_programID = programID;
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the shader program and
+ *  the history textures.
+ ***********************************************************/
+void TemporalAntiAliasing::Destroy()
+{
+	if (0 != m_programID)
+	{
+		GLStateCache::ForgetProgram(m_programID);
+		glDeleteProgram(m_programID);
+		m_programID = 0;
+	}
+	for (int i = 0; i < 2; i++)
+	{
+		if (0 != m_historyTextureIDs[i])
+		{
+			GLStateCache::ForgetTexture(m_historyTextureIDs[i]);
+			glDeleteTextures(1, &m_historyTextureIDs[i]);
+			m_historyTextureIDs[i] = 0;
+		}
+	}
+
+	m_targetWidth = 0;
+	m_targetHeight = 0;
+	m_bHistoryValid = false;
+}
+
+/***********************************************************
+ *  GetJitter()
+ *
+ *  This method is used for getting the matrix that moves a
+ *  projection by this frame's offset, which runs through
+ *  the first points of the Halton sequences of 2 and 3.
+ *  The offset is up to half a pixel either way, given in
+ *  normalized device coordinates.
+ ***********************************************************/
+glm::mat4 TemporalAntiAliasing::GetJitter(int width, int height) const
+{
+	if ((0 == m_programID) || (width <= 0) || (height <= 0))
+	{
+		return(glm::mat4(1.0f));
+	}
+
+	// the sequences start at one, since zero is the pixel corner
+	uint32_t index = (m_frameIndex % g_JitterCount) + 1;
+	float offsetX = (Halton(index, 2) - 0.5f) * 2.0f / (float)width;
+	float offsetY = (Halton(index, 3) - 0.5f) * 2.0f / (float)height;
+
+	return(glm::translate(glm::vec3(offsetX, offsetY, 0.0f)));
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method is used for running the resolve pass over
+ *  the drawn part of the frame.  The blended result becomes
+ *  the next history, and is copied back into the frame.
+ ***********************************************************/
+void TemporalAntiAliasing::Apply(
+	GLuint colorTextureID,
+	GLuint depthTextureID,
+	int width,
+	int height,
+	const glm::mat4& viewProjection,
+	const glm::mat4& jitteredViewProjection)
+{
+	if ((0 == m_programID) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	if ((width > m_targetWidth) || (height > m_targetHeight))
+	{
+		if (false == CreateTargets(width, height))
+		{
+			return;
+		}
+	}
+
+	// a new render scale moves every pixel of the history
+	if ((width != m_historyWidth) || (height != m_historyHeight))
+	{
+		m_bHistoryValid = false;
+		m_historyWidth = width;
+		m_historyHeight = height;
+	}
+
+	GLuint currentHistoryID = m_historyTextureIDs[m_historyIndex];
+	GLuint previousHistoryID = m_historyTextureIDs[1 - m_historyIndex];
+
+	// the passes before this one may have written the frame
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	GLStateCache::UseProgram(m_programID);
+	GLStateCache::SetMat4Value("inverseViewProjection", glm::inverse(jitteredViewProjection));
+	GLStateCache::SetMat4Value("viewProjection", viewProjection);
+	GLStateCache::SetMat4Value("previousViewProjection", m_previousViewProjection);
+	GLStateCache::SetVec2Value("frameSize", glm::vec2((float)width, (float)height));
+	GLStateCache::SetFloatValue("historyBlend", (true == m_bHistoryValid) ? g_HistoryBlend : 1.0f);
+	GLStateCache::BindTexture(DynamicResolution::FRAME_TEXTURE_UNIT, GL_TEXTURE_2D, depthTextureID);
+	GLStateCache::BindTexture(HISTORY_UNIT, GL_TEXTURE_2D, previousHistoryID);
+	glBindImageTexture(g_FrameImageUnit, colorTextureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+	glBindImageTexture(g_HistoryImageUnit, currentHistoryID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+	glDispatchCompute(
+		(GLuint)((width + g_GroupSize - 1) / g_GroupSize),
+		(GLuint)((height + g_GroupSize - 1) / g_GroupSize),
+		1);
+
+	// the frame is still read around every pixel while the
+	// pass runs, so the result is copied into it afterwards -
+	// no single barrier bit covers the copy
+	glMemoryBarrier(GL_ALL_BARRIER_BITS);
+	glCopyImageSubData(
+		currentHistoryID, GL_TEXTURE_2D, 0, 0, 0, 0,
+		colorTextureID, GL_TEXTURE_2D, 0, 0, 0, 0,
+		width, height, 1);
+
+	m_previousViewProjection = viewProjection;
+	m_historyIndex = 1 - m_historyIndex;
+	m_bHistoryValid = true;
+	m_frameIndex++;
+}
+
+/***********************************************************
+ *  ResetHistory()
+ *
+ *  This method is used for starting the history over from
+ *  the next frame.
+ ***********************************************************/
+void TemporalAntiAliasing::ResetHistory()
+{
+	m_bHistoryValid = false;
+}
+
+/***********************************************************
+ *  CreateTargets()
+ *
+ *  This method is used for allocating the two history
+ *  textures in the format of the frame, so the result can
+ *  be copied straight into it.
+ ***********************************************************/
+bool TemporalAntiAliasing::CreateTargets(int width, int height)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (0 != m_historyTextureIDs[i])
+		{
+			GLStateCache::ForgetTexture(m_historyTextureIDs[i]);
+			glDeleteTextures(1, &m_historyTextureIDs[i]);
+		}
+
+		glGenTextures(1, &m_historyTextureIDs[i]);
+		GLStateCache::BindTexture(HISTORY_UNIT, GL_TEXTURE_2D, m_historyTextureIDs[i]);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, width, height);
+		// the history is reprojected to points between pixels
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	}
+
+	m_targetWidth = width;
+	m_targetHeight = height;
+	m_bHistoryValid = false;
+
+	return(true);
+}
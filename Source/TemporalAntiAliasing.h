@@ -0,0 +1,89 @@
+///////////////////////////////////////////////////////////////////////////////
+// temporalantialiasing.h
+// ============
+// smooth the edges of the drawn frame over several jittered frames
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+/***********************************************************
+ *  TemporalAntiAliasing
+ *
+ *  This class moves the projection by a different fraction
+ *  of a pixel every frame, so the frames sample different
+ *  points of every pixel, and averages them in a history.
+ *  The history is found for each pixel by reprojecting it
+ *  with the last frame's view - the scene objects do not
+ *  move, so the motion vector of a pixel comes from its
+ *  depth and the camera motion alone.  The history is then
+ *  clamped to the colors around the pixel in this frame,
+ *  so whatever the reprojection gets wrong does not ghost.
+ ***********************************************************/
+class TemporalAntiAliasing
+{
+public:
+	// texture unit the history is read from
+	static const int HISTORY_UNIT = 22;
+
+	// constructor
+	TemporalAntiAliasing();
+	// destructor
+	~TemporalAntiAliasing();
+
+	// check whether the context has compute shaders and image
+	// load and store, which are core in OpenGL 4.3
+	static bool IsSupported();
+
+	// build the resolve pass from the shader file
+	bool Create(const char* shaderFilePath, const AssetPack* pAssetPack);
+	// free the shader program and textures
+	void Destroy();
+
+	// matrix that moves a projection by this frame's sub-pixel
+	// offset, for a frame of the passed in size
+	glm::mat4 GetJitter(int width, int height) const;
+
+	// blend the lower left width by height pixels of the frame
+	// textures into the history and write the result back,
+	// from the view projection before and after the jitter
+	void Apply(
+		GLuint colorTextureID,
+		GLuint depthTextureID,
+		int width,
+		int height,
+		const glm::mat4& viewProjection,
+		const glm::mat4& jitteredViewProjection);
+
+	// drop the history, for when the frame it was built from
+	// no longer matches the next one
+	void ResetHistory();
+
+private:
+	GLuint m_programID;
+	// resolved frames, swapped every frame
+	GLuint m_historyTextureIDs[2];
+	int m_historyIndex;
+	bool m_bHistoryValid;
+	// size the history textures are allocated at
+	int m_targetWidth;
+	int m_targetHeight;
+	// frame size the history was built at
+	int m_historyWidth;
+	int m_historyHeight;
+	// view projection of the last frame, without its jitter
+	glm::mat4 m_previousViewProjection;
+	// picks the sub-pixel offset
+	uint32_t m_frameIndex;
+
+	// reallocate the history textures
+	bool CreateTargets(int width, int height);
+};
@@ -0,0 +1,284 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureimporter.cpp
+// ============
+// import texture images and cache their mip chains in a binary file
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureImporter.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static_assert(sizeof(TextureImporter::CACHE_HEADER) == 64, "CACHE_HEADER must stay 64 bytes so the mips stay aligned");
+
+namespace
+{
+	// identifies a texture cache file
+	const char g_CacheMagic[4] = { 'T', 'X', 'C', 'H' };
+
+	/***********************************************************
+	 *  FillMipChain()
+	 *
+	 *  This function is used for describing the mips stored in
+	 *  cache contents, which stay where they are.
+	 ***********************************************************/
+	void FillMipChain(
+		const TextureImporter::CACHE_HEADER* pHeader,
+		const unsigned char* pCache,
+		TextureStreamer::MIP_CHAIN& chain)
+	{
+		chain.channels = 4;
+		chain.pPixels = pCache;
+		chain.levels.resize(pHeader->mipCount);
+
+		int width = (int)pHeader->width;
+		int height = (int)pHeader->height;
+		size_t offset = pHeader->dataOffset;
+		for (uint32_t mip = 0; mip < pHeader->mipCount; mip++)
+		{
+			chain.levels[mip].width = width;
+			chain.levels[mip].height = height;
+			chain.levels[mip].offset = offset;
+			offset += (size_t)width * height * 4;
+			width = std::max(1, width / 2);
+			height = std::max(1, height / 2);
+		}
+	}
+}
+
+/***********************************************************
+ *  Import()
+ *
+ *  This method is used for decoding an image file and laying
+ *  out its cache contents - the header, then every mip.  The
+ *  rows are flipped so the bottom row is first, any channel
+ *  count is expanded to RGBA, and the mips are built with the
+ *  passed in filter.  The header records the size and write
+ *  time of the source file, so an edited image is imported
+ *  again.
+ ***********************************************************/
+bool TextureImporter::Import(
+	const unsigned char* pFileData,
+	size_t fileSize,
+	ImagePipeline::MIP_FILTER filter,
+	const char* filePath,
+	std::vector<unsigned char>& cache)
+{
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	unsigned char* pDecoded = stbi_load_from_memory(
+		pFileData,
+		(int)fileSize,
+		&width,
+		&height,
+		&channels,
+		0);
+	if (NULL == pDecoded)
+	{
+		return(false);
+	}
+
+	size_t pixelCount = (size_t)width * height;
+	ImagePipeline::FlipVertical(pDecoded, width, height, channels);
+	std::vector<unsigned char> pixels(pixelCount * 4);
+	ImagePipeline::ExpandToRGBA(pDecoded, channels, pixelCount, pixels.data());
+	stbi_image_free(pDecoded);
+
+	CACHE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, g_CacheMagic, sizeof(header.magic));
+	header.version = CACHE_VERSION;
+	MappedFile::GetFileInfo(filePath, header.sourceSize, header.sourceTime);
+	header.width = (uint32_t)width;
+	header.height = (uint32_t)height;
+	header.mipCount = (uint32_t)ImagePipeline::GetMipCount(width, height);
+	header.sourceChannels = (uint32_t)channels;
+	header.filter = (uint32_t)filter;
+	header.dataOffset = sizeof(CACHE_HEADER);
+
+	cache.assign(header.dataOffset + ImagePipeline::GetMipChainSize(width, height), 0);
+	memcpy(cache.data(), &header, sizeof(header));
+	ImagePipeline::BuildMipChain(pixels.data(), width, height, filter, cache.data() + header.dataOffset);
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetCachePath()
+ *
+ *  This method is used for getting the path of the cache
+ *  file that is written next to an image file.
+ ***********************************************************/
+std::string TextureImporter::GetCachePath(const char* filePath)
+{
+	return(std::string(filePath) + ".texcache");
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for writing the cache contents of an
+ *  imported image into its cache file next to the image.
+ ***********************************************************/
+bool TextureImporter::WriteCache(const char* filePath, const std::vector<unsigned char>& cache)
+{
+	std::string cachePath = GetCachePath(filePath);
+	// the cache may still be mapped by a load of the old version,
+	// so it is written next to it and then moved over it
+	std::string newCachePath = cachePath + ".new";
+	std::ofstream cacheFile(newCachePath.c_str(), std::ios::binary | std::ios::trunc);
+	if (!cacheFile.is_open())
+	{
+		std::cout << "Could not write texture cache " << cachePath << std::endl;
+		return(false);
+	}
+
+	cacheFile.write((const char*)cache.data(), cache.size());
+	cacheFile.close();
+
+	if ((cacheFile.fail()) ||
+		(false == MappedFile::ReplaceFile(newCachePath.c_str(), cachePath.c_str())))
+	{
+		std::cout << "Could not write texture cache " << cachePath << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  ValidateCache()
+ *
+ *  This method is used for checking the header of the cache
+ *  contents before they are used.  When the source file is
+ *  missing, or no file path is passed in because the cache
+ *  came from an asset pack, the cache is used as it is.
+ ***********************************************************/
+const TextureImporter::CACHE_HEADER* TextureImporter::ValidateCache(const unsigned char* pCache, size_t cacheSize, const char* filePath)
+{
+	if ((NULL == pCache) || (cacheSize < sizeof(CACHE_HEADER)))
+	{
+		return(NULL);
+	}
+
+	const CACHE_HEADER* pHeader = (const CACHE_HEADER*)pCache;
+	if ((memcmp(pHeader->magic, g_CacheMagic, sizeof(pHeader->magic)) != 0) ||
+		(CACHE_VERSION != pHeader->version))
+	{
+		return(NULL);
+	}
+
+	uint64_t sourceSize = 0;
+	uint64_t sourceTime = 0;
+	if ((NULL != filePath) &&
+		(true == MappedFile::GetFileInfo(filePath, sourceSize, sourceTime)) &&
+		((sourceSize != pHeader->sourceSize) || (sourceTime != pHeader->sourceTime)))
+	{
+		return(NULL);
+	}
+
+	if ((0 == pHeader->width) || (0 == pHeader->height) ||
+		(pHeader->width > 65536) || (pHeader->height > 65536) ||
+		(pHeader->dataOffset < sizeof(CACHE_HEADER)) ||
+		((pHeader->dataOffset % 4) != 0) ||
+		(pHeader->mipCount != (uint32_t)ImagePipeline::GetMipCount((int)pHeader->width, (int)pHeader->height)) ||
+		((uint64_t)pHeader->dataOffset + ImagePipeline::GetMipChainSize((int)pHeader->width, (int)pHeader->height) > cacheSize))
+	{
+		return(NULL);
+	}
+
+	return(pHeader);
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for getting the mip chain of an
+ *  image.  A valid cache, from the asset pack or next to the
+ *  image, is kept mapped and its mips are used in place.
+ *  Otherwise the image is imported and the cache is written
+ *  for the next run.  A loose cache built with a different
+ *  filter is imported again.
+ ***********************************************************/
+bool TextureImporter::Load(
+	const char* filePath,
+	const AssetPack* pAssetPack,
+	ImagePipeline::MIP_FILTER filter,
+	TextureStreamer::MIP_CHAIN& chain,
+	int& sourceChannels,
+	bool& bFromCache)
+{
+	std::string cachePath = GetCachePath(filePath);
+	AssetPack::ASSET_DATA* pCache = new AssetPack::ASSET_DATA();
+	const CACHE_HEADER* pHeader = NULL;
+	if (true == pAssetPack->Read(cachePath.c_str(), *pCache))
+	{
+		pHeader = ValidateCache(
+			pCache->pData,
+			pCache->size,
+			(true == pCache->bPacked) ? NULL : filePath);
+		if ((NULL != pHeader) && (false == pCache->bPacked) && ((uint32_t)filter != pHeader->filter))
+		{
+			pHeader = NULL;
+		}
+	}
+
+	bFromCache = (NULL != pHeader);
+	if (true == bFromCache)
+	{
+		FillMipChain(pHeader, pCache->pData, chain);
+		chain.pCache = pCache;
+		sourceChannels = (int)pHeader->sourceChannels;
+		return(true);
+	}
+
+	// release the stale cache file before it is rewritten
+	delete pCache;
+	pCache = NULL;
+
+	return(ImportFile(filePath, pAssetPack, filter, chain, sourceChannels));
+}
+
+/***********************************************************
+ *  ImportFile()
+ *
+ *  This method is used for importing an image and writing
+ *  its cache, whatever state the cache is in.  A file that
+ *  was just edited can have the same size and time stamp as
+ *  the one its cache was built from, so this is also how an
+ *  edited image is loaded again.
+ ***********************************************************/
+bool TextureImporter::ImportFile(
+	const char* filePath,
+	const AssetPack* pAssetPack,
+	ImagePipeline::MIP_FILTER filter,
+	TextureStreamer::MIP_CHAIN& chain,
+	int& sourceChannels)
+{
+	AssetPack::ASSET_DATA source;
+	if (false == pAssetPack->Read(filePath, source))
+	{
+		return(false);
+	}
+
+	std::vector<unsigned char> cache;
+	if (false == Import(source.pData, source.size, filter, filePath, cache))
+	{
+		return(false);
+	}
+	WriteCache(filePath, cache);
+
+	chain.storage.swap(cache);
+	const CACHE_HEADER* pHeader = (const CACHE_HEADER*)chain.storage.data();
+	FillMipChain(pHeader, chain.storage.data(), chain);
+	sourceChannels = (int)pHeader->sourceChannels;
+
+	return(true);
+}
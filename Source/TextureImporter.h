@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureimporter.h
+// ============
+// import texture images and cache their mip chains in a binary file
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+#include "ImagePipeline.h"
+#include "TextureStreamer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextureImporter
+ *
+ *  This class decodes texture images and runs them through
+ *  the image pipeline - flipped for OpenGL, expanded to RGBA
+ *  and given a full mip chain.  The result is written to a
+ *  binary cache file next to the image, so the mips are only
+ *  built the first time, and later loads map the cache and
+ *  hand the levels to the texture streamer as they are.
+ ***********************************************************/
+class TextureImporter
+{
+public:
+	// header at the start of a texture cache file, followed
+	// by every RGBA mip, largest first
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		// size and last write time of the source file the
+		// cache was built from
+		uint64_t sourceSize;
+		uint64_t sourceTime;
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipCount;
+		// channels of the image before it was expanded
+		uint32_t sourceChannels;
+		// ImagePipeline::MIP_FILTER the mips were built with
+		uint32_t filter;
+		// byte offset from the start of the file to the mips
+		uint32_t dataOffset;
+		uint32_t padding[4];
+	};
+
+	// bumped whenever the cache layout or the import changes
+	static const uint32_t CACHE_VERSION = 1;
+	// filter the mips are built with unless another is chosen
+	static const ImagePipeline::MIP_FILTER DEFAULT_FILTER = ImagePipeline::MIP_FILTER_KAISER;
+
+	// decode an image file and lay out its cache contents
+	static bool Import(
+		const unsigned char* pFileData,
+		size_t fileSize,
+		ImagePipeline::MIP_FILTER filter,
+		const char* filePath,
+		std::vector<unsigned char>& cache);
+
+	// path of the cache file built from an image file
+	static std::string GetCachePath(const char* filePath);
+	// write the cache file of an imported image
+	static bool WriteCache(const char* filePath, const std::vector<unsigned char>& cache);
+	// check that cache contents are complete and, unless the
+	// file path is NULL, were built from the current version
+	// of the source file
+	static const CACHE_HEADER* ValidateCache(const unsigned char* pCache, size_t cacheSize, const char* filePath);
+
+	// get the mip chain of an image from its cache, or import
+	// it when the cache is missing or out of date
+	static bool Load(
+		const char* filePath,
+		const AssetPack* pAssetPack,
+		ImagePipeline::MIP_FILTER filter,
+		TextureStreamer::MIP_CHAIN& chain,
+		int& sourceChannels,
+		bool& bFromCache);
+	// import an image and write its cache, without looking at
+	// the cache that is already there
+	static bool ImportFile(
+		const char* filePath,
+		const AssetPack* pAssetPack,
+		ImagePipeline::MIP_FILTER filter,
+		TextureStreamer::MIP_CHAIN& chain,
+		int& sourceChannels);
+};
@@ -0,0 +1,477 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.cpp
+// ============
+// keep only the texture mips the scene needs resident on the GPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureStreamer.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// video memory counted for each texel - drivers store the
+	// RGB textures with four bytes per texel as well
+	const size_t g_BytesPerTexel = 4;
+	// texture unit the textures are bound on while their mips
+	// are uploaded, above the units the scene samples from
+	const int g_UploadUnit = GLStateCache::MAX_TEXTURE_UNITS - 1;
+}
+
+/***********************************************************
+ *  TextureStreamer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureStreamer::TextureStreamer()
+{
+	m_budget = DEFAULT_BUDGET;
+	m_uploadLimit = DEFAULT_UPLOAD_LIMIT;
+}
+
+/***********************************************************
+ *  ~TextureStreamer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureStreamer::~TextureStreamer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for taking over the mip chain of a
+ *  texture and creating the texture with only the mips that
+ *  are no larger than START_SIZE, so loading stays fast no
+ *  matter how large the image is.
+ ***********************************************************/
+int TextureStreamer::AddTexture(MIP_CHAIN& chain)
+{
+	if ((true == chain.levels.empty()) || (NULL == chain.pPixels) ||
+		((3 != chain.channels) && (4 != chain.channels)))
+	{
+		return(-1);
+	}
+
+	m_textures.push_back(STREAMED_TEXTURE());
+	m_textures.back().ID = 0;
+	TakeMipChain(m_textures.back(), chain);
+
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  ReplaceTexture()
+ *
+ *  This method is used for swapping in a new version of a
+ *  texture, which can have a different size.  The new
+ *  texture is created with its small mips before the old
+ *  one is freed, so there is always one to draw with, and
+ *  its larger mips are streamed in like those of a texture
+ *  that was just added.
+ ***********************************************************/
+bool TextureStreamer::ReplaceTexture(int index, MIP_CHAIN& chain)
+{
+	if ((index < 0) || (index >= (int)m_textures.size()) ||
+		(true == chain.levels.empty()) || (NULL == chain.pPixels) ||
+		((3 != chain.channels) && (4 != chain.channels)))
+	{
+		return(false);
+	}
+
+	STREAMED_TEXTURE& texture = m_textures[index];
+	GLuint oldTextureID = texture.ID;
+	// the new levels cannot be copied from the old texture
+	texture.ID = 0;
+	ReleaseMipChain(texture.chain);
+	TakeMipChain(texture, chain);
+
+	if (0 != oldTextureID)
+	{
+		GLStateCache::ForgetTexture(oldTextureID);
+		glDeleteTextures(1, &oldTextureID);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  TakeMipChain()
+ *
+ *  This method is used for taking over the mip chain of a
+ *  texture and creating the texture with only the mips that
+ *  are no larger than START_SIZE.
+ ***********************************************************/
+void TextureStreamer::TakeMipChain(STREAMED_TEXTURE& texture, MIP_CHAIN& chain)
+{
+	// swapping the storage keeps the pixel pointer valid
+	texture.chain.channels = chain.channels;
+	texture.chain.levels.swap(chain.levels);
+	texture.chain.storage.swap(chain.storage);
+	texture.chain.pPixels = chain.pPixels;
+	texture.chain.pCache = chain.pCache;
+	chain.pPixels = NULL;
+	chain.pCache = NULL;
+	texture.internalFormat = (3 == texture.chain.channels) ? GL_RGB8 : GL_RGBA8;
+	texture.format = (3 == texture.chain.channels) ? GL_RGB : GL_RGBA;
+	texture.residentMip = 0;
+
+	texture.tailMip = 0;
+	int lastMip = (int)texture.chain.levels.size() - 1;
+	while ((texture.tailMip < lastMip) &&
+		((texture.chain.levels[texture.tailMip].width > START_SIZE) ||
+		(texture.chain.levels[texture.tailMip].height > START_SIZE)))
+	{
+		texture.tailMip++;
+	}
+	texture.requestedMip = texture.tailMip;
+
+	Reallocate(texture, texture.tailMip);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the OpenGL textures and
+ *  the mip chains kept in system memory.
+ ***********************************************************/
+void TextureStreamer::Destroy()
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		if (0 != m_textures[i].ID)
+		{
+			GLStateCache::ForgetTexture(m_textures[i].ID);
+			glDeleteTextures(1, &m_textures[i].ID);
+			m_textures[i].ID = 0;
+		}
+		ReleaseMipChain(m_textures[i].chain);
+	}
+	m_textures.clear();
+}
+
+/***********************************************************
+ *  ReleaseMipChain()
+ *
+ *  This method is used for freeing the pixels of a mip
+ *  chain, and unmapping its texture cache.
+ ***********************************************************/
+void TextureStreamer::ReleaseMipChain(MIP_CHAIN& chain)
+{
+	delete chain.pCache;
+	chain.pCache = NULL;
+	chain.pPixels = NULL;
+	chain.levels.clear();
+	std::vector<unsigned char>().swap(chain.storage);
+}
+
+/***********************************************************
+ *  SetBudget()
+ *
+ *  This method is used for setting the amount of video
+ *  memory the resident mips may use.  The small mips of
+ *  every texture stay resident even over the budget.
+ ***********************************************************/
+void TextureStreamer::SetBudget(size_t bytes)
+{
+	m_budget = bytes;
+}
+
+/***********************************************************
+ *  SetUploadLimit()
+ *
+ *  This method is used for setting how many bytes of new
+ *  mips are uploaded in one frame.  At least one mip is
+ *  uploaded every frame that needs one.
+ ***********************************************************/
+void TextureStreamer::SetUploadLimit(size_t bytesPerFrame)
+{
+	m_uploadLimit = bytesPerFrame;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for resetting the requested mips
+ *  before the scene objects of a frame are looked at.
+ ***********************************************************/
+void TextureStreamer::BeginFrame()
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		m_textures[i].requestedMip = m_textures[i].tailMip;
+	}
+}
+
+/***********************************************************
+ *  RequestFootprint()
+ *
+ *  This method is used for requesting the mip that has about
+ *  one texel per pixel when the texture is repeated uvScale
+ *  times across the passed in number of pixels.  The finest
+ *  mip requested in a frame wins.
+ ***********************************************************/
+void TextureStreamer::RequestFootprint(int index, float uvScale, float pixels)
+{
+	if ((index < 0) || (index >= (int)m_textures.size()))
+	{
+		return;
+	}
+
+	STREAMED_TEXTURE& texture = m_textures[index];
+	if (pixels < 1.0f)
+	{
+		return;
+	}
+
+	const MIP_LEVEL& baseLevel = texture.chain.levels[0];
+	float texels = (float)std::max(baseLevel.width, baseLevel.height) * std::max(uvScale, 0.0f);
+	int mip = 0;
+	if (texels > pixels)
+	{
+		mip = (int)std::floor(std::log2(texels / pixels));
+	}
+	mip = std::min(mip, texture.tailMip);
+
+	texture.requestedMip = std::min(texture.requestedMip, mip);
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for fitting the requested mips into
+ *  the budget and re-allocating the textures that need a
+ *  different set of mips.  Mips that are no longer needed
+ *  are only dropped when the budget is exceeded, starting
+ *  with the largest, and then the finest needed mips of the
+ *  largest textures are dropped.  Dropping mips only copies
+ *  on the GPU, so it is done right away, while new mips are
+ *  streamed in over several frames, the most needed first.
+ ***********************************************************/
+bool TextureStreamer::Update()
+{
+	int textureCount = (int)m_textures.size();
+	std::vector<int> keptMips(textureCount);
+	size_t totalBytes = 0;
+
+	for (int i = 0; i < textureCount; i++)
+	{
+		keptMips[i] = std::min(m_textures[i].residentMip, m_textures[i].requestedMip);
+		totalBytes += GetBytes(m_textures[i], keptMips[i]);
+	}
+
+	while (totalBytes > m_budget)
+	{
+		int dropIndex = -1;
+		bool bDropUnneeded = false;
+		size_t dropSaving = 0;
+
+		for (int i = 0; i < textureCount; i++)
+		{
+			const STREAMED_TEXTURE& texture = m_textures[i];
+			if (keptMips[i] >= texture.tailMip)
+			{
+				continue;
+			}
+
+			bool bUnneeded = (keptMips[i] < texture.requestedMip);
+			size_t saving = GetBytes(texture, keptMips[i]) - GetBytes(texture, keptMips[i] + 1);
+			if (((true == bUnneeded) && (false == bDropUnneeded)) ||
+				((bUnneeded == bDropUnneeded) && (saving > dropSaving)))
+			{
+				dropIndex = i;
+				bDropUnneeded = bUnneeded;
+				dropSaving = saving;
+			}
+		}
+
+		// only the small mips are left
+		if (dropIndex < 0)
+		{
+			break;
+		}
+
+		keptMips[dropIndex]++;
+		totalBytes -= dropSaving;
+	}
+
+	bool bChanged = false;
+	std::vector<int> streamIn;
+	for (int i = 0; i < textureCount; i++)
+	{
+		if (keptMips[i] > m_textures[i].residentMip)
+		{
+			Reallocate(m_textures[i], keptMips[i]);
+			bChanged = true;
+		}
+		else if (keptMips[i] < m_textures[i].residentMip)
+		{
+			streamIn.push_back(i);
+		}
+	}
+
+	// the textures missing the most mips are streamed in first
+	std::sort(streamIn.begin(), streamIn.end(), [this, &keptMips](int a, int b)
+		{
+			return((m_textures[a].residentMip - keptMips[a]) > (m_textures[b].residentMip - keptMips[b]));
+		});
+
+	size_t uploadedBytes = 0;
+	for (size_t i = 0; i < streamIn.size(); i++)
+	{
+		STREAMED_TEXTURE& texture = m_textures[streamIn[i]];
+		int topMip = texture.residentMip;
+
+		while (topMip > keptMips[streamIn[i]])
+		{
+			const MIP_LEVEL& level = texture.chain.levels[topMip - 1];
+			size_t levelBytes = (size_t)level.width * level.height * texture.chain.channels;
+			if ((uploadedBytes > 0) && (uploadedBytes + levelBytes > m_uploadLimit))
+			{
+				break;
+			}
+			uploadedBytes += levelBytes;
+			topMip--;
+		}
+
+		if (topMip < texture.residentMip)
+		{
+			Reallocate(texture, topMip);
+			bChanged = true;
+		}
+	}
+
+	return(bChanged);
+}
+
+/***********************************************************
+ *  GetTextureCount()
+ *
+ *  This method is used for getting the number of textures.
+ ***********************************************************/
+int TextureStreamer::GetTextureCount() const
+{
+	return((int)m_textures.size());
+}
+
+/***********************************************************
+ *  GetTextureID()
+ *
+ *  This method is used for getting the current OpenGL ID of
+ *  a texture, which changes whenever it is re-allocated.
+ ***********************************************************/
+GLuint TextureStreamer::GetTextureID(int index) const
+{
+	if ((index < 0) || (index >= (int)m_textures.size()))
+	{
+		return(0);
+	}
+
+	return(m_textures[index].ID);
+}
+
+/***********************************************************
+ *  GetResidentBytes()
+ *
+ *  This method is used for getting the video memory used by
+ *  the resident mips of all the textures.
+ ***********************************************************/
+size_t TextureStreamer::GetResidentBytes() const
+{
+	size_t totalBytes = 0;
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		totalBytes += GetBytes(m_textures[i], m_textures[i].residentMip);
+	}
+
+	return(totalBytes);
+}
+
+/***********************************************************
+ *  GetBytes()
+ *
+ *  This method is used for getting the video memory used by
+ *  a texture with the passed in mip and all coarser mips
+ *  resident.
+ ***********************************************************/
+size_t TextureStreamer::GetBytes(const STREAMED_TEXTURE& texture, int topMip) const
+{
+	size_t bytes = 0;
+	for (size_t mip = (size_t)topMip; mip < texture.chain.levels.size(); mip++)
+	{
+		const MIP_LEVEL& level = texture.chain.levels[mip];
+		bytes += (size_t)level.width * level.height * g_BytesPerTexel;
+	}
+
+	return(bytes);
+}
+
+/***********************************************************
+ *  Reallocate()
+ *
+ *  This method is used for creating a texture again with
+ *  the passed in finest mip.  The mips that were already
+ *  resident are copied on the GPU, and the rest are uploaded
+ *  from the mip chain, before the old texture is freed.  The
+ *  texture is bound on its own unit, so the scene textures
+ *  stay bound.
+ ***********************************************************/
+void TextureStreamer::Reallocate(STREAMED_TEXTURE& texture, int topMip)
+{
+	const MIP_LEVEL& topLevel = texture.chain.levels[topMip];
+	int mipCount = (int)texture.chain.levels.size();
+	GLuint textureID = 0;
+
+	glGenTextures(1, &textureID);
+	GLStateCache::BindTexture(g_UploadUnit, GL_TEXTURE_2D, textureID);
+	glTexStorage2D(GL_TEXTURE_2D, mipCount - topMip, texture.internalFormat, topLevel.width, topLevel.height);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// the RGB rows are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (int mip = topMip; mip < mipCount; mip++)
+	{
+		const MIP_LEVEL& level = texture.chain.levels[mip];
+		if ((0 != texture.ID) && (mip >= texture.residentMip))
+		{
+			glCopyImageSubData(
+				texture.ID, GL_TEXTURE_2D, mip - texture.residentMip, 0, 0, 0,
+				textureID, GL_TEXTURE_2D, mip - topMip, 0, 0, 0,
+				level.width, level.height, 1);
+		}
+		else
+		{
+			glTexSubImage2D(
+				GL_TEXTURE_2D,
+				mip - topMip,
+				0,
+				0,
+				level.width,
+				level.height,
+				texture.format,
+				GL_UNSIGNED_BYTE,
+				texture.chain.pPixels + level.offset);
+		}
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	if (0 != texture.ID)
+	{
+		GLStateCache::ForgetTexture(texture.ID);
+		glDeleteTextures(1, &texture.ID);
+	}
+	texture.ID = textureID;
+	texture.residentMip = topMip;
+}
@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturestreamer.h
+// ============
+// keep only the texture mips the scene needs resident on the GPU
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TextureStreamer
+ *
+ *  This class owns the scene textures and decides which of
+ *  their mip levels are resident in video memory.  The full
+ *  mip chain of every texture stays in system memory, most
+ *  often in its mapped texture cache, and each texture
+ *  starts on the GPU with only its small mips.
+ *  Every frame the scene requests the mip each texture needs
+ *  for its on-screen size, and the streamer re-allocates the
+ *  textures with more or fewer mips, copying the levels that
+ *  are already resident, while keeping the total under the
+ *  video memory budget.
+ ***********************************************************/
+class TextureStreamer
+{
+public:
+	// one level of a mip chain
+	struct MIP_LEVEL
+	{
+		int width;
+		int height;
+		// byte offset of the level in the chain pixels
+		size_t offset;
+	};
+
+	// decoded image and all its mip levels, tightly packed
+	struct MIP_CHAIN
+	{
+		int channels;
+		std::vector<MIP_LEVEL> levels;
+		// start of the pixels, which are either held in storage
+		// or in the texture cache that pCache keeps mapped
+		const unsigned char* pPixels;
+		std::vector<unsigned char> storage;
+		AssetPack::ASSET_DATA* pCache;
+
+		MIP_CHAIN()
+		{
+			channels = 0;
+			pPixels = NULL;
+			pCache = NULL;
+		}
+	};
+
+	// default amount of video memory the textures may use
+	static const size_t DEFAULT_BUDGET = 128 * 1024 * 1024;
+	// default bytes uploaded for the textures in one frame
+	static const size_t DEFAULT_UPLOAD_LIMIT = 4 * 1024 * 1024;
+	// textures start with the mips no larger than this size
+	static const int START_SIZE = 128;
+
+	// constructor
+	TextureStreamer();
+	// destructor
+	~TextureStreamer();
+
+	// take over a mip chain and create its texture with only
+	// the small mips resident, returning the texture index
+	int AddTexture(MIP_CHAIN& chain);
+	// take over the mip chain of a new version of a texture,
+	// which starts again with only its small mips resident
+	bool ReplaceTexture(int index, MIP_CHAIN& chain);
+	// free every texture
+	void Destroy();
+	// free the pixels of a mip chain that was not added
+	static void ReleaseMipChain(MIP_CHAIN& chain);
+
+	// limits for the resident mips and the uploads
+	void SetBudget(size_t bytes);
+	void SetUploadLimit(size_t bytesPerFrame);
+
+	// forget the mips requested in the last frame
+	void BeginFrame();
+	// request the mip needed to draw a texture repeated
+	// uvScale times across the passed in number of pixels
+	void RequestFootprint(int index, float uvScale, float pixels);
+	// re-allocate the textures whose resident mips changed,
+	// returning true when any texture ID changed
+	bool Update();
+
+	int GetTextureCount() const;
+	GLuint GetTextureID(int index) const;
+	// video memory used by the resident mips
+	size_t GetResidentBytes() const;
+
+private:
+	// one streamed texture
+	struct STREAMED_TEXTURE
+	{
+		MIP_CHAIN chain;
+		GLenum internalFormat;
+		GLenum format;
+		GLuint ID;
+		// finest mip level currently on the GPU
+		int residentMip;
+		// coarsest mip level that is always kept resident
+		int tailMip;
+		// finest mip level needed by the current frame, or
+		// tailMip when the texture was not seen
+		int requestedMip;
+	};
+
+	std::vector<STREAMED_TEXTURE> m_textures;
+	size_t m_budget;
+	size_t m_uploadLimit;
+
+	// video memory used by a texture with the passed in mip
+	// and all coarser mips resident
+	size_t GetBytes(const STREAMED_TEXTURE& texture, int topMip) const;
+	// take over a mip chain and create its texture
+	void TakeMipChain(STREAMED_TEXTURE& texture, MIP_CHAIN& chain);
+	// create the texture again with a different finest mip
+	void Reallocate(STREAMED_TEXTURE& texture, int topMip);
+};
@@ -0,0 +1,331 @@
+///////////////////////////////////////////////////////////////////////////////
+// tonemapping.cpp
+// ============
+// bring the HDR frame into the display range with bloom and auto exposure
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ToneMapping.h"
+#include "GLStateCache.h"
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// declaration of global variables
+namespace
+{
+	// work group size of the compose pass - must match the shader
+	const int g_ComposeGroupSize = 8;
+	// image units the passes read and write
+	const GLuint g_FrameImageUnit = 0;
+	const GLuint g_BloomImageUnit = 1;
+	// names of the passes for the error messages
+	const char* g_PassNames[] = { "bloom", "compose" };
+
+	// exposed luminance above which the frame starts to bloom,
+	// and how much of the average of the levels is added back
+	const float g_BloomThreshold = 1.0f;
+	const float g_BloomStrength = 0.5f;
+	// exposed brightness the average of the frame is brought to
+	const float g_ExposureKey = 0.18f;
+	// range the exposure is kept in
+	const float g_MinExposure = 0.25f;
+	const float g_MaxExposure = 4.0f;
+	// how quickly the exposure follows the frame, per second
+	const float g_AdaptationRate = 1.5f;
+	// range of log2 luminance spread over the histogram bins
+	const float g_MinLogLuminance = -10.0f;
+	const float g_MaxLogLuminance = 6.0f;
+
+	// starting exposure, which leaves the frame as it was drawn
+	const float g_InitialExposure = 1.0f;
+}
+
+/***********************************************************
+ *  ToneMapping()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ToneMapping::ToneMapping()
+{
+	for (int i = 0; i < PASS_COUNT; i++)
+	{
+		m_programIDs[i] = 0;
+	}
+	m_bloomTextureID = 0;
+	m_exposureBufferID = 0;
+	m_bloomWidth = 0;
+	m_bloomHeight = 0;
+}
+
+/***********************************************************
+ *  ~ToneMapping()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ToneMapping::~ToneMapping()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking whether the context has
+ *  compute shaders and image load and store.
+ ***********************************************************/
+bool ToneMapping::IsSupported()
+{
+	return(GLEW_VERSION_4_3);
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for building the two passes from the
+ *  shader file, and the exposure buffer with an empty
+ *  histogram.  The bloom texture is created by the first
+ *  BuildBloom(), once the frame size is known.
+ ***********************************************************/
+bool ToneMapping::Create(const char* shaderFilePath, const AssetPack* pAssetPack)
+{
+	Destroy();
+
+	AssetPack::ASSET_DATA shaderFile;
+	if (false == pAssetPack->Read(shaderFilePath, shaderFile))
+	{
+		std::cout << "Could not open the tone mapping shader: " << shaderFilePath << std::endl;
+		return(false);
+	}
+
+	for (int i = 0; i < PASS_COUNT; i++)
+	{
+		if (false == LoadPass(shaderFile, (PASS)i))
+		{
+			Destroy();
+			return(false);
+		}
+	}
+
+	EXPOSURE_STATE exposureState;
+	memset(&exposureState, 0, sizeof(exposureState));
+	exposureState.exposure = g_InitialExposure;
+
+	glGenBuffers(1, &m_exposureBufferID);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_exposureBufferID);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(EXPOSURE_STATE), &exposureState, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the shader programs, the
+ *  bloom texture and the exposure buffer.
+ ***********************************************************/
+void ToneMapping::Destroy()
+{
+	for (int i = 0; i < PASS_COUNT; i++)
+	{
+		if (0 != m_programIDs[i])
+		{
+			GLStateCache::ForgetProgram(m_programIDs[i]);
+			glDeleteProgram(m_programIDs[i]);
+			m_programIDs[i] = 0;
+		}
+	}
+	if (0 != m_bloomTextureID)
+	{
+		GLStateCache::ForgetTexture(m_bloomTextureID);
+		glDeleteTextures(1, &m_bloomTextureID);
+		m_bloomTextureID = 0;
+	}
+	if (0 != m_exposureBufferID)
+	{
+		GLStateCache::ForgetBuffer(m_exposureBufferID);
+		glDeleteBuffers(1, &m_exposureBufferID);
+		m_exposureBufferID = 0;
+	}
+
+	m_bloomWidth = 0;
+	m_bloomHeight = 0;
+}
+
+/***********************************************************
+ *  BuildBloom()
+ *
+ *  This method is used for running the bloom pass, with one
+ *  work group for every tile of the frame.  The exposure of
+ *  the last frame sets what counts as bright, and the
+ *  histogram of this frame gives the exposure of the next.
+ ***********************************************************/
+void ToneMapping::BuildBloom(GLuint colorTextureID, int width, int height, float deltaTime)
+{
+	if ((0 == m_programIDs[PASS_BLOOM]) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	int tilesX = (width + BLOOM_TILE_SIZE - 1) / BLOOM_TILE_SIZE;
+	int tilesY = (height + BLOOM_TILE_SIZE - 1) / BLOOM_TILE_SIZE;
+	if ((tilesX * BLOOM_TILE_SIZE / 2 > m_bloomWidth) || (tilesY * BLOOM_TILE_SIZE / 2 > m_bloomHeight))
+	{
+		if (false == CreateBloomTexture(width, height))
+		{
+			return;
+		}
+	}
+
+	// the frame may have been written by the passes before
+	// this one
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	GLStateCache::UseProgram(m_programIDs[PASS_BLOOM]);
+	GLStateCache::SetVec2Value("frameSize", glm::vec2((float)width, (float)height));
+	GLStateCache::SetUIntValue("groupCount", (unsigned int)(tilesX * tilesY));
+	GLStateCache::SetFloatValue("bloomThreshold", g_BloomThreshold);
+	GLStateCache::SetVec2Value("logLuminanceRange", glm::vec2(g_MinLogLuminance, g_MaxLogLuminance));
+	GLStateCache::SetFloatValue("exposureKey", g_ExposureKey);
+	GLStateCache::SetVec2Value("exposureRange", glm::vec2(g_MinExposure, g_MaxExposure));
+	// the share of the way to the new exposure covered this
+	// frame, so the adaptation speed does not depend on the
+	// frame rate
+	GLStateCache::SetFloatValue("adaptation", 1.0f - expf(-deltaTime * g_AdaptationRate));
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, EXPOSURE_BINDING, m_exposureBufferID);
+	glBindImageTexture(g_FrameImageUnit, colorTextureID, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA16F);
+	for (int level = 0; level < BLOOM_LEVEL_COUNT; level++)
+	{
+		glBindImageTexture(g_BloomImageUnit + level, m_bloomTextureID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R11F_G11F_B10F);
+	}
+	glDispatchCompute((GLuint)tilesX, (GLuint)tilesY, 1);
+
+	// the levels are sampled and the exposure read next
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+/***********************************************************
+ *  Compose()
+ *
+ *  This method is used for adding the bloom levels to the
+ *  drawn part of the frame, exposing it and tone mapping it
+ *  into the range of the window.
+ ***********************************************************/
+void ToneMapping::Compose(GLuint colorTextureID, int width, int height)
+{
+	if ((0 == m_programIDs[PASS_COMPOSE]) || (0 == m_bloomTextureID) || (width <= 0) || (height <= 0))
+	{
+		return;
+	}
+
+	GLStateCache::UseProgram(m_programIDs[PASS_COMPOSE]);
+	GLStateCache::SetVec2Value("frameSize", glm::vec2((float)width, (float)height));
+	GLStateCache::SetVec2Value("bloomSize", glm::vec2((float)m_bloomWidth, (float)m_bloomHeight));
+	GLStateCache::SetFloatValue("bloomStrength", g_BloomStrength);
+	GLStateCache::BindBufferBase(GL_SHADER_STORAGE_BUFFER, EXPOSURE_BINDING, m_exposureBufferID);
+	GLStateCache::BindTexture(BLOOM_UNIT, GL_TEXTURE_2D, m_bloomTextureID);
+	glBindImageTexture(g_FrameImageUnit, colorTextureID, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+	glDispatchCompute(
+		(GLuint)((width + g_ComposeGroupSize - 1) / g_ComposeGroupSize),
+		(GLuint)((height + g_ComposeGroupSize - 1) / g_ComposeGroupSize),
+		1);
+
+	// the frame is blitted into the window next
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+}
+
+/***********************************************************
+ *  LoadPass()
+ *
+ *  This method is used for compiling one pass of the shader
+ *  file, with the pass picked by a #define inserted after
+ *  the #version line.
+ ***********************************************************/
+bool ToneMapping::LoadPass(const AssetPack::ASSET_DATA& shaderFile, PASS pass)
+{
+	std::string source((const char*)shaderFile.pData, shaderFile.size);
+	std::string define = "#define TONE_MAPPING_PASS " + std::to_string((int)pass) + "\n";
+	size_t versionStart = source.find("#version");
+	size_t lineEnd = (std::string::npos == versionStart) ? std::string::npos : source.find('\n', versionStart);
+	if (std::string::npos == lineEnd)
+	{
+		source = define + source;
+	}
+	else
+	{
+		// the #line keeps the compile errors on the lines of the file
+		source.insert(lineEnd + 1, define + "#line 2\n");
+	}
+
+	const char* pShaderCode = source.c_str();
+	GLint success = 0;
+	char infoLog[512];
+
+	GLuint shaderID = glCreateShader(GL_COMPUTE_SHADER);
+	glShaderSource(shaderID, 1, &pShaderCode, NULL);
+	glCompileShader(shaderID);
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+		std::cout << "Failed to compile the tone mapping " << g_PassNames[pass] << " pass: " << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(false);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, shaderID);
+	glLinkProgram(programID);
+	glDeleteShader(shaderID);
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		glGetProgramInfoLog(programID, 512, NULL, infoLog);
+		std::cout << "Failed to link the tone mapping " << g_PassNames[pass] << " pass: " << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(false);
+	}
+
+	m_programIDs[pass] = programID;
+
+	return(true);
+}
+
+/***********************************************************
+ *  CreateBloomTexture()
+ *
+ *  This method is used for allocating the bloom levels in a
+ *  packed float format, which has no alpha and half the
+ *  size of half floats.  The first level is rounded up to
+ *  whole tiles, so every level is exactly half the one
+ *  before it and the work groups never share a texel.
+ ***********************************************************/
+bool ToneMapping::CreateBloomTexture(int width, int height)
+{
+	if (0 != m_bloomTextureID)
+	{
+		GLStateCache::ForgetTexture(m_bloomTextureID);
+		glDeleteTextures(1, &m_bloomTextureID);
+	}
+
+	m_bloomWidth = ((width + BLOOM_TILE_SIZE - 1) / BLOOM_TILE_SIZE) * (BLOOM_TILE_SIZE / 2);
+	m_bloomHeight = ((height + BLOOM_TILE_SIZE - 1) / BLOOM_TILE_SIZE) * (BLOOM_TILE_SIZE / 2);
+
+	glGenTextures(1, &m_bloomTextureID);
+	GLStateCache::BindTexture(BLOOM_UNIT, GL_TEXTURE_2D, m_bloomTextureID);
+	glTexStorage2D(GL_TEXTURE_2D, BLOOM_LEVEL_COUNT, GL_R11F_G11F_B10F, m_bloomWidth, m_bloomHeight);
+	// each level is read on its own, filtered within the level
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, BLOOM_LEVEL_COUNT - 1);
+
+	return(true);
+}
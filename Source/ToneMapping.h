@@ -0,0 +1,106 @@
+///////////////////////////////////////////////////////////////////////////////
+// tonemapping.h
+// ============
+// bring the HDR frame into the display range with bloom and auto exposure
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "AssetPack.h"
+
+#include <GL/glew.h>
+
+#include <cstdint>
+
+/***********************************************************
+ *  ToneMapping
+ *
+ *  This class maps the half float frame into the range the
+ *  window can show, in two compute dispatches:
+ *    - the bloom pass reads the frame once, keeps the light
+ *      above the bloom threshold at half resolution, and
+ *      halves it six more times in shared memory, with each
+ *      work group building every level of its own 64 by 64
+ *      tile.  The same texels fill a histogram of the log
+ *      luminance, and the last work group to finish turns
+ *      the histogram into the exposure, which moves towards
+ *      the average brightness over time.
+ *    - the compose pass adds the levels of the bloom back up
+ *      to the frame, applies the exposure and tone maps the
+ *      result in place.
+ *  The exposure stays in a storage buffer the passes read,
+ *  so nothing is ever read back by the CPU.
+ ***********************************************************/
+class ToneMapping
+{
+public:
+	// texture unit the bloom levels are read from
+	static const int BLOOM_UNIT = 23;
+	// half resolution level of the bloom, and the levels
+	// below it that each work group builds
+	static const int BLOOM_LEVEL_COUNT = 7;
+	// frame pixels covered by one work group of the bloom pass
+	static const int BLOOM_TILE_SIZE = 128;
+	// bins of the luminance histogram
+	static const int HISTOGRAM_BIN_COUNT = 256;
+	// storage buffer binding of the exposure
+	static const GLuint EXPOSURE_BINDING = 6;
+
+	// contents of the exposure buffer - the layout must match
+	// the ExposureState block in the shader
+	struct EXPOSURE_STATE
+	{
+		float exposure;
+		// work groups of the bloom pass finished this frame
+		uint32_t finishedGroups;
+		uint32_t padding[2];
+		uint32_t histogram[HISTOGRAM_BIN_COUNT];
+	};
+
+	// constructor
+	ToneMapping();
+	// destructor
+	~ToneMapping();
+
+	// check whether the context has compute shaders and image
+	// load and store, which are core in OpenGL 4.3
+	static bool IsSupported();
+
+	// build the passes from the shader file and create the
+	// exposure buffer
+	bool Create(const char* shaderFilePath, const AssetPack* pAssetPack);
+	// free the shader programs, bloom texture and buffer
+	void Destroy();
+
+	// build the bloom levels and the exposure from the lower
+	// left width by height pixels of the frame, letting the
+	// exposure adapt for the passed in number of seconds
+	void BuildBloom(GLuint colorTextureID, int width, int height, float deltaTime);
+	// add the bloom to the frame and tone map it in place
+	void Compose(GLuint colorTextureID, int width, int height);
+
+private:
+	// compute passes, in the order they run
+	enum PASS
+	{
+		PASS_BLOOM = 0,
+		PASS_COMPOSE,
+		PASS_COUNT
+	};
+
+	GLuint m_programIDs[PASS_COUNT];
+	// bloom levels, the first at half the frame resolution
+	GLuint m_bloomTextureID;
+	GLuint m_exposureBufferID;
+	// size the first bloom level is allocated at, rounded up
+	// to whole tiles so every level lines up with the next
+	int m_bloomWidth;
+	int m_bloomHeight;
+
+	// compile and link one pass of the shader file
+	bool LoadPass(const AssetPack::ASSET_DATA& shaderFile, PASS pass);
+	// reallocate the bloom levels for a frame size
+	bool CreateBloomTexture(int width, int height);
+};
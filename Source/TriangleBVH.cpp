@@ -0,0 +1,443 @@
+///////////////////////////////////////////////////////////////////////////////
+// trianglebvh.cpp
+// ============
+// bounding volume hierarchy for tracing rays against triangles
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TriangleBVH.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+	// bins the centroids are sorted into when looking for
+	// the cheapest split
+	const int g_SplitBins = 12;
+	// a node with this few triangles is never split
+	const uint32_t g_MaxLeafTriangles = 2;
+	// deepest the tree can get, which sizes the walk stack
+	const int g_MaxDepth = 64;
+
+	/***********************************************************
+	 *  GetArea()
+	 *
+	 *  This function is used for getting the surface area of
+	 *  a box, which is how likely a random ray is to hit it.
+	 ***********************************************************/
+	float GetArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		glm::vec3 size = glm::max(boundsMax - boundsMin, glm::vec3(0.0f));
+
+		return(2.0f * (size.x * size.y + size.y * size.z + size.z * size.x));
+	}
+
+	/***********************************************************
+	 *  IntersectBox()
+	 *
+	 *  This function is used for getting the distance a ray
+	 *  enters a box at, or FLT_MAX when it misses it or the box
+	 *  is further than the passed in distance.
+	 ***********************************************************/
+	float IntersectBox(
+		const glm::vec3& origin,
+		const glm::vec3& inverseDirection,
+		const glm::vec3& boundsMin,
+		const glm::vec3& boundsMax,
+		float maxDistance)
+	{
+		glm::vec3 t1 = (boundsMin - origin) * inverseDirection;
+		glm::vec3 t2 = (boundsMax - origin) * inverseDirection;
+		glm::vec3 tNear = glm::min(t1, t2);
+		glm::vec3 tFar = glm::max(t1, t2);
+		float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+		float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+
+		return((enter <= exit) ? enter : FLT_MAX);
+	}
+}
+
+/***********************************************************
+ *  TriangleBVH()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TriangleBVH::TriangleBVH()
+{
+}
+
+/***********************************************************
+ *  ~TriangleBVH()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TriangleBVH::~TriangleBVH()
+{
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree over the
+ *  passed in triangles, three corners each.  The triangles
+ *  are copied, so the list can be freed afterwards.
+ ***********************************************************/
+void TriangleBVH::Build(const std::vector<glm::vec3>& corners)
+{
+	uint32_t triangleCount = (uint32_t)(corners.size() / 3);
+
+	m_nodes.clear();
+	m_triangles.resize(triangleCount);
+	std::vector<glm::vec3> centroids(triangleCount);
+	std::vector<uint32_t> order(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		const glm::vec3& a = corners[i * 3];
+		const glm::vec3& b = corners[i * 3 + 1];
+		const glm::vec3& c = corners[i * 3 + 2];
+
+		m_triangles[i].corner = a;
+		m_triangles[i].edge1 = b - a;
+		m_triangles[i].edge2 = c - a;
+		m_triangles[i].index = i;
+		centroids[i] = (a + b + c) / 3.0f;
+		order[i] = i;
+	}
+
+	if (0 == triangleCount)
+	{
+		return;
+	}
+
+	// a binary tree never has more than twice the leaves
+	m_nodes.reserve((size_t)triangleCount * 2);
+	NODE root;
+	root.first = 0;
+	root.triangleCount = triangleCount;
+	m_nodes.push_back(root);
+	Subdivide(0, centroids, order);
+
+	// put the triangles in leaf order
+	std::vector<TRIANGLE> sorted(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		sorted[i] = m_triangles[order[i]];
+	}
+	m_triangles.swap(sorted);
+}
+
+/***********************************************************
+ *  Subdivide()
+ *
+ *  This method is used for fitting the bounds of a node and
+ *  splitting it where the surface area heuristic says the
+ *  two halves are cheapest to trace, if that is cheaper
+ *  than testing all of its triangles.  The centroids are
+ *  binned along each axis, and the bins give the cost of
+ *  every split between them in one sweep.
+ ***********************************************************/
+void TriangleBVH::Subdivide(uint32_t nodeIndex, std::vector<glm::vec3>& centroids, std::vector<uint32_t>& order)
+{
+	uint32_t first = m_nodes[nodeIndex].first;
+	uint32_t count = m_nodes[nodeIndex].triangleCount;
+
+	glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+	glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+	glm::vec3 centroidMin = glm::vec3(FLT_MAX);
+	glm::vec3 centroidMax = glm::vec3(-FLT_MAX);
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		const TRIANGLE& triangle = m_triangles[order[i]];
+		glm::vec3 b = triangle.corner + triangle.edge1;
+		glm::vec3 c = triangle.corner + triangle.edge2;
+		boundsMin = glm::min(boundsMin, glm::min(triangle.corner, glm::min(b, c)));
+		boundsMax = glm::max(boundsMax, glm::max(triangle.corner, glm::max(b, c)));
+		centroidMin = glm::min(centroidMin, centroids[order[i]]);
+		centroidMax = glm::max(centroidMax, centroids[order[i]]);
+	}
+	m_nodes[nodeIndex].boundsMin = boundsMin;
+	m_nodes[nodeIndex].boundsMax = boundsMax;
+
+	if (count <= g_MaxLeafTriangles)
+	{
+		return;
+	}
+
+	// find the cheapest split over the bins of every axis
+	float bestCost = (float)count * GetArea(boundsMin, boundsMax);
+	int bestAxis = -1;
+	float bestPosition = 0.0f;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = centroidMax[axis] - centroidMin[axis];
+		if (extent <= 0.0f)
+		{
+			continue;
+		}
+
+		glm::vec3 binMin[g_SplitBins];
+		glm::vec3 binMax[g_SplitBins];
+		uint32_t binCount[g_SplitBins];
+		for (int bin = 0; bin < g_SplitBins; bin++)
+		{
+			binMin[bin] = glm::vec3(FLT_MAX);
+			binMax[bin] = glm::vec3(-FLT_MAX);
+			binCount[bin] = 0;
+		}
+
+		float binScale = (float)g_SplitBins / extent;
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			const TRIANGLE& triangle = m_triangles[order[i]];
+			int bin = std::min(g_SplitBins - 1, (int)((centroids[order[i]][axis] - centroidMin[axis]) * binScale));
+			glm::vec3 b = triangle.corner + triangle.edge1;
+			glm::vec3 c = triangle.corner + triangle.edge2;
+			binMin[bin] = glm::min(binMin[bin], glm::min(triangle.corner, glm::min(b, c)));
+			binMax[bin] = glm::max(binMax[bin], glm::max(triangle.corner, glm::max(b, c)));
+			binCount[bin]++;
+		}
+
+		// the area and count left of every split, then the
+		// right side swept back to meet them
+		float leftArea[g_SplitBins - 1];
+		uint32_t leftCount[g_SplitBins - 1];
+		glm::vec3 sweepMin = glm::vec3(FLT_MAX);
+		glm::vec3 sweepMax = glm::vec3(-FLT_MAX);
+		uint32_t sweepCount = 0;
+		for (int split = 0; split < g_SplitBins - 1; split++)
+		{
+			sweepMin = glm::min(sweepMin, binMin[split]);
+			sweepMax = glm::max(sweepMax, binMax[split]);
+			sweepCount += binCount[split];
+			leftArea[split] = GetArea(sweepMin, sweepMax);
+			leftCount[split] = sweepCount;
+		}
+
+		sweepMin = glm::vec3(FLT_MAX);
+		sweepMax = glm::vec3(-FLT_MAX);
+		sweepCount = 0;
+		for (int split = g_SplitBins - 2; split >= 0; split--)
+		{
+			sweepMin = glm::min(sweepMin, binMin[split + 1]);
+			sweepMax = glm::max(sweepMax, binMax[split + 1]);
+			sweepCount += binCount[split + 1];
+			if ((0 == sweepCount) || (0 == leftCount[split]))
+			{
+				continue;
+			}
+
+			float cost = (float)leftCount[split] * leftArea[split] + (float)sweepCount * GetArea(sweepMin, sweepMax);
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestPosition = centroidMin[axis] + (float)(split + 1) / binScale;
+			}
+		}
+	}
+
+	if (bestAxis < 0)
+	{
+		return;
+	}
+
+	// move the triangles left of the split to the front
+	uint32_t middle = first;
+	for (uint32_t i = first; i < first + count; i++)
+	{
+		if (centroids[order[i]][bestAxis] < bestPosition)
+		{
+			std::swap(order[i], order[middle]);
+			middle++;
+		}
+	}
+	if ((middle == first) || (middle == first + count))
+	{
+		return;
+	}
+
+	uint32_t leftIndex = (uint32_t)m_nodes.size();
+	NODE child;
+	child.boundsMin = glm::vec3(0.0f);
+	child.boundsMax = glm::vec3(0.0f);
+	child.first = first;
+	child.triangleCount = middle - first;
+	m_nodes.push_back(child);
+	child.first = middle;
+	child.triangleCount = first + count - middle;
+	m_nodes.push_back(child);
+
+	m_nodes[nodeIndex].first = leftIndex;
+	m_nodes[nodeIndex].triangleCount = 0;
+
+	Subdivide(leftIndex, centroids, order);
+	Subdivide(leftIndex + 1, centroids, order);
+}
+
+/***********************************************************
+ *  Intersect()
+ *
+ *  This method is used for finding the closest triangle
+ *  along a ray.  The direction does not need to be unit
+ *  length, the distances are measured in its lengths.
+ ***********************************************************/
+bool TriangleBVH::Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RAY_HIT& hit) const
+{
+	return(Traverse(origin, direction, maxDistance, false, hit));
+}
+
+/***********************************************************
+ *  IsOccluded()
+ *
+ *  This method is used for checking whether anything lies
+ *  on a ray before the passed in distance, like a shadow
+ *  ray on its way to a light.
+ ***********************************************************/
+bool TriangleBVH::IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+	RAY_HIT hit;
+
+	return(Traverse(origin, direction, maxDistance, true, hit));
+}
+
+/***********************************************************
+ *  GetTriangleCount()
+ *
+ *  This method is used for getting the number of triangles
+ *  in the tree.
+ ***********************************************************/
+uint32_t TriangleBVH::GetTriangleCount() const
+{
+	return((uint32_t)m_triangles.size());
+}
+
+/***********************************************************
+ *  GetNodeCount()
+ *
+ *  This method is used for getting the number of nodes in
+ *  the tree.
+ ***********************************************************/
+uint32_t TriangleBVH::GetNodeCount() const
+{
+	return((uint32_t)m_nodes.size());
+}
+
+/***********************************************************
+ *  Traverse()
+ *
+ *  This method is used for walking the tree along a ray
+ *  with a small stack, visiting the nearer child of a node
+ *  first so the closest hit shrinks the ray early.  The
+ *  triangles are tested with the Moller-Trumbore method,
+ *  from both sides.
+ ***********************************************************/
+bool TriangleBVH::Traverse(
+	const glm::vec3& origin,
+	const glm::vec3& direction,
+	float maxDistance,
+	bool bAnyHit,
+	RAY_HIT& hit) const
+{
+	if (true == m_nodes.empty())
+	{
+		return(false);
+	}
+
+	glm::vec3 inverseDirection;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		inverseDirection[axis] = (direction[axis] != 0.0f) ? 1.0f / direction[axis] : FLT_MAX;
+	}
+
+	bool bHit = false;
+	float closest = maxDistance;
+	uint32_t stack[g_MaxDepth];
+	int stackSize = 0;
+	uint32_t nodeIndex = 0;
+
+	if (FLT_MAX == IntersectBox(origin, inverseDirection, m_nodes[0].boundsMin, m_nodes[0].boundsMax, closest))
+	{
+		return(false);
+	}
+
+	while (true)
+	{
+		const NODE& node = m_nodes[nodeIndex];
+		if (node.triangleCount > 0)
+		{
+			for (uint32_t i = node.first; i < node.first + node.triangleCount; i++)
+			{
+				const TRIANGLE& triangle = m_triangles[i];
+				glm::vec3 p = glm::cross(direction, triangle.edge2);
+				float determinant = glm::dot(triangle.edge1, p);
+				if (fabsf(determinant) < 1e-12f)
+				{
+					continue;
+				}
+
+				float inverseDeterminant = 1.0f / determinant;
+				glm::vec3 s = origin - triangle.corner;
+				float u = glm::dot(s, p) * inverseDeterminant;
+				if ((u < 0.0f) || (u > 1.0f))
+				{
+					continue;
+				}
+				glm::vec3 q = glm::cross(s, triangle.edge1);
+				float v = glm::dot(direction, q) * inverseDeterminant;
+				if ((v < 0.0f) || (u + v > 1.0f))
+				{
+					continue;
+				}
+				float distance = glm::dot(triangle.edge2, q) * inverseDeterminant;
+				if ((distance <= 0.0f) || (distance >= closest))
+				{
+					continue;
+				}
+
+				bHit = true;
+				closest = distance;
+				hit.distance = distance;
+				hit.triangle = triangle.index;
+				hit.u = u;
+				hit.v = v;
+				if (true == bAnyHit)
+				{
+					return(true);
+				}
+			}
+		}
+		else
+		{
+			uint32_t nearIndex = node.first;
+			uint32_t farIndex = node.first + 1;
+			float nearDistance = IntersectBox(origin, inverseDirection, m_nodes[nearIndex].boundsMin, m_nodes[nearIndex].boundsMax, closest);
+			float farDistance = IntersectBox(origin, inverseDirection, m_nodes[farIndex].boundsMin, m_nodes[farIndex].boundsMax, closest);
+			if (farDistance < nearDistance)
+			{
+				std::swap(nearIndex, farIndex);
+				std::swap(nearDistance, farDistance);
+			}
+
+			if (FLT_MAX != nearDistance)
+			{
+				if ((FLT_MAX != farDistance) && (stackSize < g_MaxDepth))
+				{
+					stack[stackSize++] = farIndex;
+				}
+				nodeIndex = nearIndex;
+				continue;
+			}
+		}
+
+		if (0 == stackSize)
+		{
+			break;
+		}
+		nodeIndex = stack[--stackSize];
+	}
+
+	return(bHit);
+}
@@ -0,0 +1,88 @@
+///////////////////////////////////////////////////////////////////////////////
+// trianglebvh.h
+// ============
+// bounding volume hierarchy for tracing rays against triangles
+//
+//	Created for CS-330-Computational Graphics and Visualization
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  TriangleBVH
+ *
+ *  This class sorts a list of triangles into a tree of
+ *  nested bounding boxes, so a ray only has to be tested
+ *  against the few triangles in the boxes it passes through.
+ *  The tree is split with the surface area heuristic over a
+ *  small number of bins, and stored as one flat array with
+ *  the two children of a node next to each other.  Once it
+ *  is built it is only read, so any number of threads can
+ *  trace rays through it at the same time.
+ ***********************************************************/
+class TriangleBVH
+{
+public:
+	// closest triangle a ray hit
+	struct RAY_HIT
+	{
+		// distance along the ray direction
+		float distance;
+		// index of the triangle in the list it was built from
+		uint32_t triangle;
+		// barycentric weights of the second and third corners
+		float u;
+		float v;
+	};
+
+	// constructor
+	TriangleBVH();
+	// destructor
+	~TriangleBVH();
+
+	// build the tree over triangles given as three corners each
+	void Build(const std::vector<glm::vec3>& corners);
+	// find the closest triangle along a ray, up to a distance
+	bool Intersect(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RAY_HIT& hit) const;
+	// check whether any triangle blocks a ray, which can stop
+	// at the first one found
+	bool IsOccluded(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+
+	// size of the tree
+	uint32_t GetTriangleCount() const;
+	uint32_t GetNodeCount() const;
+
+private:
+	// node of the tree - a leaf when it holds triangles,
+	// otherwise first is the index of its left child
+	struct NODE
+	{
+		glm::vec3 boundsMin;
+		uint32_t first;
+		glm::vec3 boundsMax;
+		uint32_t triangleCount;
+	};
+
+	// triangle stored in the layout the hit test wants
+	struct TRIANGLE
+	{
+		glm::vec3 corner;
+		glm::vec3 edge1;
+		glm::vec3 edge2;
+		uint32_t index;
+	};
+
+	std::vector<NODE> m_nodes;
+	// triangles in the order the leaves use them
+	std::vector<TRIANGLE> m_triangles;
+
+	// split a node in two, and its children after it
+	void Subdivide(uint32_t nodeIndex, std::vector<glm::vec3>& centroids, std::vector<uint32_t>& order);
+	// walk the tree along a ray
+	bool Traverse(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, bool bAnyHit, RAY_HIT& hit) const;
+};
@@ -8,18 +8,26 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "GLStateCache.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <iostream>
+#include <string>
+
 // declaration of the global variables and defines
 namespace
 {
-	// Variables for window width and height
+	// Variables for the initial window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
+	// current size of the window framebuffer in pixels, which
+	// differs from the window size on high-DPI displays
+	int g_FramebufferWidth = WINDOW_WIDTH;
+	int g_FramebufferHeight = WINDOW_HEIGHT;
 	const char* g_ViewName = "view";
 	const char* g_ProjectionName = "projection";
 
@@ -27,18 +35,42 @@ namespace
 	// the 3D scene
 	Camera* g_pCamera = nullptr;
 
-	// these variables are used for mouse movement processing
-	float gLastX = WINDOW_WIDTH / 2.0f;
-	float gLastY = WINDOW_HEIGHT / 2.0f;
-	bool gFirstMouse = true;
+	// key and cursor events buffered from the GLFW callbacks
+	// until the next frame is prepared
+	InputManager* g_pInputManager = nullptr;
+	// records the applied input, or replays a recording in
+	// place of the live input
+	InputRecorder* g_pInputRecorder = nullptr;
 
 	// time between current frame and last frame
 	float gDeltaTime = 0.0f; 
 	float gLastFrame = 0.0f;
 
-	// the following variable is false when orthographic projection
-	// is off and true when it is on
-	bool bOrthographicProjection = false;
+	// near and far clipping distances of every view
+	const float g_NearPlane = 0.1f;
+	const float g_FarPlane = 100.0f;
+	// half the height of the scene shown in the orthographic views
+	const float g_OrthoHalfHeight = 10.0f;
+
+	// compute shader files of the passes over the drawn frame
+	const char* g_AmbientOcclusionShaderPath = "shaders/ambientOcclusionComputeShader.glsl";
+	const char* g_TemporalAntiAliasingShaderPath = "shaders/temporalAntiAliasingComputeShader.glsl";
+	const char* g_ToneMappingShaderPath = "shaders/toneMappingComputeShader.glsl";
+
+	// fixed cameras for the front, side and top orthographic
+	// views, all looking at the middle of the scene
+	struct ORTHO_CAMERA
+	{
+		glm::vec3 position;
+		glm::vec3 front;
+		glm::vec3 up;
+	};
+	const ORTHO_CAMERA g_OrthoCameras[3] =
+	{
+		{ glm::vec3(0.0f, 5.0f, 20.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(20.0f, 5.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) },
+		{ glm::vec3(0.0f, 25.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f) }
+	};
 }
 
 /***********************************************************
@@ -47,17 +79,48 @@ namespace
  *  The constructor for the class
  ***********************************************************/
 ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+	ShaderVariants* pShaderVariants)
 {
 	// initialize the member variables
-	m_pShaderManager = pShaderManager;
+	m_pShaderVariants = pShaderVariants;
 	m_pWindow = NULL;
+	m_viewMode = VIEW_PERSPECTIVE;
+	m_viewCount = 1;
+	for (int i = 0; i < MAX_VIEWS; i++)
+	{
+		m_views[i].view = glm::mat4(1.0f);
+		m_views[i].projection = glm::mat4(1.0f);
+		m_views[i].position = glm::vec3(0.0f, 0.0f, 0.0f);
+		m_views[i].viewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		m_views[i].bOrthographic = false;
+		m_views[i].bUseCamera = true;
+		m_viewProjections[i] = glm::mat4(1.0f);
+	}
+	m_projectionZoom = 0.0f;
+	m_projectionAspect = 0.0f;
+	m_bProjectionsValid = false;
+	m_pDynamicResolution = new DynamicResolution();
+	m_pAmbientOcclusion = NULL;
+	m_pTemporalAntiAliasing = NULL;
+	m_pToneMapping = NULL;
+	m_jitter = glm::mat4(1.0f);
+	m_pProfiler = new GPUProfiler();
+	m_frameScope = m_pProfiler->AddScope("frame");
+	// the scopes of the optional passes are added when the
+	// passes are turned on
+	m_resolveScope = -1;
+	m_ambientOcclusionScope = -1;
+	m_temporalScope = -1;
+	m_bloomScope = -1;
+	m_toneMappingScope = -1;
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 11.0f, 10.0f);
 	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -5.0f);
 	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 	g_pCamera->Zoom = 80;
+	g_pInputManager = new InputManager();
+	g_pInputRecorder = new InputRecorder();
 }
 
 /***********************************************************
@@ -68,13 +131,49 @@ ViewManager::ViewManager(
 ViewManager::~ViewManager()
 {
 	// free up allocated memory
-	m_pShaderManager = NULL;
+	m_pShaderVariants = NULL;
 	m_pWindow = NULL;
+	if (NULL != m_pDynamicResolution)
+	{
+		delete m_pDynamicResolution;
+		m_pDynamicResolution = NULL;
+	}
+	if (NULL != m_pAmbientOcclusion)
+	{
+		delete m_pAmbientOcclusion;
+		m_pAmbientOcclusion = NULL;
+	}
+	if (NULL != m_pTemporalAntiAliasing)
+	{
+		delete m_pTemporalAntiAliasing;
+		m_pTemporalAntiAliasing = NULL;
+	}
+	if (NULL != m_pToneMapping)
+	{
+		delete m_pToneMapping;
+		m_pToneMapping = NULL;
+	}
+	if (NULL != m_pProfiler)
+	{
+		delete m_pProfiler;
+		m_pProfiler = NULL;
+	}
 	if (NULL != g_pCamera)
 	{
 		delete g_pCamera;
 		g_pCamera = NULL;
 	}
+	if (NULL != g_pInputRecorder)
+	{
+		// finishes the recorded file if one is being written
+		delete g_pInputRecorder;
+		g_pInputRecorder = NULL;
+	}
+	if (NULL != g_pInputManager)
+	{
+		delete g_pInputManager;
+		g_pInputManager = NULL;
+	}
 }
 
 /***********************************************************
@@ -86,6 +185,12 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 {
 	GLFWwindow* window = nullptr;
 
+	// allow the window to be resized
+	glfwWindowHint(GLFW_RESIZABLE, GL_TRUE);
+	// the scene is drawn offscreen and only copied into the
+	// window, so any multisampling is done offscreen
+	glfwWindowHint(GLFW_SAMPLES, 0);
+
 	// try to create the displayed OpenGL window
 	window = glfwCreateWindow(
 		WINDOW_WIDTH,
@@ -105,10 +210,16 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 
 	// this callback is used to receive mouse moving events
 	glfwSetCursorPosCallback(window, &ViewManager::Mouse_Position_Callback);
+	// this callback is used to receive key press and release events
+	glfwSetKeyCallback(window, &ViewManager::Key_Callback);
+	// this callback is used to receive window resize events
+	glfwSetFramebufferSizeCallback(window, &ViewManager::Framebuffer_Size_Callback);
+	glfwGetFramebufferSize(window, &g_FramebufferWidth, &g_FramebufferHeight);
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	// blend factors for supporting tranparent rendering - the
+	// shaders output premultiplied alpha, and blending is only
+	// turned on while the transparent objects are drawn
+	GLStateCache::BlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 
 	m_pWindow = window;
 
@@ -120,44 +231,71 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
  *
  *  This method is automatically called from GLFW whenever
  *  the mouse is moved within the active GLFW display window.
+ *  The position is only buffered here - the camera is moved
+ *  once per frame by ProcessMouseEvents().
  ***********************************************************/
 void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
 {
-	// when the first mouse move event is received, this needs to be recorded so that
-	// all subsequent mouse moves can correctly calculate the X position offset and Y
-	// position offset for proper operation
-	if (gFirstMouse)
+	// the live cursor is ignored while a recording is replayed
+	if ((NULL != g_pInputManager) && (false == g_pInputRecorder->IsReplaying()))
 	{
-		gLastX = xMousePos;
-		gLastY = yMousePos;
-		gFirstMouse = false;
+		g_pInputManager->QueueCursorEvent(glfwGetTime(), xMousePos, yMousePos);
 	}
+}
 
-	// calculate the X offset and Y offset values for moving the 3D camera accordingly
-	float xOffset = xMousePos - gLastX;
-	float yOffset = gLastY - yMousePos; // reversed since y-coordinates go from bottom to top
+/***********************************************************
+ *  Key_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  a key is pressed, repeated or released while the display
+ *  window has focus.  The event is only buffered here - it
+ *  is applied by ProcessKeyboardEvents().
+ ***********************************************************/
+void ViewManager::Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+	if (NULL == g_pInputManager)
+	{
+		return;
+	}
 
-	// set the current positions into the last position variables
-	gLastX = xMousePos;
-	gLastY = yMousePos;
+	// only the escape key still works while a recording is
+	// replayed, so the replay can be stopped
+	if ((true == g_pInputRecorder->IsReplaying()) && (key != GLFW_KEY_ESCAPE))
+	{
+		return;
+	}
 
-	// move the 3D camera according to the calculated offsets
-	g_pCamera->ProcessMouseMovement(xOffset, yOffset);
+	g_pInputManager->QueueKeyEvent(glfwGetTime(), key, action);
+}
 
-	//adjust 3D camera movement speed
-	// g_pCamera->ProcessMouseScroll(yOffset);
+/***********************************************************
+ *  Framebuffer_Size_Callback()
+ *
+ *  This method is automatically called from GLFW whenever
+ *  the framebuffer of the display window changes size.  A
+ *  minimized window reports a size of zero, which is kept
+ *  out so the aspect ratio stays valid.
+ ***********************************************************/
+void ViewManager::Framebuffer_Size_Callback(GLFWwindow* window, int width, int height)
+{
+	if ((width > 0) && (height > 0))
+	{
+		g_FramebufferWidth = width;
+		g_FramebufferHeight = height;
+	}
 }
 
 /***********************************************************
  *  ProcessKeyboardEvents()
  *
- *  This method is called to process any keyboard events
- *  that may be waiting in the event queue.
+ *  This method is called to process the keyboard events
+ *  buffered since the previous frame.  The camera moves for
+ *  as long as each key was held during that time.
  ***********************************************************/
 void ViewManager::ProcessKeyboardEvents()
 {
 	// close the window if the escape key has been pressed
-	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+	if (g_pInputManager->WasKeyPressed(GLFW_KEY_ESCAPE))
 	{
 		glfwSetWindowShouldClose(m_pWindow, true);
 	}
@@ -168,57 +306,182 @@ void ViewManager::ProcessKeyboardEvents()
 	}
 
 	// process camera zooming in and out
-	if (glfwGetKey(m_pWindow, GLFW_KEY_W) == GLFW_PRESS)
+	if (g_pInputManager->GetKeyHeldTime(GLFW_KEY_W) > 0.0f)
 	{
-		g_pCamera->ProcessKeyboard(FORWARD, gDeltaTime);
+		g_pCamera->ProcessKeyboard(FORWARD, g_pInputManager->GetKeyHeldTime(GLFW_KEY_W));
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_S) == GLFW_PRESS)
+	if (g_pInputManager->GetKeyHeldTime(GLFW_KEY_S) > 0.0f)
 	{
-		g_pCamera->ProcessKeyboard(BACKWARD, gDeltaTime);
+		g_pCamera->ProcessKeyboard(BACKWARD, g_pInputManager->GetKeyHeldTime(GLFW_KEY_S));
 	}
 
 	// process camera panning left and right
-	if (glfwGetKey(m_pWindow, GLFW_KEY_A) == GLFW_PRESS)
+	if (g_pInputManager->GetKeyHeldTime(GLFW_KEY_A) > 0.0f)
 	{
-		g_pCamera->ProcessKeyboard(LEFT, gDeltaTime);
+		g_pCamera->ProcessKeyboard(LEFT, g_pInputManager->GetKeyHeldTime(GLFW_KEY_A));
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_D) == GLFW_PRESS)
+	if (g_pInputManager->GetKeyHeldTime(GLFW_KEY_D) > 0.0f)
 	{
-		g_pCamera->ProcessKeyboard(RIGHT, gDeltaTime);
+		g_pCamera->ProcessKeyboard(RIGHT, g_pInputManager->GetKeyHeldTime(GLFW_KEY_D));
 	}
 	// process camera panning up and down
-	if (glfwGetKey(m_pWindow, GLFW_KEY_Q) == GLFW_PRESS)
+	if (g_pInputManager->GetKeyHeldTime(GLFW_KEY_Q) > 0.0f)
 	{
-		g_pCamera->ProcessKeyboard(UP, gDeltaTime);
+		g_pCamera->ProcessKeyboard(UP, g_pInputManager->GetKeyHeldTime(GLFW_KEY_Q));
 	}
-	if (glfwGetKey(m_pWindow, GLFW_KEY_E) == GLFW_PRESS)
+	if (g_pInputManager->GetKeyHeldTime(GLFW_KEY_E) > 0.0f)
 	{
-		g_pCamera->ProcessKeyboard(DOWN, gDeltaTime);
+		g_pCamera->ProcessKeyboard(DOWN, g_pInputManager->GetKeyHeldTime(GLFW_KEY_E));
 	}
 
-	// change between different projection views
-	if (glfwGetKey(m_pWindow, GLFW_KEY_O) == GLFW_PRESS)
+	// change between different projection views - O and P are
+	// kept as the original keys for the front and perspective views
+	if (g_pInputManager->WasKeyPressed(GLFW_KEY_1) || g_pInputManager->WasKeyPressed(GLFW_KEY_O))
+	{
+		SetViewMode(VIEW_FRONT);
+	}
+	if (g_pInputManager->WasKeyPressed(GLFW_KEY_2))
+	{
+		SetViewMode(VIEW_SIDE);
+	}
+	if (g_pInputManager->WasKeyPressed(GLFW_KEY_3))
+	{
+		SetViewMode(VIEW_TOP);
+	}
+	if (g_pInputManager->WasKeyPressed(GLFW_KEY_4) || g_pInputManager->WasKeyPressed(GLFW_KEY_P))
+	{
+		SetViewMode(VIEW_PERSPECTIVE);
+	}
+	if (g_pInputManager->WasKeyPressed(GLFW_KEY_5))
 	{
-		// change to a multi-view orthographic projection
-		bOrthographicProjection = true;
+		SetViewMode(VIEW_QUAD);
+	}
+}
 
-		// change the camera settings to show a front orthographic view
-		g_pCamera->Position = glm::vec3(0.0f, 0.0f, 15.0f);
-		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-		g_pCamera->Front = glm::vec3(0.0f, 0.0f, -1.0f);
+/***********************************************************
+ *  ProcessMouseEvents()
+ *
+ *  This method is called to move the camera by all of the
+ *  cursor movement buffered since the previous frame, in a
+ *  single step.
+ ***********************************************************/
+void ViewManager::ProcessMouseEvents()
+{
+	// if the camera object is null, then exit this method
+	if (NULL == g_pCamera)
+	{
+		return;
+	}
+	// the single orthographic views keep their fixed direction
+	if ((m_viewMode != VIEW_PERSPECTIVE) && (m_viewMode != VIEW_QUAD))
+	{
+		return;
 	}
-	// change between different projection views
-	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS)
+
+	glm::vec2 cursorDelta = g_pInputManager->GetCursorDelta();
+	if ((cursorDelta.x != 0.0f) || (cursorDelta.y != 0.0f))
 	{
-		// change to perspective projection
-		bOrthographicProjection = false;
+		// move the 3D camera according to the calculated offsets
+		g_pCamera->ProcessMouseMovement(cursorDelta.x, cursorDelta.y);
+	}
+}
 
+/***********************************************************
+ *  SetViewMode()
+ *
+ *  This method is used for switching to a different way of
+ *  viewing the scene.  The single orthographic views move
+ *  the camera to their fixed position, where it can still
+ *  be panned, and the perspective and quad views put the
+ *  camera back at its perspective starting point.
+ ***********************************************************/
+void ViewManager::SetViewMode(VIEW_MODE viewMode)
+{
+	if (viewMode == VIEW_PERSPECTIVE || viewMode == VIEW_QUAD)
+	{
 		// change the camera settings to show a perspective view
 		g_pCamera->Position = glm::vec3(0.0f, 5.5f, 15.0f);
 		g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
 		g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
 		g_pCamera->Zoom = 80;
 	}
+	else
+	{
+		// change the camera settings to show an orthographic view
+		const ORTHO_CAMERA& orthoCamera = g_OrthoCameras[viewMode - VIEW_FRONT];
+		g_pCamera->Position = orthoCamera.position;
+		g_pCamera->Front = orthoCamera.front;
+		g_pCamera->Up = orthoCamera.up;
+	}
+
+	m_viewMode = viewMode;
+
+	// set which views are shown and the part of the frame each one
+	// fills - the quad view follows the usual drafting layout, with
+	// the top view above the front view and the side view beside it
+	if (viewMode == VIEW_QUAD)
+	{
+		m_viewCount = 4;
+		m_views[0].viewport = glm::vec4(0.5f, 0.5f, 0.5f, 0.5f);
+		m_views[0].bOrthographic = false;
+		m_views[0].bUseCamera = true;
+		m_views[1].viewport = glm::vec4(0.0f, 0.5f, 0.5f, 0.5f);
+		m_views[2].viewport = glm::vec4(0.0f, 0.0f, 0.5f, 0.5f);
+		m_views[3].viewport = glm::vec4(0.5f, 0.0f, 0.5f, 0.5f);
+
+		const ORTHO_CAMERA* pOrthoCameras[3] = { &g_OrthoCameras[2], &g_OrthoCameras[0], &g_OrthoCameras[1] };
+		for (int i = 1; i < 4; i++)
+		{
+			const ORTHO_CAMERA& orthoCamera = *pOrthoCameras[i - 1];
+			m_views[i].view = glm::lookAt(orthoCamera.position, orthoCamera.position + orthoCamera.front, orthoCamera.up);
+			m_views[i].position = orthoCamera.position;
+			m_views[i].bOrthographic = true;
+			m_views[i].bUseCamera = false;
+		}
+	}
+	else
+	{
+		m_viewCount = 1;
+		m_views[0].viewport = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+		m_views[0].bOrthographic = (viewMode != VIEW_PERSPECTIVE);
+		m_views[0].bUseCamera = true;
+	}
+
+	m_bProjectionsValid = false;
+}
+
+/***********************************************************
+ *  UpdateProjections()
+ *
+ *  This method is used for rebuilding the projection matrix
+ *  of every view, but only when the camera zoom, the aspect
+ *  ratio or the view mode has changed since they were last
+ *  built.  Every quad pane is half the width and height of
+ *  the frame, so the panes keep the frame aspect ratio.
+ ***********************************************************/
+void ViewManager::UpdateProjections(float aspectRatio)
+{
+	if ((true == m_bProjectionsValid) &&
+		(m_projectionZoom == g_pCamera->Zoom) &&
+		(m_projectionAspect == aspectRatio))
+	{
+		return;
+	}
+
+	glm::mat4 perspective = glm::perspective(glm::radians(g_pCamera->Zoom), aspectRatio, g_NearPlane, g_FarPlane);
+	glm::mat4 orthographic = glm::ortho(
+		-g_OrthoHalfHeight * aspectRatio, g_OrthoHalfHeight * aspectRatio,
+		-g_OrthoHalfHeight, g_OrthoHalfHeight,
+		g_NearPlane, g_FarPlane);
+
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		m_views[i].projection = (true == m_views[i].bOrthographic) ? orthographic : perspective;
+	}
+
+	m_projectionZoom = g_pCamera->Zoom;
+	m_projectionAspect = aspectRatio;
+	m_bProjectionsValid = true;
 }
 
 /***********************************************************
@@ -230,32 +493,482 @@ void ViewManager::ProcessKeyboardEvents()
  ***********************************************************/
 void ViewManager::PrepareSceneView()
 {
-	glm::mat4 view;
-	glm::mat4 projection;
-
 	// per-frame timing
-	float currentFrame = glfwGetTime();
+	double currentTime = glfwGetTime();
+
+	// a replay feeds the recorded input on a fixed timestep,
+	// and closes the window once the recording runs out
+	if (true == g_pInputRecorder->IsReplaying())
+	{
+		if (true == g_pInputRecorder->IsReplayFinished())
+		{
+			g_pInputRecorder->FinishReplay(g_pCamera);
+			glfwSetWindowShouldClose(m_pWindow, true);
+		}
+		else
+		{
+			currentTime = g_pInputRecorder->AdvanceReplay(g_pInputManager, currentTime);
+		}
+	}
+
+	float currentFrame = (float)currentTime;
 	gDeltaTime = currentFrame - gLastFrame;
 	gLastFrame = currentFrame;
 
-	// process any keyboard events that may be waiting in the 
-	// event queue
+	// apply the input buffered since the previous frame at this
+	// one point, before the view matrix is built from the camera
+	g_pInputManager->BeginFrame(currentTime);
 	ProcessKeyboardEvents();
+	ProcessMouseEvents();
+	g_pInputRecorder->RecordFrame(currentTime, g_pInputManager, g_pCamera);
 
-	// get the current view matrix from the camera
-	view = g_pCamera->GetViewMatrix();
+	// the projection matrices are only rebuilt when they change
+	UpdateProjections((GLfloat)g_FramebufferWidth / (GLfloat)g_FramebufferHeight);
 
-	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	// a single view is moved by a different fraction of a pixel
+	// every frame for the temporal anti-aliasing
+	m_jitter = glm::mat4(1.0f);
+	if ((NULL != m_pTemporalAntiAliasing) && (m_viewCount == 1))
+	{
+		m_jitter = m_pTemporalAntiAliasing->GetJitter(
+			m_pDynamicResolution->GetRenderWidth(),
+			m_pDynamicResolution->GetRenderHeight());
+	}
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
+	// get the current view matrix from the camera for the views
+	// that follow it, and keep the combined matrices for culling
+	// the scene objects
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		if (true == m_views[i].bUseCamera)
+		{
+			m_views[i].view = g_pCamera->GetViewMatrix();
+			m_views[i].position = g_pCamera->Position;
+		}
+		m_viewProjections[i] = m_jitter * m_views[i].projection * m_views[i].view;
+	}
+
+	// a single view is set into the shader here, the quad view
+	// sets each of its views as it is drawn
+	if (m_viewCount == 1)
+	{
+		ApplyView(0);
+	}
+}
+
+/***********************************************************
+ *  GetViewProjection()
+ *
+ *  This method is used for getting the combined view and
+ *  projection matrix that was prepared for the current frame.
+ ***********************************************************/
+glm::mat4 ViewManager::GetViewProjection()
+{
+	return(m_viewProjections[0]);
+}
+
+/***********************************************************
+ *  GetViewCount()
+ *
+ *  This method is used for getting the number of views that
+ *  were prepared for the current frame.
+ ***********************************************************/
+int ViewManager::GetViewCount()
+{
+	return(m_viewCount);
+}
+
+/***********************************************************
+ *  GetViewProjections()
+ *
+ *  This method is used for getting the combined view and
+ *  projection matrix of every view prepared for the frame.
+ ***********************************************************/
+const glm::mat4* ViewManager::GetViewProjections()
+{
+	return(m_viewProjections);
+}
+
+/***********************************************************
+ *  ApplyView()
+ *
+ *  This method is used for setting the viewport to the part
+ *  of the scene render target that a view fills, and for
+ *  setting the view values into the shader.
+ ***********************************************************/
+void ViewManager::ApplyView(int viewIndex)
+{
+	if ((viewIndex < 0) || (viewIndex >= m_viewCount))
+	{
+		return;
+	}
+
+	const SCENE_VIEW& sceneView = m_views[viewIndex];
+	int renderWidth = m_pDynamicResolution->GetRenderWidth();
+	int renderHeight = m_pDynamicResolution->GetRenderHeight();
+	if ((renderWidth > 0) && (renderHeight > 0))
+	{
+		GLStateCache::Viewport(
+			(GLint)(sceneView.viewport.x * renderWidth),
+			(GLint)(sceneView.viewport.y * renderHeight),
+			(GLsizei)(sceneView.viewport.z * renderWidth),
+			(GLsizei)(sceneView.viewport.w * renderHeight));
+	}
+
+	// if the shader variants object is valid
+	if (NULL != m_pShaderVariants)
 	{
 		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
+		m_pShaderVariants->SetMat4Value(g_ViewName, sceneView.view);
+		// set the projection matrix into the shader for proper rendering
+		m_pShaderVariants->SetMat4Value(g_ProjectionName, m_jitter * sceneView.projection);
 		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		m_pShaderVariants->SetVec3Value("viewPosition", sceneView.position);
+		// only this view is drawn
+		m_pShaderVariants->SetIntValue("viewCount", 1);
+	}
+}
+
+/***********************************************************
+ *  GetViewportHeight()
+ *
+ *  This method is used for getting the height in pixels of
+ *  one of the views, in the scaled offscreen target.
+ ***********************************************************/
+int ViewManager::GetViewportHeight(int viewIndex)
+{
+	if ((viewIndex < 0) || (viewIndex >= m_viewCount))
+	{
+		return(0);
+	}
+
+	return((int)(m_views[viewIndex].viewport.w * m_pDynamicResolution->GetRenderHeight()));
+}
+
+/***********************************************************
+ *  ApplyAllViews()
+ *
+ *  This method is used for setting one entry of the viewport
+ *  array for every view, and the view projection and view
+ *  position of every view into the shader.  The vertex
+ *  shader then sends each instance of a draw to the viewport
+ *  of its view.
+ ***********************************************************/
+void ViewManager::ApplyAllViews()
+{
+	int renderWidth = m_pDynamicResolution->GetRenderWidth();
+	int renderHeight = m_pDynamicResolution->GetRenderHeight();
+
+	for (int i = 0; i < m_viewCount; i++)
+	{
+		const SCENE_VIEW& sceneView = m_views[i];
+
+		if ((renderWidth > 0) && (renderHeight > 0))
+		{
+			GLStateCache::ViewportIndexed(
+				(GLuint)i,
+				(GLfloat)(int)(sceneView.viewport.x * renderWidth),
+				(GLfloat)(int)(sceneView.viewport.y * renderHeight),
+				(GLfloat)(int)(sceneView.viewport.z * renderWidth),
+				(GLfloat)(int)(sceneView.viewport.w * renderHeight));
+		}
+
+		if (NULL != m_pShaderVariants)
+		{
+			std::string index = "[" + std::to_string(i) + "]";
+			m_pShaderVariants->SetMat4Value("viewProjections" + index, m_viewProjections[i]);
+			m_pShaderVariants->SetVec3Value("viewPositions" + index, sceneView.position);
+		}
+	}
+
+	if (NULL != m_pShaderVariants)
+	{
+		m_pShaderVariants->SetIntValue("viewCount", m_viewCount);
+	}
+}
+
+/***********************************************************
+ *  GetInputManager()
+ *
+ *  This method is used for getting the object that buffers
+ *  the input events of the display window.
+ ***********************************************************/
+InputManager* ViewManager::GetInputManager()
+{
+	return(g_pInputManager);
+}
+
+/***********************************************************
+ *  StartInputRecording()
+ *
+ *  This method is used for recording the input applied for
+ *  every frame of this run into the passed in file.
+ ***********************************************************/
+bool ViewManager::StartInputRecording(const char* filePath)
+{
+	return(g_pInputRecorder->StartRecording(filePath, g_pCamera));
+}
+
+/***********************************************************
+ *  StartInputReplay()
+ *
+ *  This method is used for driving the camera from the input
+ *  recorded in the passed in file instead of the live input.
+ ***********************************************************/
+bool ViewManager::StartInputReplay(const char* filePath)
+{
+	return(g_pInputRecorder->StartReplay(filePath, g_pCamera));
+}
+
+/***********************************************************
+ *  BeginSceneRender()
+ *
+ *  This method is used for binding the offscreen target that
+ *  the scene is drawn into, at the current render scale of
+ *  the window framebuffer size.
+ ***********************************************************/
+void ViewManager::BeginSceneRender()
+{
+	m_pProfiler->BeginFrame();
+	m_pProfiler->BeginScope(m_frameScope);
+	m_pDynamicResolution->BeginFrame(g_FramebufferWidth, g_FramebufferHeight);
+}
+
+/***********************************************************
+ *  EndSceneRender()
+ *
+ *  This method is used for running the passes over the
+ *  drawn frame, and scaling it up into the display window.
+ *  The multisampled frame is resolved first, so the passes
+ *  read one value per pixel.  The ambient occlusion and the
+ *  temporal anti-aliasing are only run for a single view,
+ *  since the panes of the quad view each have their own
+ *  projection.
+ ***********************************************************/
+void ViewManager::EndSceneRender()
+{
+	int renderWidth = m_pDynamicResolution->GetRenderWidth();
+	int renderHeight = m_pDynamicResolution->GetRenderHeight();
+	glm::mat4 projection = m_jitter * m_views[0].projection;
+
+	m_pProfiler->BeginScope(m_resolveScope);
+	m_pDynamicResolution->Resolve();
+	m_pProfiler->EndScope(m_resolveScope);
+
+	if ((NULL != m_pAmbientOcclusion) && (1 == m_viewCount))
+	{
+		m_pProfiler->BeginScope(m_ambientOcclusionScope);
+		m_pAmbientOcclusion->Apply(
+			m_pDynamicResolution->GetColorTexture(),
+			m_pDynamicResolution->GetDepthTexture(),
+			renderWidth,
+			renderHeight,
+			m_views[0].view,
+			projection);
+		m_pProfiler->EndScope(m_ambientOcclusionScope);
+	}
+	else if (NULL != m_pAmbientOcclusion)
+	{
+		m_pAmbientOcclusion->ResetHistory();
+	}
+
+	if ((NULL != m_pTemporalAntiAliasing) && (1 == m_viewCount))
+	{
+		m_pProfiler->BeginScope(m_temporalScope);
+		m_pTemporalAntiAliasing->Apply(
+			m_pDynamicResolution->GetColorTexture(),
+			m_pDynamicResolution->GetDepthTexture(),
+			renderWidth,
+			renderHeight,
+			m_views[0].projection * m_views[0].view,
+			m_viewProjections[0]);
+		m_pProfiler->EndScope(m_temporalScope);
+	}
+	else if (NULL != m_pTemporalAntiAliasing)
+	{
+		m_pTemporalAntiAliasing->ResetHistory();
+	}
+
+	// the whole frame is tone mapped, in any view layout
+	if (NULL != m_pToneMapping)
+	{
+		m_pProfiler->BeginScope(m_bloomScope);
+		m_pToneMapping->BuildBloom(
+			m_pDynamicResolution->GetColorTexture(),
+			renderWidth,
+			renderHeight,
+			gDeltaTime);
+		m_pProfiler->EndScope(m_bloomScope);
+
+		m_pProfiler->BeginScope(m_toneMappingScope);
+		m_pToneMapping->Compose(
+			m_pDynamicResolution->GetColorTexture(),
+			renderWidth,
+			renderHeight);
+		m_pProfiler->EndScope(m_toneMappingScope);
+	}
+
+	m_pDynamicResolution->EndFrame();
+	m_pProfiler->EndScope(m_frameScope);
+	m_pProfiler->EndFrame();
+}
+
+/***********************************************************
+ *  SetTargetFrameRate()
+ *
+ *  This method is used for setting the frame rate that the
+ *  dynamic render scale adjusts the GPU time to hold.
+ ***********************************************************/
+void ViewManager::SetTargetFrameRate(float framesPerSecond)
+{
+	if (framesPerSecond > 0.0f)
+	{
+		m_pDynamicResolution->SetTargetFrameTime(1000.0f / framesPerSecond);
 	}
-}
\ No newline at end of file
+}
+
+/***********************************************************
+ *  SetRenderScale()
+ *
+ *  This method is used for fixing the render scale, or for
+ *  letting it follow the GPU time when zero is passed in.
+ ***********************************************************/
+void ViewManager::SetRenderScale(float renderScale)
+{
+	m_pDynamicResolution->SetFixedScale(renderScale);
+}
+
+/***********************************************************
+ *  SetAmbientOcclusion()
+ *
+ *  This method is used for turning on the ambient occlusion
+ *  passes, sampled at the frame resolution divided by 1, 2
+ *  or 4.  It must be called once the OpenGL context exists.
+ ***********************************************************/
+bool ViewManager::SetAmbientOcclusion(int resolutionDivisor, const AssetPack* pAssetPack)
+{
+	if (false == AmbientOcclusion::IsSupported())
+	{
+		std::cout << "Ambient occlusion needs OpenGL 4.3 compute shaders, so it is turned off" << std::endl;
+		return(false);
+	}
+
+	if (NULL == m_pAmbientOcclusion)
+	{
+		m_pAmbientOcclusion = new AmbientOcclusion();
+	}
+	if (false == m_pAmbientOcclusion->Create(g_AmbientOcclusionShaderPath, pAssetPack, resolutionDivisor))
+	{
+		delete m_pAmbientOcclusion;
+		m_pAmbientOcclusion = NULL;
+		return(false);
+	}
+
+	if (m_ambientOcclusionScope < 0)
+	{
+		m_ambientOcclusionScope = m_pProfiler->AddScope("ambient occlusion");
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetMultisampling()
+ *
+ *  This method is used for drawing the scene with 2, 4 or 8
+ *  samples per pixel, which are resolved into the frame
+ *  before the passes over it.  The time of the resolve is
+ *  profiled on its own, and the cost of drawing the extra
+ *  samples shows up in the time of the frame.
+ ***********************************************************/
+void ViewManager::SetMultisampling(int sampleCount)
+{
+	m_pDynamicResolution->SetSampleCount(sampleCount);
+
+	if ((m_pDynamicResolution->GetSampleCount() > 1) && (m_resolveScope < 0))
+	{
+		std::string name = "msaa " + std::to_string(m_pDynamicResolution->GetSampleCount()) + "x resolve";
+		m_resolveScope = m_pProfiler->AddScope(name.c_str());
+	}
+}
+
+/***********************************************************
+ *  SetTemporalAntiAliasing()
+ *
+ *  This method is used for turning on the temporal
+ *  anti-aliasing.  It must be called once the OpenGL
+ *  context exists.
+ ***********************************************************/
+bool ViewManager::SetTemporalAntiAliasing(const AssetPack* pAssetPack)
+{
+	if (false == TemporalAntiAliasing::IsSupported())
+	{
+		std::cout << "Temporal anti-aliasing needs OpenGL 4.3 compute shaders, so it is turned off" << std::endl;
+		return(false);
+	}
+
+	if (NULL == m_pTemporalAntiAliasing)
+	{
+		m_pTemporalAntiAliasing = new TemporalAntiAliasing();
+	}
+	if (false == m_pTemporalAntiAliasing->Create(g_TemporalAntiAliasingShaderPath, pAssetPack))
+	{
+		delete m_pTemporalAntiAliasing;
+		m_pTemporalAntiAliasing = NULL;
+		return(false);
+	}
+
+	if (m_temporalScope < 0)
+	{
+		m_temporalScope = m_pProfiler->AddScope("taa resolve");
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SetToneMapping()
+ *
+ *  This method is used for turning on the exposure, bloom
+ *  and tone mapping of the half float frame.  Without it
+ *  the frame is shown as drawn, clipped to the display
+ *  range.  It must be called once the OpenGL context exists.
+ ***********************************************************/
+bool ViewManager::SetToneMapping(const AssetPack* pAssetPack)
+{
+	if (false == ToneMapping::IsSupported())
+	{
+		std::cout << "Tone mapping needs OpenGL 4.3 compute shaders, so it is turned off" << std::endl;
+		return(false);
+	}
+
+	if (NULL == m_pToneMapping)
+	{
+		m_pToneMapping = new ToneMapping();
+	}
+	if (false == m_pToneMapping->Create(g_ToneMappingShaderPath, pAssetPack))
+	{
+		delete m_pToneMapping;
+		m_pToneMapping = NULL;
+		return(false);
+	}
+
+	if (m_bloomScope < 0)
+	{
+		m_bloomScope = m_pProfiler->AddScope("bloom and exposure");
+		m_toneMappingScope = m_pProfiler->AddScope("tone mapping");
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  PrintGPUProfile()
+ *
+ *  This method is used for printing the average GPU time of
+ *  the frame and of the passes over it.
+ ***********************************************************/
+void ViewManager::PrintGPUProfile()
+{
+	m_pProfiler->PrintReport();
+}
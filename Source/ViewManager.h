@@ -9,7 +9,15 @@
 
 #pragma once
 
-#include "ShaderManager.h"
+#include "ShaderVariants.h"
+#include "InputManager.h"
+#include "InputRecorder.h"
+#include "DynamicResolution.h"
+#include "AmbientOcclusion.h"
+#include "TemporalAntiAliasing.h"
+#include "ToneMapping.h"
+#include "GPUProfiler.h"
+#include "AssetPack.h"
 #include "camera.h"
 
 // GLFW library
@@ -18,23 +26,87 @@
 class ViewManager
 {
 public:
+	// ways the scene can be viewed
+	enum VIEW_MODE
+	{
+		VIEW_PERSPECTIVE = 0,
+		VIEW_FRONT,
+		VIEW_SIDE,
+		VIEW_TOP,
+		VIEW_QUAD
+	};
+
+	// most views shown at once, in the quad view
+	static const int MAX_VIEWS = 4;
+
 	// constructor
 	ViewManager(
-		ShaderManager* pShaderManager);
+		ShaderVariants* pShaderVariants);
 	// destructor
 	~ViewManager();
 
 	// mouse position callback for mouse interaction with the 3D scene
 	static void Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos);
+	// key callback for keyboard interaction with the 3D scene
+	static void Key_Callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	// framebuffer size callback for resizing the display window
+	static void Framebuffer_Size_Callback(GLFWwindow* window, int width, int height);
 
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
+	// pointer to the shader variants the scene is drawn with
+	ShaderVariants* m_pShaderVariants;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// one view of the scene and the part of the frame it fills
+	struct SCENE_VIEW
+	{
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 position;
+		// x, y, width and height as fractions of the frame
+		glm::vec4 viewport;
+		bool bOrthographic;
+		bool bUseCamera;
+	};
+
+	// current way the scene is viewed
+	VIEW_MODE m_viewMode;
+	// views prepared for the current frame
+	SCENE_VIEW m_views[MAX_VIEWS];
+	int m_viewCount;
+	// combined view and projection matrices for the current frame
+	glm::mat4 m_viewProjections[MAX_VIEWS];
+	// values the cached projection matrices were built for
+	float m_projectionZoom;
+	float m_projectionAspect;
+	bool m_bProjectionsValid;
+	// offscreen target the scene is drawn into at a scaled resolution
+	DynamicResolution* m_pDynamicResolution;
+	// darkens the drawn frame where it is occluded, when enabled
+	AmbientOcclusion* m_pAmbientOcclusion;
+	// averages the edges of the drawn frames, when enabled
+	TemporalAntiAliasing* m_pTemporalAntiAliasing;
+	// brings the frame into the display range, when enabled
+	ToneMapping* m_pToneMapping;
+	// sub-pixel offset of this frame's projection
+	glm::mat4 m_jitter;
+	// GPU time of the parts of the frame
+	GPUProfiler* m_pProfiler;
+	int m_frameScope;
+	int m_resolveScope;
+	int m_ambientOcclusionScope;
+	int m_temporalScope;
+	int m_bloomScope;
+	int m_toneMappingScope;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
+	// process the mouse movement for interaction with the 3D scene
+	void ProcessMouseEvents();
+	// switch to a different way of viewing the scene
+	void SetViewMode(VIEW_MODE viewMode);
+	// rebuild the projection matrices if the zoom or aspect changed
+	void UpdateProjections(float aspectRatio);
 
 public:
 	// create the initial OpenGL display window
@@ -42,4 +114,43 @@ public:
 	
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+	// get the view projection matrix prepared for the current frame
+	glm::mat4 GetViewProjection();
+	// get the views prepared for the current frame
+	int GetViewCount();
+	const glm::mat4* GetViewProjections();
+	// set the viewport and shader values for drawing one view
+	void ApplyView(int viewIndex);
+	// height in pixels of a view at the current render scale
+	int GetViewportHeight(int viewIndex);
+	// set the viewports and shader values of every view, for
+	// drawing all of them in a single pass
+	void ApplyAllViews();
+	// get the input events buffered for the display window
+	InputManager* GetInputManager();
+	// record the input of this run into the passed in file
+	bool StartInputRecording(const char* filePath);
+	// replay the input recorded in the passed in file
+	bool StartInputReplay(const char* filePath);
+
+	// start drawing the scene into the scaled offscreen target
+	void BeginSceneRender();
+	// scale the drawn scene up into the display window
+	void EndSceneRender();
+	// frame rate that the dynamic render scale aims to hold
+	void SetTargetFrameRate(float framesPerSecond);
+	// fix the render scale, or pass zero for a dynamic scale
+	void SetRenderScale(float renderScale);
+	// darken the occluded parts of the frame, sampling the
+	// occlusion at the frame resolution divided by 1, 2 or 4
+	bool SetAmbientOcclusion(int resolutionDivisor, const AssetPack* pAssetPack);
+	// draw the scene with 2, 4 or 8 samples per pixel
+	void SetMultisampling(int sampleCount);
+	// average the edges over jittered frames
+	bool SetTemporalAntiAliasing(const AssetPack* pAssetPack);
+	// expose and tone map the frame, with bloom around the
+	// bright parts
+	bool SetToneMapping(const AssetPack* pAssetPack);
+	// print the GPU time of the parts of the frame
+	void PrintGPUProfile();
 };
\ No newline at end of file
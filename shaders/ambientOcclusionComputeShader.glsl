@@ -0,0 +1,265 @@
+#version 430 core
+
+// each invocation works on one pixel, in 8 by 8 tiles - must
+// match the C++ side
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// AO_PASS is defined by the C++ side to pick the pass each
+// program is built for
+#define PASS_OCCLUSION 0
+#define PASS_ACCUMULATE 1
+#define PASS_UPSAMPLE 2
+
+// linear depth stored for the pixels that show no geometry
+const float SKY_DEPTH = 65000.0;
+
+// depth of the drawn frame
+layout(binding = 20) uniform sampler2D depthMap;
+
+uniform mat4 inverseProjection;
+// size of the drawn part of the frame, and of the reduced
+// resolution the occlusion is sampled at
+uniform vec2 frameSize;
+uniform vec2 targetSize;
+uniform int resolutionDivisor;
+
+/***********************************************************
+ *  GetViewPosition()
+ *
+ *  Rebuild the view space position of a frame pixel from
+ *  its depth.
+ ***********************************************************/
+vec3 GetViewPosition(ivec2 pixel)
+{
+	float depth = texelFetch(depthMap, pixel, 0).r;
+	vec2 ndc = (vec2(pixel) + 0.5) / frameSize * 2.0 - 1.0;
+	vec4 position = inverseProjection * vec4(ndc, depth * 2.0 - 1.0, 1.0);
+
+	return(position.xyz / position.w);
+}
+
+/***********************************************************
+ *  IsSky()
+ *
+ *  Check whether no geometry was drawn at a frame pixel.
+ ***********************************************************/
+bool IsSky(ivec2 pixel)
+{
+	return(texelFetch(depthMap, pixel, 0).r >= 1.0);
+}
+
+/***********************************************************
+ *  GetFramePixel()
+ *
+ *  Get the frame pixel a reduced resolution pixel stands for.
+ ***********************************************************/
+ivec2 GetFramePixel(ivec2 targetPixel)
+{
+	return(min(targetPixel * resolutionDivisor + resolutionDivisor / 2, ivec2(frameSize) - 1));
+}
+
+#if AO_PASS == PASS_OCCLUSION
+
+// samples per pixel and frame
+const int SAMPLE_COUNT = 12;
+// distance an occluder must be in front of a sample, so a
+// flat surface does not occlude itself
+const float DEPTH_BIAS = 0.015;
+
+uniform mat4 projection;
+// distance around a point searched for occluders
+uniform float radius;
+uniform uint frameIndex;
+
+layout(rg16f, binding = 1) writeonly uniform image2D occlusionImage;
+
+/***********************************************************
+ *  main()
+ *
+ *  Sample a hemisphere around the surface point of a pixel,
+ *  turned to its normal, and count the samples that end up
+ *  behind the drawn depth.
+ ***********************************************************/
+void main()
+{
+	ivec2 targetPixel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(targetPixel, ivec2(targetSize))))
+	{
+		return;
+	}
+
+	ivec2 pixel = GetFramePixel(targetPixel);
+	if (IsSky(pixel))
+	{
+		imageStore(occlusionImage, targetPixel, vec4(1.0, SKY_DEPTH, 0.0, 0.0));
+		return;
+	}
+
+	vec3 position = GetViewPosition(pixel);
+
+	// the normal is built from the closer neighbour on each
+	// axis, so it does not bend around depth edges
+	ivec2 maxPixel = ivec2(frameSize) - 1;
+	vec3 right = GetViewPosition(min(pixel + ivec2(1, 0), maxPixel)) - position;
+	vec3 left = position - GetViewPosition(max(pixel - ivec2(1, 0), ivec2(0)));
+	vec3 up = GetViewPosition(min(pixel + ivec2(0, 1), maxPixel)) - position;
+	vec3 down = position - GetViewPosition(max(pixel - ivec2(0, 1), ivec2(0)));
+	bool bRight = (pixel.x < maxPixel.x) && ((pixel.x == 0) || (abs(right.z) < abs(left.z)));
+	bool bUp = (pixel.y < maxPixel.y) && ((pixel.y == 0) || (abs(up.z) < abs(down.z)));
+	vec3 normal = normalize(cross((bRight) ? right : left, (bUp) ? up : down));
+
+	// the samples are turned by a different angle for each
+	// pixel and frame, which the accumulation averages out
+	float noise = fract(52.9829189 * fract(dot(vec2(pixel), vec2(0.06711056, 0.00583715))) +
+		float(frameIndex % 64u) * 0.618034);
+	float angle = noise * 6.2831853;
+	vec3 randomVector = vec3(cos(angle), sin(angle), 0.0);
+	vec3 tangent = normalize(randomVector - normal * dot(randomVector, normal));
+	vec3 bitangent = cross(normal, tangent);
+
+	float occlusion = 0.0;
+	for (int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		// cosine weighted directions on a golden angle spiral,
+		// reaching out further with each sample
+		float t = (float(i) + 0.5) / float(SAMPLE_COUNT);
+		float sinTheta = sqrt(t);
+		float phi = float(i) * 2.3999632;
+		vec3 direction = vec3(cos(phi) * sinTheta, sin(phi) * sinTheta, sqrt(1.0 - t));
+		float scale = mix(0.1, 1.0, t * t);
+		vec3 samplePosition = position +
+			(tangent * direction.x + bitangent * direction.y + normal * direction.z) * radius * scale;
+
+		vec4 sampleClip = projection * vec4(samplePosition, 1.0);
+		vec2 sampleUV = sampleClip.xy / sampleClip.w * 0.5 + 0.5;
+		if (any(lessThan(sampleUV, vec2(0.0))) || any(greaterThanEqual(sampleUV, vec2(1.0))))
+		{
+			continue;
+		}
+
+		// geometry far in front of the point is something else
+		// passing in front of it, not an occluder
+		float sceneDepth = GetViewPosition(ivec2(sampleUV * frameSize)).z;
+		float rangeWeight = smoothstep(0.0, 1.0, radius / max(abs(position.z - sceneDepth), 0.0001));
+		if (sceneDepth >= samplePosition.z + DEPTH_BIAS)
+		{
+			occlusion += rangeWeight;
+		}
+	}
+
+	float ambient = 1.0 - occlusion / float(SAMPLE_COUNT);
+	imageStore(occlusionImage, targetPixel, vec4(ambient, -position.z, 0.0, 0.0));
+}
+
+#elif AO_PASS == PASS_ACCUMULATE
+
+uniform mat4 inverseView;
+// view values of the frame the history was built in
+uniform mat4 previousView;
+uniform mat4 previousViewProjection;
+// weight of this frame - one when there is no history
+uniform float historyBlend;
+
+layout(binding = 21) uniform sampler2D historyMap;
+layout(rg16f, binding = 0) readonly uniform image2D occlusionImage;
+layout(rg16f, binding = 1) writeonly uniform image2D historyImage;
+
+/***********************************************************
+ *  main()
+ *
+ *  Find where the surface point of a pixel was in the last
+ *  frame, and blend the new occlusion into the history
+ *  there, unless the depth shows the history holds another
+ *  surface.
+ ***********************************************************/
+void main()
+{
+	ivec2 targetPixel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(targetPixel, ivec2(targetSize))))
+	{
+		return;
+	}
+
+	vec2 current = imageLoad(occlusionImage, targetPixel).rg;
+	float ambient = current.r;
+
+	if ((current.g < SKY_DEPTH) && (historyBlend < 1.0))
+	{
+		vec3 position = GetViewPosition(GetFramePixel(targetPixel));
+		vec4 worldPosition = inverseView * vec4(position, 1.0);
+		vec4 previousClip = previousViewProjection * worldPosition;
+		vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+		float previousDepth = -(previousView * worldPosition).z;
+
+		if (all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThan(previousUV, vec2(1.0))))
+		{
+			// from a frame pixel position to the reduced
+			// resolution pixel whose center stands for it
+			vec2 previousPixel = previousUV * frameSize;
+			vec2 historyCoordinate = (previousPixel - 0.5 - float(resolutionDivisor / 2)) / float(resolutionDivisor) + 0.5;
+			vec2 history = texture(historyMap, historyCoordinate / vec2(textureSize(historyMap, 0))).rg;
+
+			if (abs(history.g - previousDepth) < (0.05 * previousDepth + 0.02))
+			{
+				ambient = mix(history.r, current.r, historyBlend);
+			}
+		}
+	}
+
+	imageStore(historyImage, targetPixel, vec4(ambient, current.g, 0.0, 0.0));
+}
+
+#else
+
+// how far the frame is darkened where it is fully occluded
+uniform float strength;
+
+layout(rg16f, binding = 0) readonly uniform image2D historyImage;
+layout(rgba16f, binding = 1) uniform image2D frameImage;
+
+/***********************************************************
+ *  main()
+ *
+ *  Blend the four nearest reduced resolution pixels of the
+ *  history, favoring the ones at the depth of this pixel,
+ *  and darken the frame color by the result.
+ ***********************************************************/
+void main()
+{
+	ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(pixel, ivec2(frameSize))) || IsSky(pixel))
+	{
+		return;
+	}
+
+	float depth = -GetViewPosition(pixel).z;
+
+	// position among the reduced resolution pixels, whose
+	// centers sit on the frame pixels they stand for
+	vec2 coordinate = (vec2(pixel) - float(resolutionDivisor / 2)) / float(resolutionDivisor);
+	ivec2 base = ivec2(floor(coordinate));
+	vec2 fraction = coordinate - vec2(base);
+	ivec2 maxTarget = ivec2(targetSize) - 1;
+
+	float ambient = 0.0;
+	float totalWeight = 0.0;
+	for (int i = 0; i < 4; i++)
+	{
+		ivec2 offset = ivec2(i & 1, i >> 1);
+		vec2 tap = imageLoad(historyImage, clamp(base + offset, ivec2(0), maxTarget)).rg;
+		vec2 bilinear = mix(1.0 - fraction, fraction, vec2(offset));
+		// a tap on another surface hardly counts, so the
+		// occlusion stays on its side of a depth edge
+		float depthWeight = exp(-abs(tap.g - depth) / (0.02 * depth));
+		float weight = bilinear.x * bilinear.y * depthWeight + 0.00001;
+		ambient += tap.r * weight;
+		totalWeight += weight;
+	}
+	ambient /= totalWeight;
+
+	vec4 color = imageLoad(frameImage, pixel);
+	color.rgb *= mix(1.0, ambient, strength);
+	imageStore(frameImage, pixel, color);
+}
+
+#endif
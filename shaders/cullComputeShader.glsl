@@ -0,0 +1,140 @@
+#version 460 core
+
+// each invocation culls one scene object
+layout(local_size_x = 64) in;
+
+// number of levels of detail per mesh and the index of the
+// transparent bucket - must match the C++ side
+const uint LOD_COUNT = 3;
+const uint TRANSPARENT_BUCKET = 7;
+// objects with a higher mesh value use imported meshes,
+// which are drawn by the CPU - must match the C++ side
+const uint MESH_TYPE_COUNT = 7;
+// most views culled in one pass - must match the C++ side
+const int MAX_VIEWS = 4;
+
+struct ObjectRecord
+{
+	vec4 boundingSphere;
+	uint mesh;
+	uint bTransparent;
+	uint padding0;
+	uint padding1;
+};
+
+struct MeshLOD
+{
+	uint firstIndex;
+	uint indexCount;
+	int baseVertex;
+	uint padding;
+};
+
+struct DrawCommand
+{
+	uint count;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std430, binding = 2) readonly buffer ObjectRecords
+{
+	ObjectRecord objects[];
+};
+
+layout(std430, binding = 3) readonly buffer MeshLODs
+{
+	MeshLOD meshLODs[];
+};
+
+layout(std430, binding = 4) writeonly buffer DrawCommands
+{
+	DrawCommand commands[];
+};
+
+layout(std430, binding = 5) buffer DrawCounts
+{
+	uint drawCounts[];
+};
+
+uniform int viewCount;
+uniform mat4 viewProjections[MAX_VIEWS];
+uniform vec4 frustumPlanes[MAX_VIEWS * 6];
+uniform vec2 lodThresholds;
+uniform uint objectCount;
+uniform uint bucketCapacity;
+
+void main()
+{
+	uint objectIndex = gl_GlobalInvocationID.x;
+	if (objectIndex >= objectCount)
+	{
+		return;
+	}
+
+	ObjectRecord object = objects[objectIndex];
+	if (object.mesh >= MESH_TYPE_COUNT)
+	{
+		return;
+	}
+
+	vec3 center = object.boundingSphere.xyz;
+	float radius = object.boundingSphere.w;
+
+	// keep the object if any view sees it, and pick the level
+	// of detail from the view it is largest in
+	bool bVisible = false;
+	float projectedSize = 0.0;
+	for (int view = 0; view < viewCount; view++)
+	{
+		bool bInView = true;
+		for (int i = 0; i < 6; i++)
+		{
+			vec4 plane = frustumPlanes[view * 6 + i];
+			if (dot(plane.xyz, center) + plane.w < -radius)
+			{
+				bInView = false;
+				break;
+			}
+		}
+
+		if (bInView)
+		{
+			float clipW = max((viewProjections[view] * vec4(center, 1.0)).w, 0.0001);
+			projectedSize = max(projectedSize, radius / clipW);
+			bVisible = true;
+		}
+	}
+
+	if (!bVisible)
+	{
+		return;
+	}
+
+	uint lod = LOD_COUNT - 1;
+	if (projectedSize > lodThresholds.x)
+	{
+		lod = 0;
+	}
+	else if (projectedSize > lodThresholds.y)
+	{
+		lod = 1;
+	}
+
+	MeshLOD meshLOD = meshLODs[object.mesh * LOD_COUNT + lod];
+	uint bucket = (object.bTransparent != 0) ? TRANSPARENT_BUCKET : object.mesh;
+	uint slot = atomicAdd(drawCounts[bucket], 1);
+
+	DrawCommand command;
+	command.count = meshLOD.indexCount;
+	// one instance per view, each sent to its own viewport
+	command.instanceCount = uint(viewCount);
+	command.firstIndex = meshLOD.firstIndex;
+	command.baseVertex = meshLOD.baseVertex;
+	// with the draw index divisor set to the view count, every
+	// instance of the command reads this object's index
+	command.baseInstance = objectIndex;
+	commands[bucket * bucketCapacity + slot] = command;
+}
@@ -0,0 +1,357 @@
+///////////////////////////////////////////////////////////////////////////////
+// fragmentShader.glsl
+// ============
+// light and color the scene fragments using the per-draw records
+///////////////////////////////////////////////////////////////////////////////
+
+#version 460 core
+
+#define TOTAL_TEXTURES 16
+
+// variant switches - ShaderVariants defines these after the
+// #version line, and the defaults build the general program
+// 0 no texture, 1 always textured, 2 decided per draw record
+#ifndef TEXTURE_MODE
+#define TEXTURE_MODE 2
+#endif
+#ifndef USE_LIGHTING
+#define USE_LIGHTING 1
+#endif
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT 4
+#endif
+// opaque variants write an alpha of 1
+#ifndef TRANSPARENT
+#define TRANSPARENT 1
+#endif
+// metallic and roughness shading lit by the environment maps
+#ifndef USE_PBR
+#define USE_PBR 0
+#endif
+// draw records with an atlas square read the baked lightmap
+// instead of evaluating the light sources
+#ifndef USE_LIGHTMAPS
+#define USE_LIGHTMAPS 0
+#endif
+
+// per-draw values - must match DrawDataBuffer::DRAW_RECORD
+struct DrawRecord
+{
+	mat4 model;
+	vec4 color;
+	vec2 UVscale;
+	// 16 bit index into the material table, in the low bits
+	uint materialIndex;
+	uint padding;
+	// square of the lightmap atlas, zero without a lightmap
+	vec4 lightmapScaleOffset;
+};
+
+// material values - must match SceneManager::MATERIAL_RECORD
+struct Material
+{
+	vec4 ambientColorStrength;
+	vec4 diffuseColor;
+	vec4 specularColorShininess;
+	// albedo, normal and roughness texture units, -1 where
+	// the material has none
+	ivec4 textureSet;
+	// metallic and roughness, for the physically based shading
+	vec4 metallicRoughness;
+};
+
+struct LightSource
+{
+	vec3 position;
+	vec3 ambientColor;
+	vec3 diffuseColor;
+	vec3 specularColor;
+	float focalStrength;
+	float specularIntensity;
+};
+
+layout (std430, binding = 0) readonly buffer DrawRecords
+{
+	DrawRecord drawRecords[];
+};
+
+layout (std430, binding = 1) readonly buffer Materials
+{
+	Material materials[];
+};
+
+in vec3 fragmentPosition;
+in vec3 fragmentVertexNormal;
+in vec2 fragmentTextureCoordinate;
+in vec2 fragmentLightmapCoordinate;
+in vec3 fragmentViewPosition;
+flat in uint fragmentDrawIndex;
+
+out vec4 outFragmentColor;
+
+// the scene textures are bound to texture units 0 to 15
+layout (binding = 0) uniform sampler2D sceneTextures[TOTAL_TEXTURES];
+#if USE_LIGHTING
+uniform LightSource lightSources[LIGHT_COUNT];
+#endif
+
+#if USE_PBR
+// environment lighting maps - the units must match
+// EnvironmentLighting, after the scene textures
+layout (binding = 16) uniform samplerCube irradianceMap;
+layout (binding = 17) uniform samplerCube specularMap;
+layout (binding = 18) uniform sampler2D brdfLookup;
+
+const float PI = 3.14159265f;
+#endif
+
+#if USE_LIGHTMAPS
+// baked diffuse light of the static objects - the unit must
+// match LightmapBaker, after the environment maps
+layout (binding = 19) uniform sampler2D lightmap;
+// ambient colors of all the light sources added together
+uniform vec3 ambientLight;
+#endif
+
+/***********************************************************
+ *  PerturbNormal()
+ *
+ *  Bend the normal by a tangent space normal map.  The scene
+ *  meshes carry no tangents, so the tangent frame is built
+ *  from the screen space derivatives of the position and the
+ *  texture coordinate.
+ ***********************************************************/
+vec3 PerturbNormal(vec3 normal, vec3 mapNormal)
+{
+	vec3 positionDX = dFdx(fragmentPosition);
+	vec3 positionDY = dFdy(fragmentPosition);
+	vec2 textureDX = dFdx(fragmentTextureCoordinate);
+	vec2 textureDY = dFdy(fragmentTextureCoordinate);
+
+	vec3 perpendicularDY = cross(positionDY, normal);
+	vec3 perpendicularDX = cross(normal, positionDX);
+	vec3 tangent = perpendicularDY * textureDX.x + perpendicularDX * textureDY.x;
+	vec3 bitangent = perpendicularDY * textureDX.y + perpendicularDX * textureDY.y;
+	float scale = inversesqrt(max(dot(tangent, tangent), dot(bitangent, bitangent)));
+
+	return(normalize(mat3(tangent * scale, bitangent * scale, normal) * mapNormal));
+}
+
+/***********************************************************
+ *  CalcLightSource()
+ *
+ *  Calculate the ambient, diffuse and specular lighting
+ *  that one light source contributes to the fragment.
+ ***********************************************************/
+vec3 CalcLightSource(LightSource light, Material material, float glossiness, vec3 lightNormal, vec3 vertexPosition, vec3 viewDirection)
+{
+	vec3 ambient;
+	vec3 diffuse;
+	vec3 specular;
+
+	// calculate the ambient lighting
+	ambient = light.ambientColor * material.ambientColorStrength.rgb * material.ambientColorStrength.a;
+
+	// calculate the diffuse lighting
+	vec3 lightDirection = normalize(light.position - vertexPosition);
+	float impact = max(dot(lightNormal, lightDirection), 0.0f);
+	diffuse = impact * material.diffuseColor.rgb * light.diffuseColor;
+
+	// calculate the specular lighting
+	vec3 reflectDirection = reflect(-lightDirection, lightNormal);
+	float specularComponent = pow(max(dot(viewDirection, reflectDirection), 0.0f), light.focalStrength);
+	specular = light.specularIntensity * specularComponent * glossiness * material.specularColorShininess.rgb * light.specularColor;
+
+	return(ambient + diffuse + specular);
+}
+
+#if USE_PBR
+/***********************************************************
+ *  FresnelSchlick()
+ *
+ *  Approximate the share of the light that is reflected at
+ *  an angle.  Rough surfaces reflect less at grazing angles.
+ ***********************************************************/
+vec3 FresnelSchlick(float cosTheta, vec3 F0, float roughness)
+{
+	return(F0 + (max(vec3(1.0f - roughness), F0) - F0) * pow(clamp(1.0f - cosTheta, 0.0f, 1.0f), 5.0f));
+}
+
+#if USE_LIGHTING
+/***********************************************************
+ *  AddLightSourcePBR()
+ *
+ *  Add the diffuse and the GGX specular light that one light
+ *  source contributes to the fragment.  The light colors
+ *  were tuned for the Phong terms, so a surface facing a
+ *  light is given its color as the diffuse result.
+ ***********************************************************/
+void AddLightSourcePBR(
+	LightSource light,
+	vec3 albedo,
+	float metallic,
+	float roughness,
+	vec3 F0,
+	vec3 normal,
+	vec3 viewDirection,
+	inout vec3 diffuse,
+	inout vec3 specular)
+{
+	vec3 lightDirection = normalize(light.position - fragmentPosition);
+	vec3 halfVector = normalize(viewDirection + lightDirection);
+	float NdotL = max(dot(normal, lightDirection), 0.0f);
+	float NdotV = max(dot(normal, viewDirection), 0.0001f);
+	float NdotH = max(dot(normal, halfVector), 0.0f);
+
+	float alpha = roughness * roughness;
+	float alpha2 = alpha * alpha;
+	float denominator = NdotH * NdotH * (alpha2 - 1.0f) + 1.0f;
+	float distribution = alpha2 / (PI * denominator * denominator);
+	float k = (roughness + 1.0f) * (roughness + 1.0f) / 8.0f;
+	float geometry = (NdotV / (NdotV * (1.0f - k) + k)) * (NdotL / (NdotL * (1.0f - k) + k));
+	vec3 fresnel = FresnelSchlick(max(dot(halfVector, viewDirection), 0.0f), F0, 0.0f);
+
+	vec3 irradiance = light.diffuseColor * NdotL;
+	diffuse += (1.0f - fresnel) * (1.0f - metallic) * albedo * irradiance;
+	specular += PI * distribution * geometry * fresnel / (4.0f * NdotV * max(NdotL, 0.0001f)) * irradiance;
+}
+#endif
+
+/***********************************************************
+ *  ShadePhysicallyBased()
+ *
+ *  Light the fragment with the environment maps and the
+ *  light sources.  The diffuse light comes from the
+ *  irradiance map, and the reflections from the specular
+ *  mip of the roughness scaled by the split sum lookup.
+ *  The colors are stored gamma encoded, so they are decoded
+ *  for the lighting and encoded again after it.
+ ***********************************************************/
+vec4 ShadePhysicallyBased(Material material, vec4 baseColor, float roughness, vec3 normal, vec3 viewDirection, bool bLightmapped, vec3 bakedLight)
+{
+	float alpha = baseColor.a;
+	vec3 albedo = pow(baseColor.rgb / max(alpha, 0.001f), vec3(2.2f));
+	float metallic = material.metallicRoughness.x;
+	vec3 F0 = mix(vec3(0.04f), albedo, metallic);
+	float NdotV = max(dot(normal, viewDirection), 0.0001f);
+
+	vec3 fresnel = FresnelSchlick(NdotV, F0, roughness);
+	vec3 diffuse = (1.0f - fresnel) * (1.0f - metallic) * albedo * texture(irradianceMap, normal).rgb;
+	float specularMip = roughness * float(textureQueryLevels(specularMap) - 1);
+	vec3 reflection = textureLod(specularMap, reflect(-viewDirection, normal), specularMip).rgb;
+	vec2 brdf = texture(brdfLookup, vec2(NdotV, roughness)).rg;
+	vec3 specular = reflection * (F0 * brdf.x + brdf.y);
+
+	// the baked light holds the light sources and their
+	// bounces, so only the reflections come from the maps
+	if (bLightmapped)
+	{
+		diffuse += (1.0f - fresnel) * (1.0f - metallic) * albedo * bakedLight;
+	}
+#if USE_LIGHTING
+	else
+	{
+		for (int i = 0; i < LIGHT_COUNT; i++)
+		{
+			AddLightSourcePBR(lightSources[i], albedo, metallic, roughness, F0, normal, viewDirection, diffuse, specular);
+		}
+	}
+#endif
+
+	// the colors are premultiplied, so the reflections on
+	// glass are not faded by its alpha
+	vec3 color = diffuse * alpha + specular;
+
+	return(vec4(pow(color, vec3(1.0f / 2.2f)), alpha));
+}
+#endif
+
+void main()
+{
+	DrawRecord record = drawRecords[fragmentDrawIndex];
+	Material material = materials[record.materialIndex & 0xFFFFu];
+	// colors are blended with premultiplied alpha, like the
+	// textures are stored
+	vec4 baseColor = vec4(record.color.rgb * record.color.a, record.color.a);
+
+	// the material is the same for the whole draw, so its
+	// texture units are safe to use for indexing the sampler
+	// array
+#if TEXTURE_MODE == 1
+	baseColor = texture(sceneTextures[material.textureSet.x], fragmentTextureCoordinate);
+#elif TEXTURE_MODE == 2
+	if (material.textureSet.x >= 0)
+	{
+		baseColor = texture(sceneTextures[material.textureSet.x], fragmentTextureCoordinate);
+	}
+#endif
+
+#if !TRANSPARENT
+	baseColor.a = 1.0f;
+#endif
+
+#if USE_LIGHTING || USE_PBR
+	vec3 lightNormal = normalize(fragmentVertexNormal);
+	if (material.textureSet.y >= 0)
+	{
+		vec3 mapNormal = texture(sceneTextures[material.textureSet.y], fragmentTextureCoordinate).xyz * 2.0f - 1.0f;
+		lightNormal = PerturbNormal(lightNormal, mapNormal);
+	}
+	// the roughness map is read from the green channel
+	float roughnessSample = 0.0f;
+	if (material.textureSet.z >= 0)
+	{
+		roughnessSample = texture(sceneTextures[material.textureSet.z], fragmentTextureCoordinate).g;
+	}
+	vec3 viewDirection = normalize(fragmentViewPosition - fragmentPosition);
+#endif
+
+	// the atlas square is the same for the whole draw
+	bool bLightmapped = false;
+	vec3 bakedLight = vec3(0.0f);
+#if USE_LIGHTMAPS
+	if (record.lightmapScaleOffset.x > 0.0f)
+	{
+		bLightmapped = true;
+		bakedLight = texture(lightmap, fragmentLightmapCoordinate).rgb;
+	}
+#endif
+
+#if USE_PBR
+	{
+		float roughness = material.metallicRoughness.y;
+		if (material.textureSet.z >= 0)
+		{
+			roughness *= roughnessSample;
+		}
+		outFragmentColor = ShadePhysicallyBased(material, baseColor, clamp(roughness, 0.04f, 1.0f), lightNormal, viewDirection, bLightmapped, bakedLight);
+	}
+#elif USE_LIGHTING
+	{
+		// rough parts of the surface lose their highlights
+		float glossiness = 1.0f - roughnessSample;
+		vec3 phongResult = vec3(0.0f);
+
+#if USE_LIGHTMAPS
+		if (bLightmapped)
+		{
+			// the baked light replaces the diffuse terms, and
+			// the view dependent highlights are left out
+			phongResult = ambientLight * material.ambientColorStrength.rgb * material.ambientColorStrength.a +
+				bakedLight * material.diffuseColor.rgb;
+		}
+		else
+#endif
+		{
+			for (int i = 0; i < LIGHT_COUNT; i++)
+			{
+				phongResult += CalcLightSource(lightSources[i], material, glossiness, lightNormal, fragmentPosition, viewDirection);
+			}
+		}
+
+		outFragmentColor = vec4(phongResult * baseColor.rgb, baseColor.a);
+	}
+#else
+	outFragmentColor = baseColor;
+#endif
+}
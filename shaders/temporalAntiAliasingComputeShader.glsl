@@ -0,0 +1,77 @@
+#version 430 core
+
+// each invocation resolves one pixel, in 8 by 8 tiles - must
+// match the C++ side
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// depth of the drawn frame, and the resolved last frame
+layout(binding = 20) uniform sampler2D depthMap;
+layout(binding = 22) uniform sampler2D historyMap;
+
+layout(rgba16f, binding = 0) readonly uniform image2D frameImage;
+layout(rgba16f, binding = 1) writeonly uniform image2D historyImage;
+
+// view projection of this frame with and without its jitter,
+// and of the last frame without its jitter
+uniform mat4 inverseViewProjection;
+uniform mat4 viewProjection;
+uniform mat4 previousViewProjection;
+// size of the drawn part of the frame
+uniform vec2 frameSize;
+// weight of this frame - one when there is no history
+uniform float historyBlend;
+
+/***********************************************************
+ *  main()
+ *
+ *  Reproject a pixel into the last frame along its motion
+ *  vector, clamp the history found there to the colors
+ *  around the pixel, and blend this frame into it.
+ ***********************************************************/
+void main()
+{
+	ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+	ivec2 maxPixel = ivec2(frameSize) - 1;
+	if (any(greaterThan(pixel, maxPixel)))
+	{
+		return;
+	}
+
+	// range of the colors around the pixel, which any
+	// history that still belongs to it falls inside
+	vec3 current = imageLoad(frameImage, pixel).rgb;
+	vec3 minColor = current;
+	vec3 maxColor = current;
+	for (int y = -1; y <= 1; y++)
+	{
+		for (int x = -1; x <= 1; x++)
+		{
+			vec3 neighbor = imageLoad(frameImage, clamp(pixel + ivec2(x, y), ivec2(0), maxPixel)).rgb;
+			minColor = min(minColor, neighbor);
+			maxColor = max(maxColor, neighbor);
+		}
+	}
+
+	vec3 result = current;
+	if (historyBlend < 1.0)
+	{
+		// the motion vector is where the surface point of the
+		// pixel moved since the last frame, without the jitter
+		vec2 uv = (vec2(pixel) + 0.5) / frameSize;
+		float depth = texelFetch(depthMap, pixel, 0).r;
+		vec4 worldPosition = inverseViewProjection * vec4(uv * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+		worldPosition /= worldPosition.w;
+		vec4 currentClip = viewProjection * worldPosition;
+		vec4 previousClip = previousViewProjection * worldPosition;
+		vec2 motion = (currentClip.xy / currentClip.w - previousClip.xy / previousClip.w) * 0.5;
+		vec2 historyUV = uv - motion;
+
+		if (all(greaterThanEqual(historyUV, vec2(0.0))) && all(lessThan(historyUV, vec2(1.0))))
+		{
+			vec3 history = texture(historyMap, historyUV * frameSize / vec2(textureSize(historyMap, 0))).rgb;
+			result = mix(clamp(history, minColor, maxColor), current, historyBlend);
+		}
+	}
+
+	imageStore(historyImage, pixel, vec4(result, 1.0));
+}
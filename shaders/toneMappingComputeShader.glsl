@@ -0,0 +1,306 @@
+#version 430 core
+
+// TONE_MAPPING_PASS is defined by the C++ side to pick the
+// pass each program is built for
+#define PASS_BLOOM 0
+#define PASS_COMPOSE 1
+
+// must match the C++ side
+const int BLOOM_LEVEL_COUNT = 7;
+const uint HISTOGRAM_BIN_COUNT = 256u;
+
+// exposure applied to the frame, and the histogram and count
+// of finished work groups the bloom pass builds it from
+layout(std430, binding = 6) coherent buffer ExposureState
+{
+	float exposure;
+	uint finishedGroups;
+	uint padding0;
+	uint padding1;
+	uint histogram[HISTOGRAM_BIN_COUNT];
+};
+
+// size of the drawn part of the frame
+uniform vec2 frameSize;
+
+/***********************************************************
+ *  GetLuminance()
+ *
+ *  Get the brightness of a color as the eye sees it.
+ ***********************************************************/
+float GetLuminance(vec3 color)
+{
+	return(dot(color, vec3(0.2126, 0.7152, 0.0722)));
+}
+
+#if TONE_MAPPING_PASS == PASS_BLOOM
+
+// each work group builds every level of one 64 by 64 tile of
+// the first bloom level, with each thread starting from a
+// 4 by 4 block of it - must match the C++ side
+layout(local_size_x = 16, local_size_y = 16) in;
+
+// work groups in the dispatch
+uniform uint groupCount;
+// exposed luminance above which the frame blooms
+uniform float bloomThreshold;
+// log2 luminance spread over the histogram bins after the first
+uniform vec2 logLuminanceRange;
+// exposed brightness the average of the frame is brought to,
+// the range the exposure is kept in, and the share of the
+// way to it covered this frame
+uniform float exposureKey;
+uniform vec2 exposureRange;
+uniform float adaptation;
+
+layout(rgba16f, binding = 0) readonly uniform image2D frameImage;
+layout(r11f_g11f_b10f, binding = 1) writeonly uniform image2D bloomLevels[BLOOM_LEVEL_COUNT];
+
+// the levels from the third on, halved in place
+shared vec3 s_level[16][16];
+shared uint s_histogram[HISTOGRAM_BIN_COUNT];
+shared uint s_ticket;
+// sums of the histogram, for the last work group
+shared float s_binSum[HISTOGRAM_BIN_COUNT];
+shared float s_pixelCount[HISTOGRAM_BIN_COUNT];
+
+/***********************************************************
+ *  StoreLevel()
+ *
+ *  Write a texel of one of the bloom levels, with the image
+ *  picked by a constant index.
+ ***********************************************************/
+void StoreLevel(int level, ivec2 texel, vec3 color)
+{
+	vec4 value = vec4(color, 0.0);
+
+	switch (level)
+	{
+	case 0: imageStore(bloomLevels[0], texel, value); break;
+	case 1: imageStore(bloomLevels[1], texel, value); break;
+	case 2: imageStore(bloomLevels[2], texel, value); break;
+	case 3: imageStore(bloomLevels[3], texel, value); break;
+	case 4: imageStore(bloomLevels[4], texel, value); break;
+	case 5: imageStore(bloomLevels[5], texel, value); break;
+	default: imageStore(bloomLevels[6], texel, value); break;
+	}
+}
+
+/***********************************************************
+ *  GetHistogramBin()
+ *
+ *  Get the histogram bin of a luminance - the first bin
+ *  holds the black pixels.
+ ***********************************************************/
+uint GetHistogramBin(float luminance)
+{
+	if (luminance < 0.0001)
+	{
+		return(0u);
+	}
+
+	float t = clamp((log2(luminance) - logLuminanceRange.x) / (logLuminanceRange.y - logLuminanceRange.x), 0.0, 1.0);
+
+	return(uint(t * float(HISTOGRAM_BIN_COUNT - 2u)) + 1u);
+}
+
+/***********************************************************
+ *  main()
+ *
+ *  Build the bloom levels of a tile and add its texels to
+ *  the histogram.  The last work group to finish turns the
+ *  histogram into the exposure and empties it again.
+ ***********************************************************/
+void main()
+{
+	uint localIndex = gl_LocalInvocationIndex;
+	ivec2 localID = ivec2(gl_LocalInvocationID.xy);
+	ivec2 tile = ivec2(gl_WorkGroupID.xy);
+	ivec2 maxPixel = ivec2(frameSize) - 1;
+	ivec2 levelSize = (ivec2(frameSize) + 1) / 2;
+	float currentExposure = exposure;
+
+	s_histogram[localIndex] = 0u;
+	barrier();
+
+	// the first level keeps the bright part of each 2 by 2
+	// block of frame pixels
+	vec3 block[4][4];
+	for (int y = 0; y < 4; y++)
+	{
+		for (int x = 0; x < 4; x++)
+		{
+			ivec2 texel = tile * 64 + localID * 4 + ivec2(x, y);
+			ivec2 pixel = texel * 2;
+			vec3 c0 = imageLoad(frameImage, min(pixel, maxPixel)).rgb;
+			vec3 c1 = imageLoad(frameImage, min(pixel + ivec2(1, 0), maxPixel)).rgb;
+			vec3 c2 = imageLoad(frameImage, min(pixel + ivec2(0, 1), maxPixel)).rgb;
+			vec3 c3 = imageLoad(frameImage, min(pixel + ivec2(1, 1), maxPixel)).rgb;
+
+			if (all(lessThan(texel, levelSize)))
+			{
+				atomicAdd(s_histogram[GetHistogramBin(GetLuminance((c0 + c1 + c2 + c3) * 0.25))], 1u);
+			}
+
+			// weighting the pixels down by their brightness keeps
+			// a single bright pixel from flickering in the bloom
+			float w0 = 1.0 / (1.0 + GetLuminance(c0) * currentExposure);
+			float w1 = 1.0 / (1.0 + GetLuminance(c1) * currentExposure);
+			float w2 = 1.0 / (1.0 + GetLuminance(c2) * currentExposure);
+			float w3 = 1.0 / (1.0 + GetLuminance(c3) * currentExposure);
+			vec3 color = (c0 * w0 + c1 * w1 + c2 * w2 + c3 * w3) / (w0 + w1 + w2 + w3);
+
+			float brightness = GetLuminance(color) * currentExposure;
+			block[y][x] = color * (max(brightness - bloomThreshold, 0.0) / max(brightness, 0.0001));
+			StoreLevel(0, texel, block[y][x]);
+		}
+	}
+
+	// the second and third levels come from the thread's own block
+	vec3 level2 = vec3(0.0);
+	for (int y = 0; y < 2; y++)
+	{
+		for (int x = 0; x < 2; x++)
+		{
+			vec3 color = (block[y * 2][x * 2] + block[y * 2][x * 2 + 1] +
+				block[y * 2 + 1][x * 2] + block[y * 2 + 1][x * 2 + 1]) * 0.25;
+			StoreLevel(1, tile * 32 + localID * 2 + ivec2(x, y), color);
+			level2 += color * 0.25;
+		}
+	}
+	StoreLevel(2, tile * 16 + localID, level2);
+	s_level[localID.y][localID.x] = level2;
+	barrier();
+
+	// the rest are halved in shared memory by fewer and fewer
+	// of the threads
+	for (int level = 3; level < BLOOM_LEVEL_COUNT; level++)
+	{
+		int size = 16 >> (level - 2);
+		bool bActive = all(lessThan(localID, ivec2(size)));
+		vec3 color = vec3(0.0);
+		if (bActive)
+		{
+			ivec2 source = localID * 2;
+			color = (s_level[source.y][source.x] + s_level[source.y][source.x + 1] +
+				s_level[source.y + 1][source.x] + s_level[source.y + 1][source.x + 1]) * 0.25;
+		}
+		barrier();
+		if (bActive)
+		{
+			s_level[localID.y][localID.x] = color;
+			StoreLevel(level, tile * size + localID, color);
+		}
+		barrier();
+	}
+
+	// add the tile's histogram to the frame's
+	if (s_histogram[localIndex] > 0u)
+	{
+		atomicAdd(histogram[localIndex], s_histogram[localIndex]);
+	}
+
+	// the histogram must be complete before this work group
+	// counts as finished
+	memoryBarrierBuffer();
+	barrier();
+	if (localIndex == 0u)
+	{
+		s_ticket = atomicAdd(finishedGroups, 1u);
+	}
+	barrier();
+	if (s_ticket != (groupCount - 1u))
+	{
+		return;
+	}
+
+	// the last work group reads every bin and empties it for
+	// the next frame - the black pixels of the first bin say
+	// nothing about how bright the lit scene is
+	uint pixelCount = atomicExchange(histogram[localIndex], 0u);
+	s_binSum[localIndex] = (localIndex == 0u) ? 0.0 : float(pixelCount) * (float(localIndex) - 0.5);
+	s_pixelCount[localIndex] = (localIndex == 0u) ? 0.0 : float(pixelCount);
+	barrier();
+	for (uint stride = HISTOGRAM_BIN_COUNT / 2u; stride > 0u; stride >>= 1u)
+	{
+		if (localIndex < stride)
+		{
+			s_binSum[localIndex] += s_binSum[localIndex + stride];
+			s_pixelCount[localIndex] += s_pixelCount[localIndex + stride];
+		}
+		barrier();
+	}
+
+	if (localIndex == 0u)
+	{
+		finishedGroups = 0u;
+		if (s_pixelCount[0] > 0.0)
+		{
+			float averageBin = s_binSum[0] / s_pixelCount[0];
+			float logLuminance = mix(logLuminanceRange.x, logLuminanceRange.y,
+				averageBin / float(HISTOGRAM_BIN_COUNT - 2u));
+			float targetExposure = clamp(exposureKey / exp2(logLuminance), exposureRange.x, exposureRange.y);
+			exposure = mix(currentExposure, targetExposure, adaptation);
+		}
+	}
+}
+
+#else
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// size the first bloom level is allocated at
+uniform vec2 bloomSize;
+// how much of the bloom is added to the frame
+uniform float bloomStrength;
+
+layout(binding = 23) uniform sampler2D bloomMap;
+layout(rgba16f, binding = 0) uniform image2D frameImage;
+
+/***********************************************************
+ *  ToneMap()
+ *
+ *  Fit of the ACES filmic curve, which rolls the bright
+ *  light off towards white instead of clipping it.
+ ***********************************************************/
+vec3 ToneMap(vec3 color)
+{
+	return(clamp((color * (2.51 * color + 0.03)) / (color * (2.43 * color + 0.59) + 0.14), 0.0, 1.0));
+}
+
+/***********************************************************
+ *  main()
+ *
+ *  Add the bloom levels at a frame pixel, expose it and
+ *  tone map it in place.
+ ***********************************************************/
+void main()
+{
+	ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(pixel, ivec2(frameSize))))
+	{
+		return;
+	}
+
+	// the first level is half the frame resolution, and four
+	// bilinear taps half a texel apart make a tent filter that
+	// hides the blocks of the coarse levels
+	vec2 uv = (vec2(pixel) + 0.5) * 0.5 / bloomSize;
+	vec3 bloom = vec3(0.0);
+	for (int level = 0; level < BLOOM_LEVEL_COUNT; level++)
+	{
+		vec2 offset = 0.5 * exp2(float(level)) / bloomSize;
+		float lod = float(level);
+		bloom += textureLod(bloomMap, uv + vec2(-offset.x, -offset.y), lod).rgb;
+		bloom += textureLod(bloomMap, uv + vec2(offset.x, -offset.y), lod).rgb;
+		bloom += textureLod(bloomMap, uv + vec2(-offset.x, offset.y), lod).rgb;
+		bloom += textureLod(bloomMap, uv + vec2(offset.x, offset.y), lod).rgb;
+	}
+	bloom *= 0.25 / float(BLOOM_LEVEL_COUNT);
+
+	vec4 color = imageLoad(frameImage, pixel);
+	vec3 exposed = (color.rgb + bloom * bloomStrength) * exposure;
+	imageStore(frameImage, pixel, vec4(ToneMap(exposed), color.a));
+}
+
+#endif
@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexShader.glsl
+// ============
+// transform the scene vertices using the per-draw records
+///////////////////////////////////////////////////////////////////////////////
+
+#version 460 core
+
+// lets the vertex shader pick the viewport for single-pass multi-view
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_viewport_index : enable
+
+#define MAX_VIEWS 4
+
+// with packed vertices the position is 0 to 1 inside the mesh
+// bounds and the normal is octahedral encoded in x and y
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+// second UV set, only the scene meshes have it
+layout (location = 3) in vec2 inLightmapCoordinate;
+// index of the draw record - set as a constant vertex attribute
+layout (location = 7) in uint inDrawIndex;
+
+// per-draw values - must match DrawDataBuffer::DRAW_RECORD
+struct DrawRecord
+{
+	mat4 model;
+	vec4 color;
+	vec2 UVscale;
+	// 16 bit index into the material table, in the low bits
+	uint materialIndex;
+	uint padding;
+	// square of the lightmap atlas, zero without a lightmap
+	vec4 lightmapScaleOffset;
+};
+
+layout (std430, binding = 0) readonly buffer DrawRecords
+{
+	DrawRecord drawRecords[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 viewPosition;
+
+// decoding of the packed vertex layout
+uniform bool bPackedVertices = false;
+uniform vec3 packedPositionOffset;
+uniform vec3 packedPositionScale;
+
+// single-pass multi-view - when more than one view is set, each
+// draw is instanced once per view and every instance is sent to
+// its own viewport
+uniform int viewCount = 1;
+uniform mat4 viewProjections[MAX_VIEWS];
+uniform vec3 viewPositions[MAX_VIEWS];
+
+out vec3 fragmentPosition;
+out vec3 fragmentVertexNormal;
+out vec2 fragmentTextureCoordinate;
+out vec2 fragmentLightmapCoordinate;
+out vec3 fragmentViewPosition;
+flat out uint fragmentDrawIndex;
+
+/***********************************************************
+ *  DecodeOctahedral()
+ *
+ *  Unfold an octahedral encoded normal back into a unit
+ *  vector.
+ ***********************************************************/
+vec3 DecodeOctahedral(vec2 encoded)
+{
+	vec3 normal = vec3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+	float fold = max(-normal.z, 0.0f);
+	normal.x += (normal.x >= 0.0f) ? -fold : fold;
+	normal.y += (normal.y >= 0.0f) ? -fold : fold;
+
+	return(normalize(normal));
+}
+
+void main()
+{
+	vec3 vertexPosition = inVertexPosition;
+	vec3 vertexNormal = inVertexNormal;
+	if (bPackedVertices == true)
+	{
+		vertexPosition = packedPositionOffset + (inVertexPosition * packedPositionScale);
+		vertexNormal = DecodeOctahedral(inVertexNormal.xy);
+	}
+
+	mat4 model = drawRecords[inDrawIndex].model;
+	vec4 worldPosition = model * vec4(vertexPosition, 1.0f);
+
+	// transform the vertex into clip coordinates
+	if (viewCount > 1)
+	{
+		int viewIndex = gl_InstanceID % viewCount;
+		gl_Position = viewProjections[viewIndex] * worldPosition;
+		fragmentViewPosition = viewPositions[viewIndex];
+#if defined(GL_ARB_shader_viewport_layer_array) || defined(GL_AMD_vertex_shader_viewport_index)
+		gl_ViewportIndex = viewIndex;
+#endif
+	}
+	else
+	{
+		gl_Position = projection * view * worldPosition;
+		fragmentViewPosition = viewPosition;
+	}
+
+	// pass the world position, normal and scaled texture
+	// coordinates on to the fragment shader
+	fragmentPosition = vec3(worldPosition);
+	fragmentVertexNormal = mat3(transpose(inverse(model))) * vertexNormal;
+	fragmentTextureCoordinate = inTextureCoordinate * drawRecords[inDrawIndex].UVscale;
+	vec4 lightmapScaleOffset = drawRecords[inDrawIndex].lightmapScaleOffset;
+	fragmentLightmapCoordinate = inLightmapCoordinate * lightmapScaleOffset.xy + lightmapScaleOffset.zw;
+	fragmentDrawIndex = inDrawIndex;
+}